@@ -0,0 +1,29 @@
+#!/usr/bin/env bash
+# Builds a benchmark program twice, once with each set of valec flags, and
+# compares their run times using scripts/smoke_benchmark.sh.
+#
+# Usage, from the Backend directory:
+#   ./benchmarks/bench.sh <program.vale> "<old valec flags>" "<new valec flags>" [program args...]
+#
+# VALEC can point at a different valec, and REGION picks the region (default resilient-v3).
+
+PROGRAM="$1"
+if [ "$PROGRAM" == "" ] ; then
+  echo "First arg should be the benchmark program"
+  exit 1
+fi
+shift;
+
+OLD_FLAGS="$1"
+shift;
+NEW_FLAGS="$1"
+shift;
+
+VALEC="${VALEC:-../Driver/build/valec}"
+REGION="${REGION:-resilient-v3}"
+NAME=$(basename "$PROGRAM" .vale)
+
+$VALEC build "bench=$PROGRAM" --no_std true --region_override $REGION --output_dir "benchbuild/${NAME}_old" -o main $OLD_FLAGS || { echo "Building old failed!" && exit 1; }
+$VALEC build "bench=$PROGRAM" --no_std true --region_override $REGION --output_dir "benchbuild/${NAME}_new" -o main $NEW_FLAGS || { echo "Building new failed!" && exit 1; }
+
+../scripts/smoke_benchmark.sh "benchbuild/${NAME}_old/main" "benchbuild/${NAME}_new/main" "$@"
@@ -0,0 +1,211 @@
+// Microbenchmark for the number formatting and parsing in builtins/numbers.c, against the
+// snprintf/strtol paths they replaced. Checks them first: integers must match snprintf, floats
+// must parse back to the same double and be no longer than the shortest %.Ng that does, and
+// the parser must match a plain digit loop. From the Backend directory:
+//   cc -O2 benchmarks/numbers_bench.c -o numbers_bench && ./numbers_bench
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../builtins/strings.c"
+#include "../builtins/numbers.c"
+
+static double nowNs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static uint64_t rngState = 88172645463325252ull;
+static uint64_t nextRandom() {
+  rngState ^= rngState << 13;
+  rngState ^= rngState >> 7;
+  rngState ^= rngState << 17;
+  return rngState;
+}
+
+static double randomFiniteDouble() {
+  for (;;) {
+    uint64_t bits = nextRandom();
+    double f;
+    memcpy(&f, &bits, sizeof(f));
+    if (f == f && f - f == 0) {
+      return f;
+    }
+  }
+}
+
+// How many significant digits the shortest round-tripping %.Ng needs.
+static int shortestPrintfDigits(double f) {
+  char buffer[40];
+  for (int precision = 1; precision < 17; precision++) {
+    snprintf(buffer, sizeof(buffer), "%.*g", precision, f);
+    if (strtod(buffer, NULL) == f) {
+      return precision;
+    }
+  }
+  return 17;
+}
+
+static int countSignificantDigits(const char* str) {
+  int count = 0;
+  int leadingZeros = 1;
+  int trailingZeros = 0;
+  for (const char* c = str; *c && *c != 'e'; c++) {
+    if (*c >= '0' && *c <= '9') {
+      if (*c == '0' && leadingZeros) {
+        continue;
+      }
+      leadingZeros = 0;
+      count++;
+      trailingZeros = *c == '0' ? trailingZeros + 1 : 0;
+    }
+  }
+  return count - trailingZeros;
+}
+
+static int64_t parseIntNaive(const char* chars, ValeInt length) {
+  const char* p = chars;
+  int negative = length > 0 && *p == '-';
+  p += negative;
+  if (p == chars + length) {
+    return VALE_PARSE_INT_INVALID;
+  }
+  uint32_t total = 0;
+  for (; p < chars + length; p++) {
+    if (*p < '0' || *p > '9') {
+      return VALE_PARSE_INT_INVALID;
+    }
+    total = total * 10 + (*p - '0');
+  }
+  return (int64_t)(int32_t)(negative ? 0u - total : total);
+}
+
+static void check() {
+  char buffer[40];
+  char expected[40];
+  int64_t edgeInts[] = { 0, 1, -1, 9, 10, 99, 100, -100, INT64_MAX, INT64_MIN, 1234567890123ll };
+  for (int i = 0; i < (int)(sizeof(edgeInts) / sizeof(edgeInts[0])) + 1000000; i++) {
+    int64_t x = i < (int)(sizeof(edgeInts) / sizeof(edgeInts[0])) ? edgeInts[i] :
+        (int64_t)(nextRandom() >> (nextRandom() % 64));
+    buffer[formatI64(buffer, x)] = 0;
+    snprintf(expected, sizeof(expected), "%lld", (long long)x);
+    if (strcmp(buffer, expected) != 0) {
+      fprintf(stderr, "formatI64(%s) gave %s!\n", expected, buffer);
+      exit(1);
+    }
+  }
+
+  double edgeFloats[] = { 0.1, 0.3, 1.0, 42.25, 1e21, 1e22, 1e-6, 1e-7, 5e-324, 1.7976931348623157e308, 2.2250738585072014e-308 };
+  for (int i = 0; i < (int)(sizeof(edgeFloats) / sizeof(edgeFloats[0])) + 200000; i++) {
+    double f = i < (int)(sizeof(edgeFloats) / sizeof(edgeFloats[0])) ? edgeFloats[i] : randomFiniteDouble();
+    buffer[formatDouble(buffer, f)] = 0;
+    if (strtod(buffer, NULL) != f) {
+      fprintf(stderr, "formatDouble(%.17g) gave %s, which doesn't round-trip!\n", f, buffer);
+      exit(1);
+    }
+    if (countSignificantDigits(buffer) > shortestPrintfDigits(f)) {
+      fprintf(stderr, "formatDouble(%.17g) gave %s, which isn't the shortest!\n", f, buffer);
+      exit(1);
+    }
+  }
+
+  const char* alphabet = "0123456789-x";
+  for (int i = 0; i < 1000000; i++) {
+    int length = nextRandom() % 24;
+    for (int j = 0; j < length; j++) {
+      // Mostly digits, so that plenty of them parse.
+      uint64_t r = nextRandom() % 100;
+      buffer[j] = r < 97 ? alphabet[r % 10] : alphabet[10 + r % 2];
+    }
+    if (length > 0 && nextRandom() % 2) {
+      buffer[0] = '-';
+    }
+    if (__vale_strParseIntBytes(buffer, length) != parseIntNaive(buffer, length)) {
+      fprintf(stderr, "__vale_strParseIntBytes disagreed on %.*s!\n", length, buffer);
+      exit(1);
+    }
+  }
+}
+
+#define NUM_VALUES 4096
+
+int main() {
+  check();
+
+  static int64_t ints[NUM_VALUES];
+  static double floats[NUM_VALUES];
+  static char intStrs[NUM_VALUES][24];
+  for (int i = 0; i < NUM_VALUES; i++) {
+    // Mostly metric-sized values, some large.
+    ints[i] = (int64_t)(nextRandom() % (i % 8 == 0 ? 10000000000000ull : 100000ull));
+    // Like latencies and ratios, with the odd one that needs all 17 digits.
+    floats[i] = i % 8 == 0 ? randomFiniteDouble() : (double)(nextRandom() % 100000) / 100.0;
+    snprintf(intStrs[i], sizeof(intStrs[i]), "%d", (int32_t)(nextRandom() % 2000000000));
+  }
+  char buffer[40];
+  int reps = 500;
+  volatile int64_t sink = 0;
+
+  double start = nowNs();
+  for (int r = 0; r < reps; r++) {
+    for (int i = 0; i < NUM_VALUES; i++) {
+      sink += snprintf(buffer, sizeof(buffer), "%lld", (long long)ints[i]);
+    }
+  }
+  printf("  %-28s %10.1f ns/op\n", "i64 snprintf", (nowNs() - start) / reps / NUM_VALUES);
+  start = nowNs();
+  for (int r = 0; r < reps; r++) {
+    for (int i = 0; i < NUM_VALUES; i++) {
+      sink += formatI64(buffer, ints[i]);
+    }
+  }
+  printf("  %-28s %10.1f ns/op\n", "i64 two-digit table", (nowNs() - start) / reps / NUM_VALUES);
+
+  start = nowNs();
+  for (int r = 0; r < reps; r++) {
+    for (int i = 0; i < NUM_VALUES; i++) {
+      sink += snprintf(buffer, sizeof(buffer), "%lf", floats[i]);
+    }
+  }
+  printf("  %-28s %10.1f ns/op\n", "float snprintf %lf (old)", (nowNs() - start) / reps / NUM_VALUES);
+  start = nowNs();
+  for (int r = 0; r < reps; r++) {
+    for (int i = 0; i < NUM_VALUES; i++) {
+      sink += snprintf(buffer, sizeof(buffer), "%.17g", floats[i]);
+    }
+  }
+  printf("  %-28s %10.1f ns/op\n", "float snprintf %.17g", (nowNs() - start) / reps / NUM_VALUES);
+  start = nowNs();
+  for (int r = 0; r < reps; r++) {
+    for (int i = 0; i < NUM_VALUES; i++) {
+      sink += formatDouble(buffer, floats[i]);
+    }
+  }
+  printf("  %-28s %10.1f ns/op\n", "float shortest", (nowNs() - start) / reps / NUM_VALUES);
+
+  start = nowNs();
+  for (int r = 0; r < reps; r++) {
+    for (int i = 0; i < NUM_VALUES; i++) {
+      sink += strtol(intStrs[i], NULL, 10);
+    }
+  }
+  printf("  %-28s %10.1f ns/op\n", "int strtol", (nowNs() - start) / reps / NUM_VALUES);
+  start = nowNs();
+  for (int r = 0; r < reps; r++) {
+    for (int i = 0; i < NUM_VALUES; i++) {
+      sink += parseIntNaive(intStrs[i], strlen(intStrs[i]));
+    }
+  }
+  printf("  %-28s %10.1f ns/op\n", "int digit loop", (nowNs() - start) / reps / NUM_VALUES);
+  start = nowNs();
+  for (int r = 0; r < reps; r++) {
+    for (int i = 0; i < NUM_VALUES; i++) {
+      sink += __vale_strParseIntBytes(intStrs[i], strlen(intStrs[i]));
+    }
+  }
+  printf("  %-28s %10.1f ns/op\n", "int eight at a time", (nowNs() - start) / reps / NUM_VALUES);
+  return 0;
+}
@@ -0,0 +1,210 @@
+// Microbenchmark for the string kernels in builtins/strings.c, over log-line and HTTP-header
+// workloads. Runs every kernel the CPU supports, checks they agree with the scalar ones, and
+// prints nanoseconds per operation. From the Backend directory:
+//   cc -O2 benchmarks/strings_bench.c -o strings_bench && ./strings_bench
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../builtins/strings.c"
+
+typedef struct {
+  const char* name;
+  StrIndexOfKernel strIndexOf;
+  FirstMismatchKernel firstMismatch;
+} KernelSet;
+
+static int numKernelSets = 0;
+static KernelSet kernelSets[3];
+
+static void addKernelSets() {
+  kernelSets[numKernelSets++] = (KernelSet){ "scalar", strIndexOfScalar, firstMismatchScalar };
+#ifdef VALE_STRINGS_X86_SIMD
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("sse2")) {
+    kernelSets[numKernelSets++] = (KernelSet){ "sse2", strIndexOfSse2, firstMismatchSse2 };
+  }
+  if (__builtin_cpu_supports("avx2")) {
+    kernelSets[numKernelSets++] = (KernelSet){ "avx2", strIndexOfAvx2, firstMismatchAvx2 };
+  }
+#endif
+}
+
+static double nowNs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// The old __vale_strindexof, for comparison.
+static ValeInt strIndexOfNaive(
+    const char* haystack, ValeInt haystackLen, const char* needle, ValeInt needleLen) {
+  for (ValeInt i = 0; i <= haystackLen - needleLen; i++) {
+    if (strncmp(needle, haystack + i, needleLen) == 0) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+static char* makeLog(int numLines, ValeInt* lenOut) {
+  static const char* levels[] = { "INFO", "DEBUG", "INFO", "WARN", "INFO" };
+  static const char* paths[] = { "/api/v1/users", "/api/v1/orders", "/healthz", "/static/app.js" };
+  char* log = malloc(numLines * 160 + 1);
+  ValeInt len = 0;
+  for (int i = 0; i < numLines; i++) {
+    len += sprintf(
+        log + len,
+        "2024-05-01T12:%02d:%02d.%03dZ %s request_id=%08x method=GET path=%s status=200 latency_ms=%d\n",
+        (i / 60) % 60, i % 60, i % 1000, levels[i % 5], i * 2654435761u, paths[i % 4], i % 97);
+  }
+  *lenOut = len;
+  return log;
+}
+
+static const char* httpHeaders =
+    "GET /api/v1/orders?limit=50 HTTP/1.1\r\n"
+    "Host: shop.example.com\r\n"
+    "User-Agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like Gecko)\r\n"
+    "Accept: application/json, text/plain, */*\r\n"
+    "Accept-Language: en-US,en;q=0.9\r\n"
+    "Accept-Encoding: gzip, deflate, br\r\n"
+    "Referer: https://shop.example.com/orders\r\n"
+    "Cookie: session=8f14e45fceea167a5a36dedd4bea2543; theme=dark\r\n"
+    "Connection: keep-alive\r\n"
+    "Content-Type: application/json\r\n"
+    "Content-Length: 0\r\n"
+    "\r\n";
+
+typedef ValeInt (*SearchFunc)(const char*, ValeInt, const char*, ValeInt);
+
+static void benchSearch(
+    const char* label, const char* haystack, ValeInt haystackLen, const char* needle, int reps) {
+  ValeInt needleLen = strlen(needle);
+  ValeInt expected = strIndexOfNaive(haystack, haystackLen, needle, needleLen);
+  double start = nowNs();
+  for (int r = 0; r < reps; r++) {
+    if (strIndexOfNaive(haystack, haystackLen, needle, needleLen) != expected) {
+      abort();
+    }
+  }
+  printf("  %-36s %-8s %10.1f ns/op\n", label, "naive", (nowNs() - start) / reps);
+  for (int k = 0; k < numKernelSets; k++) {
+    start = nowNs();
+    for (int r = 0; r < reps; r++) {
+      if (kernelSets[k].strIndexOf(haystack, haystackLen, needle, needleLen) != expected) {
+        fprintf(stderr, "%s disagreed on %s!\n", kernelSets[k].name, label);
+        exit(1);
+      }
+    }
+    printf("  %-36s %-8s %10.1f ns/op\n", label, kernelSets[k].name, (nowNs() - start) / reps);
+  }
+}
+
+static void benchCompare(const char* label, const char* a, const char* b, ValeInt len, int reps) {
+  ValeInt expected = firstMismatchScalar(a, b, len);
+  for (int k = 0; k < numKernelSets; k++) {
+    double start = nowNs();
+    for (int r = 0; r < reps; r++) {
+      if (kernelSets[k].firstMismatch(a, b, len) != expected) {
+        fprintf(stderr, "%s disagreed on %s!\n", kernelSets[k].name, label);
+        exit(1);
+      }
+    }
+    printf("  %-36s %-8s %10.1f ns/op\n", label, kernelSets[k].name, (nowNs() - start) / reps);
+  }
+}
+
+static void benchConcat(const char* label, const char* a, ValeInt aLen, const char* b, ValeInt bLen, int reps) {
+  char* dest = malloc(aLen + bLen + 1);
+  double start = nowNs();
+  for (int r = 0; r < reps; r++) {
+    for (ValeInt i = 0; i < aLen; i++) {
+      ((volatile char*)dest)[i] = a[i];
+    }
+    for (ValeInt i = 0; i < bLen; i++) {
+      ((volatile char*)dest)[aLen + i] = b[i];
+    }
+  }
+  printf("  %-36s %-8s %10.1f ns/op\n", label, "bytewise", (nowNs() - start) / reps);
+  start = nowNs();
+  for (int r = 0; r < reps; r++) {
+    memcpy(dest, a, aLen);
+    memcpy(dest + aLen, b, bLen);
+    __asm__ __volatile__("" : : "r"(dest) : "memory");
+  }
+  printf("  %-36s %-8s %10.1f ns/op\n", label, "memcpy", (nowNs() - start) / reps);
+  free(dest);
+}
+
+// Checks the kernels against the naive search on lots of small random strings, where the
+// edge cases (needle at the very end, blocks straddling the tail) are.
+static void fuzz() {
+  char haystack[200];
+  char needle[40];
+  srand(1234);
+  for (int iter = 0; iter < 200000; iter++) {
+    ValeInt haystackLen = rand() % 200;
+    ValeInt needleLen = 1 + rand() % 6;
+    for (ValeInt i = 0; i < haystackLen; i++) {
+      haystack[i] = "ab"[rand() % 2];
+    }
+    for (ValeInt i = 0; i < needleLen; i++) {
+      needle[i] = "ab"[rand() % 2];
+    }
+    if (needleLen > haystackLen) {
+      continue;
+    }
+    ValeInt expected = strIndexOfNaive(haystack, haystackLen, needle, needleLen);
+    for (int k = 0; k < numKernelSets; k++) {
+      if (kernelSets[k].strIndexOf(haystack, haystackLen, needle, needleLen) != expected) {
+        fprintf(stderr, "%s disagreed on fuzz iteration %d!\n", kernelSets[k].name, iter);
+        exit(1);
+      }
+      ValeInt len = haystackLen < 2 ? haystackLen : haystackLen / 2;
+      if (kernelSets[k].firstMismatch(haystack, haystack + haystackLen - len, len) !=
+          firstMismatchScalar(haystack, haystack + haystackLen - len, len)) {
+        fprintf(stderr, "%s firstMismatch disagreed on fuzz iteration %d!\n", kernelSets[k].name, iter);
+        exit(1);
+      }
+    }
+  }
+}
+
+int main() {
+  addKernelSets();
+  fuzz();
+
+  ValeInt logLen = 0;
+  char* log = makeLog(20000, &logLen);
+  printf("log (%d bytes):\n", logLen);
+  // Like grepping for a line that isn't there.
+  benchSearch("find \"level=ERROR\" (absent)", log, logLen, "level=ERROR", 20);
+  benchSearch("find \"latency_ms=96\" (late)", log, logLen, "latency_ms=96", 20);
+  // Splitting a log into lines, one short search per line.
+  ValeInt lineLen = strchr(log, '\n') - log + 1;
+  benchSearch("find \" path=\" in one line", log, lineLen, " path=", 2000000);
+
+  ValeInt headersLen = strlen(httpHeaders);
+  printf("http headers (%d bytes):\n", headersLen);
+  benchSearch("find \"\\r\\n\\r\\n\"", httpHeaders, headersLen, "\r\n\r\n", 2000000);
+  benchSearch("find \"Content-Length:\"", httpHeaders, headersLen, "Content-Length:", 2000000);
+  benchSearch("find \"\\r\\n\"", httpHeaders, headersLen, "\r\n", 2000000);
+
+  printf("compare:\n");
+  const char* cookieA = strstr(httpHeaders, "Cookie:");
+  char* cookieB = strdup(cookieA);
+  cookieB[50] = 'X';
+  benchCompare("header line, differs at 50", cookieA, cookieB, 60, 5000000);
+  benchCompare("two equal log copies", log, log + 0, logLen, 200);
+
+  printf("concat:\n");
+  benchConcat("header + header", httpHeaders, headersLen, httpHeaders, headersLen, 1000000);
+  benchConcat("log + log", log, logLen, log, logLen, 100);
+
+  free(cookieB);
+  free(log);
+  return 0;
+}
@@ -9,5 +9,7 @@ typedef int32_t ValeInt;
 typedef struct { ValeInt length; char chars[0]; } ValeStr;
 ValeStr* ValeStrNew(ValeInt length);
 ValeStr* ValeStrFrom(char* source);
+// Writes x in decimal to dest, which needs room for 20 chars. Returns how many it wrote.
+int ValeFormatI64(char* dest, int64_t x);
 
 #endif
@@ -0,0 +1,281 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+
+#ifdef _WIN32
+#include <io.h>
+#define open _open
+#define write _write
+#define close _close
+#else
+#include <unistd.h>
+#include <signal.h>
+#endif
+
+// The allocation profiler, for programs compiled with --alloc_profile.
+//
+// The backend gives every kind that allocates an ID, and keeps a static table of these entries
+// indexed by that ID, bumping them inline at every allocation and free. We just dump the table,
+// when the program exits, or whenever it gets a SIGUSR2. With --threadsafe_imms the bumps are
+// atomic, but a dump while other threads are allocating can still see an entry half-updated.
+//
+// The VALE_ALLOC_PROFILE environment variable says where to write it, default
+// vale_alloc_profile.json. If it ends in .pb or .pprof, we write a protobuf that pprof can read,
+// otherwise JSON.
+//
+// Everything below only uses open/write/close and hand-rolled formatting, so that it's safe to
+// call from the signal handler.
+
+// Must stay in sync with allocprofile.h's ALLOC_PROFILE_ENTRY_MEMBER_INDEX_FOR_*.
+typedef struct {
+  int64_t allocs;
+  int64_t frees;
+  int64_t bytes;
+  int64_t live;
+  int64_t peakLive;
+} ValeAllocProfileEntry;
+
+static ValeAllocProfileEntry* allocProfileTable = NULL;
+static const char** allocProfileNames = NULL;
+static int64_t allocProfileNumKinds = 0;
+
+typedef struct {
+  int fd;
+  int64_t size;
+  char buffer[4096];
+} AllocProfileWriter;
+
+static void writerFlush(AllocProfileWriter* writer) {
+  int64_t written = 0;
+  while (written < writer->size) {
+    int64_t result = write(writer->fd, writer->buffer + written, writer->size - written);
+    if (result <= 0) {
+      break;
+    }
+    written += result;
+  }
+  writer->size = 0;
+}
+
+static void writeBytes(AllocProfileWriter* writer, const char* bytes, int64_t len) {
+  for (int64_t i = 0; i < len; i++) {
+    if (writer->size == sizeof(writer->buffer)) {
+      writerFlush(writer);
+    }
+    writer->buffer[writer->size++] = bytes[i];
+  }
+}
+
+static void writeStr(AllocProfileWriter* writer, const char* str) {
+  writeBytes(writer, str, strlen(str));
+}
+
+static void writeI64(AllocProfileWriter* writer, int64_t x) {
+  char digits[24];
+  int numDigits = 0;
+  uint64_t magnitude = x < 0 ? -(uint64_t)x : (uint64_t)x;
+  do {
+    digits[sizeof(digits) - 1 - numDigits++] = '0' + (magnitude % 10);
+    magnitude /= 10;
+  } while (magnitude);
+  if (x < 0) {
+    digits[sizeof(digits) - 1 - numDigits++] = '-';
+  }
+  writeBytes(writer, digits + sizeof(digits) - numDigits, numDigits);
+}
+
+static void writeJsonStr(AllocProfileWriter* writer, const char* str) {
+  static const char hex[] = "0123456789abcdef";
+  writeStr(writer, "\"");
+  for (const char* c = str; *c; c++) {
+    if (*c == '"' || *c == '\\') {
+      char escaped[2] = { '\\', *c };
+      writeBytes(writer, escaped, 2);
+    } else if ((unsigned char)*c < 0x20) {
+      char escaped[6] = { '\\', 'u', '0', '0', hex[(*c >> 4) & 0xF], hex[*c & 0xF] };
+      writeBytes(writer, escaped, 6);
+    } else {
+      writeBytes(writer, c, 1);
+    }
+  }
+  writeStr(writer, "\"");
+}
+
+static void writeJson(AllocProfileWriter* writer) {
+  writeStr(writer, "{\"kinds\":[");
+  int first = 1;
+  for (int64_t i = 0; i < allocProfileNumKinds; i++) {
+    ValeAllocProfileEntry* entry = &allocProfileTable[i];
+    if (entry->allocs == 0) {
+      continue;
+    }
+    writeStr(writer, first ? "\n  {\"name\":" : ",\n  {\"name\":");
+    first = 0;
+    writeJsonStr(writer, allocProfileNames[i]);
+    writeStr(writer, ",\"allocs\":");
+    writeI64(writer, entry->allocs);
+    writeStr(writer, ",\"frees\":");
+    writeI64(writer, entry->frees);
+    writeStr(writer, ",\"bytes\":");
+    writeI64(writer, entry->bytes);
+    writeStr(writer, ",\"live\":");
+    writeI64(writer, entry->live);
+    writeStr(writer, ",\"peakLive\":");
+    writeI64(writer, entry->peakLive);
+    writeStr(writer, "}");
+  }
+  writeStr(writer, "\n]}\n");
+}
+
+// A tiny protobuf encoder, just enough for pprof's profile.proto.
+
+// Returns how many bytes it wrote to out, which must have room for 10.
+static int encodeVarint(char* out, uint64_t x) {
+  int len = 0;
+  do {
+    out[len++] = (char)((x & 0x7F) | (x >= 0x80 ? 0x80 : 0));
+    x >>= 7;
+  } while (x);
+  return len;
+}
+
+static int encodeVarintField(char* out, int fieldNum, uint64_t x) {
+  int len = encodeVarint(out, (uint64_t)fieldNum << 3);
+  return len + encodeVarint(out + len, x);
+}
+
+// Writes a length-delimited field whose contents are already encoded.
+static void writeLengthDelimited(
+    AllocProfileWriter* writer, int fieldNum, const char* contents, int64_t len) {
+  char header[20];
+  int headerLen = encodeVarint(header, ((uint64_t)fieldNum << 3) | 2);
+  headerLen += encodeVarint(header + headerLen, len);
+  writeBytes(writer, header, headerLen);
+  writeBytes(writer, contents, len);
+}
+
+// The strings every profile starts with. Kind i's name is string ALLOC_PROFILE_FIRST_NAME_STR + i.
+static const char* allocProfileFixedStrs[] = {
+  "", "alloc_objects", "count", "alloc_space", "bytes", "inuse_objects", "peak_inuse_objects", "free_objects"
+};
+#define ALLOC_PROFILE_FIRST_NAME_STR 8
+#define ALLOC_PROFILE_NUM_SAMPLE_TYPES 5
+
+static void writePprof(AllocProfileWriter* writer) {
+  // Profile.sample_type, in the same order as the values in each sample.
+  int sampleTypes[ALLOC_PROFILE_NUM_SAMPLE_TYPES][2] = { {1, 2}, {3, 4}, {5, 2}, {6, 2}, {7, 2} };
+  for (int i = 0; i < ALLOC_PROFILE_NUM_SAMPLE_TYPES; i++) {
+    char valueType[40];
+    int len = encodeVarintField(valueType, 1, sampleTypes[i][0]);
+    len += encodeVarintField(valueType + len, 2, sampleTypes[i][1]);
+    writeLengthDelimited(writer, 1, valueType, len);
+  }
+
+  for (int64_t i = 0; i < allocProfileNumKinds; i++) {
+    ValeAllocProfileEntry* entry = &allocProfileTable[i];
+    if (entry->allocs == 0) {
+      continue;
+    }
+    uint64_t id = i + 1;
+
+    // Profile.sample, with one location and our five values, both packed.
+    char values[ALLOC_PROFILE_NUM_SAMPLE_TYPES * 10];
+    int valuesLen = 0;
+    valuesLen += encodeVarint(values + valuesLen, entry->allocs);
+    valuesLen += encodeVarint(values + valuesLen, entry->bytes);
+    valuesLen += encodeVarint(values + valuesLen, entry->live);
+    valuesLen += encodeVarint(values + valuesLen, entry->peakLive);
+    valuesLen += encodeVarint(values + valuesLen, entry->frees);
+    char locationIds[10];
+    int locationIdsLen = encodeVarint(locationIds, id);
+    char sample[100];
+    int sampleLen = 0;
+    sample[sampleLen++] = (1 << 3) | 2;
+    sampleLen += encodeVarint(sample + sampleLen, locationIdsLen);
+    memcpy(sample + sampleLen, locationIds, locationIdsLen);
+    sampleLen += locationIdsLen;
+    sample[sampleLen++] = (2 << 3) | 2;
+    sampleLen += encodeVarint(sample + sampleLen, valuesLen);
+    memcpy(sample + sampleLen, values, valuesLen);
+    sampleLen += valuesLen;
+    writeLengthDelimited(writer, 2, sample, sampleLen);
+
+    // Profile.location, pointing at a Line that points at the kind's Function.
+    char line[12];
+    int lineLen = encodeVarintField(line, 1, id);
+    char location[40];
+    int locationLen = encodeVarintField(location, 1, id);
+    location[locationLen++] = (4 << 3) | 2;
+    locationLen += encodeVarint(location + locationLen, lineLen);
+    memcpy(location + locationLen, line, lineLen);
+    locationLen += lineLen;
+    writeLengthDelimited(writer, 4, location, locationLen);
+
+    // Profile.function, named after the kind.
+    char function[40];
+    int functionLen = encodeVarintField(function, 1, id);
+    functionLen += encodeVarintField(function + functionLen, 2, ALLOC_PROFILE_FIRST_NAME_STR + i);
+    functionLen += encodeVarintField(function + functionLen, 3, ALLOC_PROFILE_FIRST_NAME_STR + i);
+    writeLengthDelimited(writer, 5, function, functionLen);
+  }
+
+  // Profile.string_table. Every kind gets a slot, even the ones we skipped, so the indices line up.
+  for (int i = 0; i < ALLOC_PROFILE_FIRST_NAME_STR; i++) {
+    writeLengthDelimited(writer, 6, allocProfileFixedStrs[i], strlen(allocProfileFixedStrs[i]));
+  }
+  for (int64_t i = 0; i < allocProfileNumKinds; i++) {
+    writeLengthDelimited(writer, 6, allocProfileNames[i], strlen(allocProfileNames[i]));
+  }
+}
+
+static int hasSuffix(const char* str, const char* suffix) {
+  size_t strLen = strlen(str);
+  size_t suffixLen = strlen(suffix);
+  return strLen >= suffixLen && strcmp(str + strLen - suffixLen, suffix) == 0;
+}
+
+void __vale_allocProfileDump() {
+  if (!allocProfileTable) {
+    return;
+  }
+  const char* path = getenv("VALE_ALLOC_PROFILE");
+  if (!path || !*path) {
+    path = "vale_alloc_profile.json";
+  }
+#ifdef _WIN32
+  int fd = open(path, _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, 0644);
+#else
+  int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+#endif
+  if (fd < 0) {
+    return;
+  }
+  AllocProfileWriter writer;
+  writer.fd = fd;
+  writer.size = 0;
+  if (hasSuffix(path, ".pb") || hasSuffix(path, ".pprof")) {
+    writePprof(&writer);
+  } else {
+    writeJson(&writer);
+  }
+  writerFlush(&writer);
+  close(fd);
+}
+
+#ifndef _WIN32
+static void allocProfileSignalHandler(int signum) {
+  (void)signum;
+  __vale_allocProfileDump();
+}
+#endif
+
+void __vale_allocProfileInit(void* table, const char** names, int64_t numKinds) {
+  allocProfileTable = (ValeAllocProfileEntry*)table;
+  allocProfileNames = names;
+  allocProfileNumKinds = numKinds;
+#ifndef _WIN32
+  signal(SIGUSR2, allocProfileSignalHandler);
+#endif
+}
@@ -0,0 +1,124 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+// This is the arena region's allocator, used when the backend is given --region_override=arena.
+// Allocating bumps a pointer through the current page, and grabs a new page when that one runs
+// out. Freeing an individual object does nothing; memory only comes back when the program
+// releases a mark (see __vbi_arenaMark and __vbi_arenaRelease), which frees everything allocated
+// since, and when main returns, which frees everything.
+//
+// Anything allocated after a mark that's still reachable when it's released is dangling, like
+// any other use-after-free in the unsafe region.
+// It's single-threaded, like the rest of the builtins.
+
+// Pages are this big unless one allocation needs more, in which case it gets a page to itself.
+// VALE_ARENA_PAGE_BYTES overrides it.
+#define VALE_ARENA_DEFAULT_PAGE_BYTES ((int64_t)1048576)
+#define VALE_ARENA_ALIGNMENT 16
+
+typedef struct ValeArenaPage {
+  struct ValeArenaPage* previous;
+  // Where the usable bytes start and end. begin is right after this header, aligned.
+  char* begin;
+  char* end;
+} ValeArenaPage;
+
+static ValeArenaPage* arenaCurrentPage = NULL;
+static char* arenaBump = NULL;
+static char* arenaBumpEnd = NULL;
+// We keep the last released page of the default size around, so a program that marks and
+// releases once per request doesn't go back to malloc for a new page every time.
+static ValeArenaPage* arenaSparePage = NULL;
+static int64_t arenaPageBytes = 0;
+
+static int64_t arenaRoundUp(int64_t size) {
+  return (size + (VALE_ARENA_ALIGNMENT - 1)) & ~(int64_t)(VALE_ARENA_ALIGNMENT - 1);
+}
+
+static int64_t arenaDefaultPageBytes() {
+  if (arenaPageBytes == 0) {
+    const char* sizeStr = getenv("VALE_ARENA_PAGE_BYTES");
+    arenaPageBytes = sizeStr && *sizeStr ? atoll(sizeStr) : VALE_ARENA_DEFAULT_PAGE_BYTES;
+    if (arenaPageBytes < 4096) {
+      arenaPageBytes = 4096;
+    }
+  }
+  return arenaPageBytes;
+}
+
+static int64_t arenaPageCapacity(ValeArenaPage* page) {
+  return page->end - page->begin;
+}
+
+static void arenaFreePage(ValeArenaPage* page) {
+  if (arenaPageCapacity(page) == arenaDefaultPageBytes() && arenaSparePage == NULL) {
+    arenaSparePage = page;
+  } else {
+    free(page);
+  }
+}
+
+static void arenaNewPage(int64_t minBytes) {
+  int64_t capacity = arenaDefaultPageBytes();
+  ValeArenaPage* page = NULL;
+  if (minBytes <= capacity && arenaSparePage) {
+    page = arenaSparePage;
+    arenaSparePage = NULL;
+  } else {
+    if (minBytes > capacity) {
+      capacity = minBytes;
+    }
+    int64_t headerBytes = arenaRoundUp(sizeof(ValeArenaPage));
+    page = (ValeArenaPage*)malloc(headerBytes + capacity);
+    if (page == NULL) {
+      fprintf(stderr, "Arena couldn't allocate a %lld byte page!\n", (long long)(headerBytes + capacity));
+      exit(1);
+    }
+    page->begin = (char*)page + headerBytes;
+    page->end = page->begin + capacity;
+  }
+  page->previous = arenaCurrentPage;
+  arenaCurrentPage = page;
+  arenaBump = page->begin;
+  arenaBumpEnd = page->end;
+}
+
+void* __vale_arena_malloc(int64_t size) {
+  size = arenaRoundUp(size > 0 ? size : 1);
+  if (arenaBumpEnd - arenaBump < size) {
+    arenaNewPage(size);
+  }
+  void* result = arenaBump;
+  arenaBump += size;
+  return result;
+}
+
+// A mark is just the bump pointer at the time, or 0 if nothing's been allocated yet.
+int64_t __vale_arena_mark() {
+  return (int64_t)(intptr_t)arenaBump;
+}
+
+// Frees everything allocated since the given mark. 0 frees everything.
+void __vale_arena_release(int64_t mark) {
+  char* markPtr = (char*)(intptr_t)mark;
+  while (arenaCurrentPage) {
+    ValeArenaPage* page = arenaCurrentPage;
+    if (markPtr >= page->begin && markPtr <= page->end) {
+      arenaBump = markPtr;
+      // The mark might be in an older page than the one we were bumping through.
+      arenaBumpEnd = page->end;
+      return;
+    }
+    arenaCurrentPage = page->previous;
+    arenaFreePage(page);
+  }
+  // Either we released everything, or the mark was from before the first page.
+  arenaBump = NULL;
+  arenaBumpEnd = NULL;
+  if (markPtr == NULL && arenaSparePage) {
+    free(arenaSparePage);
+    arenaSparePage = NULL;
+  }
+}
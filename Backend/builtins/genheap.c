@@ -0,0 +1,383 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+// This is the generational heap, used by the resilient regions when the backend is given
+// --gen_heap. Those regions put a 32-bit generation at the top of every object, and a weak
+// reference remembers the generation its target had. Dereferencing compares the two.
+//
+// For that to be safe, a freed object's memory must stay readable and must keep its
+// generation forever, and the only thing that may ever be put there again is another object
+// with a higher generation. malloc/free promise none of that, so instead we:
+//  - Carve memory into slabs, each holding slots of one size class. A slot is only ever reused
+//    for the same size class, so a generation is always at the same address.
+//  - Never give a slab back to the OS. We only tell the OS it can drop the physical pages of a
+//    slab that's been completely empty for a while (see genHeapScavenge), or of a freed jumbo
+//    slab once the free ones hold GEN_HEAP_MAX_CACHED_JUMBO_BYTES.
+//  - Increment the generation on free. The allocator sets the generation, the region's
+//    constructors leave it alone.
+//  - Never hand out generation 0. Released pages read back as zero, so no weak ref can match
+//    them.
+// It's single-threaded, like the rest of the builtins.
+
+// Slabs are aligned to their size, so we can find a slot's slab by masking its address.
+// 64KB is also the allocation granularity on Windows, so VirtualAlloc aligns them for us.
+#define GEN_HEAP_SLAB_BYTES ((uintptr_t)65536)
+// Slots start after this, which leaves room for the GenSlab header.
+#define GEN_HEAP_SLAB_HEADER_BYTES 128
+// Anything bigger than this gets a "jumbo" slab all to itself.
+#define GEN_HEAP_MAX_SMALL_BYTES 16384
+#define GEN_HEAP_MIN_SLOT_BYTES 16
+#define GEN_HEAP_JUMBO_CLASS 0xFFFFFFFF
+// The free list link lives past the generation, so it never clobbers it. Slots are at least
+// GEN_HEAP_MIN_SLOT_BYTES, so it always fits.
+#define GEN_HEAP_FREE_LINK_OFFSET 8
+// Every this many frees, we look for slabs whose pages we can release.
+#define GEN_HEAP_SCAVENGE_INTERVAL 4096
+// A slab is long-idle if it's been empty for this many frees.
+#define GEN_HEAP_IDLE_FREES 65536
+// Free jumbo slabs keep the physical pages of at most this many bytes between them. Past that,
+// a freed jumbo slab's pages go back to the OS right away instead of waiting to be scavenged.
+#define GEN_HEAP_MAX_CACHED_JUMBO_BYTES ((uint64_t)16 * 1024 * 1024)
+// The generation every never-used slot starts at. Never 0, see above.
+#define GEN_HEAP_INITIAL_GEN 1
+
+typedef struct GenSlab {
+  uint32_t sizeClass;
+  uint32_t slotBytes;
+  uint32_t numSlots;
+  // How many slots we've bump-allocated since this slab was made or last released.
+  uint32_t numBumped;
+  uint32_t numLive;
+  // Every slot we bump-allocate starts at this generation.
+  uint32_t genFloor;
+  // The highest generation any slot in here has reached.
+  uint32_t maxGen;
+  // Whether its pages (other than the first) have been given back to the OS since it was last
+  // used.
+  uint32_t released;
+  // The heap's numFrees when this slab became empty, or 0 if it's not empty.
+  uint64_t idleSince;
+  // Size of the whole mapping, which is more than GEN_HEAP_SLAB_BYTES for jumbo slabs.
+  uint64_t totalBytes;
+  void* freeList;
+  struct GenSlab* nextPartial;
+  struct GenSlab* nextInHeap;
+  uint32_t inPartialList;
+} GenSlab;
+
+typedef struct {
+  // Index into sizeClassSlotBytes for every 16B increment up to GEN_HEAP_MAX_SMALL_BYTES.
+  uint8_t sizeClassByGranule[GEN_HEAP_MAX_SMALL_BYTES / 16 + 1];
+  uint32_t sizeClassSlotBytes[64];
+  uint32_t numSizeClasses;
+  // Slabs that have at least one slot we can hand out, per size class.
+  GenSlab* partialSlabs[64];
+  // Empty jumbo slabs, waiting for an allocation that fits in them.
+  GenSlab* freeJumboSlabs;
+  // The total size of the free jumbo slabs whose pages we haven't released.
+  uint64_t cachedJumboBytes;
+  // Every slab we've ever made, for scavenging.
+  GenSlab* allSlabs;
+  uint64_t numFrees;
+  uint64_t pageBytes;
+  int initialized;
+} GenHeap;
+
+static GenHeap genHeap;
+
+_Static_assert(sizeof(GenSlab) <= GEN_HEAP_SLAB_HEADER_BYTES, "GenSlab header too big!");
+
+static void genHeapInit() {
+  // Size classes are every 16B up to 128B, then four per doubling, which keeps internal
+  // fragmentation under 25%.
+  uint32_t numClasses = 0;
+  for (uint32_t slotBytes = GEN_HEAP_MIN_SLOT_BYTES; slotBytes <= 128; slotBytes += 16) {
+    genHeap.sizeClassSlotBytes[numClasses++] = slotBytes;
+  }
+  for (uint32_t base = 128; base < GEN_HEAP_MAX_SMALL_BYTES; base *= 2) {
+    for (uint32_t quarter = 1; quarter <= 4; quarter++) {
+      genHeap.sizeClassSlotBytes[numClasses++] = base + quarter * (base / 4);
+    }
+  }
+  assert(genHeap.sizeClassSlotBytes[numClasses - 1] == GEN_HEAP_MAX_SMALL_BYTES);
+  assert(numClasses <= 64);
+  genHeap.numSizeClasses = numClasses;
+
+  uint32_t sizeClass = 0;
+  for (uint32_t granule = 0; granule <= GEN_HEAP_MAX_SMALL_BYTES / 16; granule++) {
+    while (genHeap.sizeClassSlotBytes[sizeClass] < granule * 16) {
+      sizeClass++;
+    }
+    genHeap.sizeClassByGranule[granule] = (uint8_t)sizeClass;
+  }
+
+#ifdef _WIN32
+  SYSTEM_INFO systemInfo;
+  GetSystemInfo(&systemInfo);
+  genHeap.pageBytes = systemInfo.dwPageSize;
+#else
+  genHeap.pageBytes = (uint64_t)sysconf(_SC_PAGESIZE);
+#endif
+
+  genHeap.initialized = 1;
+}
+
+// Returns memory aligned to GEN_HEAP_SLAB_BYTES, zeroed.
+static void* genHeapMapAligned(uint64_t bytes) {
+#ifdef _WIN32
+  void* result = VirtualAlloc(NULL, bytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+  if (!result) {
+    fprintf(stderr, "Generational heap couldn't allocate %llu bytes!\n", (unsigned long long)bytes);
+    exit(1);
+  }
+  assert(((uintptr_t)result & (GEN_HEAP_SLAB_BYTES - 1)) == 0);
+  return result;
+#else
+  // Map an extra slab's worth so we can trim it down to an aligned range.
+  uint64_t mappedBytes = bytes + GEN_HEAP_SLAB_BYTES;
+  char* mapped =
+      (char*)mmap(NULL, mappedBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (mapped == MAP_FAILED) {
+    fprintf(stderr, "Generational heap couldn't allocate %llu bytes!\n", (unsigned long long)bytes);
+    exit(1);
+  }
+  char* aligned =
+      (char*)(((uintptr_t)mapped + GEN_HEAP_SLAB_BYTES - 1) & ~(GEN_HEAP_SLAB_BYTES - 1));
+  uint64_t frontBytes = aligned - mapped;
+  uint64_t backBytes = mappedBytes - frontBytes - bytes;
+  // These were never used, so it's fine to give them back.
+  if (frontBytes) {
+    munmap(mapped, frontBytes);
+  }
+  if (backBytes) {
+    munmap(aligned + bytes, backBytes);
+  }
+  return aligned;
+#endif
+}
+
+// Tells the OS it can drop these pages. They stay mapped; reading them afterward gives either
+// their old contents or zeroes, both of which are safe, see above.
+static void genHeapReleasePages(char* begin, uint64_t bytes) {
+  if (bytes == 0) {
+    return;
+  }
+#ifdef _WIN32
+  VirtualAlloc(begin, bytes, MEM_RESET, PAGE_READWRITE);
+#else
+  madvise(begin, bytes, MADV_DONTNEED);
+#endif
+}
+
+static GenSlab* genHeapSlabOf(void* obj) {
+  return (GenSlab*)((uintptr_t)obj & ~(GEN_HEAP_SLAB_BYTES - 1));
+}
+
+static char* genHeapFirstSlot(GenSlab* slab) {
+  return (char*)slab + GEN_HEAP_SLAB_HEADER_BYTES;
+}
+
+static GenSlab* genHeapNewSlab(uint32_t sizeClass, uint32_t slotBytes, uint64_t totalBytes) {
+  GenSlab* slab = (GenSlab*)genHeapMapAligned(totalBytes);
+  slab->sizeClass = sizeClass;
+  slab->slotBytes = slotBytes;
+  slab->numSlots = (uint32_t)((totalBytes - GEN_HEAP_SLAB_HEADER_BYTES) / slotBytes);
+  slab->numBumped = 0;
+  slab->numLive = 0;
+  slab->genFloor = GEN_HEAP_INITIAL_GEN;
+  slab->maxGen = GEN_HEAP_INITIAL_GEN;
+  slab->released = 0;
+  slab->idleSince = 0;
+  slab->totalBytes = totalBytes;
+  slab->freeList = NULL;
+  slab->nextPartial = NULL;
+  slab->nextInHeap = genHeap.allSlabs;
+  slab->inPartialList = 0;
+  genHeap.allSlabs = slab;
+  return slab;
+}
+
+static void genHeapRemovePartial(GenSlab* slab) {
+  GenSlab** link = &genHeap.partialSlabs[slab->sizeClass];
+  while (*link != slab) {
+    assert(*link);
+    link = &(*link)->nextPartial;
+  }
+  *link = slab->nextPartial;
+  slab->nextPartial = NULL;
+  slab->inPartialList = 0;
+}
+
+// Gives back the physical pages of slabs that have been empty for a long time. The first page
+// of each slab holds its header, so that one stays.
+static void genHeapScavenge() {
+  for (GenSlab* slab = genHeap.allSlabs; slab; slab = slab->nextInHeap) {
+    if (slab->numLive > 0 || slab->released || slab->idleSince == 0) {
+      continue;
+    }
+    if (genHeap.numFrees - slab->idleSince < GEN_HEAP_IDLE_FREES) {
+      continue;
+    }
+    char* releaseBegin = (char*)slab + genHeap.pageBytes;
+    genHeapReleasePages(releaseBegin, slab->totalBytes - genHeap.pageBytes);
+    slab->released = 1;
+
+    if (slab->sizeClass == GEN_HEAP_JUMBO_CLASS) {
+      if (slab->inPartialList) {
+        genHeap.cachedJumboBytes -= slab->totalBytes;
+      }
+      // A jumbo slab's only slot starts in the first page, so its generation survived.
+      continue;
+    }
+    // The free list and generations in the released pages might be gone now, so start this
+    // slab over, bumping from a generation higher than any it ever had.
+    slab->freeList = NULL;
+    slab->numBumped = 0;
+    if (slab->maxGen == UINT32_MAX) {
+      // A slot ran out of generations, so this slab can never be used again.
+      if (slab->inPartialList) {
+        genHeapRemovePartial(slab);
+      }
+      slab->numSlots = 0;
+    } else {
+      slab->genFloor = slab->maxGen + 1;
+      slab->maxGen = slab->genFloor;
+    }
+  }
+}
+
+static void* genHeapJumboMalloc(int64_t bytes) {
+  uint64_t totalBytes =
+      (GEN_HEAP_SLAB_HEADER_BYTES + (uint64_t)bytes + GEN_HEAP_SLAB_BYTES - 1) &
+      ~(uint64_t)(GEN_HEAP_SLAB_BYTES - 1);
+
+  // Take the smallest free slab that fits, as long as it's not more than twice what we need, so
+  // a small object doesn't tie up a slab that a later big one could have used. Since we can't
+  // unmap slabs (see above), this is what keeps varying sizes from growing the heap forever.
+  GenSlab** bestLink = NULL;
+  for (GenSlab** link = &genHeap.freeJumboSlabs; *link; link = &(*link)->nextPartial) {
+    uint64_t slabBytes = (*link)->totalBytes;
+    if (slabBytes >= totalBytes && slabBytes <= totalBytes * 2 &&
+        (!bestLink || slabBytes < (*bestLink)->totalBytes)) {
+      bestLink = link;
+    }
+  }
+  GenSlab* slab = bestLink ? *bestLink : NULL;
+  if (slab) {
+    *bestLink = slab->nextPartial;
+    slab->nextPartial = NULL;
+    slab->inPartialList = 0;
+    if (!slab->released) {
+      genHeap.cachedJumboBytes -= slab->totalBytes;
+    }
+  } else {
+    slab = genHeapNewSlab(GEN_HEAP_JUMBO_CLASS, (uint32_t)(totalBytes - GEN_HEAP_SLAB_HEADER_BYTES), totalBytes);
+    *(uint32_t*)genHeapFirstSlot(slab) = slab->genFloor;
+  }
+  slab->numLive = 1;
+  slab->idleSince = 0;
+  slab->released = 0;
+  return genHeapFirstSlot(slab);
+}
+
+void* __genMalloc(int64_t bytes) {
+  if (!genHeap.initialized) {
+    genHeapInit();
+  }
+  if (bytes > GEN_HEAP_MAX_SMALL_BYTES) {
+    return genHeapJumboMalloc(bytes);
+  }
+  uint32_t granule = (uint32_t)((bytes + 15) / 16);
+  uint32_t sizeClass = genHeap.sizeClassByGranule[granule];
+
+  GenSlab* slab = genHeap.partialSlabs[sizeClass];
+  if (!slab) {
+    slab = genHeapNewSlab(sizeClass, genHeap.sizeClassSlotBytes[sizeClass], GEN_HEAP_SLAB_BYTES);
+    slab->inPartialList = 1;
+    genHeap.partialSlabs[sizeClass] = slab;
+  }
+
+  char* slot = NULL;
+  if (slab->freeList) {
+    // Its generation was already incremented when it was freed.
+    slot = (char*)slab->freeList;
+    slab->freeList = *(void**)(slot + GEN_HEAP_FREE_LINK_OFFSET);
+  } else {
+    assert(slab->numBumped < slab->numSlots);
+    slot = genHeapFirstSlot(slab) + (uint64_t)slab->numBumped * slab->slotBytes;
+    slab->numBumped++;
+    *(uint32_t*)slot = slab->genFloor;
+  }
+  slab->numLive++;
+  slab->idleSince = 0;
+  slab->released = 0;
+
+  if (!slab->freeList && slab->numBumped == slab->numSlots) {
+    // It's full, take it out of the partial list. It's at the head, since we just used it.
+    genHeap.partialSlabs[sizeClass] = slab->nextPartial;
+    slab->nextPartial = NULL;
+    slab->inPartialList = 0;
+  }
+  return slot;
+}
+
+void __genFree(void* obj) {
+  assert(obj);
+  assert(genHeap.initialized);
+  GenSlab* slab = genHeapSlabOf(obj);
+  assert(slab->numLive > 0);
+
+  uint32_t* genPtr = (uint32_t*)obj;
+  uint32_t gen = *genPtr;
+  slab->numLive--;
+  genHeap.numFrees++;
+
+  if (gen == UINT32_MAX) {
+    // This slot is out of generations. Set it to 0, which no weak ref can have, and never
+    // hand it out again.
+    *genPtr = 0;
+    slab->maxGen = UINT32_MAX;
+  } else {
+    *genPtr = gen + 1;
+    if (gen + 1 > slab->maxGen) {
+      slab->maxGen = gen + 1;
+    }
+    if (slab->sizeClass == GEN_HEAP_JUMBO_CLASS) {
+      slab->nextPartial = genHeap.freeJumboSlabs;
+      slab->inPartialList = 1;
+      genHeap.freeJumboSlabs = slab;
+      if (genHeap.cachedJumboBytes + slab->totalBytes > GEN_HEAP_MAX_CACHED_JUMBO_BYTES) {
+        // Its only slot starts in the first page, so that one stays, with the generation.
+        genHeapReleasePages((char*)slab + genHeap.pageBytes, slab->totalBytes - genHeap.pageBytes);
+        slab->released = 1;
+      } else {
+        genHeap.cachedJumboBytes += slab->totalBytes;
+      }
+    } else {
+      *(void**)((char*)obj + GEN_HEAP_FREE_LINK_OFFSET) = slab->freeList;
+      slab->freeList = obj;
+      if (!slab->inPartialList) {
+        slab->nextPartial = genHeap.partialSlabs[slab->sizeClass];
+        slab->inPartialList = 1;
+        genHeap.partialSlabs[slab->sizeClass] = slab;
+      }
+    }
+  }
+
+  if (slab->numLive == 0) {
+    slab->idleSince = genHeap.numFrees;
+  }
+  if (genHeap.numFrees % GEN_HEAP_SCAVENGE_INTERVAL == 0) {
+    genHeapScavenge();
+  }
+}
@@ -0,0 +1,532 @@
+#include <stdint.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "ValeBuiltins.h"
+
+// Number formatting and parsing, behind str(int), str(i64), str(float) and stdlib's int(StrSlice).
+//
+// Integers are formatted two digits at a time out of a table. Floats are formatted with Ryu
+// (Ulf Adams, "Ryu: fast float-to-string conversion", PLDI 2018), which finds the shortest
+// digits that parse back to the same double. Integers are parsed eight digits at a time.
+
+static const char digitPairs[201] =
+    "0001020304050607080910111213141516171819"
+    "2021222324252627282930313233343536373839"
+    "4041424344454647484950515253545556575859"
+    "6061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+// Writes x's digits right-to-left, ending just before bufferEnd. Returns where they start.
+static char* formatU64Backwards(char* bufferEnd, uint64_t x) {
+  char* p = bufferEnd;
+  while (x >= 100) {
+    uint64_t pair = x % 100;
+    x /= 100;
+    p -= 2;
+    memcpy(p, &digitPairs[pair * 2], 2);
+  }
+  if (x >= 10) {
+    p -= 2;
+    memcpy(p, &digitPairs[x * 2], 2);
+  } else {
+    *--p = (char)('0' + x);
+  }
+  return p;
+}
+
+// Writes x to dest, which needs room for 20 chars. Returns how many it wrote.
+static int formatI64(char* dest, int64_t x) {
+  char buffer[20];
+  char* end = buffer + sizeof(buffer);
+  char* begin = formatU64Backwards(end, x < 0 ? -(uint64_t)x : (uint64_t)x);
+  if (x < 0) {
+    *--begin = '-';
+  }
+  memcpy(dest, begin, end - begin);
+  return (int)(end - begin);
+}
+
+int ValeFormatI64(char* dest, int64_t x) {
+  return formatI64(dest, x);
+}
+
+#if defined(__SIZEOF_INT128__)
+#define VALE_NUMBERS_RYU 1
+
+#include <stdatomic.h>
+
+typedef __uint128_t RyuU128;
+
+#define RYU_POW5_INV_BITCOUNT 125
+#define RYU_POW5_BITCOUNT 125
+#define RYU_POW5_INV_TABLE_SIZE 342
+#define RYU_POW5_TABLE_SIZE 326
+
+// Ryu's multiplier tables: the top 125 bits of 5^i, and of 2^k / 5^i. The reference
+// implementation ships them precomputed, we instead fill in each entry the first time a
+// float with that exponent is formatted, see ryuPow5Split and ryuPow5InvSplit.
+//
+// With --threadsafe_imms, two threads can fill the same entry at once. They compute the same
+// words, so either can win; the words are atomics so that isn't a race, and each entry's Ready
+// flag is stored with release after its words, so whoever loads it with acquire sees them.
+static _Atomic uint64_t ryuPow5SplitTable[RYU_POW5_TABLE_SIZE][2];
+static _Atomic char ryuPow5SplitReady[RYU_POW5_TABLE_SIZE];
+static _Atomic uint64_t ryuPow5InvSplitTable[RYU_POW5_INV_TABLE_SIZE][2];
+static _Atomic char ryuPow5InvSplitReady[RYU_POW5_INV_TABLE_SIZE];
+
+static void ryuLoadEntry(_Atomic uint64_t* entry, uint64_t* out) {
+  out[0] = atomic_load_explicit(&entry[0], memory_order_relaxed);
+  out[1] = atomic_load_explicit(&entry[1], memory_order_relaxed);
+}
+
+static void ryuPublishEntry(_Atomic uint64_t* entry, _Atomic char* ready, RyuU128 value) {
+  atomic_store_explicit(&entry[0], (uint64_t)value, memory_order_relaxed);
+  atomic_store_explicit(&entry[1], (uint64_t)(value >> 64), memory_order_relaxed);
+  atomic_store_explicit(ready, 1, memory_order_release);
+}
+
+// Just enough of a little-endian bignum to hold 5^341, plus a bit.
+#define RYU_BIGNUM_WORDS 28
+typedef struct {
+  uint32_t words[RYU_BIGNUM_WORDS];
+  int numWords;
+} RyuBignum;
+
+static void ryuBignumPow5(RyuBignum* out, int e) {
+  memset(out, 0, sizeof(RyuBignum));
+  out->words[0] = 1;
+  out->numWords = 1;
+  while (e > 0) {
+    // 5^13 is the biggest power of 5 that fits in 32 bits.
+    int step = e < 13 ? e : 13;
+    uint32_t factor = 1;
+    for (int i = 0; i < step; i++) {
+      factor *= 5;
+    }
+    uint64_t carry = 0;
+    for (int i = 0; i < out->numWords; i++) {
+      uint64_t product = (uint64_t)out->words[i] * factor + carry;
+      out->words[i] = (uint32_t)product;
+      carry = product >> 32;
+    }
+    if (carry) {
+      out->words[out->numWords++] = (uint32_t)carry;
+    }
+    e -= step;
+  }
+}
+
+static int ryuBignumBitLength(const RyuBignum* b) {
+  return (b->numWords - 1) * 32 + (32 - __builtin_clz(b->words[b->numWords - 1]));
+}
+
+// Returns bits [start, start + 128) of b.
+static RyuU128 ryuBignumBitsFrom(const RyuBignum* b, int start) {
+  RyuU128 result = 0;
+  for (int bit = 127; bit >= 0; bit--) {
+    int index = start + bit;
+    int isSet = index / 32 < b->numWords && ((b->words[index / 32] >> (index % 32)) & 1);
+    result = (result << 1) | (RyuU128)isSet;
+  }
+  return result;
+}
+
+static int ryuBignumCompare(const RyuBignum* a, const RyuBignum* b) {
+  int numWords = a->numWords > b->numWords ? a->numWords : b->numWords;
+  for (int i = numWords - 1; i >= 0; i--) {
+    uint32_t aWord = i < a->numWords ? a->words[i] : 0;
+    uint32_t bWord = i < b->numWords ? b->words[i] : 0;
+    if (aWord != bWord) {
+      return aWord < bWord ? -1 : 1;
+    }
+  }
+  return 0;
+}
+
+// 5^i >> (bitLength(5^i) - 125), i.e. its top 125 bits, low word in out[0].
+static void ryuPow5Split(int i, uint64_t* out) {
+  if (!atomic_load_explicit(&ryuPow5SplitReady[i], memory_order_acquire)) {
+    RyuBignum pow5;
+    ryuBignumPow5(&pow5, i);
+    int shift = ryuBignumBitLength(&pow5) - RYU_POW5_BITCOUNT;
+    RyuU128 split = shift >= 0 ? ryuBignumBitsFrom(&pow5, shift) : ryuBignumBitsFrom(&pow5, 0) << -shift;
+    ryuPublishEntry(ryuPow5SplitTable[i], &ryuPow5SplitReady[i], split);
+  }
+  ryuLoadEntry(ryuPow5SplitTable[i], out);
+}
+
+// 2^(bitLength(5^i) - 1 + 125) / 5^i + 1, by long division one bit at a time. Low
+// word in out[0].
+static void ryuPow5InvSplit(int i, uint64_t* out) {
+  if (!atomic_load_explicit(&ryuPow5InvSplitReady[i], memory_order_acquire)) {
+    RyuBignum pow5;
+    ryuBignumPow5(&pow5, i);
+    int dividendBit = ryuBignumBitLength(&pow5) - 1 + RYU_POW5_INV_BITCOUNT;
+    RyuBignum remainder;
+    memset(&remainder, 0, sizeof(remainder));
+    remainder.numWords = 1;
+    RyuU128 quotient = 0;
+    for (int bit = dividendBit; bit >= 0; bit--) {
+      // remainder = remainder * 2 + (this bit of the dividend)
+      uint32_t carry = bit == dividendBit;
+      for (int w = 0; w < remainder.numWords; w++) {
+        uint32_t word = remainder.words[w];
+        remainder.words[w] = (word << 1) | carry;
+        carry = word >> 31;
+      }
+      if (carry) {
+        remainder.words[remainder.numWords++] = carry;
+      }
+      quotient <<= 1;
+      if (ryuBignumCompare(&remainder, &pow5) >= 0) {
+        uint64_t borrow = 0;
+        for (int w = 0; w < remainder.numWords; w++) {
+          uint64_t subtrahend = (w < pow5.numWords ? pow5.words[w] : 0) + borrow;
+          borrow = remainder.words[w] < subtrahend;
+          remainder.words[w] = (uint32_t)(remainder.words[w] - subtrahend);
+        }
+        while (remainder.numWords > 1 && remainder.words[remainder.numWords - 1] == 0) {
+          remainder.numWords--;
+        }
+        quotient |= 1;
+      }
+    }
+    quotient += 1;
+    ryuPublishEntry(ryuPow5InvSplitTable[i], &ryuPow5InvSplitReady[i], quotient);
+  }
+  ryuLoadEntry(ryuPow5InvSplitTable[i], out);
+}
+
+// ceil(log2(5^e)), or 1 for e == 0.
+static int32_t ryuPow5Bits(int32_t e) {
+  return (int32_t)(((uint32_t)e * 1217359) >> 19) + 1;
+}
+
+// floor(log10(2^e))
+static uint32_t ryuLog10Pow2(int32_t e) {
+  return ((uint32_t)e * 78913) >> 18;
+}
+
+// floor(log10(5^e))
+static uint32_t ryuLog10Pow5(int32_t e) {
+  return ((uint32_t)e * 732923) >> 20;
+}
+
+static int ryuMultipleOfPowerOf5(uint64_t value, uint32_t p) {
+  uint32_t count = 0;
+  while (value % 5 == 0 && value != 0) {
+    value /= 5;
+    count++;
+  }
+  return count >= p;
+}
+
+static int ryuMultipleOfPowerOf2(uint64_t value, uint32_t p) {
+  return (value & ((1ull << p) - 1)) == 0;
+}
+
+static uint64_t ryuMulShift64(uint64_t m, const uint64_t* mul, int32_t j) {
+  RyuU128 b0 = (RyuU128)m * mul[0];
+  RyuU128 b2 = (RyuU128)m * mul[1];
+  return (uint64_t)(((b0 >> 64) + b2) >> (j - 64));
+}
+
+// Finds the shortest decimal digits (and their exponent) that parse back to the given finite,
+// nonzero double, per Ryu's d2d.
+static void ryuShortest(
+    uint64_t ieeeMantissa, uint32_t ieeeExponent, uint64_t* digitsOut, int32_t* exponentOut) {
+  int32_t e2;
+  uint64_t m2;
+  if (ieeeExponent == 0) {
+    e2 = 1 - 1023 - 52 - 2;
+    m2 = ieeeMantissa;
+  } else {
+    e2 = (int32_t)ieeeExponent - 1023 - 52 - 2;
+    m2 = (1ull << 52) | ieeeMantissa;
+  }
+  int acceptBounds = (m2 & 1) == 0;
+
+  // The halfway points to the neighboring doubles are mv +/- 2, in units of 2^e2.
+  uint64_t mv = 4 * m2;
+  uint32_t mmShift = ieeeMantissa != 0 || ieeeExponent <= 1;
+
+  uint64_t vr, vp, vm;
+  int32_t e10;
+  int vmIsTrailingZeros = 0;
+  int vrIsTrailingZeros = 0;
+  if (e2 >= 0) {
+    uint32_t q = ryuLog10Pow2(e2) - (e2 > 3);
+    e10 = (int32_t)q;
+    int32_t k = RYU_POW5_INV_BITCOUNT + ryuPow5Bits((int32_t)q) - 1;
+    int32_t i = -e2 + (int32_t)q + k;
+    uint64_t mul[2];
+    ryuPow5InvSplit(q, mul);
+    vr = ryuMulShift64(4 * m2, mul, i);
+    vp = ryuMulShift64(4 * m2 + 2, mul, i);
+    vm = ryuMulShift64(4 * m2 - 1 - mmShift, mul, i);
+    if (q <= 21) {
+      if (mv % 5 == 0) {
+        vrIsTrailingZeros = ryuMultipleOfPowerOf5(mv, q);
+      } else if (acceptBounds) {
+        vmIsTrailingZeros = ryuMultipleOfPowerOf5(mv - 1 - mmShift, q);
+      } else {
+        vp -= ryuMultipleOfPowerOf5(mv + 2, q);
+      }
+    }
+  } else {
+    uint32_t q = ryuLog10Pow5(-e2) - (-e2 > 1);
+    e10 = (int32_t)q + e2;
+    int32_t i = -e2 - (int32_t)q;
+    int32_t k = ryuPow5Bits(i) - RYU_POW5_BITCOUNT;
+    int32_t j = (int32_t)q - k;
+    uint64_t mul[2];
+    ryuPow5Split(i, mul);
+    vr = ryuMulShift64(4 * m2, mul, j);
+    vp = ryuMulShift64(4 * m2 + 2, mul, j);
+    vm = ryuMulShift64(4 * m2 - 1 - mmShift, mul, j);
+    if (q <= 1) {
+      vrIsTrailingZeros = 1;
+      if (acceptBounds) {
+        vmIsTrailingZeros = mmShift == 1;
+      } else {
+        --vp;
+      }
+    } else if (q < 63) {
+      vrIsTrailingZeros = ryuMultipleOfPowerOf2(mv, q);
+    }
+  }
+
+  // Drop digits while the interval [vm, vp] still has a number with fewer of them.
+  int32_t removed = 0;
+  uint32_t lastRemovedDigit = 0;
+  uint64_t output;
+  if (vmIsTrailingZeros || vrIsTrailingZeros) {
+    // The rare general case, where the bounds or the exact value end in zeros.
+    while (vp / 10 > vm / 10) {
+      vmIsTrailingZeros &= vm % 10 == 0;
+      vrIsTrailingZeros &= lastRemovedDigit == 0;
+      lastRemovedDigit = (uint32_t)(vr % 10);
+      vr /= 10;
+      vp /= 10;
+      vm /= 10;
+      removed++;
+    }
+    if (vmIsTrailingZeros) {
+      while (vm % 10 == 0) {
+        vrIsTrailingZeros &= lastRemovedDigit == 0;
+        lastRemovedDigit = (uint32_t)(vr % 10);
+        vr /= 10;
+        vp /= 10;
+        vm /= 10;
+        removed++;
+      }
+    }
+    if (vrIsTrailingZeros && lastRemovedDigit == 5 && vr % 2 == 0) {
+      // Exactly halfway, so round to even.
+      lastRemovedDigit = 4;
+    }
+    output = vr + ((vr == vm && (!acceptBounds || !vmIsTrailingZeros)) || lastRemovedDigit >= 5);
+  } else {
+    int roundUp = 0;
+    if (vp / 100 > vm / 100) {
+      roundUp = vr % 100 >= 50;
+      vr /= 100;
+      vp /= 100;
+      vm /= 100;
+      removed += 2;
+    }
+    while (vp / 10 > vm / 10) {
+      roundUp = vr % 10 >= 5;
+      vr /= 10;
+      vp /= 10;
+      vm /= 10;
+      removed++;
+    }
+    output = vr + (vr == vm || roundUp);
+  }
+  *digitsOut = output;
+  *exponentOut = e10 + removed;
+}
+
+#endif
+
+// Writes f to dest, which needs room for 32 chars, and returns how many it wrote. Uses the
+// shortest digits that round-trip, in plain notation with at least one digit after the point
+// (like 42.0 or 0.001) unless that'd take more than 21 digits, then like 1.5e+300.
+static int formatDouble(char* dest, double f) {
+  uint64_t bits;
+  memcpy(&bits, &f, sizeof(bits));
+  int negative = (int)(bits >> 63);
+  uint32_t ieeeExponent = (uint32_t)((bits >> 52) & 0x7FF);
+  uint64_t ieeeMantissa = bits & ((1ull << 52) - 1);
+  char* p = dest;
+
+  if (ieeeExponent == 0x7FF) {
+    const char* special = ieeeMantissa ? "nan" : negative ? "-inf" : "inf";
+    memcpy(dest, special, strlen(special));
+    return (int)strlen(special);
+  }
+  if (negative) {
+    *p++ = '-';
+  }
+  if (ieeeExponent == 0 && ieeeMantissa == 0) {
+    memcpy(p, "0.0", 3);
+    return (int)(p + 3 - dest);
+  }
+
+#ifdef VALE_NUMBERS_RYU
+  uint64_t digits;
+  int32_t exponent;
+  ryuShortest(ieeeMantissa, ieeeExponent, &digits, &exponent);
+  char digitsBuffer[20];
+  char* digitsEnd = digitsBuffer + sizeof(digitsBuffer);
+  char* digitsBegin = formatU64Backwards(digitsEnd, digits);
+  int numDigits = (int)(digitsEnd - digitsBegin);
+#else
+  // Without 128-bit multiplies, fall back to the C library: much slower, but still shortest.
+  double magnitude = negative ? -f : f;
+  char scientific[32];
+  for (int precision = 0; precision < 17; precision++) {
+    snprintf(scientific, sizeof(scientific), "%.*e", precision, magnitude);
+    if (strtod(scientific, NULL) == magnitude) {
+      break;
+    }
+  }
+  char digitsBuffer[20];
+  char* digitsBegin = digitsBuffer;
+  int numDigits = 0;
+  for (char* c = scientific; *c != 'e'; c++) {
+    if (*c != '.') {
+      digitsBuffer[numDigits++] = *c;
+    }
+  }
+  while (numDigits > 1 && digitsBuffer[numDigits - 1] == '0') {
+    numDigits--;
+  }
+  int32_t exponent = atoi(strchr(scientific, 'e') + 1) - (numDigits - 1);
+#endif
+
+  // How many digits come before the decimal point.
+  int32_t pointPosition = numDigits + exponent;
+  if (pointPosition >= numDigits && pointPosition <= 21) {
+    memcpy(p, digitsBegin, numDigits);
+    p += numDigits;
+    memset(p, '0', pointPosition - numDigits);
+    p += pointPosition - numDigits;
+    memcpy(p, ".0", 2);
+    p += 2;
+  } else if (pointPosition > 0 && pointPosition <= 21) {
+    memcpy(p, digitsBegin, pointPosition);
+    p += pointPosition;
+    *p++ = '.';
+    memcpy(p, digitsBegin + pointPosition, numDigits - pointPosition);
+    p += numDigits - pointPosition;
+  } else if (pointPosition > -6 && pointPosition <= 0) {
+    memcpy(p, "0.", 2);
+    p += 2;
+    memset(p, '0', -pointPosition);
+    p += -pointPosition;
+    memcpy(p, digitsBegin, numDigits);
+    p += numDigits;
+  } else {
+    *p++ = digitsBegin[0];
+    if (numDigits > 1) {
+      *p++ = '.';
+      memcpy(p, digitsBegin + 1, numDigits - 1);
+      p += numDigits - 1;
+    }
+    *p++ = 'e';
+    *p++ = pointPosition - 1 < 0 ? '-' : '+';
+    int32_t scientificExponent = pointPosition - 1 < 0 ? 1 - pointPosition : pointPosition - 1;
+    char exponentBuffer[4];
+    char* exponentEnd = exponentBuffer + sizeof(exponentBuffer);
+    char* exponentBegin = formatU64Backwards(exponentEnd, scientificExponent);
+    memcpy(p, exponentBegin, exponentEnd - exponentBegin);
+    p += exponentEnd - exponentBegin;
+  }
+  return (int)(p - dest);
+}
+
+extern ValeStr* __vale_castI64Str(int64_t n) {
+  char buffer[20];
+  int length = formatI64(buffer, n);
+  ValeStr* result = ValeStrNew(length);
+  memcpy(result->chars, buffer, length);
+  return result;
+}
+
+extern ValeStr* __vale_castI32Str(int32_t n) {
+  return __vale_castI64Str((int64_t)n);
+}
+
+extern ValeStr* __vale_castFloatStr(double f) {
+  char buffer[32];
+  int length = formatDouble(buffer, f);
+  ValeStr* result = ValeStrNew(length);
+  memcpy(result->chars, buffer, length);
+  return result;
+}
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define VALE_NUMBERS_SWAR 1
+
+// Whether all eight bytes are ASCII digits. A byte over '9' carries into the high nibble when
+// we add 6, and a byte under '0' already has the wrong one.
+static int isEightDigits(uint64_t chunk) {
+  return ((chunk & 0xF0F0F0F0F0F0F0F0) |
+      (((chunk + 0x0606060606060606) & 0xF0F0F0F0F0F0F0F0) >> 4)) == 0x3333333333333333;
+}
+
+// Combines eight ASCII digits (the first one in the lowest byte) into their value, by merging
+// neighboring digits, then pairs, then quads.
+static uint32_t parseEightDigits(uint64_t chunk) {
+  chunk -= 0x3030303030303030;
+  chunk = (chunk * 10) + (chunk >> 8);
+  chunk =
+      (((chunk & 0x000000FF000000FF) * 0x000F424000000064) +
+          (((chunk >> 16) & 0x000000FF000000FF) * 0x0000271000000001)) >> 32;
+  return (uint32_t)chunk;
+}
+
+#endif
+
+// Parses an optional '-' followed by one or more ASCII digits, wrapping around on overflow
+// like Vale's int arithmetic. Returns the int, sign-extended, or VALE_PARSE_INT_INVALID if
+// the chars aren't all that. The backend calls this directly for stdlib's int(StrSlice).
+#define VALE_PARSE_INT_INVALID ((int64_t)1 << 32)
+int64_t __vale_strParseIntBytes(const char* chars, ValeInt length) {
+  const char* p = chars;
+  const char* end = chars + length;
+  int negative = 0;
+  if (p < end && *p == '-') {
+    negative = 1;
+    p++;
+  }
+  if (p == end) {
+    return VALE_PARSE_INT_INVALID;
+  }
+  uint32_t total = 0;
+#ifdef VALE_NUMBERS_SWAR
+  while (end - p >= 8) {
+    uint64_t chunk;
+    memcpy(&chunk, p, 8);
+    if (!isEightDigits(chunk)) {
+      break;
+    }
+    total = total * 100000000u + parseEightDigits(chunk);
+    p += 8;
+  }
+#endif
+  for (; p < end; p++) {
+    uint32_t digit = (uint32_t)(unsigned char)*p - '0';
+    if (digit > 9) {
+      return VALE_PARSE_INT_INVALID;
+    }
+    total = total * 10 + digit;
+  }
+  if (negative) {
+    total = 0u - total;
+  }
+  return (int64_t)(int32_t)total;
+}
@@ -1,21 +1,196 @@
 #include <stdint.h>
 #include <inttypes.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include "ValeBuiltins.h"
 
+#ifdef _WIN32
+#include <windows.h>
+#include <io.h>
+#define write _write
+#define isatty _isatty
+#define VALE_STDOUT_THREAD_LOCAL __declspec(thread)
+#else
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/uio.h>
+#define VALE_STDOUT_THREAD_LOCAL _Thread_local
+#endif
+
+// Everything Vale prints goes through a per-thread output buffer, which we write to fd 1 when
+// it fills up, when the program calls flush(), when the thread or program exits, and when it
+// panics. If stdout is a terminal, we also flush after every write that ends a line, like C's
+// stdio would. VALE_STDOUT_BUFFER=0 makes every write go straight out.
+//
+// This bypasses C's stdout, so anything an extern prints with printf can come out of order
+// with what Vale printed before it, unless the program calls flush() first.
+
+#define VALE_STDOUT_BUFFER_SIZE 65536
+
+typedef struct {
+  char* chars;
+  int64_t size;
+  int64_t capacity;
+  // Whether to flush after every newline.
+  int lineBuffered;
+  int initialized;
+} ValeStdoutBuffer;
+
+static VALE_STDOUT_THREAD_LOCAL ValeStdoutBuffer stdoutBuffer = { NULL, 0, 0, 0, 0 };
+// So that two threads' first writes don't both install the exit handlers.
+#ifdef _WIN32
+static INIT_ONCE stdoutExitHandlersOnce = INIT_ONCE_STATIC_INIT;
+#else
+static pthread_once_t stdoutExitHandlersOnce = PTHREAD_ONCE_INIT;
+static pthread_key_t stdoutThreadExitKey;
+#endif
+
+static void stdoutWriteAll(const char* bytes, int64_t len) {
+  // If anything went through C's stdout, let it out first.
+  fflush(stdout);
+  while (len > 0) {
+    int64_t result = write(1, bytes, len);
+    if (result <= 0) {
+      return;
+    }
+    bytes += result;
+    len -= result;
+  }
+}
+
+void __vale_flushstdout() {
+  ValeStdoutBuffer* buffer = &stdoutBuffer;
+  if (buffer->size > 0) {
+    stdoutWriteAll(buffer->chars, buffer->size);
+    buffer->size = 0;
+  }
+}
+
+#ifndef _WIN32
+// Runs when a thread that printed exits. The main thread's buffer is left to the atexit handler.
+static void stdoutThreadExit(void* bufferPtr) {
+  ValeStdoutBuffer* buffer = (ValeStdoutBuffer*)bufferPtr;
+  __vale_flushstdout();
+  free(buffer->chars);
+  buffer->chars = NULL;
+  buffer->capacity = 0;
+  // If some later thread-exit code prints again, it'll start a new buffer.
+  buffer->initialized = 0;
+}
+#endif
+
+// Covers panics and exit() calls from externs, as well as returning from main.
+#ifdef _WIN32
+static BOOL CALLBACK stdoutInstallExitHandlers(PINIT_ONCE once, PVOID param, PVOID* context) {
+  (void)once;
+  (void)param;
+  (void)context;
+  atexit(__vale_flushstdout);
+  return TRUE;
+}
+#else
+static void stdoutInstallExitHandlers() {
+  atexit(__vale_flushstdout);
+  pthread_key_create(&stdoutThreadExitKey, stdoutThreadExit);
+}
+#endif
+
+static void stdoutBufferInit(ValeStdoutBuffer* buffer) {
+  const char* sizeStr = getenv("VALE_STDOUT_BUFFER");
+  buffer->capacity = sizeStr && *sizeStr ? atoll(sizeStr) : VALE_STDOUT_BUFFER_SIZE;
+  if (buffer->capacity < 0) {
+    buffer->capacity = 0;
+  }
+  buffer->chars = buffer->capacity > 0 ? (char*)malloc(buffer->capacity) : NULL;
+  if (buffer->capacity > 0 && !buffer->chars) {
+    buffer->capacity = 0;
+  }
+  buffer->size = 0;
+  buffer->lineBuffered = isatty(1);
+  buffer->initialized = 1;
+
+#ifdef _WIN32
+  InitOnceExecuteOnce(&stdoutExitHandlersOnce, stdoutInstallExitHandlers, NULL, NULL);
+#else
+  pthread_once(&stdoutExitHandlersOnce, stdoutInstallExitHandlers);
+  // Makes the key's destructor flush and free this thread's buffer when it exits.
+  pthread_setspecific(stdoutThreadExitKey, buffer);
+#endif
+}
+
+// Writes the buffered bytes and then the given ones, in one syscall where we can.
+static void stdoutWriteThrough(ValeStdoutBuffer* buffer, const char* bytes, int64_t len) {
+#ifndef _WIN32
+  if (buffer->size > 0) {
+    fflush(stdout);
+    struct iovec parts[2] = {
+      { buffer->chars, (size_t)buffer->size },
+      { (void*)bytes, (size_t)len }
+    };
+    int64_t total = buffer->size + len;
+    int64_t written = writev(1, parts, 2);
+    buffer->size = 0;
+    if (written >= 0 && written < total) {
+      // A short write, so finish whatever's left of the two parts.
+      if (written < (int64_t)parts[0].iov_len) {
+        stdoutWriteAll((const char*)parts[0].iov_base + written, parts[0].iov_len - written);
+        stdoutWriteAll(bytes, len);
+      } else {
+        stdoutWriteAll(bytes + (written - parts[0].iov_len), total - written);
+      }
+    }
+    return;
+  }
+#endif
+  __vale_flushstdout();
+  stdoutWriteAll(bytes, len);
+}
+
+void __vale_writestdout(const char* bytes, int64_t len) {
+  ValeStdoutBuffer* buffer = &stdoutBuffer;
+  if (!buffer->initialized) {
+    stdoutBufferInit(buffer);
+  }
+  if (buffer->size + len > buffer->capacity) {
+    if (len >= buffer->capacity / 2) {
+      // Too big to be worth copying in.
+      stdoutWriteThrough(buffer, bytes, len);
+      return;
+    }
+    __vale_flushstdout();
+  }
+  memcpy(buffer->chars + buffer->size, bytes, len);
+  buffer->size += len;
+  if (buffer->lineBuffered && memchr(bytes, '\n', len)) {
+    __vale_flushstdout();
+  }
+}
+
+void __vale_printstr(ValeStr* s, ValeInt start, ValeInt length) {
+  __vale_writestdout(s->chars + start, length);
+  free(s);
+}
+
+// Reading from stdin, for __vbi_getch. Flushes first, so that prompts show up.
+int64_t __vale_getch() {
+  __vale_flushstdout();
+  return getchar();
+}
 
 void __vprintCStr(const char* str) {
-  printf("%s", str);
+  __vale_writestdout(str, strlen(str));
 }
 
 void __vprintI64(int64_t x) {
-  printf("%lld", x);
+  char buffer[20];
+  __vale_writestdout(buffer, ValeFormatI64(buffer, x));
 }
 
 void __vprintBool(int8_t x) {
   if (x) {
-    printf("true");
+    __vale_writestdout("true", 4);
   } else {
-    printf("false");
+    __vale_writestdout("false", 5);
   }
 }
@@ -24,6 +24,208 @@ ValeStr* ValeStrFrom(char* source) {
   return result;
 }
 
+// The string kernels below come in scalar, SSE2, and AVX2 flavors. The first string builtin
+// call picks the widest one the CPU supports, see chooseStrKernels.
+//
+// Substring search uses the first-and-last-byte filter: for a block of candidate positions at
+// once, compare the haystack against the needle's first byte, and (shifted by the needle's
+// length) against its last byte. Only positions where both match get a full memcmp, which in
+// practice (log lines, HTTP headers) means almost none of them.
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define VALE_STRINGS_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+typedef ValeInt (*StrIndexOfKernel)(
+    const char* haystack, ValeInt haystackLen, const char* needle, ValeInt needleLen);
+// Returns the index of the first byte where a and b differ, or len if they don't.
+typedef ValeInt (*FirstMismatchKernel)(const char* a, const char* b, ValeInt len);
+
+// Checks the candidate at haystack + i, whose first and last bytes already match the needle's.
+static int strNeedleMatchesAt(
+    const char* haystack, ValeInt i, const char* needle, ValeInt needleLen) {
+  return needleLen <= 2 || memcmp(haystack + i + 1, needle + 1, needleLen - 2) == 0;
+}
+
+// Searches the candidate positions from begin onward. Requires 1 <= needleLen <= haystackLen.
+static ValeInt strIndexOfScalarFrom(
+    const char* haystack, ValeInt haystackLen, const char* needle, ValeInt needleLen,
+    ValeInt begin) {
+  ValeInt lastCandidate = haystackLen - needleLen;
+  ValeInt i = begin;
+  while (i <= lastCandidate) {
+    const char* found = memchr(haystack + i, needle[0], lastCandidate - i + 1);
+    if (!found) {
+      return -1;
+    }
+    i = found - haystack;
+    if (haystack[i + needleLen - 1] == needle[needleLen - 1] &&
+        strNeedleMatchesAt(haystack, i, needle, needleLen)) {
+      return i;
+    }
+    i++;
+  }
+  return -1;
+}
+
+static ValeInt strIndexOfScalar(
+    const char* haystack, ValeInt haystackLen, const char* needle, ValeInt needleLen) {
+  return strIndexOfScalarFrom(haystack, haystackLen, needle, needleLen, 0);
+}
+
+static ValeInt firstMismatchScalar(const char* a, const char* b, ValeInt len) {
+  ValeInt i = 0;
+  while (i < len && a[i] == b[i]) {
+    i++;
+  }
+  return i;
+}
+
+#ifdef VALE_STRINGS_X86_SIMD
+
+__attribute__((target("sse2")))
+static ValeInt strIndexOfSse2(
+    const char* haystack, ValeInt haystackLen, const char* needle, ValeInt needleLen) {
+  __m128i first = _mm_set1_epi8(needle[0]);
+  __m128i last = _mm_set1_epi8(needle[needleLen - 1]);
+  ValeInt numCandidates = haystackLen - needleLen + 1;
+  ValeInt i = 0;
+  // The last byte's load reads up to haystack[i + needleLen + 14], which this keeps in bounds.
+  for (; i + 16 <= numCandidates; i += 16) {
+    __m128i blockFirst = _mm_loadu_si128((const __m128i*)(haystack + i));
+    __m128i blockLast = _mm_loadu_si128((const __m128i*)(haystack + i + needleLen - 1));
+    uint32_t mask =
+        (uint32_t)_mm_movemask_epi8(
+            _mm_and_si128(_mm_cmpeq_epi8(first, blockFirst), _mm_cmpeq_epi8(last, blockLast)));
+    while (mask) {
+      ValeInt candidate = i + __builtin_ctz(mask);
+      if (strNeedleMatchesAt(haystack, candidate, needle, needleLen)) {
+        return candidate;
+      }
+      mask &= mask - 1;
+    }
+  }
+  return strIndexOfScalarFrom(haystack, haystackLen, needle, needleLen, i);
+}
+
+__attribute__((target("avx2")))
+static ValeInt strIndexOfAvx2(
+    const char* haystack, ValeInt haystackLen, const char* needle, ValeInt needleLen) {
+  __m256i first = _mm256_set1_epi8(needle[0]);
+  __m256i last = _mm256_set1_epi8(needle[needleLen - 1]);
+  ValeInt numCandidates = haystackLen - needleLen + 1;
+  ValeInt i = 0;
+  for (; i + 32 <= numCandidates; i += 32) {
+    __m256i blockFirst = _mm256_loadu_si256((const __m256i*)(haystack + i));
+    __m256i blockLast = _mm256_loadu_si256((const __m256i*)(haystack + i + needleLen - 1));
+    uint32_t mask =
+        (uint32_t)_mm256_movemask_epi8(
+            _mm256_and_si256(
+                _mm256_cmpeq_epi8(first, blockFirst), _mm256_cmpeq_epi8(last, blockLast)));
+    while (mask) {
+      ValeInt candidate = i + __builtin_ctz(mask);
+      if (strNeedleMatchesAt(haystack, candidate, needle, needleLen)) {
+        return candidate;
+      }
+      mask &= mask - 1;
+    }
+  }
+  return strIndexOfScalarFrom(haystack, haystackLen, needle, needleLen, i);
+}
+
+__attribute__((target("sse2")))
+static ValeInt firstMismatchSse2(const char* a, const char* b, ValeInt len) {
+  ValeInt i = 0;
+  for (; i + 16 <= len; i += 16) {
+    __m128i blockA = _mm_loadu_si128((const __m128i*)(a + i));
+    __m128i blockB = _mm_loadu_si128((const __m128i*)(b + i));
+    uint32_t equalMask = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(blockA, blockB));
+    if (equalMask != 0xFFFF) {
+      return i + __builtin_ctz(~equalMask);
+    }
+  }
+  return i + firstMismatchScalar(a + i, b + i, len - i);
+}
+
+__attribute__((target("avx2")))
+static ValeInt firstMismatchAvx2(const char* a, const char* b, ValeInt len) {
+  ValeInt i = 0;
+  for (; i + 32 <= len; i += 32) {
+    __m256i blockA = _mm256_loadu_si256((const __m256i*)(a + i));
+    __m256i blockB = _mm256_loadu_si256((const __m256i*)(b + i));
+    uint32_t equalMask = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(blockA, blockB));
+    if (equalMask != 0xFFFFFFFFu) {
+      return i + __builtin_ctz(~equalMask);
+    }
+  }
+  return i + firstMismatchScalar(a + i, b + i, len - i);
+}
+
+#endif
+
+static StrIndexOfKernel strIndexOfKernel = NULL;
+static FirstMismatchKernel firstMismatchKernel = NULL;
+
+static void chooseStrKernels() {
+  strIndexOfKernel = strIndexOfScalar;
+  firstMismatchKernel = firstMismatchScalar;
+#ifdef VALE_STRINGS_X86_SIMD
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    strIndexOfKernel = strIndexOfAvx2;
+    firstMismatchKernel = firstMismatchAvx2;
+  } else if (__builtin_cpu_supports("sse2")) {
+    strIndexOfKernel = strIndexOfSse2;
+    firstMismatchKernel = firstMismatchSse2;
+  }
+#endif
+}
+
+static ValeInt strIndexOf(
+    const char* haystack, ValeInt haystackLen, const char* needle, ValeInt needleLen) {
+  if (needleLen == 0) {
+    return 0;
+  }
+  if (needleLen > haystackLen) {
+    return -1;
+  }
+  if (!strIndexOfKernel) {
+    chooseStrKernels();
+  }
+  return strIndexOfKernel(haystack, haystackLen, needle, needleLen);
+}
+
+static ValeInt firstMismatch(const char* a, const char* b, ValeInt len) {
+  if (!firstMismatchKernel) {
+    chooseStrKernels();
+  }
+  return firstMismatchKernel(a, b, len);
+}
+
+static ValeInt strCompare(const char* a, ValeInt aLen, const char* b, ValeInt bLen) {
+  ValeInt commonLen = aLen < bLen ? aLen : bLen;
+  ValeInt i = firstMismatch(a, b, commonLen);
+  if (i < commonLen) {
+    // Compare as char like we always have, rather than memcmp's unsigned char.
+    return a[i] < b[i] ? -1 : 1;
+  } else if (aLen != bLen) {
+    return aLen < bLen ? -1 : 1;
+  }
+  return 0;
+}
+
+// The backend calls these two directly, on the chars inside its own strings, instead of going
+// through the __vale_strindexof and __vale_strcmp externs and copying both strings.
+ValeInt __vale_strindexofBytes(
+    const char* haystack, ValeInt haystackLen, const char* needle, ValeInt needleLen) {
+  return strIndexOf(haystack, haystackLen, needle, needleLen);
+}
+
+ValeInt __vale_strcmpBytes(const char* a, ValeInt aLen, const char* b, ValeInt bLen) {
+  return strCompare(a, aLen, b, bLen);
+}
+
 ValeInt __vale_strindexof(
     ValeStr* haystackContainerStr, ValeInt haystackBegin, ValeInt haystackEnd,
     ValeStr* needleContainerStr, ValeInt needleBegin, ValeInt needleEnd) {
@@ -35,16 +237,10 @@ ValeInt __vale_strindexof(
   char* needle = needleContainerChars + needleBegin;
   ValeInt needleLen = needleEnd - needleBegin;
 
-  for (ValeInt i = 0; i <= haystackLen - needleLen; i++) {
-    if (strncmp(needle, haystack + i, needleLen) == 0) {
-      free(haystackContainerStr);
-      free(needleContainerStr);
-      return i;
-    }
-  }
+  ValeInt result = strIndexOf(haystack, haystackLen, needle, needleLen);
   free(haystackContainerStr);
   free(needleContainerStr);
-  return -1;
+  return result;
 }
 
 
@@ -59,7 +255,7 @@ ValeStr* __vale_substring(
 
   ValeStr* result = ValeStrNew(length);
   char* resultChars = result->chars;
-  strncpy(resultChars, sourceChars + begin, length);
+  memcpy(resultChars, sourceChars + begin, length);
   free(sourceStr);
   return result;
 }
@@ -79,24 +275,10 @@ char __vale_streq(
   char* b = bContainerChars + bBegin;
   ValeInt bLen = bEnd - bBegin;
 
-  if (aLen != bLen) {
-    free(aStr);
-    free(bStr);
-    return FALSE;
-  }
-  ValeInt len = aLen;
-
-  for (int i = 0; i < len; i++) {
-    if (a[i] != b[i]) {
-      free(aStr);
-      free(bStr);
-      return FALSE;
-    }
-  }
-
+  char result = aLen == bLen && firstMismatch(a, b, aLen) == aLen ? TRUE : FALSE;
   free(aStr);
   free(bStr);
-  return TRUE;
+  return result;
 }
 
 ValeInt __vale_strcmp(
@@ -114,34 +296,10 @@ ValeInt __vale_strcmp(
   char* b = bContainerChars + bBegin;
   ValeInt bLen = bEnd - bBegin;
 
-  for (int i = 0; ; i++) {
-    if (i >= aLen && i >= bLen) {
-      break;
-    }
-    if (i >= aLen && i < bLen) {
-      free(aStr);
-      free(bStr);
-      return -1;
-    }
-    if (i < aLen && i >= bLen) {
-      free(aStr);
-      free(bStr);
-      return 1;
-    }
-    if (a[i] < b[i]) {
-      free(aStr);
-      free(bStr);
-      return -1;
-    }
-    if (a[i] > b[i]) {
-      free(aStr);
-      free(bStr);
-      return 1;
-    }
-  }
+  ValeInt result = strCompare(a, aLen, b, bLen);
   free(aStr);
   free(bStr);
-  return 0;
+  return result;
 }
 
 ValeStr* __vale_addStr(
@@ -153,12 +311,8 @@ ValeStr* __vale_addStr(
   ValeStr* result = ValeStrNew(aLength + bLength);
   char* dest = result->chars;
 
-  for (int i = 0; i < aLength; i++) {
-    dest[i] = a[aBegin + i];
-  }
-  for (int i = 0; i < bLength; i++) {
-    dest[i + aLength] = b[bBegin + i];
-  }
+  memcpy(dest, a + aBegin, aLength);
+  memcpy(dest + aLength, b + bBegin, bLength);
   // Add a null terminating char for compatibility with C.
   // Backend should allocate an extra byte to accommodate this.
   // (Backend also adds this in case we didn't do it here)
@@ -169,34 +323,6 @@ ValeStr* __vale_addStr(
   return result;
 }
 
-extern ValeStr* __vale_castI64Str(int64_t n) {
-  char tempBuffer[100] = { 0 };
-  int charsWritten = snprintf(tempBuffer, 100, "%lld", n);
-  ValeStr* result = ValeStrNew(charsWritten);
-  char* resultChars = result->chars;
-  strncpy(resultChars, tempBuffer, charsWritten);
-  return result;
-}
-
-extern ValeStr* __vale_castI32Str(int32_t n) {
-  return __vale_castI64Str((int64_t)n);
-}
-
-extern ValeStr* __vale_castFloatStr(double f) {
-  char tempBuffer[100] = { 0 };
-  int charsWritten = snprintf(tempBuffer, 100, "%lf", f);
-  ValeStr* result = ValeStrNew(charsWritten);
-  char* resultChars = result->chars;
-  strncpy(resultChars, tempBuffer, charsWritten);
-  return result;
-}
-
-void __vale_printstr(ValeStr* s, ValeInt start, ValeInt length) {
-  char* chars = s->chars;
-  fwrite(chars + start, 1, length, stdout);
-  free(s);
-}
-
 ValeInt __vale_strtoascii(ValeStr* s, ValeInt begin, ValeInt end) {
   assert(begin + 1 <= end);
   char* chars = s->chars;
@@ -211,3 +337,62 @@ ValeStr* __vale_strfromascii(ValeInt code) {
   *dest = code;
   return result;
 }
+
+// The growable buffer behind stdlib's StringBuilder. The backend lowers the __vbi_strBuilder*
+// builtins into calls to these, handing Vale an int64 handle. Appends double the capacity when
+// they run out, so building a string of n bytes copies O(n) bytes in total.
+typedef struct {
+  char* chars;
+  ValeInt length;
+  ValeInt capacity;
+} ValeStrBuilder;
+
+int64_t __vale_strBuilderNew() {
+  ValeStrBuilder* builder = (ValeStrBuilder*)malloc(sizeof(ValeStrBuilder));
+  builder->capacity = 64;
+  builder->length = 0;
+  builder->chars = (char*)malloc(builder->capacity);
+  return (int64_t)(intptr_t)builder;
+}
+
+void __vale_strBuilderAppend(int64_t handle, const char* chars, ValeInt length) {
+  ValeStrBuilder* builder = (ValeStrBuilder*)(intptr_t)handle;
+  // Sizes are ValeInts, so do the math in 64 bits and stop at INT32_MAX rather than overflow.
+  int64_t neededLength = (int64_t)builder->length + length;
+  if (neededLength > builder->capacity) {
+    if (neededLength > INT32_MAX) {
+      fprintf(stderr, "Couldn't grow string builder to %lld bytes, strings can't be that long!\n", (long long)neededLength);
+      exit(1);
+    }
+    int64_t newCapacity = (int64_t)builder->capacity * 2;
+    while (newCapacity < neededLength) {
+      newCapacity *= 2;
+    }
+    if (newCapacity > INT32_MAX) {
+      newCapacity = INT32_MAX;
+    }
+    char* newChars = (char*)realloc(builder->chars, newCapacity);
+    if (!newChars) {
+      fprintf(stderr, "Couldn't grow string builder to %lld bytes!\n", (long long)newCapacity);
+      exit(1);
+    }
+    builder->chars = newChars;
+    builder->capacity = (ValeInt)newCapacity;
+  }
+  memcpy(builder->chars + builder->length, chars, length);
+  builder->length = (ValeInt)neededLength;
+}
+
+ValeInt __vale_strBuilderLength(int64_t handle) {
+  return ((ValeStrBuilder*)(intptr_t)handle)->length;
+}
+
+char* __vale_strBuilderChars(int64_t handle) {
+  return ((ValeStrBuilder*)(intptr_t)handle)->chars;
+}
+
+void __vale_strBuilderFree(int64_t handle) {
+  ValeStrBuilder* builder = (ValeStrBuilder*)(intptr_t)handle;
+  free(builder->chars);
+  free(builder);
+}
@@ -0,0 +1,177 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+
+#ifdef _WIN32
+#include <io.h>
+#include <intrin.h>
+#define open _open
+#define write _write
+#define close _close
+#define VALE_TRACE_THREAD_LOCAL __declspec(thread)
+#else
+#include <unistd.h>
+#include <signal.h>
+#include <time.h>
+#define VALE_TRACE_THREAD_LOCAL _Thread_local
+#endif
+
+// Binary tracing, for programs compiled with --binary_trace.
+//
+// Every flare in the program becomes a call to __vale_trace, which writes a fixed-size record
+// into the calling thread's ring buffer, overwriting the oldest record once it's full. The
+// backend writes trace_strings.json next to the build, which maps the records' event and location
+// IDs back to text.
+//
+// When the program exits or crashes, we write the calling thread's ring buffer, oldest record
+// first, to the file named by VALE_TRACE (default vale_trace.bin). test/decode_trace.py turns that
+// back into readable text. VALE_TRACE_RECORDS sets how many records each ring holds (rounded up
+// to a power of two, default 65536).
+
+#define VALE_TRACE_MAGIC "VTRC"
+#define VALE_TRACE_VERSION 1
+#define VALE_TRACE_DEFAULT_RECORDS 65536
+
+typedef struct {
+  uint32_t eventId;
+  uint32_t locationId;
+  uint64_t values[2];
+  uint64_t timestamp;
+} ValeTraceRecord;
+
+typedef struct {
+  char magic[4];
+  uint32_t version;
+  uint32_t recordSize;
+  uint32_t unused;
+  uint64_t numRecords;
+} ValeTraceFileHeader;
+
+typedef struct {
+  ValeTraceRecord* records;
+  // Always a power of two, so we can mask instead of mod.
+  uint64_t capacity;
+  // How many records this thread has ever written.
+  uint64_t numWritten;
+} ValeTraceRing;
+
+static VALE_TRACE_THREAD_LOCAL ValeTraceRing traceRing = { NULL, 0, 0 };
+static int traceHandlersInstalled = 0;
+
+static uint64_t traceTimestamp() {
+#if defined(_MSC_VER)
+  return __rdtsc();
+#elif defined(__x86_64__) || defined(__i386__)
+  return __builtin_ia32_rdtsc();
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#endif
+}
+
+static void traceWriteAll(int fd, const void* bytes, uint64_t len) {
+  uint64_t written = 0;
+  while (written < len) {
+    int64_t result = write(fd, (const char*)bytes + written, len - written);
+    if (result <= 0) {
+      break;
+    }
+    written += result;
+  }
+}
+
+// Only uses open/write/close, so that it's safe to call from the signal handler.
+static void traceDump() {
+  ValeTraceRing* ring = &traceRing;
+  if (!ring->records) {
+    return;
+  }
+  const char* path = getenv("VALE_TRACE");
+  if (!path || !*path) {
+    path = "vale_trace.bin";
+  }
+#ifdef _WIN32
+  int fd = open(path, _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, 0644);
+#else
+  int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+#endif
+  if (fd < 0) {
+    return;
+  }
+
+  uint64_t numRecords = ring->numWritten < ring->capacity ? ring->numWritten : ring->capacity;
+  ValeTraceFileHeader header;
+  memcpy(header.magic, VALE_TRACE_MAGIC, 4);
+  header.version = VALE_TRACE_VERSION;
+  header.recordSize = sizeof(ValeTraceRecord);
+  header.unused = 0;
+  header.numRecords = numRecords;
+  traceWriteAll(fd, &header, sizeof(header));
+
+  // The oldest record is the one we'd overwrite next, if the ring has wrapped.
+  uint64_t oldestIndex = (ring->numWritten - numRecords) & (ring->capacity - 1);
+  uint64_t numBeforeWrap = ring->capacity - oldestIndex;
+  if (numBeforeWrap > numRecords) {
+    numBeforeWrap = numRecords;
+  }
+  traceWriteAll(fd, &ring->records[oldestIndex], numBeforeWrap * sizeof(ValeTraceRecord));
+  traceWriteAll(fd, &ring->records[0], (numRecords - numBeforeWrap) * sizeof(ValeTraceRecord));
+  close(fd);
+}
+
+#ifndef _WIN32
+static void traceCrashHandler(int signum) {
+  traceDump();
+  // Let the crash carry on as it would have without us.
+  signal(signum, SIG_DFL);
+  raise(signum);
+}
+#endif
+
+static void traceRingInit(ValeTraceRing* ring) {
+  uint64_t capacity = VALE_TRACE_DEFAULT_RECORDS;
+  const char* capacityStr = getenv("VALE_TRACE_RECORDS");
+  if (capacityStr && atoll(capacityStr) > 0) {
+    uint64_t requested = atoll(capacityStr);
+    capacity = 1;
+    while (capacity < requested) {
+      capacity *= 2;
+    }
+  }
+  ring->records = calloc(capacity, sizeof(ValeTraceRecord));
+  if (!ring->records) {
+    fprintf(stderr, "Couldn't allocate trace buffer!\n");
+    exit(1);
+  }
+  ring->capacity = capacity;
+  ring->numWritten = 0;
+
+  if (!traceHandlersInstalled) {
+    traceHandlersInstalled = 1;
+    atexit(traceDump);
+#ifndef _WIN32
+    signal(SIGSEGV, traceCrashHandler);
+    signal(SIGBUS, traceCrashHandler);
+    signal(SIGABRT, traceCrashHandler);
+    signal(SIGFPE, traceCrashHandler);
+    signal(SIGILL, traceCrashHandler);
+#endif
+  }
+}
+
+void __vale_trace(uint32_t eventId, uint32_t locationId, uint64_t value0, uint64_t value1) {
+  ValeTraceRing* ring = &traceRing;
+  if (!ring->records) {
+    traceRingInit(ring);
+  }
+  ValeTraceRecord* record = &ring->records[ring->numWritten & (ring->capacity - 1)];
+  record->eventId = eventId;
+  record->locationId = locationId;
+  record->values[0] = value0;
+  record->values[1] = value1;
+  record->timestamp = traceTimestamp();
+  ring->numWritten++;
+}
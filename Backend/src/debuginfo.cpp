@@ -0,0 +1,208 @@
+#include <llvm-c/Core.h>
+#include <llvm-c/DebugInfo.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "debuginfo.h"
+#include "globalstate.h"
+#include "function/function.h"
+
+// The DIFile for each source path, where each of its lines start, and which file each Vale
+// function is in.
+class DebugFiles {
+public:
+  explicit DebugFiles(GlobalState* globalState_) : globalState(globalState_) {}
+
+  LLVMMetadataRef getFile(const std::string& filepath) {
+    auto iter = files.find(filepath);
+    if (iter != files.end()) {
+      return iter->second;
+    }
+    std::string directory = ".";
+    std::string filename = filepath;
+    auto slash = filepath.find_last_of("/\\");
+    if (slash != std::string::npos) {
+      directory = slash == 0 ? filepath.substr(0, 1) : filepath.substr(0, slash);
+      filename = filepath.substr(slash + 1);
+    }
+    auto fileMD =
+        LLVMDIBuilderCreateFile(
+            globalState->dibuilder,
+            filename.c_str(), filename.size(), directory.c_str(), directory.size());
+    files.emplace(filepath, fileMD);
+    return fileMD;
+  }
+
+  // 1-based line and column, or 0 and 0 if we can't read the file.
+  std::pair<unsigned, unsigned> getLineAndColumn(const std::string& filepath, int offset) {
+    auto iter = lineStarts.find(filepath);
+    if (iter == lineStarts.end()) {
+      iter = lineStarts.emplace(filepath, readLineStarts(filepath)).first;
+    }
+    auto& starts = iter->second;
+    if (starts.empty() || offset < 0) {
+      return std::make_pair(0, 0);
+    }
+    auto after = std::upper_bound(starts.begin(), starts.end(), offset);
+    unsigned line = after - starts.begin();
+    unsigned column = offset - starts[line - 1] + 1;
+    return std::make_pair(line, column);
+  }
+
+  std::unordered_map<LLVMValueRef, std::string> functionFilepaths;
+
+private:
+  // The frontend reads sources a line at a time and joins them with \n, so offsets don't count
+  // any \r's. We do the same here.
+  static std::vector<int> readLineStarts(const std::string& filepath) {
+    std::ifstream file(filepath, std::ios::binary);
+    if (!file) {
+      return {};
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    auto contents = buffer.str();
+
+    std::vector<int> starts = { 0 };
+    int offset = 0;
+    for (size_t i = 0; i < contents.size(); i++) {
+      if (contents[i] == '\r') {
+        if (i + 1 < contents.size() && contents[i + 1] == '\n') {
+          continue;
+        }
+        offset++;
+        starts.push_back(offset);
+      } else {
+        offset++;
+        if (contents[i] == '\n') {
+          starts.push_back(offset);
+        }
+      }
+    }
+    return starts;
+  }
+
+  GlobalState* globalState;
+  std::unordered_map<std::string, LLVMMetadataRef> files;
+  std::unordered_map<std::string, std::vector<int>> lineStarts;
+};
+
+static LLVMMetadataRef makeSubprogram(
+    GlobalState* globalState, LLVMValueRef functionL, LLVMMetadataRef fileMD, unsigned line) {
+  auto subroutineTypeMD =
+      LLVMDIBuilderCreateSubroutineType(globalState->dibuilder, fileMD, nullptr, 0, LLVMDIFlagZero);
+  size_t nameLen = 0;
+  auto name = LLVMGetValueName2(functionL, &nameLen);
+  bool isLocalToUnit = LLVMGetLinkage(functionL) == LLVMInternalLinkage;
+  auto subprogramMD =
+      LLVMDIBuilderCreateFunction(
+          globalState->dibuilder, fileMD, name, nameLen, name, nameLen, fileMD, line,
+          subroutineTypeMD, isLocalToUnit, true, line, LLVMDIFlagPrototyped,
+          globalState->opt->release);
+  LLVMSetSubprogram(functionL, subprogramMD);
+  return subprogramMD;
+}
+
+void beginDebugInfo(GlobalState* globalState) {
+  globalState->dibuilder = LLVMCreateDIBuilder(globalState->mod);
+  globalState->difile = LLVMDIBuilderCreateFile(globalState->dibuilder, "main.vale", 9, ".", 1);
+  // If theres a compile error on this line, its some sort of LLVM version issue, try commenting or uncommenting the last four args.
+  globalState->compileUnit =
+      LLVMDIBuilderCreateCompileUnit(
+          globalState->dibuilder, LLVMDWARFSourceLanguageC, globalState->difile, "Vale compiler",
+          13, globalState->opt->release, "", 0, 0, "", 0, LLVMDWARFEmissionLineTablesOnly, 0, 0, 0,
+          "isysroothere", strlen("isysroothere"), "sdkhere", strlen("sdkhere"));
+  globalState->debugFiles = new DebugFiles(globalState);
+
+  auto int32LT = LLVMInt32TypeInContext(globalState->context);
+  LLVMAddModuleFlag(
+      globalState->mod, LLVMModuleFlagBehaviorWarning, "Debug Info Version", strlen("Debug Info Version"),
+      LLVMValueAsMetadata(LLVMConstInt(int32LT, LLVMDebugMetadataVersion(), false)));
+  LLVMAddModuleFlag(
+      globalState->mod, LLVMModuleFlagBehaviorWarning, "Dwarf Version", strlen("Dwarf Version"),
+      LLVMValueAsMetadata(LLVMConstInt(int32LT, 4, false)));
+}
+
+void beginFunctionDebugInfo(GlobalState* globalState, Function* functionM, LLVMValueRef functionL) {
+  if (!functionM->range) {
+    return; // finishDebugInfo will give it one on line 0.
+  }
+  auto& range = *functionM->range;
+  auto files = globalState->debugFiles;
+  auto line = files->getLineAndColumn(range.filepath, range.begin).first;
+  makeSubprogram(globalState, functionL, files->getFile(range.filepath), line);
+  files->functionFilepaths[functionL] = range.filepath;
+}
+
+LLVMMetadataRef beginExpressionDebugInfo(
+    GlobalState* globalState, FunctionState* functionState, LLVMBuilderRef builder, Expression* expr) {
+  auto previousLocationMD = LLVMGetCurrentDebugLocation2(builder);
+  auto files = globalState->debugFiles;
+  auto functionFilepathIter = files->functionFilepaths.find(functionState->containingFuncL);
+  // A location has to be in its function's file, so we leave anything from elsewhere on the
+  // location around it.
+  if (functionFilepathIter == files->functionFilepaths.end() ||
+      functionFilepathIter->second != expr->range->filepath) {
+    return previousLocationMD;
+  }
+  auto [line, column] = files->getLineAndColumn(expr->range->filepath, expr->range->begin);
+  if (line == 0) {
+    return previousLocationMD;
+  }
+  auto locationMD =
+      LLVMDIBuilderCreateDebugLocation(
+          globalState->context, line, column, LLVMGetSubprogram(functionState->containingFuncL),
+          nullptr);
+  LLVMSetCurrentDebugLocation2(builder, locationMD);
+  return previousLocationMD;
+}
+
+void finishDebugInfo(GlobalState* globalState) {
+  auto framePointerAttr =
+      LLVMCreateStringAttribute(
+          globalState->context, "frame-pointer", strlen("frame-pointer"), "all", strlen("all"));
+
+  for (auto functionL = LLVMGetFirstFunction(globalState->mod);
+      functionL != nullptr;
+      functionL = LLVMGetNextFunction(functionL)) {
+    if (LLVMCountBasicBlocks(functionL) == 0) {
+      continue; // Just a declaration.
+    }
+
+    auto subprogramMD = LLVMGetSubprogram(functionL);
+    if (subprogramMD == nullptr) {
+      subprogramMD = makeSubprogram(globalState, functionL, globalState->difile, 0);
+    }
+    LLVMAddAttributeAtIndex(functionL, LLVMAttributeFunctionIndex, framePointerAttr);
+
+    auto functionLocationMD =
+        LLVMDIBuilderCreateDebugLocation(
+            globalState->context, LLVMDISubprogramGetLine(subprogramMD), 0, subprogramMD, nullptr);
+    for (auto blockL = LLVMGetFirstBasicBlock(functionL);
+        blockL != nullptr;
+        blockL = LLVMGetNextBasicBlock(blockL)) {
+      auto lastLocationMD = functionLocationMD;
+      for (auto instructionL = LLVMGetFirstInstruction(blockL);
+          instructionL != nullptr;
+          instructionL = LLVMGetNextInstruction(instructionL)) {
+        auto locationMD = LLVMInstructionGetDebugLoc(instructionL);
+        // A location from a builder that was pointed at some other function doesn't count.
+        if (locationMD != nullptr && LLVMDILocationGetScope(locationMD) == subprogramMD) {
+          lastLocationMD = locationMD;
+        } else {
+          LLVMInstructionSetDebugLoc(instructionL, lastLocationMD);
+        }
+      }
+    }
+  }
+
+  LLVMDIBuilderFinalize(globalState->dibuilder);
+  delete globalState->debugFiles;
+  globalState->debugFiles = nullptr;
+}
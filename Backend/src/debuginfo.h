@@ -0,0 +1,32 @@
+#ifndef DEBUGINFO_H_
+#define DEBUGINFO_H_
+
+#include <llvm-c/Core.h>
+
+class GlobalState;
+class FunctionState;
+class Function;
+class Expression;
+
+// For --debug_info. Makes the DIBuilder and compile unit, and adds the module flags LLVM wants
+// before it'll emit any DWARF.
+void beginDebugInfo(GlobalState* globalState);
+
+// For --debug_info, before translating a Vale function's body. Gives functionL a DISubprogram on
+// the line functionM was declared, so its expressions' locations have somewhere to live.
+void beginFunctionDebugInfo(GlobalState* globalState, Function* functionM, LLVMValueRef functionL);
+
+// For --debug_info. If expr knows where it is in the source (see Expression::range), points
+// builder there, so everything translating expr builds is on that line. Returns where builder
+// pointed before, to hand back to LLVMSetCurrentDebugLocation2 when expr is done.
+LLVMMetadataRef beginExpressionDebugInfo(
+    GlobalState* globalState, FunctionState* functionState, LLVMBuilderRef builder, Expression* expr);
+
+// For --debug_info, once the whole program is generated. Gives every other function we defined
+// (drops, main's setup, and so on) a DISubprogram on line 0 of main.vale. Any instruction
+// without a location gets the one before it in its block, or its function's line. Also asks
+// LLVM to keep every function's frame pointer, so debuggers and profilers can attribute time
+// and crashes to Vale functions, even in release builds.
+void finishDebugInfo(GlobalState* globalState);
+
+#endif
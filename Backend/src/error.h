@@ -10,6 +10,7 @@ enum class ExitCode : int {
     BadOpts = 1,    // Invalid compiler options
     LlvmSetupFailed = 2,    // Failure to set up LLVM
     VerifyFailed = 3,    // LLVM didn't like the AST we gave it.
+    JitFailed = 4,    // Couldn't compile, link, or start the program for --jit.
 };
 
 
@@ -16,18 +16,39 @@ Externs::Externs(LLVMModuleRef mod, LLVMContextRef context) {
   censusContains = addExtern(mod, "__vcensusContains", int64LT, {voidPtrLT});
   censusAdd = addExtern(mod, "__vcensusAdd", voidLT, {voidPtrLT});
   censusRemove = addExtern(mod, "__vcensusRemove", voidLT, {voidPtrLT});
+  allocProfileInit =
+      addExtern(mod, "__vale_allocProfileInit", voidLT, {voidPtrLT, LLVMPointerType(int8PtrLT, 0), int64LT});
+  allocProfileDump = addExtern(mod, "__vale_allocProfileDump", voidLT, {});
+  trace = addExtern(mod, "__vale_trace", voidLT, {int32LT, int32LT, int64LT, int64LT});
   malloc = addExtern(mod, "malloc", int8PtrLT, {int64LT});
   free = addExtern(mod, "free", voidLT, {int8PtrLT});
+  genMalloc = addExtern(mod, "__genMalloc", int8PtrLT, {int64LT});
+  genFree = addExtern(mod, "__genFree", voidLT, {int8PtrLT});
+  arenaMalloc = addExtern(mod, "__vale_arena_malloc", int8PtrLT, {int64LT});
+  arenaMark = addExtern(mod, "__vale_arena_mark", int64LT, {});
+  arenaRelease = addExtern(mod, "__vale_arena_release", voidLT, {int64LT});
   exit = addExtern(mod, "exit", voidLT, {int64LT});
   assert = addExtern(mod, "__vassert", voidLT, {int1LT, int8PtrLT});
   assertI64Eq = addExtern(mod, "__vassertI64Eq", voidLT, {int64LT, int64LT, int8PtrLT});
   printCStr = addExtern(mod, "__vprintCStr", voidLT, {int8PtrLT});
-  getch = addExtern(mod, "getchar", int64LT, {});
+  getch = addExtern(mod, "__vale_getch", int64LT, {});
   printInt = addExtern(mod, "__vprintI64", voidLT, {int64LT});
+  writeStdout = addExtern(mod, "__vale_writestdout", voidLT, {int8PtrLT, int64LT});
+  flushStdout = addExtern(mod, "__vale_flushstdout", voidLT, {});
   strlen = addExtern(mod, "strlen", int32LT, {int8PtrLT});
   strncpy = addExtern(mod, "strncpy", voidLT, {int8PtrLT, int8PtrLT, int64LT});
   memcpy = addExtern(mod, "memcpy", int8PtrLT, {int8PtrLT, int8PtrLT, int64LT});
   memset = addExtern(mod, "memset", voidLT, {int8PtrLT, int8LT, int64LT});
+  memcmp = addExtern(mod, "memcmp", int32LT, {int8PtrLT, int8PtrLT, int64LT});
+  strIndexOfBytes = addExtern(mod, "__vale_strindexofBytes", int32LT, {int8PtrLT, int32LT, int8PtrLT, int32LT});
+  strCmpBytes = addExtern(mod, "__vale_strcmpBytes", int32LT, {int8PtrLT, int32LT, int8PtrLT, int32LT});
+
+  strBuilderNew = addExtern(mod, "__vale_strBuilderNew", int64LT, {});
+  strBuilderAppend = addExtern(mod, "__vale_strBuilderAppend", voidLT, {int64LT, int8PtrLT, int32LT});
+  strBuilderLength = addExtern(mod, "__vale_strBuilderLength", int32LT, {int64LT});
+  strBuilderChars = addExtern(mod, "__vale_strBuilderChars", int8PtrLT, {int64LT});
+  strBuilderFree = addExtern(mod, "__vale_strBuilderFree", voidLT, {int64LT});
+  strParseIntBytes = addExtern(mod, "__vale_strParseIntBytes", int64LT, {int8PtrLT, int32LT});
 
 //  initTwinPages = addExtern(mod, "__vale_initTwinPages", int8PtrLT, {});
 }
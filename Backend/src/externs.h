@@ -5,22 +5,45 @@ class Externs {
 public:
   LLVMValueRef malloc = nullptr;
   LLVMValueRef free = nullptr;
+  LLVMValueRef genMalloc = nullptr;
+  LLVMValueRef genFree = nullptr;
+  LLVMValueRef arenaMalloc = nullptr;
+  LLVMValueRef arenaMark = nullptr;
+  LLVMValueRef arenaRelease = nullptr;
   LLVMValueRef assert = nullptr;
   LLVMValueRef exit = nullptr;
   LLVMValueRef assertI64Eq = nullptr;
   LLVMValueRef printCStr = nullptr;
   LLVMValueRef getch = nullptr;
   LLVMValueRef printInt = nullptr;
+  LLVMValueRef writeStdout = nullptr;
+  LLVMValueRef flushStdout = nullptr;
   LLVMValueRef strlen = nullptr;
   LLVMValueRef memset = nullptr;
   LLVMValueRef strncpy = nullptr;
   LLVMValueRef memcpy = nullptr;
+  LLVMValueRef memcmp = nullptr;
+
+  LLVMValueRef strIndexOfBytes = nullptr;
+  LLVMValueRef strCmpBytes = nullptr;
+
+  LLVMValueRef strBuilderNew = nullptr;
+  LLVMValueRef strBuilderAppend = nullptr;
+  LLVMValueRef strBuilderLength = nullptr;
+  LLVMValueRef strBuilderChars = nullptr;
+  LLVMValueRef strBuilderFree = nullptr;
+  LLVMValueRef strParseIntBytes = nullptr;
 
 //  LLVMValueRef initTwinPages = nullptr;
   LLVMValueRef censusContains = nullptr;
   LLVMValueRef censusAdd = nullptr;
   LLVMValueRef censusRemove = nullptr;
 
+  LLVMValueRef allocProfileInit = nullptr;
+  LLVMValueRef allocProfileDump = nullptr;
+
+  LLVMValueRef trace = nullptr;
+
   Externs(LLVMModuleRef mod, LLVMContextRef context);
 };
 
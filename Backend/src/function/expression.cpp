@@ -7,6 +7,7 @@
 #include "../region/common/heap.h"
 
 #include "../translatetype.h"
+#include "../debuginfo.h"
 
 #include "expressions/expressions.h"
 #include "expressions/shared/shared.h"
@@ -42,7 +43,15 @@ Ref translateExpression(
     LLVMBuilderRef builder,
     Expression* expr) {
   functionState->instructionDepthInAst++;
+  bool hasDebugLocation = globalState->opt->debugInfo && expr->range.has_value();
+  LLVMMetadataRef previousDebugLocation = nullptr;
+  if (hasDebugLocation) {
+    previousDebugLocation = beginExpressionDebugInfo(globalState, functionState, builder, expr);
+  }
   auto resultLE = translateExpressionInner(globalState, functionState, blockState, builder, expr);
+  if (hasDebugLocation) {
+    LLVMSetCurrentDebugLocation2(builder, previousDebugLocation);
+  }
   functionState->instructionDepthInAst--;
   return resultLE;
 }
@@ -99,6 +108,7 @@ Ref translateExpressionInner(
       auto toReturnLE =
           globalState->getRegion(ret->sourceType)
               ->checkValidReference(FL(), functionState, builder, ret->sourceType, sourceRef);
+      markTailCallIfPossible(functionState, builder, toReturnLE);
       LLVMBuildRet(builder, toReturnLE);
       return wrap(globalState->getRegion(globalState->metalCache->neverRef), globalState->metalCache->neverRef, globalState->neverPtr);
     }
@@ -381,6 +391,60 @@ Ref translateExpressionInner(
         ->dealias(
             AFL("pushRuntimeSizedArrayNoBoundsCheck"), functionState, builder, arrayType, arrayRef);
 
+    return makeVoidRef(globalState);
+  } else if (auto migrateRuntimeSizedArray = dynamic_cast<MigrateRuntimeSizedArray*>(expr)) {
+    buildFlare(FL(), globalState, functionState, builder, typeid(*expr).name());
+    auto sourceArrayType = migrateRuntimeSizedArray->sourceArrayType;
+    auto targetArrayType = migrateRuntimeSizedArray->targetArrayType;
+    auto arrayMT = migrateRuntimeSizedArray->arrayKind;
+    assert(sourceArrayType->ownership == Ownership::OWN);
+    bool arrayKnownLive = true;
+    auto i32Ref = globalState->metalCache->i32Ref;
+
+    auto sourceArrayRef =
+        translateExpression(
+            globalState, functionState, blockState, builder, migrateRuntimeSizedArray->sourceArrayExpr);
+    globalState->getRegion(sourceArrayType)
+        ->checkValidReference(FL(), functionState, builder, sourceArrayType, sourceArrayRef);
+    auto targetArrayRef =
+        translateExpression(
+            globalState, functionState, blockState, builder, migrateRuntimeSizedArray->targetArrayExpr);
+    globalState->getRegion(targetArrayType)
+        ->checkValidReference(FL(), functionState, builder, targetArrayType, targetArrayRef);
+
+    auto sourceLenLE =
+        globalState->getRegion(i32Ref)->checkValidReference(FL(), functionState, builder, i32Ref,
+            globalState->getRegion(sourceArrayType)
+                ->getRuntimeSizedArrayLength(
+                    functionState, builder, sourceArrayType, sourceArrayRef, arrayKnownLive));
+    auto targetLenLE =
+        globalState->getRegion(i32Ref)->checkValidReference(FL(), functionState, builder, i32Ref,
+            globalState->getRegion(targetArrayType)
+                ->getRuntimeSizedArrayLength(
+                    functionState, builder, targetArrayType, targetArrayRef, arrayKnownLive));
+    auto targetCapacityLE =
+        globalState->getRegion(i32Ref)->checkValidReference(FL(), functionState, builder, i32Ref,
+            globalState->getRegion(targetArrayType)
+                ->getRuntimeSizedArrayCapacity(
+                    functionState, builder, targetArrayType, targetArrayRef, arrayKnownLive));
+    // The elements are copied in one go, so unlike push, we can't let this slide.
+    auto hasRoomLE =
+        LLVMBuildICmp(
+            builder, LLVMIntULE, LLVMBuildAdd(builder, targetLenLE, sourceLenLE, "newLen"),
+            targetCapacityLE, "hasRoom");
+    buildAssert(globalState, functionState, builder, hasRoomLE, "Runtime-sized array has no room for migrated elements!");
+
+    globalState->getRegion(targetArrayType)
+        ->migrateRuntimeSizedArrayNoBoundsCheck(
+            functionState, builder, arrayMT, sourceArrayType, sourceArrayRef, targetArrayType, targetArrayRef);
+
+    // The source is empty now, so this just frees it.
+    globalState->getRegion(sourceArrayType)
+        ->discardOwningRef(FL(), functionState, blockState, builder, sourceArrayType, sourceArrayRef);
+    globalState->getRegion(targetArrayType)
+        ->dealias(
+            AFL("migrateRuntimeSizedArrayNoBoundsCheck"), functionState, builder, targetArrayType, targetArrayRef);
+
     return makeVoidRef(globalState);
   } else if (auto popRuntimeSizedArray = dynamic_cast<PopRuntimeSizedArray*>(expr)) {
     buildFlare(FL(), globalState, functionState, builder, typeid(*expr).name());
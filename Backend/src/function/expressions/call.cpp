@@ -1,10 +1,81 @@
 #include <iostream>
+#include <optional>
 #include "shared/shared.h"
 
 #include "../../translatetype.h"
 
 #include "../expression.h"
+#include "shared/string.h"
 
+// Whether this is Builtins' `func +(a str, b str) str`, from str.vale.
+static bool isBuiltinStrConcat(GlobalState* globalState, Prototype* prototype) {
+  auto strRefMT = globalState->metalCache->strRef;
+  auto name = prototype->name;
+  bool isPlus = name->name == "+" || name->name.rfind("+_", 0) == 0;
+  bool isBuiltin = name->packageCoord == globalState->metalCache->builtinPackageCoord;
+  return isPlus && isBuiltin &&
+      prototype->params.size() == 2 &&
+      prototype->params[0] == strRefMT &&
+      prototype->params[1] == strRefMT &&
+      prototype->returnType == strRefMT;
+}
+
+// Collects the operands of a left- (or right-) nested chain of string +'s, in evaluation order.
+static void collectStrConcatLeaves(
+    GlobalState* globalState,
+    Expression* expr,
+    std::vector<Expression*>* leaves) {
+  auto call = dynamic_cast<Call*>(expr);
+  if (call && isBuiltinStrConcat(globalState, call->function)) {
+    for (auto argExpr : call->argExprs) {
+      collectStrConcatLeaves(globalState, argExpr, leaves);
+    }
+  } else {
+    leaves->push_back(expr);
+  }
+}
+
+// Something like a + b + c + d would otherwise make and free two intermediate strings, and
+// copy a's bytes three times. Instead, we evaluate all the operands, then copy them into one
+// new string. Returns nullopt if this isn't a chain of at least two +'s.
+static std::optional<Ref> translateStrConcatChain(
+    GlobalState* globalState,
+    FunctionState* functionState,
+    BlockState* blockState,
+    LLVMBuilderRef builder,
+    Call* call) {
+  if (!isBuiltinStrConcat(globalState, call->function)) {
+    return std::nullopt;
+  }
+  std::vector<Expression*> leafExprs;
+  collectStrConcatLeaves(globalState, call, &leafExprs);
+  if (leafExprs.size() < 3) {
+    return std::nullopt;
+  }
+
+  auto strRefMT = globalState->metalCache->strRef;
+  auto strRegion = globalState->getRegion(strRefMT);
+  std::vector<Ref> leafRefs;
+  std::vector<std::pair<LLVMValueRef, LLVMValueRef>> pieces;
+  for (auto leafExpr : leafExprs) {
+    auto leafRef = translateExpression(globalState, functionState, blockState, builder, leafExpr);
+    buildFlare(FL(), globalState, functionState, builder);
+    strRegion->checkValidReference(FL(), functionState, builder, strRefMT, leafRef);
+    leafRefs.push_back(leafRef);
+  }
+  for (auto leafRef : leafRefs) {
+    pieces.emplace_back(
+        strRegion->getStringBytesPtr(functionState, builder, leafRef),
+        strRegion->getStringLen(functionState, builder, leafRef));
+  }
+  auto resultRef = buildConcatStrBytes(globalState, functionState, builder, pieces);
+  for (auto leafRef : leafRefs) {
+    strRegion->dealias(FL(), functionState, builder, strRefMT, leafRef);
+  }
+  globalState->strConcatChainsFlattened++;
+  globalState->strConcatOperandsFlattened += leafExprs.size();
+  return resultRef;
+}
 
 Ref translateCall(
     GlobalState* globalState,
@@ -12,6 +83,10 @@ Ref translateCall(
     BlockState* blockState,
     LLVMBuilderRef builder,
     Call* call) {
+  if (auto maybeConcatResult = translateStrConcatChain(globalState, functionState, blockState, builder, call)) {
+    return *maybeConcatResult;
+  }
+
   auto argsLE = std::vector<Ref>{};
   argsLE.reserve(call->argExprs.size());
   for (int i = 0; i < call->argExprs.size(); i++) {
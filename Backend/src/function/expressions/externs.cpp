@@ -1,4 +1,5 @@
 #include <iostream>
+#include <optional>
 #include "../boundary.h"
 #include "shared/shared.h"
 #include "shared/string.h"
@@ -10,6 +11,132 @@
 
 #include "../expression.h"
 
+// Points at the given offset into a string's bytes, without copying them.
+static LLVMValueRef getStrSliceBytesPtr(
+    GlobalState* globalState,
+    FunctionState* functionState,
+    LLVMBuilderRef builder,
+    Ref strRef,
+    LLVMValueRef beginLE) {
+  auto charsPtrLE =
+      globalState->getRegion(globalState->metalCache->strRef)
+          ->getStringBytesPtr(functionState, builder, strRef);
+  return LLVMBuildGEP(builder, charsPtrLE, &beginLE, 1, "sliceBytesPtr");
+}
+
+static void dealiasStrArgs(
+    GlobalState* globalState,
+    FunctionState* functionState,
+    LLVMBuilderRef builder,
+    Prototype* prototype,
+    const std::vector<Ref>& args) {
+  for (int i = 0; i < args.size(); i++) {
+    if (prototype->params[i] == globalState->metalCache->strRef) {
+      globalState->getRegion(globalState->metalCache->strRef)
+          ->dealias(FL(), functionState, builder, globalState->metalCache->strRef, args[i]);
+    }
+  }
+}
+
+// The builtin string externs (see Builtins' str.vale and print.vale) take strings plus a begin
+// and an end (or a length) for each. Calling them like any other extern would copy the
+// strings into fresh linear buffers for the C side to read and free, so instead we work on the
+// strings' own bytes right here. Returns nullopt if this isn't one of them.
+static std::optional<Ref> buildInlineStrBuiltinCall(
+    GlobalState* globalState,
+    FunctionState* functionState,
+    LLVMBuilderRef builder,
+    Prototype* prototype,
+    const std::vector<Ref>& args) {
+  auto strRefMT = globalState->metalCache->strRef;
+  auto name = prototype->name->name;
+  // Only Builtins' own externs; a user's extern that happens to share one of these names is
+  // called like any other.
+  if (prototype->name->packageCoord != globalState->metalCache->builtinPackageCoord) {
+    return std::nullopt;
+  }
+  if (name == "printstr") {
+    if (args.size() != 3 || prototype->params[0] != strRefMT) {
+      return std::nullopt;
+    }
+    auto beginLE = checkValidInternalReference(FL(), globalState, functionState, builder, prototype->params[1], args[1]);
+    auto lenLE = checkValidInternalReference(FL(), globalState, functionState, builder, prototype->params[2], args[2]);
+    std::vector<LLVMValueRef> writeArgsLE = {
+        getStrSliceBytesPtr(globalState, functionState, builder, args[0], beginLE),
+        LLVMBuildZExt(builder, lenLE, LLVMInt64TypeInContext(globalState->context), "lenI64") };
+    LLVMBuildCall(builder, globalState->externs->writeStdout, writeArgsLE.data(), writeArgsLE.size(), "");
+    dealiasStrArgs(globalState, functionState, builder, prototype, args);
+    globalState->inlinedStrBuiltinCalls[name]++;
+    return makeVoidRef(globalState);
+  }
+  if (name == "substring") {
+    if (args.size() != 3 || prototype->params[0] != strRefMT || prototype->returnType != strRefMT) {
+      return std::nullopt;
+    }
+    auto beginLE = checkValidInternalReference(FL(), globalState, functionState, builder, prototype->params[1], args[1]);
+    auto lenLE = checkValidInternalReference(FL(), globalState, functionState, builder, prototype->params[2], args[2]);
+    auto sourceBytesPtrLE = getStrSliceBytesPtr(globalState, functionState, builder, args[0], beginLE);
+    auto resultRef =
+        globalState->getRegion(strRefMT)->mallocStr(
+            makeVoidRef(globalState), functionState, builder, lenLE, sourceBytesPtrLE);
+    dealiasStrArgs(globalState, functionState, builder, prototype, args);
+    globalState->inlinedStrBuiltinCalls[name]++;
+    return resultRef;
+  }
+
+  if (name != "strindexof" && name != "streq" && name != "strcmp" && name != "addStr") {
+    return std::nullopt;
+  }
+  if (args.size() != 6 || prototype->params[0] != strRefMT || prototype->params[3] != strRefMT) {
+    return std::nullopt;
+  }
+  auto aBeginLE = checkValidInternalReference(FL(), globalState, functionState, builder, prototype->params[1], args[1]);
+  auto aEndOrLenLE = checkValidInternalReference(FL(), globalState, functionState, builder, prototype->params[2], args[2]);
+  auto bBeginLE = checkValidInternalReference(FL(), globalState, functionState, builder, prototype->params[4], args[4]);
+  auto bEndOrLenLE = checkValidInternalReference(FL(), globalState, functionState, builder, prototype->params[5], args[5]);
+  auto aBytesPtrLE = getStrSliceBytesPtr(globalState, functionState, builder, args[0], aBeginLE);
+  auto bBytesPtrLE = getStrSliceBytesPtr(globalState, functionState, builder, args[3], bBeginLE);
+  auto int64LT = LLVMInt64TypeInContext(globalState->context);
+
+  if (name == "addStr") {
+    auto resultRef =
+        buildConcatStrBytes(
+            globalState, functionState, builder,
+            {{aBytesPtrLE, aEndOrLenLE}, {bBytesPtrLE, bEndOrLenLE}});
+    dealiasStrArgs(globalState, functionState, builder, prototype, args);
+    globalState->inlinedStrBuiltinCalls[name]++;
+    return resultRef;
+  }
+
+  auto aLenLE = LLVMBuildSub(builder, aEndOrLenLE, aBeginLE, "aLen");
+  auto bLenLE = LLVMBuildSub(builder, bEndOrLenLE, bBeginLE, "bLen");
+  LLVMValueRef resultLE = nullptr;
+  if (name == "streq") {
+    // Compare zero bytes if the lengths differ, so memcmp never reads past the shorter one.
+    auto sameLenLE = LLVMBuildICmp(builder, LLVMIntEQ, aLenLE, bLenLE, "sameLen");
+    auto compareLenLE =
+        LLVMBuildSelect(
+            builder, sameLenLE, LLVMBuildZExt(builder, aLenLE, int64LT, "aLenI64"),
+            constI64LE(globalState, 0), "compareLen");
+    std::vector<LLVMValueRef> memcmpArgsLE = { aBytesPtrLE, bBytesPtrLE, compareLenLE };
+    auto memcmpResultLE =
+        LLVMBuildCall(builder, globalState->externs->memcmp, memcmpArgsLE.data(), memcmpArgsLE.size(), "memcmpResult");
+    resultLE =
+        LLVMBuildAnd(
+            builder, sameLenLE,
+            LLVMBuildICmp(builder, LLVMIntEQ, memcmpResultLE, constI32LE(globalState, 0), "sameBytes"),
+            "streq");
+  } else {
+    std::vector<LLVMValueRef> kernelArgsLE = { aBytesPtrLE, aLenLE, bBytesPtrLE, bLenLE };
+    auto kernelLE =
+        name == "strindexof" ? globalState->externs->strIndexOfBytes : globalState->externs->strCmpBytes;
+    resultLE = LLVMBuildCall(builder, kernelLE, kernelArgsLE.data(), kernelArgsLE.size(), name.c_str());
+  }
+  dealiasStrArgs(globalState, functionState, builder, prototype, args);
+  globalState->inlinedStrBuiltinCalls[name]++;
+  return wrap(globalState->getRegion(prototype->returnType), prototype->returnType, resultLE);
+}
+
 Ref buildExternCall(
     GlobalState* globalState,
     FunctionState* functionState,
@@ -185,6 +312,7 @@ Ref buildExternCall(
     return wrap(globalState->getRegion(globalState->metalCache->floatRef), globalState->metalCache->floatRef, result);
   } else if (prototype->name->name == "__vbi_panic") {
     buildPrint(globalState, builder, "(panic)\n");
+    LLVMBuildCall(builder, globalState->externs->flushStdout, nullptr, 0, "");
     // See MPESC for status codes
     auto exitCodeLE = makeConstIntExpr(functionState, builder, LLVMInt64TypeInContext(globalState->context), 1);
     LLVMBuildCall(builder, globalState->externs->exit, &exitCodeLE, 1, "");
@@ -193,6 +321,16 @@ Ref buildExternCall(
   } else if (prototype->name->name == "__vbi_getch") {
     auto resultIntLE = LLVMBuildCall(builder, globalState->externs->getch, nullptr, 0, "");
     return wrap(globalState->getRegion(prototype->returnType), prototype->returnType, resultIntLE);
+  } else if (prototype->name->name == "__vbi_arenaMark") {
+    assert(args.size() == 0);
+    auto markLE = LLVMBuildCall(builder, globalState->externs->arenaMark, nullptr, 0, "arenaMark");
+    return wrap(globalState->getRegion(prototype->returnType), prototype->returnType, markLE);
+  } else if (prototype->name->name == "__vbi_arenaRelease") {
+    assert(args.size() == 1);
+    // Everything the arena handed out since the mark is gone after this, see builtins/arena.c.
+    auto markLE = checkValidInternalReference(FL(), globalState, functionState, builder, prototype->params[0], args[0]);
+    LLVMBuildCall(builder, globalState->externs->arenaRelease, &markLE, 1, "");
+    return makeVoidRef(globalState);
   } else if (prototype->name->name == "__vbi_eqFloatFloat") {
     assert(args.size() == 2);
     auto leftLE = checkValidInternalReference(FL(), globalState, functionState, builder, prototype->params[0], args[0]);
@@ -224,6 +362,48 @@ Ref buildExternCall(
     assert(args.size() == 2);
     auto result = LLVMBuildOr( builder, leftLE, rightLE, "");
     return wrap(globalState->getRegion(prototype->returnType), prototype->returnType, result);
+  } else if (prototype->name->name == "__vbi_strBuilderNew") {
+    assert(args.size() == 0);
+    auto result = LLVMBuildCall(builder, globalState->externs->strBuilderNew, nullptr, 0, "strBuilder");
+    return wrap(globalState->getRegion(prototype->returnType), prototype->returnType, result);
+  } else if (prototype->name->name == "__vbi_strBuilderAppend") {
+    assert(args.size() == 4);
+    auto handleLE = checkValidInternalReference(FL(), globalState, functionState, builder, prototype->params[0], args[0]);
+    auto beginLE = checkValidInternalReference(FL(), globalState, functionState, builder, prototype->params[2], args[2]);
+    auto endLE = checkValidInternalReference(FL(), globalState, functionState, builder, prototype->params[3], args[3]);
+    std::vector<LLVMValueRef> appendArgsLE = {
+        handleLE,
+        getStrSliceBytesPtr(globalState, functionState, builder, args[1], beginLE),
+        LLVMBuildSub(builder, endLE, beginLE, "len") };
+    LLVMBuildCall(builder, globalState->externs->strBuilderAppend, appendArgsLE.data(), appendArgsLE.size(), "");
+    dealiasStrArgs(globalState, functionState, builder, prototype, args);
+    return makeVoidRef(globalState);
+  } else if (prototype->name->name == "__vbi_strBuilderBuild") {
+    assert(args.size() == 1);
+    // Leaves the builder as it is, since StringBuilder.str() only borrows it.
+    auto handleLE = checkValidInternalReference(FL(), globalState, functionState, builder, prototype->params[0], args[0]);
+    auto lenLE = LLVMBuildCall(builder, globalState->externs->strBuilderLength, &handleLE, 1, "len");
+    auto charsPtrLE = LLVMBuildCall(builder, globalState->externs->strBuilderChars, &handleLE, 1, "chars");
+    return buildConcatStrBytes(globalState, functionState, builder, {{charsPtrLE, lenLE}});
+  } else if (prototype->name->name == "__vbi_strBuilderFree") {
+    assert(args.size() == 1);
+    auto handleLE = checkValidInternalReference(FL(), globalState, functionState, builder, prototype->params[0], args[0]);
+    LLVMBuildCall(builder, globalState->externs->strBuilderFree, &handleLE, 1, "");
+    return makeVoidRef(globalState);
+  } else if (prototype->name->name == "__vbi_strParseInt") {
+    assert(args.size() == 3);
+    auto beginLE = checkValidInternalReference(FL(), globalState, functionState, builder, prototype->params[1], args[1]);
+    auto endLE = checkValidInternalReference(FL(), globalState, functionState, builder, prototype->params[2], args[2]);
+    std::vector<LLVMValueRef> parseArgsLE = {
+        getStrSliceBytesPtr(globalState, functionState, builder, args[0], beginLE),
+        LLVMBuildSub(builder, endLE, beginLE, "len") };
+    auto resultLE =
+        LLVMBuildCall(builder, globalState->externs->strParseIntBytes, parseArgsLE.data(), parseArgsLE.size(), "parsed");
+    dealiasStrArgs(globalState, functionState, builder, prototype, args);
+    return wrap(globalState->getRegion(prototype->returnType), prototype->returnType, resultLE);
+  } else if (auto maybeStrResult =
+      buildInlineStrBuiltinCall(globalState, functionState, builder, prototype, args)) {
+    return *maybeStrResult;
   } else {
     auto valeArgRefs = std::vector<Ref>{};
     valeArgRefs.reserve(args.size());
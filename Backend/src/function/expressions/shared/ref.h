@@ -52,6 +52,8 @@ struct WeakFatPtrLE {
 
 
 // An LLVM register, which contains a reference.
+struct TraceEvent;
+
 struct Ref {
   Ref(Reference* refM_, LLVMValueRef refLE_) : refM(refM_), refLE(refLE_) {}
 
@@ -75,6 +77,7 @@ private:
       GlobalState* globalState,
       LLVMBuilderRef builder,
       Ref ref);
+  friend void collectTraceArg(TraceEvent* event, Ref ref);
 };
 
 Ref wrap(IRegion* region, Reference* refM, LLVMValueRef exprLE);
@@ -68,6 +68,7 @@ LLVMValueRef adjustStrongRc(
     case RegionOverride::NAIVE_RC:
       break;
     case RegionOverride::FAST:
+    case RegionOverride::ARENA:
       assert(refM->ownership == Ownership::SHARE);
       break;
     case RegionOverride::RESILIENT_V3: case RegionOverride::RESILIENT_V4:
@@ -81,7 +82,13 @@ LLVMValueRef adjustStrongRc(
       kindStructsSource->getControlBlockPtr(from, functionState, builder, exprRef, refM);
   auto rcPtrLE = kindStructsSource->getStrongRcPtrFromControlBlockPtr(builder, refM, controlBlockPtrLE);
 //  auto oldRc = LLVMBuildLoad(builder, rcPtrLE, "oldRc");
-  auto newRc = adjustCounter(globalState, builder, globalState->metalCache->i32, rcPtrLE, amount);
+  LLVMValueRef newRc = nullptr;
+  if (globalState->opt->threadsafeImms && refM->ownership == Ownership::SHARE) {
+    // Immutables can be shared with other threads, so someone else might be adjusting this too.
+    newRc = adjustCounterAtomic(globalState, builder, globalState->metalCache->i32, rcPtrLE, amount);
+  } else {
+    newRc = adjustCounter(globalState, builder, globalState->metalCache->i32, rcPtrLE, amount);
+  }
 //  flareAdjustStrongRc(from, globalState, functionState, builder, refM, controlBlockPtrLE, oldRc, newRc);
   return newRc;
 }
@@ -98,6 +105,7 @@ LLVMValueRef strongRcIsZero(
     case RegionOverride::NAIVE_RC:
       break;
     case RegionOverride::FAST:
+    case RegionOverride::ARENA:
       assert(refM->ownership == Ownership::SHARE);
       break;
     case RegionOverride::RESILIENT_V3: case RegionOverride::RESILIENT_V4:
@@ -151,6 +159,70 @@ void buildPrint(
   buildPrint(globalState, builder, ref.refLE);
 }
 
+static int getTraceStringId(
+    std::unordered_map<std::string, int>* ids,
+    std::vector<std::string>* strs,
+    const std::string& str) {
+  auto iter = ids->find(str);
+  if (iter == ids->end()) {
+    iter = ids->emplace(str, strs->size()).first;
+    strs->push_back(str);
+  }
+  return iter->second;
+}
+
+void buildTraceRecord(
+    AreaAndFileAndLine from,
+    GlobalState* globalState,
+    LLVMBuilderRef builder,
+    const TraceEvent& event) {
+  auto int32LT = LLVMInt32TypeInContext(globalState->context);
+  auto int64LT = LLVMInt64TypeInContext(globalState->context);
+
+  auto location =
+      (from.area.empty() ? "" : getFileName(from.area) + ": ") +
+      getFileName(from.file) + ":" + std::to_string(from.line);
+  auto locationId = getTraceStringId(&globalState->traceLocationIds, &globalState->traceLocations, location);
+
+  std::string message = event.message;
+  std::vector<LLVMValueRef> valuesLE;
+  for (auto valueLE : event.valuesLE) {
+    auto valueLT = LLVMTypeOf(valueLE);
+    LLVMValueRef valueI64LE = nullptr;
+    if (valueLT == int64LT) {
+      valueI64LE = valueLE;
+    } else if (LLVMGetTypeKind(valueLT) == LLVMIntegerTypeKind) {
+      valueI64LE = LLVMBuildZExt(builder, valueLE, int64LT, "traceValue");
+    } else if (LLVMGetTypeKind(valueLT) == LLVMPointerTypeKind) {
+      valueI64LE = LLVMBuildPtrToInt(builder, valueLE, int64LT, "traceValue");
+    } else if (LLVMGetTypeKind(valueLT) == LLVMDoubleTypeKind) {
+      valueI64LE = LLVMBuildBitCast(builder, valueLE, int64LT, "traceValue");
+    }
+    if (valueI64LE && valuesLE.size() < 2) {
+      valuesLE.push_back(valueI64LE);
+    } else {
+      // Either it doesn't fit in a record or we can't make it an integer, so leave a ? in its {}.
+      auto placeholderPos = message.find("{}");
+      for (int i = 0; i < valuesLE.size(); i++) {
+        placeholderPos = message.find("{}", placeholderPos + 2);
+      }
+      message.replace(placeholderPos, 2, "{?}");
+    }
+  }
+  auto eventId = getTraceStringId(&globalState->traceEventIds, &globalState->traceEvents, message);
+
+  while (valuesLE.size() < 2) {
+    valuesLE.push_back(constI64LE(globalState, 0));
+  }
+  LLVMValueRef argsLE[4] = {
+      LLVMConstInt(int32LT, eventId, false),
+      LLVMConstInt(int32LT, locationId, false),
+      valuesLE[0],
+      valuesLE[1]
+  };
+  LLVMBuildCall(builder, globalState->externs->trace, argsLE, 4, "");
+}
+
 void buildPrint(
     GlobalState* globalState,
     LLVMBuilderRef builder,
@@ -257,6 +329,8 @@ Ref buildInterfaceCall(
 
   auto resultLE =
       LLVMBuildCall(builder, methodFunctionPtrLE, argsLE.data(), argsLE.size(), "");
+  // Every itable entry is one of our functions, see VALE_CALL_CONV.
+  LLVMSetInstructionCallConv(resultLE, VALE_CALL_CONV);
   buildFlare(FL(), globalState, functionState, builder);
   return wrap(globalState->getRegion(prototype->returnType), prototype->returnType, resultLE);
 }
@@ -332,6 +406,7 @@ Ref buildCall(
   buildFlare(FL(), globalState, functionState, builder, "Doing call");
 
   auto resultLE = LLVMBuildCall(builder, funcL, argsLE.data(), argsLE.size(), "");
+  LLVMSetInstructionCallConv(resultLE, VALE_CALL_CONV);
 
   buildFlare(FL(), globalState, functionState, builder, "Done with call");
 
@@ -120,6 +120,42 @@ inline void buildPrintIndent(
   buildPrint(globalState, builder, indentStr);
 }
 
+// With --binary_trace, a flare becomes a fixed-size binary record instead of printed text. The flare's
+// constant parts become its message, with a {} wherever a runtime value goes, and only the first
+// two runtime values are kept. See builtins/trace.c.
+struct TraceEvent {
+  std::string message;
+  std::vector<LLVMValueRef> valuesLE;
+};
+
+inline void collectTraceArg(TraceEvent* event, const std::string& str) {
+  event->message += str;
+}
+inline void collectTraceArg(TraceEvent* event, int num) {
+  event->message += std::to_string(num);
+}
+inline void collectTraceArg(TraceEvent* event, LLVMValueRef exprLE) {
+  event->message += "{}";
+  event->valuesLE.push_back(exprLE);
+}
+inline void collectTraceArg(TraceEvent* event, Ref ref) {
+  collectTraceArg(event, ref.refLE);
+}
+
+template<typename First, typename... Rest>
+inline void collectTraceArgs(TraceEvent* event, First&& first, Rest&&... rest) {
+  collectTraceArg(event, std::forward<First>(first));
+  collectTraceArgs(event, std::forward<Rest>(rest)...);
+}
+
+inline void collectTraceArgs(TraceEvent* event) { }
+
+void buildTraceRecord(
+    AreaAndFileAndLine from,
+    GlobalState* globalState,
+    LLVMBuilderRef builder,
+    const TraceEvent& event);
+
 template<typename... T>
 inline void buildFlare(
     AreaAndFileAndLine from,
@@ -137,6 +173,11 @@ inline void buildFlare(
     buildFlareInner(globalState, builder, std::forward<T>(rest)...);
     buildPrint(globalState, builder, "\n");
   }
+  if (globalState->opt->binaryTrace) {
+    TraceEvent event;
+    collectTraceArgs(&event, std::forward<T>(rest)...);
+    buildTraceRecord(from, globalState, builder, event);
+  }
 }
 
 LLVMValueRef getInterfaceMethodFunctionPtrFromItable(
@@ -69,3 +69,33 @@ Ref buildConstantVStr(
 
   return strRef;
 }
+
+Ref buildConcatStrBytes(
+    GlobalState* globalState,
+    FunctionState* functionState,
+    LLVMBuilderRef builder,
+    const std::vector<std::pair<LLVMValueRef, LLVMValueRef>>& bytesPtrAndLenPieces) {
+  auto strRefMT = globalState->metalCache->strRef;
+  auto int64LT = LLVMInt64TypeInContext(globalState->context);
+
+  LLVMValueRef resultLenLE = constI32LE(globalState, 0);
+  for (auto [bytesPtrLE, lenLE] : bytesPtrAndLenPieces) {
+    resultLenLE = LLVMBuildAdd(builder, resultLenLE, lenLE, "resultLen");
+  }
+  auto resultRef =
+      globalState->getRegion(strRefMT)->mallocStr(
+          makeVoidRef(globalState), functionState, builder, resultLenLE, nullptr);
+  auto resultBytesPtrLE =
+      globalState->getRegion(strRefMT)->getStringBytesPtr(functionState, builder, resultRef);
+
+  LLVMValueRef offsetLE = constI32LE(globalState, 0);
+  for (auto [bytesPtrLE, lenLE] : bytesPtrAndLenPieces) {
+    std::vector<LLVMValueRef> memcpyArgsLE = {
+        LLVMBuildGEP(builder, resultBytesPtrLE, &offsetLE, 1, "destPtr"),
+        bytesPtrLE,
+        LLVMBuildZExt(builder, lenLE, int64LT, "lenI64") };
+    LLVMBuildCall(builder, globalState->externs->memcpy, memcpyArgsLE.data(), memcpyArgsLE.size(), "");
+    offsetLE = LLVMBuildAdd(builder, offsetLE, lenLE, "offset");
+  }
+  return resultRef;
+}
@@ -26,4 +26,12 @@ Ref buildConstantVStr(
     LLVMBuilderRef builder,
     const std::string& contents);
 
+// Makes one new string holding all the given (bytes pointer, i32 length) pieces back to back,
+// with a single allocation.
+Ref buildConcatStrBytes(
+    GlobalState* globalState,
+    FunctionState* functionState,
+    LLVMBuilderRef builder,
+    const std::vector<std::pair<LLVMValueRef, LLVMValueRef>>& bytesPtrAndLenPieces);
+
 #endif
\ No newline at end of file
@@ -1,8 +1,10 @@
 #include <iostream>
+#include <llvm/IR/Instructions.h>
 #include "expressions/shared/shared.h"
 #include "../region/linear/linear.h"
 
 #include "../translatetype.h"
+#include "../debuginfo.h"
 
 #include "function.h"
 #include "expression.h"
@@ -22,13 +24,50 @@ LLVMValueRef declareFunction(
   auto valeFunctionNameL = functionM->prototype->name->name;
 
   LLVMValueRef valeFunctionL = LLVMAddFunction(globalState->mod, valeFunctionNameL.c_str(), valeFunctionTypeL);
+  LLVMSetFunctionCallConv(valeFunctionL, VALE_CALL_CONV);
 
   assert(globalState->functions.count(functionM->prototype->name->name) == 0);
   globalState->functions.emplace(functionM->prototype->name->name, valeFunctionL);
+  // lookupFunction prefers extra functions, so don't cover one up.
+  if (functionM->prototype->functionL == nullptr) {
+    functionM->prototype->functionL = valeFunctionL;
+  }
 
   return valeFunctionL;
 }
 
+void markTailCallIfPossible(
+    FunctionState* functionState,
+    LLVMBuilderRef builder,
+    LLVMValueRef resultLE) {
+  if (!LLVMIsACallInst(resultLE)) {
+    return;
+  }
+  // Anything between the call and the ret, like a flare or a check on the result, would have to
+  // run after the callee returns.
+  if (LLVMGetLastInstruction(LLVMGetInsertBlock(builder)) != resultLE) {
+    return;
+  }
+  auto callerL = functionState->containingFuncL;
+  if (LLVMGetFunctionCallConv(callerL) != VALE_CALL_CONV ||
+      LLVMGetInstructionCallConv(resultLE) != VALE_CALL_CONV) {
+    return;
+  }
+  // musttail needs the same parameter and return types. Requiring the exact same function type
+  // is a bit stricter than that, but it covers self-recursion and most mutual recursion.
+  if (LLVMGetCalledFunctionType(resultLE) != LLVMGlobalGetValueType(callerL)) {
+    return;
+  }
+  // The callee can't see our frame once it's gone, so nothing can point into it.
+  for (int i = 0; i < LLVMGetNumArgOperands(resultLE); i++) {
+    if (LLVMIsAAllocaInst(LLVMGetOperand(resultLE, i))) {
+      return;
+    }
+  }
+  // The C API can only set the plain tail marker, which LLVM is free to ignore.
+  llvm::cast<llvm::CallInst>(llvm::unwrap(resultLE))->setTailCallKind(llvm::CallInst::TCK_MustTail);
+}
+
 bool translatesToCVoid(GlobalState* globalState, Reference* returnMT) {
   if (returnMT == globalState->metalCache->neverRef) {
     return true;
@@ -222,6 +261,10 @@ void translateFunction(
   auto functionL = globalState->getFunction(functionM->prototype->name);
   auto returnTypeL = globalState->getRegion(functionM->prototype->returnType)->translateType(functionM->prototype->returnType);
 
+  if (globalState->opt->debugInfo) {
+    beginFunctionDebugInfo(globalState, functionM, functionL);
+  }
+
   auto localsBlockName = std::string("localsBlock");
   auto localsBuilder = LLVMCreateBuilderInContext(globalState->context);
   LLVMBasicBlockRef localsBlockL = LLVMAppendBasicBlockInContext(globalState->context, functionL, localsBlockName.c_str());
@@ -306,8 +349,11 @@ void declareExtraFunction(
 
   auto functionLT = LLVMFunctionType(returnTypeLT, paramsLT.data(), paramsLT.size(), false);
   auto functionL = LLVMAddFunction(globalState->mod, llvmName.c_str(), functionLT);
+  LLVMSetFunctionCallConv(functionL, VALE_CALL_CONV);
   // Don't define it yet, we're just declaring them right now.
-  globalState->extraFunctions.emplace(std::make_pair(prototype, functionL));
+  if (globalState->extraFunctions.emplace(std::make_pair(prototype, functionL)).second) {
+    prototype->functionL = functionL;
+  }
 }
 
 void defineFunctionBody(
@@ -160,6 +160,12 @@ public:
   }
 };
 
+// The calling convention for every function we define for Vale code, including the regions'
+// extra functions. Only externs, the vale_abi_ export thunks, and main are called from C, and
+// they keep the C convention. Every call to one of ours, direct or through an itable, has to say
+// this too.
+constexpr LLVMCallConv VALE_CALL_CONV = LLVMFastCallConv;
+
 void translateFunction(
     GlobalState* globalState,
     Function* functionM);
@@ -194,6 +200,14 @@ void declareAndDefineExtraFunction(
     std::string llvmName,
     std::function<void(FunctionState*, LLVMBuilderRef)> definer);
 
+// Called right before we return callLE's result. If it's a call to something with the same
+// signature as us (such as ourselves), marks it musttail, so a recursion in tail position runs
+// in constant stack.
+void markTailCallIfPossible(
+    FunctionState* functionState,
+    LLVMBuilderRef builder,
+    LLVMValueRef resultLE);
+
 bool typeNeedsPointerParameter(GlobalState* globalState, Reference* returnMT);
 bool translatesToCVoid(GlobalState* globalState, Reference* returnMT);
 LLVMTypeRef translateReturnType(GlobalState* globalState, Reference* returnMT);
@@ -9,11 +9,13 @@
 GlobalState::GlobalState(AddressNumberer* addressNumberer_) :
     addressNumberer(addressNumberer_),
     interfaceTablePtrs(0, addressNumberer->makeHasher<Edge*>()),
+    fatInterfaces(0, addressNumberer->makeHasher<InterfaceKind*>()),
     interfaceExtraMethods(0, addressNumberer->makeHasher<InterfaceKind*>()),
     overridesBySubstructByInterface(0, addressNumberer->makeHasher<InterfaceKind*>()),
     extraFunctions(0, addressNumberer->makeHasher<Prototype*>()),
     regions(0, addressNumberer->makeHasher<RegionId*>()),
-    regionIdByKind(0, addressNumberer->makeHasher<Kind*>())
+    regionIdByKind(0, addressNumberer->makeHasher<Kind*>()),
+    allocProfileKindIds(0, addressNumberer->makeHasher<Kind*>())
 {}
 
 std::vector<LLVMTypeRef> GlobalState::getInterfaceFunctionTypes(InterfaceKind* kind) {
@@ -84,51 +86,67 @@ std::vector<LLVMValueRef> GlobalState::getEdgeFunctions(Edge* edge) {
 }
 
 IRegion* GlobalState::getRegion(Reference* referenceM) {
-  return getRegion(referenceM->kind);
+  if (referenceM->region == nullptr) {
+    referenceM->region = getRegion(referenceM->kind);
+  }
+  return referenceM->region;
 }
 
 IRegion* GlobalState::getRegion(Kind* kindM) {
+  if (kindM->region) {
+    return kindM->region;
+  }
+  RegionId* regionId = nullptr;
   if (auto innt = dynamic_cast<Int*>(kindM)) {
-    return getRegion(innt->regionId);
+    regionId = innt->regionId;
   } else if (auto vooid = dynamic_cast<Void*>(kindM)) {
-    return getRegion(vooid->regionId);
+    regionId = vooid->regionId;
   } else if (auto boool = dynamic_cast<Bool*>(kindM)) {
-    return getRegion(boool->regionId);
+    regionId = boool->regionId;
   } else if (auto flooat = dynamic_cast<Float*>(kindM)) {
-    return getRegion(flooat->regionId);
+    regionId = flooat->regionId;
   } else if (auto never = dynamic_cast<Never*>(kindM)) {
-    return getRegion(never->regionId);
+    regionId = never->regionId;
   } else if (auto str = dynamic_cast<Str*>(kindM)) {
-    return getRegion(str->regionId);
+    regionId = str->regionId;
   } else {
     auto iter = regionIdByKind.find(kindM);
     if (iter == regionIdByKind.end()) {
       std::cerr << "Couldn't find region for: " << typeid(*kindM).name() << std::endl;
       exit(1);
     }
-    auto regionId = iter->second;
-    return getRegion(regionId);
+    regionId = iter->second;
   }
+  kindM->region = getRegion(regionId);
+  return kindM->region;
 }
 
 IRegion* GlobalState::getRegion(RegionId* regionId) {
+  if (regionId->region) {
+    return regionId->region;
+  }
+  IRegion* result = nullptr;
   if (regionId == metalCache->rcImmRegionId) {
-    return rcImm;
+    result = rcImm;
   } else if (regionId == metalCache->linearRegionId) {
-    return linearRegion;
+    result = linearRegion;
   } else if (regionId == metalCache->unsafeRegionId) {
-    return unsafeRegion;
+    result = unsafeRegion;
+  } else if (regionId == metalCache->arenaRegionId) {
+    result = arenaRegion;
   } else if (regionId == metalCache->assistRegionId) {
-    return assistRegion;
+    result = assistRegion;
   } else if (regionId == metalCache->naiveRcRegionId) {
-    return naiveRcRegion;
+    result = naiveRcRegion;
   } else if (regionId == metalCache->resilientV3RegionId) {
-    return resilientV3Region;
+    result = resilientV3Region;
   } else if (regionId == metalCache->resilientV4RegionId) {
-    return resilientV4Region;
+    result = resilientV4Region;
   } else {
     assert(false);
   }
+  regionId->region = result;
+  return result;
 }
 
 LLVMValueRef GlobalState::getFunction(Name* name) {
@@ -2,8 +2,12 @@
 #define GLOBALSTATE_H_
 
 #include <llvm-c/Core.h>
+#include <llvm-c/Orc.h>
 
+#include <map>
+#include <memory>
 #include <unordered_map>
+#include <unordered_set>
 #include "metal/metalcache.h"
 #include "region/common/defaultlayout/structs.h"
 
@@ -19,6 +23,8 @@ class KindStructs;
 class ControlBlock;
 class Linear;
 class RCImm;
+class PackageCache;
+class DebugFiles;
 
 constexpr int LGT_ENTRY_MEMBER_INDEX_FOR_GEN = 0;
 constexpr int LGT_ENTRY_MEMBER_INDEX_FOR_NEXT_FREE = 1;
@@ -31,9 +37,13 @@ public:
 
   LLVMTargetMachineRef machine = nullptr;
   LLVMContextRef context = nullptr;
+  // Only for --jit, where it owns context, so the JIT can share it with the modules we give it.
+  LLVMOrcThreadSafeContextRef threadSafeContext = nullptr;
   LLVMDIBuilderRef dibuilder = nullptr;
   LLVMMetadataRef compileUnit = nullptr;
   LLVMMetadataRef difile = nullptr;
+  // Only for --debug_info, see debuginfo.h.
+  DebugFiles* debugFiles = nullptr;
 
   ValeOptions *opt = nullptr;
 
@@ -44,8 +54,16 @@ public:
   int ptrSize = 0;
 
   MetalCache* metalCache = nullptr;
+  // Only for --serve, where the packages and the metal cache come from here, see packagecache.h.
+  PackageCache* packageCache = nullptr;
 
   Program* program = nullptr;
+  // What metalCache and program point to, unless --serve's package cache owns the metal cache.
+  // compileValeCode makes them, and they live as long as we do, because merging functions and
+  // finishing debug info still look at them after it returns.
+  std::unique_ptr<AddressNumberer> ownedAddressNumberer;
+  std::unique_ptr<MetalCache> ownedMetalCache;
+  std::unique_ptr<Program> ownedProgram;
 
   LLVMValueRef numMainArgs = nullptr;
   LLVMValueRef mainArgs = nullptr;
@@ -67,6 +85,25 @@ public:
 
 //  LLVMValueRef genMalloc = nullptr, genFree = nullptr;
 
+  // Only used with --alloc_profile, see allocprofile.h.
+  LLVMTypeRef allocProfileEntryLT = nullptr;
+  LLVMValueRef allocProfileTable = nullptr, allocProfileNames = nullptr, allocProfileNumKinds = nullptr;
+  std::unordered_map<Kind*, int, AddressHasher<Kind*>> allocProfileKindIds;
+  std::vector<std::string> allocProfileKindNames;
+
+  // Only used with --binary_trace, these become the trace string table, see buildTraceRecord.
+  std::unordered_map<std::string, int> traceEventIds;
+  std::vector<std::string> traceEvents;
+  std::unordered_map<std::string, int> traceLocationIds;
+  std::vector<std::string> traceLocations;
+
+  // Only printed with --stats. The builtin string extern calls that buildInlineStrBuiltinCall
+  // did right there, by extern, and the chains of string +'s that translateStrConcatChain
+  // turned into one concatenation.
+  std::map<std::string, int> inlinedStrBuiltinCalls;
+  int strConcatChainsFlattened = 0;
+  int strConcatOperandsFlattened = 0;
+
   LLVMTypeRef concreteHandleLT = nullptr; // 24 bytes, for SSA, RSA, and structs
   LLVMTypeRef interfaceHandleLT = nullptr; // 32 bytes, for interfaces. concreteHandleLT plus 8b itable ptr.
 
@@ -79,6 +116,10 @@ public:
   std::unordered_map<std::string, LLVMValueRef> stringConstants;
 
   std::unordered_map<Edge*, LLVMValueRef, AddressHasher<Edge*>> interfaceTablePtrs;
+  // Only used with --thin_interface_refs. Interfaces that some weakable struct implements, or
+  // some struct that also implements another interface. Those objects' headers can't hold the
+  // one itable, so these interfaces' references stay fat. See KindStructs::isThinInterface.
+  std::unordered_set<InterfaceKind*, AddressHasher<InterfaceKind*>> fatInterfaces;
 
   std::unordered_map<std::string, LLVMValueRef> functions;
   std::unordered_map<std::string, LLVMValueRef> externFunctions;
@@ -153,6 +194,9 @@ public:
   }
 
   LLVMValueRef lookupFunction(Prototype* prototype) {
+    if (prototype->functionL) {
+      return prototype->functionL;
+    }
     auto iter = extraFunctions.find(prototype);
     if (iter != extraFunctions.end()) {
       return iter->second;
@@ -211,6 +255,7 @@ public:
   RCImm* rcImm = nullptr;
   IRegion* mutRegion = nullptr;
   IRegion* unsafeRegion = nullptr;
+  IRegion* arenaRegion = nullptr;
   IRegion* assistRegion = nullptr;
   IRegion* naiveRcRegion = nullptr;
   IRegion* resilientV3Region = nullptr;
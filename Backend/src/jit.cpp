@@ -0,0 +1,324 @@
+#include <llvm-c/Core.h>
+#include <llvm-c/Error.h>
+#include <llvm-c/IRReader.h>
+#include <llvm-c/LLJIT.h>
+#include <llvm-c/Orc.h>
+
+#include <csetjmp>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <unordered_map>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "jit.h"
+#include "globalstate.h"
+#include "error.h"
+
+static void exitOnJitError(LLVMErrorRef err, const std::string& whatFailed) {
+  if (err) {
+    char* message = LLVMGetErrorMessage(err);
+    std::string messageStr = message;
+    LLVMDisposeErrorMessage(message);
+    errorExit(ExitCode::JitFailed, whatFailed, ": ", messageStr);
+  }
+}
+
+static bool readWholeFile(const std::string& path, std::string* contents) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    return false;
+  }
+  std::stringstream buffer;
+  buffer << file.rdbuf();
+  *contents = buffer.str();
+  return true;
+}
+
+// FNV-1a, we only need it to tell versions of a file apart.
+static uint64_t hashBytes(uint64_t hash, const std::string& bytes) {
+  for (unsigned char c : bytes) {
+    hash ^= c;
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+static std::string jitCacheDir(ValeOptions* opt) {
+  if (!opt->jitCacheDir.empty()) {
+    return opt->jitCacheDir;
+  }
+  if (auto fromEnv = getenv("VALE_JIT_CACHE_DIR")) {
+    return fromEnv;
+  }
+  if (auto home = getenv("HOME")) {
+    return std::string(home) + "/.cache/vale/jit";
+  }
+  return (std::filesystem::temp_directory_path() / "vale-jit-cache").string();
+}
+
+static std::string shellQuote(const std::string& arg) {
+  std::string result = "'";
+  for (char c : arg) {
+    if (c == '\'') {
+      result += "'\\''";
+    } else {
+      result += c;
+    }
+  }
+  return result + "'";
+}
+
+// Hashes the source along with the headers it includes with quotes, as found next to it or in
+// the output's include dir. That's not everything the preprocessor could pull in, but it covers
+// ValeBuiltins.h and the generated extern headers, which are the ones that change.
+static uint64_t hashNativeInput(
+    ValeOptions* opt, const std::string& sourcePath, const std::string& source, const std::string& flags) {
+  uint64_t hash = 14695981039346656037ull;
+  hash = hashBytes(hash, flags);
+  hash = hashBytes(hash, sourcePath);
+  hash = hashBytes(hash, source);
+
+  auto sourceDir = std::filesystem::path(sourcePath).parent_path();
+  auto includeDir = std::filesystem::path(opt->outputDir) / "include";
+  std::istringstream lines(source);
+  std::string line;
+  while (std::getline(lines, line)) {
+    auto includePos = line.find("#include \"");
+    if (includePos == std::string::npos) {
+      continue;
+    }
+    auto nameBegin = includePos + strlen("#include \"");
+    auto nameEnd = line.find('"', nameBegin);
+    if (nameEnd == std::string::npos) {
+      continue;
+    }
+    auto name = line.substr(nameBegin, nameEnd - nameBegin);
+    std::string header;
+    if (readWholeFile((sourceDir / name).string(), &header) ||
+        readWholeFile((includeDir / name).string(), &header)) {
+      hash = hashBytes(hash, header);
+    }
+  }
+  return hash;
+}
+
+// Returns the path to the cached bitcode for this C file, compiling it first if needed.
+static std::string compileToBitcode(ValeOptions* opt, const std::string& sourcePath) {
+  std::string source;
+  if (!readWholeFile(sourcePath, &source)) {
+    errorExit(ExitCode::JitFailed, "Couldn't read JIT input: ", sourcePath);
+  }
+  auto flags =
+      std::string("-c -emit-llvm -O2 -I ") +
+      shellQuote((std::filesystem::path(opt->outputDir) / "include").string());
+  char hashStr[17];
+  snprintf(hashStr, sizeof(hashStr), "%016llx",
+      (unsigned long long)hashNativeInput(opt, sourcePath, source, flags));
+
+  auto cacheDir = std::filesystem::path(jitCacheDir(opt));
+  auto bitcodePath =
+      (cacheDir / (std::filesystem::path(sourcePath).stem().string() + "-" + hashStr + ".bc")).string();
+  if (std::filesystem::exists(bitcodePath)) {
+    return bitcodePath;
+  }
+
+  std::error_code ignored;
+  std::filesystem::create_directories(cacheDir, ignored);
+  // Other backends might be compiling the same file right now, so write it somewhere of our own
+  // and then rename it into place, which either of us can win.
+  auto tempPath = bitcodePath + "." + std::to_string(getpid()) + ".tmp";
+  auto compiler = getenv("VALE_JIT_CC") ? getenv("VALE_JIT_CC") : "clang";
+  auto command =
+      std::string(compiler) + " " + flags + " -o " + shellQuote(tempPath) + " " + shellQuote(sourcePath);
+  if (std::system(command.c_str()) != 0) {
+    errorExit(ExitCode::JitFailed, "Couldn't compile JIT input, command was: ", command);
+  }
+  std::filesystem::rename(tempPath, bitcodePath);
+  return bitcodePath;
+}
+
+// Bitcode we've already read, by path, so --jit_batch only reads each file once.
+static std::unordered_map<std::string, std::string> loadedBitcode;
+
+static LLVMModuleRef loadModule(LLVMContextRef context, const std::string& path) {
+  auto found = loadedBitcode.find(path);
+  if (found == loadedBitcode.end()) {
+    std::string contents;
+    if (!readWholeFile(path, &contents)) {
+      errorExit(ExitCode::JitFailed, "Couldn't read JIT input: ", path);
+    }
+    found = loadedBitcode.emplace(path, std::move(contents)).first;
+  }
+  auto buffer =
+      LLVMCreateMemoryBufferWithMemoryRangeCopy(found->second.data(), found->second.size(), path.c_str());
+  LLVMModuleRef mod = nullptr;
+  char* err = nullptr;
+  // Takes the buffer, and handles .ll files as well as bitcode.
+  if (LLVMParseIRInContext(context, buffer, &mod, &err) != 0) {
+    std::string message = err;
+    LLVMDisposeMessage(err);
+    errorExit(ExitCode::JitFailed, "Couldn't load JIT input ", path, ": ", message);
+  }
+  return mod;
+}
+
+// The JIT's linker doesn't do thread-local relocations. The program runs on just this thread
+// (we don't JIT --threadsafe_imms programs), so plain globals do the same job.
+static void demoteThreadLocals(LLVMModuleRef mod) {
+  for (auto global = LLVMGetFirstGlobal(mod); global; global = LLVMGetNextGlobal(global)) {
+    if (LLVMIsThreadLocal(global)) {
+      LLVMSetThreadLocal(global, false);
+    }
+  }
+}
+
+// What we need to undo after a program, so the next one in this process starts clean.
+struct JitRun {
+  jmp_buf exitJump;
+  int exitCode = 0;
+  std::vector<void (*)()> atexitHandlers;
+  std::vector<std::pair<pthread_key_t, void (*)(void*)>> threadKeys;
+};
+static JitRun* currentJitRun = nullptr;
+
+// The program gets these instead of the real ones, see defineHostSymbols.
+
+static int jitAtexit(void (*handler)()) {
+  currentJitRun->atexitHandlers.push_back(handler);
+  return 0;
+}
+
+[[noreturn]] static void jitExit(int code) {
+  currentJitRun->exitCode = code;
+  longjmp(currentJitRun->exitJump, 1);
+}
+
+static int jitPthreadKeyCreate(pthread_key_t* key, void (*destructor)(void*)) {
+  int result = pthread_key_create(key, destructor);
+  if (result == 0) {
+    currentJitRun->threadKeys.emplace_back(*key, destructor);
+  }
+  return result;
+}
+
+// Without these the program's exit() would end the backend, and its atexit handlers and
+// thread-exit destructors would run after we've freed their code.
+static void defineHostSymbols(LLVMOrcLLJITRef jit, LLVMOrcJITDylibRef dylib) {
+  std::vector<std::pair<const char*, void*>> hostFunctions = {
+      { "atexit", (void*)&jitAtexit },
+      { "exit", (void*)&jitExit },
+      { "pthread_key_create", (void*)&jitPthreadKeyCreate },
+  };
+  std::vector<LLVMJITCSymbolMapPair> symbols;
+  for (auto [name, address] : hostFunctions) {
+    LLVMJITCSymbolMapPair pair;
+    pair.Name = LLVMOrcLLJITMangleAndIntern(jit, name);
+    pair.Sym.Address = (LLVMOrcJITTargetAddress)(uintptr_t)address;
+    pair.Sym.Flags.GenericFlags = LLVMJITSymbolGenericFlagsExported | LLVMJITSymbolGenericFlagsCallable;
+    pair.Sym.Flags.TargetFlags = 0;
+    symbols.push_back(pair);
+  }
+  exitOnJitError(
+      LLVMOrcJITDylibDefine(dylib, LLVMOrcAbsoluteSymbols(symbols.data(), symbols.size())),
+      "Couldn't define host symbols for JIT");
+}
+
+// Does what exit() would have: the atexit handlers, last registered first, and then the
+// thread-exit destructors, which this thread otherwise wouldn't run until it really exits.
+static void finishJitRun(JitRun* run) {
+  while (!run->atexitHandlers.empty()) {
+    auto handler = run->atexitHandlers.back();
+    run->atexitHandlers.pop_back();
+    // A handler can call exit() too, which just moves us on to the next one.
+    if (setjmp(run->exitJump) == 0) {
+      handler();
+    }
+  }
+  for (auto [key, destructor] : run->threadKeys) {
+    auto value = pthread_getspecific(key);
+    if (value && destructor) {
+      pthread_setspecific(key, nullptr);
+      destructor(value);
+    }
+    pthread_key_delete(key);
+  }
+}
+
+static bool endsWith(const std::string& str, const std::string& suffix) {
+  return str.size() >= suffix.size() && str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+int runJit(GlobalState* globalState, const std::vector<std::string>& nativeInputPaths) {
+  auto opt = globalState->opt;
+
+  auto inputPaths = nativeInputPaths;
+  // The extern glue we generated for this program, which the Coordinator would normally pick up.
+  auto abiDir = std::filesystem::path(opt->outputDir) / "abi";
+  if (std::filesystem::is_directory(abiDir)) {
+    for (auto& entry : std::filesystem::recursive_directory_iterator(abiDir)) {
+      if (entry.is_regular_file() && entry.path().extension() == ".c") {
+        inputPaths.push_back(entry.path().string());
+      }
+    }
+  }
+
+  LLVMOrcLLJITRef jit = nullptr;
+  exitOnJitError(LLVMOrcCreateLLJIT(&jit, nullptr), "Couldn't create JIT");
+  auto mainDylib = LLVMOrcLLJITGetMainJITDylib(jit);
+  defineHostSymbols(jit, mainDylib);
+  // Everything else (libc and friends) comes from the backend's own process.
+  LLVMOrcDefinitionGeneratorRef processSymbols = nullptr;
+  exitOnJitError(
+      LLVMOrcCreateDynamicLibrarySearchGeneratorForProcess(
+          &processSymbols, LLVMOrcLLJITGetGlobalPrefix(jit), nullptr, nullptr),
+      "Couldn't make JIT search the process for symbols");
+  LLVMOrcJITDylibAddGenerator(mainDylib, processSymbols);
+
+  auto addModule = [globalState, jit, mainDylib](LLVMModuleRef mod) {
+    demoteThreadLocals(mod);
+    LLVMSetTarget(mod, LLVMOrcLLJITGetTripleString(jit));
+    LLVMSetDataLayout(mod, LLVMOrcLLJITGetDataLayoutStr(jit));
+    auto threadSafeModule = LLVMOrcCreateNewThreadSafeModule(mod, globalState->threadSafeContext);
+    exitOnJitError(LLVMOrcLLJITAddLLVMIRModule(jit, mainDylib, threadSafeModule), "Couldn't add module to JIT");
+  };
+  addModule(globalState->mod);
+  globalState->mod = nullptr;
+  for (auto& path : inputPaths) {
+    auto irPath = endsWith(path, ".c") ? compileToBitcode(opt, path) : path;
+    addModule(loadModule(globalState->context, irPath));
+  }
+
+  // Code generation happens here, when something first asks for main.
+  LLVMOrcJITTargetAddress entryAddress = 0;
+  exitOnJitError(LLVMOrcLLJITLookup(jit, &entryAddress, "main"), "Couldn't find main in JIT");
+  auto entry = (int64_t (*)(int64_t, char**))(uintptr_t)entryAddress;
+
+  std::vector<std::string> args = { "main" };
+  args.insert(args.end(), opt->jitArgs.begin(), opt->jitArgs.end());
+  std::vector<char*> argv;
+  for (auto& arg : args) {
+    argv.push_back(const_cast<char*>(arg.c_str()));
+  }
+  argv.push_back(nullptr);
+
+  JitRun run;
+  currentJitRun = &run;
+  volatile int64_t result = 0;
+  if (setjmp(run.exitJump) == 0) {
+    result = entry(args.size(), argv.data());
+  } else {
+    result = run.exitCode;
+  }
+  finishJitRun(&run);
+  currentJitRun = nullptr;
+  std::cout.flush();
+
+  exitOnJitError(LLVMOrcDisposeLLJIT(jit), "Couldn't dispose JIT");
+  return (int)result;
+}
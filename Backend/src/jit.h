@@ -0,0 +1,22 @@
+#ifndef JIT_H_
+#define JIT_H_
+
+#include <string>
+#include <vector>
+
+class GlobalState;
+
+// For --jit. Instead of writing build.o for clang to link, we hand the finished module to ORC's
+// LLJIT along with the program's C inputs (the builtins, packages' native code, and whatever the
+// backend generated under abi/), and call its main right here in the backend's process.
+//
+// The C inputs are compiled to bitcode with clang (or $VALE_JIT_CC) once, and cached by a hash
+// of their contents in --jit_cache_dir, $VALE_JIT_CACHE_DIR, or ~/.cache/vale/jit. That clang
+// should be the same LLVM version as the backend, so we can read its bitcode.
+//
+// Takes ownership of globalState->mod, and returns the program's exit code. If the program
+// calls exit() we catch it and return that code instead, so this can be called again for the
+// next program, see --jit_batch.
+int runJit(GlobalState* globalState, const std::vector<std::string>& nativeInputPaths);
+
+#endif
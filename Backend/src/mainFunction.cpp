@@ -1,6 +1,7 @@
 #include "function/function.h"
 #include "function/expressions/expressions.h"
 #include "globalstate.h"
+#include "region/common/allocprofile.h"
 
 std::tuple<LLVMValueRef, LLVMBuilderRef> makeStringSetupFunction(GlobalState* globalState) {
   auto voidLT = LLVMVoidTypeInContext(globalState->context);
@@ -43,7 +44,12 @@ Prototype* makeValeMainFunction(
         buildFlare(FL(), globalState, functionState, entryBuilder);
 
         LLVMBuildCall(entryBuilder, stringSetupFunctionL, nullptr, 0, "");
-        LLVMBuildCall(entryBuilder, globalState->lookupFunction(mainSetupFuncProto), nullptr, 0, "");
+        auto mainSetupCallLE =
+            LLVMBuildCall(entryBuilder, globalState->lookupFunction(mainSetupFuncProto), nullptr, 0, "");
+        LLVMSetInstructionCallConv(mainSetupCallLE, VALE_CALL_CONV);
+        if (globalState->opt->allocProfile) {
+          buildAllocProfileInit(globalState, entryBuilder);
+        }
 //
 //        LLVMBuildStore(
 //            entryBuilder,
@@ -86,6 +92,10 @@ Prototype* makeValeMainFunction(
         buildCall(globalState, functionState, entryBuilder, mainCleanupFunctionPrototype, {});
         buildFlare(FL(), globalState, functionState, entryBuilder);
 
+        if (globalState->opt->allocProfile) {
+          buildAllocProfileDump(globalState, entryBuilder);
+        }
+
         if (globalState->opt->printMemOverhead) {
           buildFlare(FL(), globalState, functionState, entryBuilder);
           buildPrint(globalState, entryBuilder, "\nLiveness checks: ");
@@ -96,6 +106,9 @@ Prototype* makeValeMainFunction(
         }
         buildFlare(FL(), globalState, functionState, entryBuilder);
 
+        // Anything main printed might still be sitting in the stdout buffer, see stdio.c.
+        LLVMBuildCall(entryBuilder, globalState->externs->flushStdout, nullptr, 0, "");
+
         if (globalState->opt->census) {
           buildFlare(FL(), globalState, functionState, entryBuilder);
           // Remove all the things from the census that we added at the start of the program.
@@ -173,6 +186,7 @@ LLVMValueRef makeEntryFunction(
   LLVMBuildStore(entryBuilder, argsLE, globalState->mainArgs);
 
   auto mainResultLE = LLVMBuildCall(entryBuilder, globalState->lookupFunction(valeMainPrototype), nullptr, 0, "");
+  LLVMSetInstructionCallConv(mainResultLE, VALE_CALL_CONV);
 
   LLVMBuildRet(entryBuilder, mainResultLE);
   LLVMDisposeBuilder(entryBuilder);
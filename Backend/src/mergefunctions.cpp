@@ -0,0 +1,113 @@
+#include <llvm-c/Core.h>
+#include <llvm-c/TargetMachine.h>
+#include <llvm-c/Transforms/IPO.h>
+
+#include <iostream>
+
+#include "mergefunctions.h"
+#include "globalstate.h"
+
+namespace {
+
+struct ModuleSize {
+  int definedFunctions = 0;
+  int64_t instructions = 0;
+};
+
+ModuleSize measureModule(LLVMModuleRef mod) {
+  ModuleSize size;
+  for (auto functionL = LLVMGetFirstFunction(mod);
+      functionL != nullptr;
+      functionL = LLVMGetNextFunction(functionL)) {
+    if (LLVMCountBasicBlocks(functionL) == 0) {
+      continue;
+    }
+    size.definedFunctions++;
+    for (auto blockL = LLVMGetFirstBasicBlock(functionL);
+        blockL != nullptr;
+        blockL = LLVMGetNextBasicBlock(blockL)) {
+      for (auto instructionL = LLVMGetFirstInstruction(blockL);
+          instructionL != nullptr;
+          instructionL = LLVMGetNextInstruction(instructionL)) {
+        size.instructions++;
+      }
+    }
+  }
+  return size;
+}
+
+// How big the object file for this module would be. Returns -1 if it can't be generated.
+int64_t measureObjectBytes(LLVMTargetMachineRef machine, LLVMModuleRef mod) {
+  char* error = nullptr;
+  LLVMMemoryBufferRef buffer = nullptr;
+  if (LLVMTargetMachineEmitToMemoryBuffer(machine, mod, LLVMObjectFile, &error, &buffer) != 0) {
+    LLVMDisposeMessage(error);
+    return -1;
+  }
+  int64_t bytes = LLVMGetBufferSize(buffer);
+  LLVMDisposeMemoryBuffer(buffer);
+  return bytes;
+}
+
+void makeMergeable(LLVMValueRef functionL) {
+  if (LLVMCountBasicBlocks(functionL) == 0) {
+    return;
+  }
+  LLVMSetLinkage(functionL, LLVMInternalLinkage);
+  LLVMSetUnnamedAddress(functionL, LLVMGlobalUnnamedAddr);
+}
+
+}
+
+void mergeIdenticalFunctions(GlobalState* globalState) {
+  for (auto[name, functionL] : globalState->functions) {
+    makeMergeable(functionL);
+  }
+  for (auto[prototype, functionL] : globalState->extraFunctions) {
+    makeMergeable(functionL);
+  }
+
+  bool printStats = globalState->opt->printStats && globalState->machine != nullptr;
+  ModuleSize sizeBefore;
+  int64_t objectBytesBefore = -1;
+  if (printStats) {
+    sizeBefore = measureModule(globalState->mod);
+    // Codegen can change the module, so measure a copy.
+    auto copy = LLVMCloneModule(globalState->mod);
+    objectBytesBefore = measureObjectBytes(globalState->machine, copy);
+    LLVMDisposeModule(copy);
+  }
+
+  LLVMPassManagerRef passmgr = LLVMCreatePassManager();
+  LLVMAddMergeFunctionsPass(passmgr);
+  LLVMRunPassManager(passmgr, globalState->mod);
+  LLVMDisposePassManager(passmgr);
+
+  // The functions we merged away are gone now, so nobody should look these up anymore. That
+  // includes the ones declareFunction and declareExtraFunction cached on the prototypes, so that
+  // lookupFunction trips its assert instead of handing back an erased function.
+  for (auto[packageCoord, package] : globalState->program->packages) {
+    for (auto[name, function] : package->functions) {
+      function->prototype->functionL = nullptr;
+    }
+  }
+  for (auto[prototype, functionL] : globalState->extraFunctions) {
+    prototype->functionL = nullptr;
+  }
+  globalState->functions.clear();
+  globalState->extraFunctions.clear();
+
+  if (printStats) {
+    auto sizeAfter = measureModule(globalState->mod);
+    auto copy = LLVMCloneModule(globalState->mod);
+    auto objectBytesAfter = measureObjectBytes(globalState->machine, copy);
+    LLVMDisposeModule(copy);
+    std::cout << "Merged " << (sizeBefore.definedFunctions - sizeAfter.definedFunctions)
+        << " identical functions, " << (sizeBefore.instructions - sizeAfter.instructions)
+        << " instructions";
+    if (objectBytesBefore >= 0 && objectBytesAfter >= 0) {
+      std::cout << ", " << (objectBytesBefore - objectBytesAfter) << " bytes of object code";
+    }
+    std::cout << "." << std::endl;
+  }
+}
@@ -0,0 +1,20 @@
+#ifndef MERGEFUNCTIONS_H_
+#define MERGEFUNCTIONS_H_
+
+class GlobalState;
+
+// The frontend monomorphizes generics, so we get a separate function for every instantiation of
+// e.g. List<T>.add. Once lowered, a lot of them are identical except for which struct type their
+// pointers point to, so this runs LLVM's MergeFunctions over the module to fold those into one.
+//
+// Vale functions and the regions' extra functions are only called from inside the module (the
+// outside world goes through the vale_abi_ thunks and main), and nothing compares their
+// addresses, so first we make them internal and unnamed_addr. That lets MergeFunctions point all
+// their users (itables included) at the survivor and delete the duplicate, rather than leaving a
+// thunk behind.
+//
+// With --stats, prints how many functions merged, and how many bytes smaller build.o got, which
+// costs generating the object twice.
+void mergeIdenticalFunctions(GlobalState* globalState);
+
+#endif
@@ -28,6 +28,14 @@ extern const std::string BUILTIN_PROJECT_NAME;
 class Block;
 class Expression;
 
+// Where something is in the source, from the frontend's RangeS. The offsets count characters
+// from the start of the file.
+struct SourceRange {
+  std::string filepath;
+  int begin;
+  int end;
+};
+
 // Defined in this file
 class Program;
 class StructDefinition;
@@ -436,14 +444,19 @@ class Function {
 public:
     Prototype* prototype;
     Expression* block;
+    // Where the function (or lambda) is in the source, for --debug_info. Empty for functions the
+    // compiler made up.
+    std::optional<SourceRange> range;
 
     Function(
 
         Prototype* prototype_,
-    Expression* block_
+    Expression* block_,
+    std::optional<SourceRange> range_
         ) :
         prototype(prototype_),
-        block(block_) {}
+        block(block_),
+        range(range_) {}
 };
 
 // Interned
@@ -452,6 +465,8 @@ public:
     Name* name;
     std::vector<Reference*> params;
     Reference* returnType;
+    // The function we declared for this, so GlobalState::lookupFunction is just a load.
+    LLVMValueRef functionL = nullptr;
 
     Prototype(
         Name* name_,
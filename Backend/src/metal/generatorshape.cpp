@@ -0,0 +1,270 @@
+#include <unordered_map>
+#include "generatorshape.h"
+
+namespace {
+
+// How deep we'll follow calls, e.g. from the lambda's __call into + and then into __vbi_addI32.
+constexpr int MAX_CALL_DEPTH = 8;
+
+struct SymbolicValue {
+  enum class Kind {
+    UNKNOWN,
+    VOID,
+    INT,
+    BOOL,
+    FLOAT,
+    // The generator itself, its first argument.
+    CLOSURE,
+    // A captured immutable array, loaded from the closure by load.
+    CAPTURED_ARRAY,
+    // The captured array's element at exactly the index.
+    ELEMENT_OF_CAPTURED
+  };
+
+  Kind kind = Kind::UNKNOWN;
+  // For INT, the value is scale * i + offset, wrapping at bits.
+  int bits = 0;
+  uint64_t scale = 0;
+  uint64_t offset = 0;
+  bool boolValue = false;
+  double floatValue = 0;
+  MemberLoad* load = nullptr;
+  RuntimeSizedArrayLoad* elementLoad = nullptr;
+
+  static SymbolicValue unknown() { return SymbolicValue(); }
+  static SymbolicValue ofKind(Kind kind) {
+    SymbolicValue result;
+    result.kind = kind;
+    return result;
+  }
+  static SymbolicValue affine(int bits, uint64_t scale, uint64_t offset) {
+    SymbolicValue result;
+    result.kind = Kind::INT;
+    result.bits = bits;
+    result.scale = mask(bits, scale);
+    result.offset = mask(bits, offset);
+    return result;
+  }
+  static uint64_t mask(int bits, uint64_t value) {
+    return bits >= 64 ? value : value & ((1ULL << bits) - 1);
+  }
+
+  bool isKnown() const { return kind != Kind::UNKNOWN; }
+  bool isConstantInt() const { return kind == Kind::INT && scale == 0; }
+};
+
+struct Frame {
+  std::vector<SymbolicValue> args;
+  std::unordered_map<Local*, SymbolicValue> locals;
+  // Set once we hit a Return.
+  bool returned = false;
+  SymbolicValue result;
+};
+
+class GeneratorEvaluator {
+public:
+  GeneratorEvaluator(Program* program_) : program(program_) {}
+
+  SymbolicValue callFunction(Prototype* prototype, const std::vector<SymbolicValue>& args, int depth) {
+    auto builtinResult = evaluateBuiltin(prototype->name->name, args);
+    if (builtinResult.isKnown() || depth >= MAX_CALL_DEPTH) {
+      return builtinResult;
+    }
+    auto maybeFunction = program->getMaybeFunction(prototype->name);
+    if (!maybeFunction.has_value() || (*maybeFunction)->block == nullptr) {
+      return SymbolicValue::unknown();
+    }
+    Frame frame;
+    frame.args = args;
+    auto blockResult = evaluate(&frame, (*maybeFunction)->block, depth);
+    if (frame.returned) {
+      return frame.result;
+    }
+    return blockResult;
+  }
+
+private:
+  Program* program;
+
+  SymbolicValue evaluateBuiltin(const std::string& name, const std::vector<SymbolicValue>& args) {
+    if (args.size() == 2 && args[0].kind == SymbolicValue::Kind::INT &&
+        args[1].kind == SymbolicValue::Kind::INT && args[0].bits == args[1].bits) {
+      auto& left = args[0];
+      auto& right = args[1];
+      int bits = left.bits;
+      if (name == "__vbi_addI32" || name == "__vbi_addI64") {
+        return SymbolicValue::affine(bits, left.scale + right.scale, left.offset + right.offset);
+      } else if (name == "__vbi_subtractI32" || name == "__vbi_subtractI64") {
+        return SymbolicValue::affine(bits, left.scale - right.scale, left.offset - right.offset);
+      } else if (name == "__vbi_multiplyI32" || name == "__vbi_multiplyI64") {
+        // Still affine as long as one side doesn't depend on i.
+        if (left.scale == 0) {
+          return SymbolicValue::affine(bits, left.offset * right.scale, left.offset * right.offset);
+        } else if (right.scale == 0) {
+          return SymbolicValue::affine(bits, left.scale * right.offset, left.offset * right.offset);
+        }
+      }
+    } else if (args.size() == 1 && args[0].kind == SymbolicValue::Kind::INT) {
+      if (name == "__vbi_negateI32" || name == "__vbi_negateI64") {
+        return SymbolicValue::affine(args[0].bits, 0 - args[0].scale, 0 - args[0].offset);
+      }
+    }
+    return SymbolicValue::unknown();
+  }
+
+  bool evaluateArgs(Frame* frame, const std::vector<Expression*>& argExprs, int depth, std::vector<SymbolicValue>* result) {
+    for (auto argExpr : argExprs) {
+      auto arg = evaluate(frame, argExpr, depth);
+      if (!arg.isKnown() || frame->returned) {
+        return false;
+      }
+      result->push_back(arg);
+    }
+    return true;
+  }
+
+  SymbolicValue evaluate(Frame* frame, Expression* expr, int depth) {
+    if (frame->returned) {
+      // Whatever's after a return never runs.
+      return SymbolicValue::ofKind(SymbolicValue::Kind::VOID);
+    } else if (dynamic_cast<ConstantVoid*>(expr)) {
+      return SymbolicValue::ofKind(SymbolicValue::Kind::VOID);
+    } else if (auto constantInt = dynamic_cast<ConstantInt*>(expr)) {
+      return SymbolicValue::affine(constantInt->bits, 0, (uint64_t)constantInt->value);
+    } else if (auto constantBool = dynamic_cast<ConstantBool*>(expr)) {
+      auto result = SymbolicValue::ofKind(SymbolicValue::Kind::BOOL);
+      result.boolValue = constantBool->value;
+      return result;
+    } else if (auto constantF64 = dynamic_cast<ConstantF64*>(expr)) {
+      auto result = SymbolicValue::ofKind(SymbolicValue::Kind::FLOAT);
+      result.floatValue = constantF64->value;
+      return result;
+    } else if (auto argument = dynamic_cast<Argument*>(expr)) {
+      if (argument->argumentIndex < 0 || argument->argumentIndex >= frame->args.size()) {
+        return SymbolicValue::unknown();
+      }
+      return frame->args[argument->argumentIndex];
+    } else if (auto block = dynamic_cast<Block*>(expr)) {
+      return evaluate(frame, block->inner, depth);
+    } else if (auto consecutor = dynamic_cast<Consecutor*>(expr)) {
+      auto result = SymbolicValue::ofKind(SymbolicValue::Kind::VOID);
+      for (auto inner : consecutor->exprs) {
+        result = evaluate(frame, inner, depth);
+        if (!result.isKnown() || frame->returned) {
+          return result;
+        }
+      }
+      return result;
+    } else if (auto ret = dynamic_cast<Return*>(expr)) {
+      auto result = evaluate(frame, ret->sourceExpr, depth);
+      if (!result.isKnown()) {
+        return result;
+      }
+      frame->returned = true;
+      frame->result = result;
+      return SymbolicValue::ofKind(SymbolicValue::Kind::VOID);
+    } else if (auto stackify = dynamic_cast<Stackify*>(expr)) {
+      auto source = evaluate(frame, stackify->sourceExpr, depth);
+      if (!source.isKnown()) {
+        return source;
+      }
+      frame->locals[stackify->local] = source;
+      return SymbolicValue::ofKind(SymbolicValue::Kind::VOID);
+    } else if (auto localLoad = dynamic_cast<LocalLoad*>(expr)) {
+      auto iter = frame->locals.find(localLoad->local);
+      return iter == frame->locals.end() ? SymbolicValue::unknown() : iter->second;
+    } else if (auto unstackify = dynamic_cast<Unstackify*>(expr)) {
+      auto iter = frame->locals.find(unstackify->local);
+      return iter == frame->locals.end() ? SymbolicValue::unknown() : iter->second;
+    } else if (auto discard = dynamic_cast<Discard*>(expr)) {
+      auto source = evaluate(frame, discard->sourceExpr, depth);
+      if (!source.isKnown()) {
+        return source;
+      }
+      return SymbolicValue::ofKind(SymbolicValue::Kind::VOID);
+    } else if (auto call = dynamic_cast<Call*>(expr)) {
+      std::vector<SymbolicValue> args;
+      if (!evaluateArgs(frame, call->argExprs, depth, &args)) {
+        return SymbolicValue::unknown();
+      }
+      return callFunction(call->function, args, depth + 1);
+    } else if (auto externCall = dynamic_cast<ExternCall*>(expr)) {
+      std::vector<SymbolicValue> args;
+      if (!evaluateArgs(frame, externCall->argExprs, depth, &args)) {
+        return SymbolicValue::unknown();
+      }
+      return evaluateBuiltin(externCall->function->name->name, args);
+    } else if (auto memberLoad = dynamic_cast<MemberLoad*>(expr)) {
+      auto structValue = evaluate(frame, memberLoad->structExpr, depth);
+      auto memberType = memberLoad->expectedResultType;
+      if (structValue.kind == SymbolicValue::Kind::CLOSURE &&
+          memberType->ownership == Ownership::SHARE &&
+          dynamic_cast<RuntimeSizedArrayT*>(memberType->kind)) {
+        auto result = SymbolicValue::ofKind(SymbolicValue::Kind::CAPTURED_ARRAY);
+        result.load = memberLoad;
+        return result;
+      }
+      return SymbolicValue::unknown();
+    } else if (auto rsaLoad = dynamic_cast<RuntimeSizedArrayLoad*>(expr)) {
+      auto arrayValue = evaluate(frame, rsaLoad->arrayExpr, depth);
+      auto indexValue = evaluate(frame, rsaLoad->indexExpr, depth);
+      // Only exactly the index, so we can copy the front of the array.
+      if (arrayValue.kind == SymbolicValue::Kind::CAPTURED_ARRAY &&
+          arrayValue.load->expectedResultType == rsaLoad->arrayType &&
+          indexValue.kind == SymbolicValue::Kind::INT && indexValue.bits == 32 &&
+          indexValue.scale == 1 && indexValue.offset == 0 &&
+          rsaLoad->resultType->ownership == Ownership::SHARE &&
+          rsaLoad->resultType->location == Location::INLINE) {
+        auto result = SymbolicValue::ofKind(SymbolicValue::Kind::ELEMENT_OF_CAPTURED);
+        result.load = arrayValue.load;
+        result.elementLoad = rsaLoad;
+        return result;
+      }
+      return SymbolicValue::unknown();
+    } else {
+      return SymbolicValue::unknown();
+    }
+  }
+};
+
+} // namespace
+
+GeneratorShape analyzeGeneratorShape(Program* program, Prototype* generatorMethod) {
+  GeneratorShape shape;
+  if (generatorMethod->params.size() != 2) {
+    return shape;
+  }
+  auto indexKind = dynamic_cast<Int*>(generatorMethod->params[1]->kind);
+  if (!indexKind || indexKind->bits != 32) {
+    return shape;
+  }
+
+  std::vector<SymbolicValue> args = {
+      SymbolicValue::ofKind(SymbolicValue::Kind::CLOSURE),
+      SymbolicValue::affine(32, 1, 0)
+  };
+  auto result = GeneratorEvaluator(program).callFunction(generatorMethod, args, 0);
+  switch (result.kind) {
+    case SymbolicValue::Kind::INT:
+      shape.kind = GeneratorShape::Kind::AFFINE_INT;
+      shape.bits = result.bits;
+      shape.scale = result.scale;
+      shape.offset = result.offset;
+      break;
+    case SymbolicValue::Kind::BOOL:
+      shape.kind = GeneratorShape::Kind::CONSTANT_BOOL;
+      shape.boolValue = result.boolValue;
+      break;
+    case SymbolicValue::Kind::FLOAT:
+      shape.kind = GeneratorShape::Kind::CONSTANT_FLOAT;
+      shape.floatValue = result.floatValue;
+      break;
+    case SymbolicValue::Kind::ELEMENT_OF_CAPTURED:
+      shape.kind = GeneratorShape::Kind::COPY_FROM_MEMBER;
+      shape.sourceArrayLoad = result.load;
+      break;
+    default:
+      break;
+  }
+  return shape;
+}
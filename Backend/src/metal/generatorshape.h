@@ -0,0 +1,38 @@
+#ifndef METAL_GENERATORSHAPE_H_
+#define METAL_GENERATORSHAPE_H_
+
+#include "ast.h"
+#include "instructions.h"
+
+// What an array generator's __call returns for index i, when we can tell that without running
+// it. fillRuntimeSizedArray and fillStaticSizedArrayFromCallable use this to fill the array with
+// a memset, memcpy, or vector stores instead of calling the generator once per element.
+struct GeneratorShape {
+  enum class Kind {
+    // Anything else, including anything with side effects. We just call it per element.
+    OPAQUE,
+    // scale * i + offset, wrapping at the result's width. A constant has a scale of 0.
+    AFFINE_INT,
+    CONSTANT_BOOL,
+    CONSTANT_FLOAT,
+    // capturedArray[i], where capturedArray is an immutable runtime-sized array the generator
+    // captured. sourceArrayLoad is the MemberLoad that gets it out of the closure.
+    COPY_FROM_MEMBER
+  };
+
+  Kind kind = Kind::OPAQUE;
+  int bits = 0;
+  uint64_t scale = 0;
+  uint64_t offset = 0;
+  bool boolValue = false;
+  double floatValue = 0;
+  MemberLoad* sourceArrayLoad = nullptr;
+};
+
+// Symbolically runs generatorMethod's body, with its first argument being the closure and its
+// second being the index. Only understands constants, locals, the integer add, subtract,
+// multiply and negate builtins, calls to functions made of those, and loading from a captured
+// array at exactly the index; anything else makes the generator OPAQUE.
+GeneratorShape analyzeGeneratorShape(Program* program, Prototype* generatorMethod);
+
+#endif
@@ -18,6 +18,10 @@ enum class RefCountCategory {
 
 class Expression {
 public:
+    // Where this is in the source, for --debug_info. Only some expressions know, see
+    // LocalLoad and MemberLoad.
+    std::optional<SourceRange> range;
+
     virtual ~Expression() {}
 
 //    virtual Reference* getResultType() const = 0;
@@ -188,10 +192,13 @@ public:
   LocalLoad(
       Local* local,
       Ownership targetOwnership,
-      std::string localName) :
+      std::string localName,
+      std::optional<SourceRange> range_) :
       local(local),
     targetOwnership(targetOwnership),
-        localName(localName) {}
+        localName(localName) {
+    range = range_;
+  }
 };
 
 
@@ -296,7 +303,8 @@ public:
       Ownership targetOwnership_,
       Reference* expectedMemberType_,
       Reference* expectedResultType_,
-      std::string memberName_) :
+      std::string memberName_,
+      std::optional<SourceRange> range_) :
     structExpr(structExpr_),
     structId(structId_),
     structType(structType_),
@@ -305,7 +313,9 @@ public:
     targetOwnership(targetOwnership_),
     expectedMemberType(expectedMemberType_),
     expectedResultType(expectedResultType_),
-    memberName(memberName_) {}
+    memberName(memberName_) {
+    range = range_;
+  }
 };
 
 
@@ -793,6 +803,29 @@ public:
       newcomerKnownLive(newcomerKnownLive_){}
 };
 
+// Moves all of the source array's elements onto the end of the target array and destroys the
+// source, see migrate.vale.
+class MigrateRuntimeSizedArray : public Expression {
+public:
+  Expression* sourceArrayExpr;
+  Reference* sourceArrayType;
+  Expression* targetArrayExpr;
+  Reference* targetArrayType;
+  RuntimeSizedArrayT* arrayKind;
+
+  MigrateRuntimeSizedArray(
+      Expression* sourceArrayExpr_,
+      Reference* sourceArrayType_,
+      Expression* targetArrayExpr_,
+      Reference* targetArrayType_,
+      RuntimeSizedArrayT* arrayKind_) :
+      sourceArrayExpr(sourceArrayExpr_),
+      sourceArrayType(sourceArrayType_),
+      targetArrayExpr(targetArrayExpr_),
+      targetArrayType(targetArrayType_),
+      arrayKind(arrayKind_) {}
+};
+
 class PopRuntimeSizedArray : public Expression {
 public:
   Expression* arrayExpr;
@@ -0,0 +1,136 @@
+#ifndef METAL_INTERNTABLE_H_
+#define METAL_INTERNTABLE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Hashes the keys MetalCache interns by: pointers, ints, enums, strings, vectors of those, and
+// tuples of all of the above. Pointers hash by address. That's fine here (unlike for maps we
+// iterate, see AddressHasher) because nothing ever iterates an intern table, so their order
+// can't leak into the output.
+struct InternKeyHasher {
+  template<typename T>
+  size_t operator()(const T& key) const {
+    return hashOne(key);
+  }
+
+private:
+  static size_t combine(size_t hash, size_t next) {
+    return hash ^ (next + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2));
+  }
+
+  template<typename T>
+  static size_t hashOne(T* ptr) {
+    return (size_t)(uintptr_t)ptr;
+  }
+  template<typename T, typename std::enable_if<std::is_integral<T>::value || std::is_enum<T>::value, int>::type = 0>
+  static size_t hashOne(T value) {
+    return (size_t)value;
+  }
+  static size_t hashOne(const std::string& str) {
+    return std::hash<std::string>()(str);
+  }
+  template<typename T>
+  static size_t hashOne(const std::vector<T>& elements) {
+    size_t hash = elements.size();
+    for (auto& element : elements) {
+      hash = combine(hash, hashOne(element));
+    }
+    return hash;
+  }
+  template<typename... T>
+  static size_t hashOne(const std::tuple<T...>& parts) {
+    size_t hash = 0;
+    std::apply([&](const auto&... part) { ((hash = combine(hash, hashOne(part))), ...); }, parts);
+    return hash;
+  }
+};
+
+// An open-addressing hash table for interning. We only ever look up and insert, never remove or
+// iterate, so it's just one flat array of slots, probed linearly from the key's hash. That's one
+// cache miss for most lookups, instead of unordered_map's bucket and then node.
+template<typename K, typename V, typename H = InternKeyHasher, typename E = std::equal_to<K>>
+class InternTable {
+public:
+  // Returns the value for key, calling makeValue to make it if it's not there yet.
+  template<typename F>
+  V& findOrInsert(K key, F&& makeValue) {
+    auto hash = hasher(key);
+    if (!slots.empty()) {
+      auto index = findSlot(key, hash);
+      if (slots[index].occupied) {
+        return slots[index].value;
+      }
+    }
+    // makeValue might intern other things in this table, so only find a slot for it afterward.
+    V value = makeValue();
+    if ((numOccupied + 1) * 4 > slots.size() * 3) {
+      grow();
+    }
+    auto index = findSlot(key, hash);
+    auto& slot = slots[index];
+    slot.occupied = true;
+    slot.hash = hash;
+    slot.key = std::move(key);
+    slot.value = std::move(value);
+    numOccupied++;
+    return slot.value;
+  }
+
+  size_t size() const { return numOccupied; }
+
+private:
+  struct Slot {
+    bool occupied = false;
+    size_t hash = 0;
+    K key;
+    V value;
+  };
+
+  // Spreads the hash's bits out before we mask it, since pointers' low bits are always zero.
+  size_t startIndex(size_t hash) const {
+    return (size_t)(((uint64_t)hash * 0x9e3779b97f4a7c15ull) >> (64 - log2Capacity));
+  }
+
+  // Returns the slot with this key, or the empty slot where it would go.
+  size_t findSlot(const K& key, size_t hash) const {
+    size_t mask = slots.size() - 1;
+    for (size_t index = startIndex(hash); ; index = (index + 1) & mask) {
+      auto& slot = slots[index];
+      if (!slot.occupied || (slot.hash == hash && equator(slot.key, key))) {
+        return index;
+      }
+    }
+  }
+
+  void grow() {
+    std::vector<Slot> oldSlots;
+    oldSlots.swap(slots);
+    log2Capacity = oldSlots.empty() ? 4 : log2Capacity + 1;
+    slots.resize((size_t)1 << log2Capacity);
+    size_t mask = slots.size() - 1;
+    for (auto& oldSlot : oldSlots) {
+      if (oldSlot.occupied) {
+        auto index = startIndex(oldSlot.hash);
+        while (slots[index].occupied) {
+          index = (index + 1) & mask;
+        }
+        slots[index] = std::move(oldSlot);
+      }
+    }
+  }
+
+  std::vector<Slot> slots;
+  int log2Capacity = 0;
+  size_t numOccupied = 0;
+  H hasher;
+  E equator;
+};
+
+#endif
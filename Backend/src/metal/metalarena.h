@@ -0,0 +1,79 @@
+#ifndef METAL_METALARENA_H_
+#define METAL_METALARENA_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <utility>
+#include <vector>
+
+// Where MetalCache puts everything it interns, and everything readjson makes for the AST. We
+// never free any of those individually, they all live as long as the MetalCache, so we just bump
+// a pointer through big pages. That keeps a function's nodes next to each other in memory,
+// and skips malloc's per-object header and bookkeeping.
+//
+// Destructors don't run, the pages are just freed when the arena goes away. Any memory the
+// objects own themselves (like a Block's vector of expressions) is left behind, same as before
+// we had the arena.
+class MetalArena {
+public:
+  MetalArena() = default;
+  MetalArena(const MetalArena&) = delete;
+  MetalArena& operator=(const MetalArena&) = delete;
+
+  ~MetalArena() {
+    for (auto page : pages) {
+      std::free(page);
+    }
+  }
+
+  template<typename T, typename... Args>
+  T* make(Args&&... args) {
+    return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+  }
+
+  void* allocate(size_t size, size_t alignment) {
+    bytesAllocated += size;
+    if (size > BIG_OBJECT_BYTES) {
+      // Gets a page to itself, so we don't waste the rest of the current one.
+      return newPage(size);
+    }
+    auto aligned = alignUp(bump, alignment);
+    if (bump == 0 || aligned + size > bumpEnd) {
+      bump = (uintptr_t)newPage(PAGE_BYTES);
+      bumpEnd = bump + PAGE_BYTES;
+      aligned = alignUp(bump, alignment);
+    }
+    bump = aligned + size;
+    return (void*)aligned;
+  }
+
+  size_t getBytesAllocated() const { return bytesAllocated; }
+  size_t getNumPages() const { return pages.size(); }
+
+private:
+  static constexpr size_t PAGE_BYTES = 256 * 1024;
+  static constexpr size_t BIG_OBJECT_BYTES = PAGE_BYTES / 8;
+
+  static uintptr_t alignUp(uintptr_t address, size_t alignment) {
+    return (address + (alignment - 1)) & ~(uintptr_t)(alignment - 1);
+  }
+
+  // malloc's alignment is enough for anything in the AST.
+  void* newPage(size_t bytes) {
+    auto page = (char*)std::malloc(bytes);
+    if (page == nullptr) {
+      throw std::bad_alloc();
+    }
+    pages.push_back(page);
+    return page;
+  }
+
+  std::vector<char*> pages;
+  uintptr_t bump = 0;
+  uintptr_t bumpEnd = 0;
+  size_t bytesAllocated = 0;
+};
+
+#endif
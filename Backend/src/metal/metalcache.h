@@ -3,6 +3,8 @@
 
 #include <unordered_map>
 
+#include "interntable.h"
+#include "metalarena.h"
 #include "types.h"
 #include "ast.h"
 #include "instructions.h"
@@ -28,66 +30,16 @@ namespace std {
     };
 }
 
-template<typename K, typename V, typename H, typename E, typename F>
-V& makeIfNotPresent(std::unordered_map<K, V, H, E>* map, const K& key, F&& makeElement) {
-  auto iter = map->find(key);
-  if (iter == map->end()) {
-    auto p = map->emplace(key, makeElement());
-    iter = p.first;
-  }
-  return iter->second;
-}
-
-struct HashRefVec {
-  AddressHasher<Reference*> hasher;
-  HashRefVec(AddressHasher<Reference*> hasher_) : hasher(hasher_) {}
-
-  size_t operator()(const std::vector<Reference *> &refs) const {
-    size_t result = 1337;
-    for (auto el : refs) {
-      result += (size_t) el;
-    }
-    return result;
-  }
-};
-struct RefVecEquals {
-  bool operator()(
-      const std::vector<Reference *> &a,
-      const std::vector<Reference *> &b) const {
-    if (a.size() != b.size())
-      return false;
-    for (size_t i = 0; i < a.size(); i++) {
-      if (a[i] != b[i])
-        return false;
-    }
-    return true;
-  }
-};
-
 class MetalCache {
 public:
   explicit MetalCache(AddressNumberer* addressNumberer_) :
-      addressNumberer(addressNumberer_),
-      structKinds(0, addressNumberer->makeHasher<Name*>()),
-      interfaceKinds(0, addressNumberer->makeHasher<Name*>()),
-      names(0, addressNumberer->makeHasher<PackageCoordinate*>()),
-      ints(0, addressNumberer->makeHasher<RegionId*>()),
-      bools(0, addressNumberer->makeHasher<RegionId*>()),
-      strs(0, addressNumberer->makeHasher<RegionId*>()),
-      floats(0, addressNumberer->makeHasher<RegionId*>()),
-      nevers(0, addressNumberer->makeHasher<RegionId*>()),
-      voids(0, addressNumberer->makeHasher<RegionId*>()),
-      runtimeSizedArrays(0, addressNumberer->makeHasher<Name*>()),
-      staticSizedArrays(0, addressNumberer->makeHasher<Name*>()),
-      unconvertedReferences(0, addressNumberer->makeHasher<Kind*>()),
-      prototypes(0, addressNumberer->makeHasher<Name*>()),
-      interfaceMethods(0, addressNumberer->makeHasher<Prototype*>()),
-      locals(0, addressNumberer->makeHasher<VariableId*>()) {
+      addressNumberer(addressNumberer_) {
 
     builtinPackageCoord = getPackageCoordinate(BUILTIN_PROJECT_NAME, {});
     rcImmRegionId = getRegionId(builtinPackageCoord, "rcimm");
     linearRegionId = getRegionId(builtinPackageCoord, "linear");
     unsafeRegionId = getRegionId(builtinPackageCoord, "unsafe");
+    arenaRegionId = getRegionId(builtinPackageCoord, "arena");
     assistRegionId = getRegionId(builtinPackageCoord, "assist");
     naiveRcRegionId = getRegionId(builtinPackageCoord, "naiverc");
     resilientV3RegionId = getRegionId(builtinPackageCoord, "resilientv3");
@@ -110,172 +62,151 @@ public:
 //    regionKind = getStructKind(getName("__Region"));
   }
 
-  PackageCoordinate* getPackageCoordinate(const std::string& projectName, const std::vector<std::string>& packageSteps) {
-
+  // Everything below, and everything readjson makes, lives in here, see metalarena.h.
+  template<typename T, typename... Args>
+  T* make(Args&&... args) {
+    return arena.make<T>(std::forward<Args>(args)...);
+  }
 
-    return makeIfNotPresent(
-        &packageCoords[projectName],
-        packageSteps,
-        [&](){ return new PackageCoordinate{projectName, packageSteps}; });
+  PackageCoordinate* getPackageCoordinate(const std::string& projectName, const std::vector<std::string>& packageSteps) {
+    return packageCoords.findOrInsert(
+        std::make_tuple(projectName, packageSteps),
+        [&](){ return make<PackageCoordinate>(projectName, packageSteps); });
   }
 
   Int* getInt(RegionId* regionId, int bits) {
-    return makeIfNotPresent(
-        &ints[regionId],
-        bits,
-        [&](){ return new Int(regionId, bits); });
+    return ints.findOrInsert(
+        std::make_tuple(regionId, bits),
+        [&](){ return make<Int>(regionId, bits); });
   }
 
   Bool* getBool(RegionId* regionId) {
-    return makeIfNotPresent(
-        &bools,
+    return bools.findOrInsert(
         regionId,
-        [&](){ return new Bool(regionId); });
+        [&](){ return make<Bool>(regionId); });
   }
 
   Str* getStr(RegionId* regionId) {
-    return makeIfNotPresent(
-        &strs,
+    return strs.findOrInsert(
         regionId,
-        [&](){ return new Str(regionId); });
+        [&](){ return make<Str>(regionId); });
   }
 
   Float* getFloat(RegionId* regionId) {
-    return makeIfNotPresent(
-        &floats,
+    return floats.findOrInsert(
         regionId,
-        [&](){ return new Float(regionId); });
+        [&](){ return make<Float>(regionId); });
   }
 
   Void* getVoid(RegionId* regionId) {
-    return makeIfNotPresent(
-        &voids,
+    return voids.findOrInsert(
         regionId,
-        [&](){ return new Void(regionId); });
+        [&](){ return make<Void>(regionId); });
   }
 
   Never* getNever(RegionId* regionId) {
-    return makeIfNotPresent(
-        &nevers,
+    return nevers.findOrInsert(
         regionId,
-        [&](){ return new Never(regionId); });
+        [&](){ return make<Never>(regionId); });
   }
 
   StructKind* getStructKind(Name* structName) {
-    return makeIfNotPresent(
-        &structKinds,
+    return structKinds.findOrInsert(
         structName,
-        [&]() { return new StructKind(structName); });
+        [&]() { return make<StructKind>(structName); });
   }
 
   InterfaceKind* getInterfaceKind(Name* structName) {
-    return makeIfNotPresent(
-        &interfaceKinds,
+    return interfaceKinds.findOrInsert(
         structName,
-        [&]() { return new InterfaceKind(structName); });
+        [&]() { return make<InterfaceKind>(structName); });
   }
 
   RuntimeSizedArrayT* getRuntimeSizedArray(Name* name) {
-    return makeIfNotPresent(
-        &runtimeSizedArrays,
+    return runtimeSizedArrays.findOrInsert(
         name,
-        [&](){ return new RuntimeSizedArrayT(name); });
+        [&](){ return make<RuntimeSizedArrayT>(name); });
   }
 
   StaticSizedArrayT* getStaticSizedArray(Name* name) {
-    return makeIfNotPresent(
-        &staticSizedArrays,
+    return staticSizedArrays.findOrInsert(
         name,
-        [&](){ return new StaticSizedArrayT(name); });
+        [&](){ return make<StaticSizedArrayT>(name); });
   }
 
   Name* getName(PackageCoordinate* packageCoordinate, std::string nameStr) {
-    return makeIfNotPresent(
-        &names[packageCoordinate],
-        nameStr,
-        [&](){ return new Name(packageCoordinate, nameStr); });
+    return names.findOrInsert(
+        std::make_tuple(packageCoordinate, nameStr),
+        [&](){ return make<Name>(packageCoordinate, nameStr); });
   }
 
   RegionId* getRegionId(PackageCoordinate* packageCoordinate, std::string nameStr) {
-    return makeIfNotPresent(
-        &regionIds,
+    return regionIds.findOrInsert(
         nameStr,
-        [&](){ return new RegionId(packageCoordinate, nameStr); });
+        [&](){ return make<RegionId>(packageCoordinate, nameStr); });
   }
 
   Reference* getReference(Ownership ownership, Location location, Kind* kind) {
-    return makeIfNotPresent<Location, Reference*>(
-        &unconvertedReferences[kind][ownership],
-        location,
-        [&](){ return new Reference(ownership, location, kind); });
+    return unconvertedReferences.findOrInsert(
+        std::make_tuple(kind, ownership, location),
+        [&](){ return make<Reference>(ownership, location, kind); });
   }
 
   Prototype* getPrototype(Name* name, Reference* returnType, std::vector<Reference*> paramTypes) {
-    return makeIfNotPresent(
-        &makeIfNotPresent(
-            &makeIfNotPresent(
-                &prototypes,
-                name,
-                [&](){ return PrototypeByParamListByReturnTypeMap(0, AddressHasher<Reference*>(addressNumberer)); }),
-            returnType,
-            [&](){ return PrototypeByParamListMap(0, HashRefVec(addressNumberer)); }),
-        paramTypes,
-        [&](){ return new Prototype(name, paramTypes, returnType); });
+    return prototypes.findOrInsert(
+        std::make_tuple(name, returnType, paramTypes),
+        [&](){ return make<Prototype>(name, paramTypes, returnType); });
   }
 
   InterfaceMethod* getInterfaceMethod(Prototype* prototype, int virtualParamIndex) {
-    return makeIfNotPresent(
-        &interfaceMethods[prototype],
-        virtualParamIndex,
-        [&](){ return new InterfaceMethod(prototype, virtualParamIndex); });
+    return interfaceMethods.findOrInsert(
+        std::make_tuple(prototype, virtualParamIndex),
+        [&](){ return make<InterfaceMethod>(prototype, virtualParamIndex); });
+  }
+
+  VariableId* getVariableId(int number, int height, const std::string& maybeName) {
+    return variableIds.findOrInsert(
+        std::make_tuple(number, maybeName),
+        [&](){ return make<VariableId>(number, height, maybeName); });
+  }
+
+  Local* getLocal(VariableId* varId, Reference* ref, bool keepAlive) {
+    return locals.findOrInsert(
+        std::make_tuple(varId, ref, keepAlive),
+        [&](){ return make<Local>(varId, ref, keepAlive); });
   }
 
   AddressNumberer* addressNumberer;
+  MetalArena arena;
+
+  InternTable<std::string, RegionId*> regionIds;
+  InternTable<Name*, StructKind*> structKinds;
+  InternTable<Name*, InterfaceKind*> interfaceKinds;
+  InternTable<std::tuple<PackageCoordinate*, std::string>, Name*> names;
+
+  InternTable<std::tuple<std::string, std::vector<std::string>>, PackageCoordinate*> packageCoords;
+  InternTable<std::tuple<RegionId*, int>, Int*> ints;
+  InternTable<RegionId*, Bool*> bools;
+  InternTable<RegionId*, Str*> strs;
+  InternTable<RegionId*, Float*> floats;
+  InternTable<RegionId*, Void*> voids;
+  InternTable<RegionId*, Never*> nevers;
+
+  InternTable<Name*, RuntimeSizedArrayT*> runtimeSizedArrays;
+  InternTable<Name*, StaticSizedArrayT*> staticSizedArrays;
+  InternTable<std::tuple<Kind*, Ownership, Location>, Reference*> unconvertedReferences;
+
+  InternTable<std::tuple<Name*, Reference*, std::vector<Reference*>>, Prototype*> prototypes;
+
+  InternTable<std::tuple<Prototype*, int>, InterfaceMethod*> interfaceMethods;
 
-  std::unordered_map<std::string, RegionId*> regionIds;
-  std::unordered_map<Name*, StructKind*, AddressHasher<Name*>> structKinds;
-  std::unordered_map<Name*, InterfaceKind*, AddressHasher<Name*>> interfaceKinds;
-  std::unordered_map<PackageCoordinate*, std::unordered_map<std::string, Name*>, AddressHasher<PackageCoordinate*>> names;
-
-  std::unordered_map<std::string, std::unordered_map<std::vector<std::string>, PackageCoordinate*, PackageCoordinate::StringVectorHasher, PackageCoordinate::StringVectorEquator>> packageCoords;
-  std::unordered_map<RegionId*, std::unordered_map<int, Int*>, AddressHasher<RegionId*>> ints;
-  std::unordered_map<RegionId*, Bool*, AddressHasher<RegionId*>> bools;
-  std::unordered_map<RegionId*, Str*, AddressHasher<RegionId*>> strs;
-  std::unordered_map<RegionId*, Float*, AddressHasher<RegionId*>> floats;
-  std::unordered_map<RegionId*, Void*, AddressHasher<RegionId*>> voids;
-  std::unordered_map<RegionId*, Never*, AddressHasher<RegionId*>> nevers;
-
-  std::unordered_map<Name*, RuntimeSizedArrayT*, AddressHasher<Name*>> runtimeSizedArrays;
-  std::unordered_map<Name*, StaticSizedArrayT*, AddressHasher<Name*>> staticSizedArrays;
-  std::unordered_map<
-      Kind*,
-      std::unordered_map<
-          Ownership,
-          std::unordered_map<
-              Location,
-              Reference*>>,
-      AddressHasher<Kind*>> unconvertedReferences;
-
-
-  using PrototypeByParamListMap =
-      std::unordered_map<std::vector<Reference*>, Prototype*, HashRefVec, RefVecEquals>;
-  using PrototypeByParamListByReturnTypeMap =
-      std::unordered_map<Reference*, PrototypeByParamListMap, AddressHasher<Reference*>>;
-  using PrototypeByParamListByReturnTypeByNameMap =
-      std::unordered_map<Name*, PrototypeByParamListByReturnTypeMap, AddressHasher<Name*>>;
-  PrototypeByParamListByReturnTypeByNameMap prototypes;
-
-  std::unordered_map<Prototype*, std::unordered_map<int, InterfaceMethod*>, AddressHasher<Prototype*>> interfaceMethods;
-
-  std::unordered_map<int, std::unordered_map<std::string, VariableId*>> variableIds;
-  using LocalByKeepAliveMap = std::unordered_map<bool, Local*>;
-  using LocalByKeepAliveByReferenceMap = std::unordered_map<Reference*, LocalByKeepAliveMap, AddressHasher<Reference*>>;
-  using LocalByKeepAliveByReferenceByVariableIdMap = std::unordered_map<VariableId*, LocalByKeepAliveByReferenceMap, AddressHasher<VariableId*>>;
-  LocalByKeepAliveByReferenceByVariableIdMap locals;
+  InternTable<std::tuple<int, std::string>, VariableId*> variableIds;
+  InternTable<std::tuple<VariableId*, Reference*, bool>, Local*> locals;
 
   RegionId* rcImmRegionId = nullptr;
   RegionId* linearRegionId = nullptr;
   RegionId* unsafeRegionId = nullptr;
+  RegionId* arenaRegionId = nullptr;
   RegionId* naiveRcRegionId = nullptr;
   RegionId* resilientV3RegionId = nullptr;
   RegionId* resilientV4RegionId = nullptr;
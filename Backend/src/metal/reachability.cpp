@@ -0,0 +1,438 @@
+#include <iostream>
+#include <typeinfo>
+#include <unordered_set>
+#include <vector>
+
+#include "reachability.h"
+#include "instructions.h"
+
+namespace {
+
+class Reachability {
+public:
+  explicit Reachability(Program* program_) : program(program_) {}
+
+  void addPrototype(Prototype* prototype) {
+    for (auto param : prototype->params) {
+      addReference(param);
+    }
+    addReference(prototype->returnType);
+    auto packageIter = program->packages.find(prototype->name->packageCoord);
+    if (packageIter == program->packages.end()) {
+      return;
+    }
+    auto functionIter = packageIter->second->functions.find(prototype->name->name);
+    if (functionIter != packageIter->second->functions.end()) {
+      if (functions.insert(functionIter->second).second) {
+        functionWorklist.push_back(functionIter->second);
+      }
+    }
+  }
+
+  void addReference(Reference* reference) {
+    if (reference) {
+      addKind(reference->kind);
+    }
+  }
+
+  void addKind(Kind* kind) {
+    if (kind && kinds.insert(kind).second) {
+      kindWorklist.push_back(kind);
+    }
+  }
+
+  void run() {
+    while (!functionWorklist.empty() || !kindWorklist.empty()) {
+      if (!functionWorklist.empty()) {
+        auto function = functionWorklist.back();
+        functionWorklist.pop_back();
+        visitExpression(function->block);
+      } else {
+        auto kind = kindWorklist.back();
+        kindWorklist.pop_back();
+        visitKind(kind);
+      }
+    }
+  }
+
+  bool isReachable(Function* function) const { return functions.count(function) > 0; }
+  bool isReachable(Kind* kind) const { return kinds.count(kind) > 0; }
+
+private:
+  Package* getMaybePackage(PackageCoordinate* packageCoord) {
+    auto iter = program->packages.find(packageCoord);
+    return iter == program->packages.end() ? nullptr : iter->second;
+  }
+
+  void addImmDestructor(Package* package, Kind* kind) {
+    auto iter = package->immDestructorsByKind.find(kind);
+    if (iter != package->immDestructorsByKind.end()) {
+      addPrototype(iter->second);
+    }
+  }
+
+  void visitKind(Kind* kind) {
+    if (auto structKind = dynamic_cast<StructKind*>(kind)) {
+      auto package = getMaybePackage(structKind->fullName->packageCoord);
+      if (!package) {
+        return;
+      }
+      auto iter = package->structs.find(structKind->fullName->name);
+      if (iter == package->structs.end()) {
+        return;
+      }
+      auto structM = iter->second;
+      for (auto member : structM->members) {
+        addReference(member->type);
+      }
+      for (auto edge : structM->edges) {
+        addKind(edge->interfaceName);
+        for (auto[interfaceMethod, structPrototype] : edge->structPrototypesByInterfaceMethod) {
+          addPrototype(interfaceMethod->prototype);
+          addPrototype(structPrototype);
+        }
+      }
+      addImmDestructor(package, kind);
+    } else if (auto interfaceKind = dynamic_cast<InterfaceKind*>(kind)) {
+      auto package = getMaybePackage(interfaceKind->fullName->packageCoord);
+      if (!package) {
+        return;
+      }
+      auto iter = package->interfaces.find(interfaceKind->fullName->name);
+      if (iter == package->interfaces.end()) {
+        return;
+      }
+      auto interfaceM = iter->second;
+      for (auto method : interfaceM->methods) {
+        addPrototype(method->prototype);
+      }
+      for (auto superInterfaceName : interfaceM->superInterfaces) {
+        if (auto superPackage = getMaybePackage(superInterfaceName->packageCoord)) {
+          auto superIter = superPackage->interfaces.find(superInterfaceName->name);
+          if (superIter != superPackage->interfaces.end()) {
+            addKind(superIter->second->kind);
+          }
+        }
+      }
+      addImmDestructor(package, kind);
+    } else if (auto ssaMT = dynamic_cast<StaticSizedArrayT*>(kind)) {
+      auto package = getMaybePackage(ssaMT->name->packageCoord);
+      if (!package) {
+        return;
+      }
+      auto iter = package->staticSizedArrays.find(ssaMT->name->name);
+      if (iter != package->staticSizedArrays.end()) {
+        addReference(iter->second->elementType);
+      }
+      addImmDestructor(package, kind);
+    } else if (auto rsaMT = dynamic_cast<RuntimeSizedArrayT*>(kind)) {
+      auto package = getMaybePackage(rsaMT->name->packageCoord);
+      if (!package) {
+        return;
+      }
+      auto iter = package->runtimeSizedArrays.find(rsaMT->name->name);
+      if (iter != package->runtimeSizedArrays.end()) {
+        addReference(iter->second->elementType);
+      }
+      addImmDestructor(package, kind);
+    }
+    // Primitives have nothing to follow.
+  }
+
+  void visitLocal(Local* local) {
+    if (local) {
+      addReference(local->type);
+    }
+  }
+
+  void visitExpressions(const std::vector<Expression*>& exprs) {
+    for (auto expr : exprs) {
+      visitExpression(expr);
+    }
+  }
+
+  // This has to know about every expression that translateExpression does, and everything in
+  // them that could name a function or kind.
+  void visitExpression(Expression* expr) {
+    if (expr == nullptr) {
+      return;
+    } else if (dynamic_cast<ConstantInt*>(expr) ||
+        dynamic_cast<ConstantVoid*>(expr) ||
+        dynamic_cast<ConstantF64*>(expr) ||
+        dynamic_cast<ConstantBool*>(expr) ||
+        dynamic_cast<ConstantStr*>(expr) ||
+        dynamic_cast<Break*>(expr)) {
+      // Nothing to follow.
+    } else if (auto discardM = dynamic_cast<Discard*>(expr)) {
+      visitExpression(discardM->sourceExpr);
+      addReference(discardM->sourceResultType);
+    } else if (auto ret = dynamic_cast<Return*>(expr)) {
+      visitExpression(ret->sourceExpr);
+      addReference(ret->sourceType);
+    } else if (auto stackify = dynamic_cast<Stackify*>(expr)) {
+      visitExpression(stackify->sourceExpr);
+      visitLocal(stackify->local);
+    } else if (auto localStore = dynamic_cast<LocalStore*>(expr)) {
+      visitExpression(localStore->sourceExpr);
+      visitLocal(localStore->local);
+    } else if (auto pointerToBorrow = dynamic_cast<PointerToBorrow*>(expr)) {
+      visitExpression(pointerToBorrow->sourceExpr);
+      addReference(pointerToBorrow->resultType);
+    } else if (auto borrowToPointer = dynamic_cast<BorrowToPointer*>(expr)) {
+      visitExpression(borrowToPointer->sourceExpr);
+      addReference(borrowToPointer->resultType);
+    } else if (auto weakAlias = dynamic_cast<WeakAlias*>(expr)) {
+      visitExpression(weakAlias->sourceExpr);
+      addReference(weakAlias->sourceType);
+      addKind(weakAlias->sourceKind);
+      addReference(weakAlias->resultType);
+    } else if (auto localLoad = dynamic_cast<LocalLoad*>(expr)) {
+      visitLocal(localLoad->local);
+    } else if (auto unstackify = dynamic_cast<Unstackify*>(expr)) {
+      visitLocal(unstackify->local);
+    } else if (auto argument = dynamic_cast<Argument*>(expr)) {
+      addReference(argument->resultType);
+    } else if (auto newStruct = dynamic_cast<NewStruct*>(expr)) {
+      visitExpressions(newStruct->sourceExprs);
+      addReference(newStruct->resultType);
+    } else if (auto consecutor = dynamic_cast<Consecutor*>(expr)) {
+      visitExpressions(consecutor->exprs);
+    } else if (auto block = dynamic_cast<Block*>(expr)) {
+      visitExpression(block->inner);
+      addReference(block->innerType);
+    } else if (auto iff = dynamic_cast<If*>(expr)) {
+      visitExpression(iff->conditionExpr);
+      visitExpression(iff->thenExpr);
+      visitExpression(iff->elseExpr);
+      addReference(iff->thenResultType);
+      addReference(iff->elseResultType);
+      addReference(iff->commonSupertype);
+    } else if (auto whiile = dynamic_cast<While*>(expr)) {
+      visitExpression(whiile->bodyExpr);
+    } else if (auto destroy = dynamic_cast<Destroy*>(expr)) {
+      visitExpression(destroy->structExpr);
+      addReference(destroy->structType);
+      for (auto localType : destroy->localTypes) {
+        addReference(localType);
+      }
+      for (auto local : destroy->localIndices) {
+        visitLocal(local);
+      }
+    } else if (auto memberLoad = dynamic_cast<MemberLoad*>(expr)) {
+      visitExpression(memberLoad->structExpr);
+      addKind(memberLoad->structId);
+      addReference(memberLoad->structType);
+      addReference(memberLoad->expectedMemberType);
+      addReference(memberLoad->expectedResultType);
+    } else if (auto dssaif = dynamic_cast<DestroyStaticSizedArrayIntoFunction*>(expr)) {
+      visitExpression(dssaif->arrayExpr);
+      visitExpression(dssaif->consumerExpr);
+      addReference(dssaif->arrayType);
+      addKind(dssaif->arrayKind);
+      addReference(dssaif->consumerType);
+      addPrototype(dssaif->consumerMethod);
+      addReference(dssaif->elementType);
+    } else if (auto dssail = dynamic_cast<DestroyStaticSizedArrayIntoLocals*>(expr)) {
+      visitExpression(dssail->arrayExpr);
+      visitExpression(dssail->consumerExpr);
+    } else if (auto pushRuntimeSizedArray = dynamic_cast<PushRuntimeSizedArray*>(expr)) {
+      visitExpression(pushRuntimeSizedArray->arrayExpr);
+      visitExpression(pushRuntimeSizedArray->newcomerExpr);
+      addReference(pushRuntimeSizedArray->arrayType);
+      addReference(pushRuntimeSizedArray->newcomerType);
+    } else if (auto migrateRuntimeSizedArray = dynamic_cast<MigrateRuntimeSizedArray*>(expr)) {
+      visitExpression(migrateRuntimeSizedArray->sourceArrayExpr);
+      visitExpression(migrateRuntimeSizedArray->targetArrayExpr);
+      addReference(migrateRuntimeSizedArray->sourceArrayType);
+      addReference(migrateRuntimeSizedArray->targetArrayType);
+      addKind(migrateRuntimeSizedArray->arrayKind);
+    } else if (auto popRuntimeSizedArray = dynamic_cast<PopRuntimeSizedArray*>(expr)) {
+      visitExpression(popRuntimeSizedArray->arrayExpr);
+      addReference(popRuntimeSizedArray->arrayType);
+    } else if (auto dmrsa = dynamic_cast<DestroyMutRuntimeSizedArray*>(expr)) {
+      visitExpression(dmrsa->arrayExpr);
+      addReference(dmrsa->arrayType);
+      addKind(dmrsa->arrayKind);
+    } else if (auto dirsa = dynamic_cast<DestroyImmRuntimeSizedArray*>(expr)) {
+      visitExpression(dirsa->arrayExpr);
+      visitExpression(dirsa->consumerExpr);
+      addReference(dirsa->arrayType);
+      addKind(dirsa->arrayKind);
+      addReference(dirsa->consumerType);
+      addKind(dirsa->consumerKind);
+      addPrototype(dirsa->consumerMethod);
+    } else if (auto staticSizedArrayLoad = dynamic_cast<StaticSizedArrayLoad*>(expr)) {
+      visitExpression(staticSizedArrayLoad->arrayExpr);
+      visitExpression(staticSizedArrayLoad->indexExpr);
+      addReference(staticSizedArrayLoad->arrayType);
+      addKind(staticSizedArrayLoad->arrayKind);
+      addReference(staticSizedArrayLoad->resultType);
+      addReference(staticSizedArrayLoad->arrayElementType);
+    } else if (auto staticSizedArrayStore = dynamic_cast<StaticSizedArrayStore*>(expr)) {
+      visitExpression(staticSizedArrayStore->arrayExpr);
+      visitExpression(staticSizedArrayStore->indexExpr);
+      visitExpression(staticSizedArrayStore->sourceExpr);
+    } else if (auto runtimeSizedArrayLoad = dynamic_cast<RuntimeSizedArrayLoad*>(expr)) {
+      visitExpression(runtimeSizedArrayLoad->arrayExpr);
+      visitExpression(runtimeSizedArrayLoad->indexExpr);
+      addReference(runtimeSizedArrayLoad->arrayType);
+      addKind(runtimeSizedArrayLoad->arrayKind);
+      addReference(runtimeSizedArrayLoad->indexType);
+      addReference(runtimeSizedArrayLoad->resultType);
+      addReference(runtimeSizedArrayLoad->arrayElementType);
+    } else if (auto runtimeSizedArrayStore = dynamic_cast<RuntimeSizedArrayStore*>(expr)) {
+      visitExpression(runtimeSizedArrayStore->arrayExpr);
+      visitExpression(runtimeSizedArrayStore->indexExpr);
+      visitExpression(runtimeSizedArrayStore->sourceExpr);
+      addReference(runtimeSizedArrayStore->arrayType);
+      addKind(runtimeSizedArrayStore->arrayKind);
+      addReference(runtimeSizedArrayStore->indexType);
+      addReference(runtimeSizedArrayStore->sourceType);
+    } else if (auto arrayLength = dynamic_cast<ArrayLength*>(expr)) {
+      visitExpression(arrayLength->sourceExpr);
+      addReference(arrayLength->sourceType);
+    } else if (auto arrayCapacity = dynamic_cast<ArrayCapacity*>(expr)) {
+      visitExpression(arrayCapacity->sourceExpr);
+      addReference(arrayCapacity->sourceType);
+    } else if (auto narrowPermission = dynamic_cast<NarrowPermission*>(expr)) {
+      visitExpression(narrowPermission->sourceExpr);
+    } else if (auto newArrayFromValues = dynamic_cast<NewArrayFromValues*>(expr)) {
+      visitExpressions(newArrayFromValues->sourceExprs);
+      addReference(newArrayFromValues->arrayRefType);
+      addKind(newArrayFromValues->arrayKind);
+    } else if (auto nirsa = dynamic_cast<NewImmRuntimeSizedArray*>(expr)) {
+      visitExpression(nirsa->sizeExpr);
+      visitExpression(nirsa->generatorExpr);
+      addReference(nirsa->sizeType);
+      addReference(nirsa->generatorType);
+      addKind(nirsa->generatorKind);
+      addPrototype(nirsa->generatorMethod);
+      addReference(nirsa->arrayRefType);
+      addReference(nirsa->elementType);
+    } else if (auto nmrsa = dynamic_cast<NewMutRuntimeSizedArray*>(expr)) {
+      visitExpression(nmrsa->sizeExpr);
+      addReference(nmrsa->sizeType);
+      addReference(nmrsa->arrayRefType);
+      addReference(nmrsa->elementType);
+    } else if (auto staticArrayFromCallable = dynamic_cast<StaticArrayFromCallable*>(expr)) {
+      visitExpression(staticArrayFromCallable->generatorExpr);
+      addReference(staticArrayFromCallable->generatorType);
+      addKind(staticArrayFromCallable->generatorKind);
+      addPrototype(staticArrayFromCallable->generatorMethod);
+      addReference(staticArrayFromCallable->arrayRefType);
+      addReference(staticArrayFromCallable->elementType);
+    } else if (auto call = dynamic_cast<Call*>(expr)) {
+      visitExpressions(call->argExprs);
+      addPrototype(call->function);
+    } else if (auto externCall = dynamic_cast<ExternCall*>(expr)) {
+      visitExpressions(externCall->argExprs);
+      addPrototype(externCall->function);
+      for (auto argType : externCall->argTypes) {
+        addReference(argType);
+      }
+    } else if (auto interfaceCall = dynamic_cast<InterfaceCall*>(expr)) {
+      visitExpressions(interfaceCall->argExprs);
+      addKind(interfaceCall->interfaceRef);
+      addPrototype(interfaceCall->functionType);
+    } else if (auto memberStore = dynamic_cast<MemberStore*>(expr)) {
+      visitExpression(memberStore->structExpr);
+      visitExpression(memberStore->sourceExpr);
+      addReference(memberStore->structType);
+      addReference(memberStore->resultType);
+    } else if (auto structToInterfaceUpcast = dynamic_cast<StructToInterfaceUpcast*>(expr)) {
+      visitExpression(structToInterfaceUpcast->sourceExpr);
+      addReference(structToInterfaceUpcast->sourceStructType);
+      addKind(structToInterfaceUpcast->sourceStructKind);
+      addReference(structToInterfaceUpcast->targetInterfaceType);
+      addKind(structToInterfaceUpcast->targetInterfaceKind);
+    } else if (auto interfaceToInterfaceUpcast = dynamic_cast<InterfaceToInterfaceUpcast*>(expr)) {
+      visitExpression(interfaceToInterfaceUpcast->sourceExpr);
+      addKind(interfaceToInterfaceUpcast->targetInterfaceRef);
+    } else if (auto checkRefCount = dynamic_cast<CheckRefCount*>(expr)) {
+      visitExpression(checkRefCount->refExpr);
+      visitExpression(checkRefCount->numExpr);
+    } else if (auto lockWeak = dynamic_cast<LockWeak*>(expr)) {
+      visitExpression(lockWeak->sourceExpr);
+      addReference(lockWeak->sourceType);
+      addPrototype(lockWeak->someConstructor);
+      addReference(lockWeak->someType);
+      addKind(lockWeak->someKind);
+      addPrototype(lockWeak->noneConstructor);
+      addReference(lockWeak->noneType);
+      addKind(lockWeak->noneKind);
+      addReference(lockWeak->resultOptType);
+      addKind(lockWeak->resultOptKind);
+    } else if (auto asSubtype = dynamic_cast<AsSubtype*>(expr)) {
+      visitExpression(asSubtype->sourceExpr);
+      addReference(asSubtype->sourceType);
+      addKind(asSubtype->targetKind);
+      addPrototype(asSubtype->okConstructor);
+      addReference(asSubtype->okType);
+      addKind(asSubtype->okKind);
+      addPrototype(asSubtype->errConstructor);
+      addReference(asSubtype->errType);
+      addKind(asSubtype->errKind);
+      addReference(asSubtype->resultResultType);
+      addKind(asSubtype->resultResultKind);
+    } else {
+      std::cerr << "Reachability doesn't know about " << typeid(*expr).name() << "!" << std::endl;
+      exit(1);
+    }
+  }
+
+  Program* program;
+  std::unordered_set<Function*> functions;
+  std::unordered_set<Kind*> kinds;
+  std::vector<Function*> functionWorklist;
+  std::vector<Kind*> kindWorklist;
+};
+
+template<typename Map, typename IsReachable>
+void pruneMap(Map* map, int* kept, int* pruned, IsReachable isReachable) {
+  for (auto iter = map->begin(); iter != map->end(); ) {
+    if (isReachable(iter->second)) {
+      (*kept)++;
+      ++iter;
+    } else {
+      (*pruned)++;
+      iter = map->erase(iter);
+    }
+  }
+}
+
+}
+
+PruneStats pruneUnreachable(Program* program) {
+  Reachability reachability(program);
+  for (auto[packageCoord, package] : program->packages) {
+    for (auto[exportName, prototype] : package->exportNameToFunction) {
+      reachability.addPrototype(prototype);
+    }
+    for (auto[exportName, kind] : package->exportNameToKind) {
+      reachability.addKind(kind);
+    }
+    // We declare every extern, so whatever they mention has to stay around.
+    for (auto[externName, prototype] : package->externNameToFunction) {
+      reachability.addPrototype(prototype);
+    }
+    for (auto[externName, kind] : package->externNameToKind) {
+      reachability.addKind(kind);
+    }
+  }
+  reachability.run();
+
+  PruneStats stats;
+  for (auto[packageCoord, package] : program->packages) {
+    pruneMap(&package->functions, &stats.functionsKept, &stats.functionsPruned,
+        [&](Function* function) { return reachability.isReachable(function); });
+    pruneMap(&package->structs, &stats.kindsKept, &stats.kindsPruned,
+        [&](StructDefinition* structM) { return reachability.isReachable(structM->kind); });
+    pruneMap(&package->interfaces, &stats.kindsKept, &stats.kindsPruned,
+        [&](InterfaceDefinition* interfaceM) { return reachability.isReachable(interfaceM->kind); });
+    pruneMap(&package->staticSizedArrays, &stats.kindsKept, &stats.kindsPruned,
+        [&](StaticSizedArrayDefinitionT* ssaDef) { return reachability.isReachable(ssaDef->kind); });
+    pruneMap(&package->runtimeSizedArrays, &stats.kindsKept, &stats.kindsPruned,
+        [&](RuntimeSizedArrayDefinitionT* rsaDef) { return reachability.isReachable(rsaDef->kind); });
+  }
+  return stats;
+}
@@ -0,0 +1,23 @@
+#ifndef METAL_REACHABILITY_H_
+#define METAL_REACHABILITY_H_
+
+#include "ast.h"
+
+struct PruneStats {
+  int functionsKept = 0;
+  int functionsPruned = 0;
+  int kindsKept = 0;
+  int kindsPruned = 0;
+};
+
+// Removes the functions, structs, interfaces, and arrays that nothing can reach from the
+// program's exports (including main) and externs, so we don't declare or lower them. Most of
+// what we'd otherwise compile is generic stdlib instantiations that the program never uses.
+//
+// Anything the backend itself might need is considered reachable too: a reachable struct keeps
+// all its edges and the methods in them, since an interface call could land on any of them, and
+// a reachable immutable kind keeps its destructor, which RCImm calls, and the serialize/
+// unserialize extra functions are made per kind, so they come along with their kinds.
+PruneStats pruneUnreachable(Program* program);
+
+#endif
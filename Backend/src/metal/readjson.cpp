@@ -1,5 +1,5 @@
 #include <iostream>
-#include <sstream>
+#include <string_view>
 
 #include "readjson.h"
 #include "instructions.h"
@@ -9,6 +9,40 @@
 // for convenience
 using json = nlohmann::json;
 
+// Looks up a field in a VAST object. Takes the key as a string_view, so this is one search
+// through the object's map comparing lengths and bytes. json's own operator[] searches twice,
+// and has to strlen the key at every comparison along the way.
+static const json& field(const json& object, std::string_view key) {
+  const auto& members = object.get_ref<const json::object_t&>();
+  auto iter = members.find(key);
+  if (iter == members.end()) {
+    std::cerr << "Couldn't find key: " << key << std::endl;
+    assert(false);
+    exit(1);
+  }
+  return iter->second;
+}
+
+// FNV-1a of a VAST node's __type. We switch on these instead of comparing the type against every
+// name in turn, and since it's constexpr the case labels are worked out at compile time. Two
+// names that collide would be a duplicate case label, so that can't sneak in.
+static constexpr uint64_t vastTypeTag(std::string_view type) {
+  uint64_t hash = 14695981039346656037ull;
+  for (char c : type) {
+    hash ^= (unsigned char)c;
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+static uint64_t readTypeTag(const json& object) {
+  return vastTypeTag(field(object, "__type").get_ref<const std::string&>());
+}
+
+static bool hasType(const json& object, std::string_view type) {
+  return field(object, "__type").get_ref<const std::string&>() == type;
+}
+
 Reference* readReference(MetalCache* cache, const json& reference);
 Ownership readUnconvertedOwnership(MetalCache* cache, const json& ownership);
 Location readLocation(MetalCache* cache, const json& location);
@@ -68,31 +102,29 @@ int64_t readI64(MetalCache* cache, const json& name) {
 }
 
 PackageCoordinate* readPackageCoordinate(MetalCache* cache, const json& packageCoord) {
-  assert(packageCoord["__type"] == "PackageCoordinate");
-  auto moduleName = readString(cache, packageCoord["project"]);//.get<std::string>();
-  auto packageSteps = readArray(cache, packageCoord["packageSteps"], readString);
+  assert(hasType(packageCoord, "PackageCoordinate"));
+  auto moduleName = readString(cache, field(packageCoord, "project"));//.get<std::string>();
+  auto packageSteps = readArray(cache, field(packageCoord, "packageSteps"), readString);
   return cache->getPackageCoordinate(moduleName, packageSteps);
 }
 
 Name* readName(MetalCache* cache, const json& name) {
   assert(name.is_object());
-  auto packageCoord = readPackageCoordinate(cache, name["packageCoordinate"]);
-  auto readableName = readString(cache, name["readableName"]);
-  int id = name["id"];
-  auto parts = readArray(cache, name["parts"], readString);
+  auto packageCoord = readPackageCoordinate(cache, field(name, "packageCoordinate"));
+  auto readableName = readString(cache, field(name, "readableName"));
+  int id = field(name, "id");
 
-  std::stringstream nameStrBuilder;
-  nameStrBuilder << readableName;
+  auto nameStr = readableName;
   if (id >= 0) {
-    nameStrBuilder << "_" << id;
+    nameStr += "_" + std::to_string(id);
   }
-  return cache->getName(packageCoord, nameStrBuilder.str());
+  return cache->getName(packageCoord, std::move(nameStr));
 }
 
 StructKind* readStructKind(MetalCache* cache, const json& kind) {
-  assert(kind["__type"] == "StructId");
+  assert(hasType(kind, "StructId"));
 
-  auto structName = readName(cache, kind["name"]);
+  auto structName = readName(cache, field(kind, "name"));
 
   auto result = cache->getStructKind(structName);
 
@@ -100,87 +132,85 @@ StructKind* readStructKind(MetalCache* cache, const json& kind) {
 }
 
 InterfaceKind* readInterfaceKind(MetalCache* cache, const json& kind) {
-  assert(kind["__type"] == "InterfaceId");
+  assert(hasType(kind, "InterfaceId"));
 
-  auto interfaceName = readName(cache, kind["name"]);
+  auto interfaceName = readName(cache, field(kind, "name"));
 
   return cache->getInterfaceKind(interfaceName);
 }
 
 RuntimeSizedArrayT* readRuntimeSizedArray(MetalCache* cache, const json& kind) {
-  auto name = readName(cache, kind["name"]);
+  auto name = readName(cache, field(kind, "name"));
 
   return cache->getRuntimeSizedArray(name);
 }
 
 RuntimeSizedArrayDefinitionT* readRuntimeSizedArrayDefinition(MetalCache* cache, const json& rsa) {
-  auto name = readName(cache, rsa["name"]);
-  auto kind = readRuntimeSizedArray(cache, rsa["kind"]);
-  auto mutability = readMutability(rsa["mutability"]);
-  auto elementType = readReference(cache, rsa["elementType"]);
+  auto name = readName(cache, field(rsa, "name"));
+  auto kind = readRuntimeSizedArray(cache, field(rsa, "kind"));
+  auto mutability = readMutability(field(rsa, "mutability"));
+  auto elementType = readReference(cache, field(rsa, "elementType"));
   auto regionId = mutability == Mutability::IMMUTABLE ? cache->rcImmRegionId : cache->mutRegionId;
 
-  return new RuntimeSizedArrayDefinitionT(name, kind, regionId, mutability, elementType);
+  return cache->make<RuntimeSizedArrayDefinitionT>(name, kind, regionId, mutability, elementType);
 }
 
 StaticSizedArrayT* readStaticSizedArray(MetalCache* cache, const json& kind) {
-  auto name = readName(cache, kind["name"]);
+  auto name = readName(cache, field(kind, "name"));
 
-  return makeIfNotPresent(
-      &cache->staticSizedArrays,
-      name,
-      [&](){ return new StaticSizedArrayT(name); });
+  return cache->getStaticSizedArray(name);
 }
 
 StaticSizedArrayDefinitionT* readStaticSizedArrayDefinition(MetalCache* cache, const json& ssa) {
-  auto name = readName(cache, ssa["name"]);
-  auto kind = readStaticSizedArray(cache, ssa["kind"]);
-  auto mutability = readMutability(ssa["mutability"]);
-  auto variability = readVariability(ssa["variability"]);
-  auto elementType = readReference(cache, ssa["elementType"]);
+  auto name = readName(cache, field(ssa, "name"));
+  auto kind = readStaticSizedArray(cache, field(ssa, "kind"));
+  auto mutability = readMutability(field(ssa, "mutability"));
+  auto variability = readVariability(field(ssa, "variability"));
+  auto elementType = readReference(cache, field(ssa, "elementType"));
   auto regionId = mutability == Mutability::IMMUTABLE ? cache->rcImmRegionId : cache->mutRegionId;
 
-  auto size = ssa["size"].get<int>();
+  auto size = field(ssa, "size").get<int>();
 
-  return new StaticSizedArrayDefinitionT(name, kind, size, regionId, mutability, variability, elementType);
+  return cache->make<StaticSizedArrayDefinitionT>(name, kind, size, regionId, mutability, variability, elementType);
 }
 
 Kind* readKind(MetalCache* cache, const json& kind) {
   assert(kind.is_object());
-  if (kind["__type"] == "Int") {
-    int bits = kind["bits"];
-    return cache->getInt(cache->rcImmRegionId, bits);
-  } else if (kind["__type"] == "Void") {
-    return cache->vooid;
-  } else if (kind["__type"] == "Bool") {
-    return cache->boool;
-  } else if (kind["__type"] == "Float") {
-    return cache->flooat;
-  } else if (kind["__type"] == "Str") {
-    return cache->str;
-  } else if (kind["__type"] == "StructId") {
-    return readStructKind(cache, kind);
-  } else if (kind["__type"] == "Never") {
-    return cache->never;
-  } else if (kind["__type"] == "RuntimeSizedArray") {
-    return readRuntimeSizedArray(cache, kind);
-  } else if (kind["__type"] == "StaticSizedArray") {
-    return readStaticSizedArray(cache, kind);
-  } else if (kind["__type"] == "InterfaceId") {
-    return readInterfaceKind(cache, kind);
-  } else {
-    std::cerr << "Unrecognized kind: " << kind["__type"] << std::endl;
-    assert(false);
+  switch (readTypeTag(kind)) {
+    case vastTypeTag("Int"):
+      return cache->getInt(cache->rcImmRegionId, field(kind, "bits"));
+    case vastTypeTag("Void"):
+      return cache->vooid;
+    case vastTypeTag("Bool"):
+      return cache->boool;
+    case vastTypeTag("Float"):
+      return cache->flooat;
+    case vastTypeTag("Str"):
+      return cache->str;
+    case vastTypeTag("StructId"):
+      return readStructKind(cache, kind);
+    case vastTypeTag("Never"):
+      return cache->never;
+    case vastTypeTag("RuntimeSizedArray"):
+      return readRuntimeSizedArray(cache, kind);
+    case vastTypeTag("StaticSizedArray"):
+      return readStaticSizedArray(cache, kind);
+    case vastTypeTag("InterfaceId"):
+      return readInterfaceKind(cache, kind);
+    default:
+      std::cerr << "Unrecognized kind: " << field(kind, "__type") << std::endl;
+      assert(false);
+      exit(1);
   }
 }
 
 Reference* readReference(MetalCache* cache, const json& reference) {
   assert(reference.is_object());
-  assert(reference["__type"] == "Ref");
+  assert(hasType(reference, "Ref"));
 
-  auto ownership = readUnconvertedOwnership(cache, reference["ownership"]);
-  auto location = readLocation(cache, reference["location"]);
-  auto kind = readKind(cache, reference["kind"]);
+  auto ownership = readUnconvertedOwnership(cache, field(reference, "ownership"));
+  auto location = readLocation(cache, field(reference, "location"));
+  auto kind = readKind(cache, field(reference, "kind"));
 //  std::string debugStr = reference["debugStr"];
 
   return cache->getReference(
@@ -191,487 +221,510 @@ Reference* readReference(MetalCache* cache, const json& reference) {
 
 Mutability readMutability(const json& mutability) {
   assert(mutability.is_object());
-  if (mutability["__type"].get<std::string>() == "Mutable") {
-    return Mutability::MUTABLE;
-  } else if (mutability["__type"].get<std::string>() == "Immutable") {
-    return Mutability::IMMUTABLE;
-  } else {
-    assert(false);
+  switch (readTypeTag(mutability)) {
+    case vastTypeTag("Mutable"):
+      return Mutability::MUTABLE;
+    case vastTypeTag("Immutable"):
+      return Mutability::IMMUTABLE;
+    default:
+      assert(false);
+      exit(1);
   }
 }
 
 Variability readVariability(const json& variability) {
   assert(variability.is_object());
-  if (variability["__type"].get<std::string>() == "Varying") {
-    return Variability::VARYING;
-  } else if (variability["__type"].get<std::string>() == "Final") {
-    return Variability::FINAL;
-  } else {
-    assert(false);
+  switch (readTypeTag(variability)) {
+    case vastTypeTag("Varying"):
+      return Variability::VARYING;
+    case vastTypeTag("Final"):
+      return Variability::FINAL;
+    default:
+      assert(false);
+      exit(1);
   }
 }
 
 Ownership readUnconvertedOwnership(MetalCache* cache, const json& ownership) {
   assert(ownership.is_object());
-//  std::cout << ownership.type() << std::endl;
-  if (ownership["__type"].get<std::string>() == "Own") {
-    return Ownership::OWN;
-  } else if (ownership["__type"].get<std::string>() == "Pointer") {
-    return Ownership::BORROW;
-  } else if (ownership["__type"].get<std::string>() == "Borrow") {
-    return Ownership::BORROW;
-  } else if (ownership["__type"].get<std::string>() == "Weak") {
-    return Ownership::WEAK;
-  } else if (ownership["__type"].get<std::string>() == "Share") {
-    return Ownership::SHARE;
-  } else {
-    assert(false);
+  switch (readTypeTag(ownership)) {
+    case vastTypeTag("Own"):
+      return Ownership::OWN;
+    case vastTypeTag("Pointer"):
+    case vastTypeTag("Borrow"):
+      return Ownership::BORROW;
+    case vastTypeTag("Weak"):
+      return Ownership::WEAK;
+    case vastTypeTag("Share"):
+      return Ownership::SHARE;
+    default:
+      assert(false);
+      exit(1);
   }
 }
 
 Location readLocation(MetalCache* cache, const json& location) {
   assert(location.is_object());
-//  std::cout << location.type() << std::endl;
-  if (location["__type"].get<std::string>() == "Inline") {
-    return Location::INLINE;
-  } else if (location["__type"].get<std::string>() == "Yonder") {
-    return Location::YONDER;
-  } else {
-    assert(false);
+  switch (readTypeTag(location)) {
+    case vastTypeTag("Inline"):
+      return Location::INLINE;
+    case vastTypeTag("Yonder"):
+      return Location::YONDER;
+    default:
+      assert(false);
+      exit(1);
   }
 }
 
 Prototype* readPrototype(MetalCache* cache, const json& prototype) {
   assert(prototype.is_object());
-  assert(prototype["__type"] == "Prototype");
+  assert(hasType(prototype, "Prototype"));
 
-  auto name = readName(cache, prototype["name"]);
-  auto params = readArray(cache, prototype["params"], readReference);
-  auto retuurn = readReference(cache, prototype["return"]);
+  auto name = readName(cache, field(prototype, "name"));
+  auto params = readArray(cache, field(prototype, "params"), readReference);
+  auto retuurn = readReference(cache, field(prototype, "return"));
 
   return cache->getPrototype(name, retuurn, params);
 }
 
 VariableId* readVariableId(MetalCache* cache, const json& variable) {
   assert(variable.is_object());
-  assert(variable["__type"] == "VariableId");
+  assert(hasType(variable, "VariableId"));
 
-  int number = variable["number"];
-  int height = variable["height"];
+  int number = field(variable, "number");
+  int height = field(variable, "height");
   std::string maybeName;
-  if (variable["optName"]["__type"] == "Some") {
-    maybeName = readName(cache, variable["optName"]["value"])->name;
+  if (hasType(field(variable, "optName"), "Some")) {
+    maybeName = readName(cache, field(field(variable, "optName"), "value"))->name;
   }
 
-  return makeIfNotPresent(
-      &cache->variableIds[number],
-      maybeName,
-      [&](){ return new VariableId(number, height, maybeName); });
+  return cache->getVariableId(number, height, maybeName);
 }
 
 Local* readLocal(MetalCache* cache, const json& local) {
   assert(local.is_object());
-  assert(local["__type"] == "Local");
-  auto varId = readVariableId(cache, local["id"]);
-  auto ref = readReference(cache, local["type"]);
-  bool keepAlive = local["keepAlive"];
-
-  return makeIfNotPresent(
-      &makeIfNotPresent(
-          &makeIfNotPresent(
-              &cache->locals,
-              varId,
-              [&](){ return MetalCache::LocalByKeepAliveByReferenceMap (0, cache->addressNumberer->makeHasher<Reference*>()); }),
-          ref,
-          [&](){ return MetalCache::LocalByKeepAliveMap(); }),
-      keepAlive,
-      [&](){ return new Local(varId, ref, keepAlive); });
+  assert(hasType(local, "Local"));
+  auto varId = readVariableId(cache, field(local, "id"));
+  auto ref = readReference(cache, field(local, "type"));
+  bool keepAlive = field(local, "keepAlive");
+
+  return cache->getLocal(varId, ref, keepAlive);
+}
+
+// Reads a frontend RangeS, if there is one, see SourceRange.
+static std::optional<SourceRange> readOptionalRange(const json& maybeRange) {
+  if (!hasType(maybeRange, "Some")) {
+    assert(hasType(maybeRange, "None"));
+    return std::nullopt;
+  }
+  auto& range = field(maybeRange, "value");
+  assert(hasType(range, "Range"));
+  auto& begin = field(range, "begin");
+  auto& end = field(range, "end");
+  return SourceRange{
+      readString(nullptr, field(field(begin, "file"), "filename")),
+      field(begin, "offset").get<int>(),
+      field(end, "offset").get<int>() };
 }
 
 Expression* readExpression(MetalCache* cache, const json& expression) {
   assert(expression.is_object());
-  std::string type = expression["__type"];
-  if (type == "ConstantInt") {
-    return new ConstantInt(
-        readI64(cache, expression["value"]),
-        expression["bits"]);
-  } else if (type == "ConstantVoid") {
-    return new ConstantVoid();
-  } else if (type == "ConstantBool") {
-    return new ConstantBool(
-        expression["value"]);
-  } else if (type == "Return") {
-    return new Return(
-        readExpression(cache, expression["sourceExpr"]),
-        readReference(cache, expression["sourceType"]));
-  } else if (type == "Break") {
-    return new Break();
-  } else if (type == "Stackify") {
-    return new Stackify(
-        readExpression(cache, expression["sourceExpr"]),
-        readLocal(cache, expression["local"]),
-        expression["knownLive"],
-        "");
-  } else if (type == "LocalStore") {
-    return new LocalStore(
-        readLocal(cache, expression["local"]),
-        readExpression(cache, expression["sourceExpr"]),
-        readName(cache, expression["localName"])->name,
-        expression["knownLive"]);
-  } else if (type == "MemberStore") {
-    return new MemberStore(
-        readExpression(cache, expression["structExpr"]),
-        readReference(cache, expression["structType"]),
-        expression["structKnownLive"],
-        expression["memberIndex"],
-        readExpression(cache, expression["sourceExpr"]),
-        readReference(cache, expression["resultType"]),
-        readName(cache, expression["memberName"])->name);
-  } else if (type == "Discard") {
-    return new Discard(
-        readExpression(cache, expression["sourceExpr"]),
-        readReference(cache, expression["sourceResultType"]));
-  } else if (type == "Argument") {
-    return new Argument(
-        readReference(cache, expression["resultType"]),
-        expression["argumentIndex"]);
-  } else if (type == "Unstackify") {
-    return new Unstackify(
-        readLocal(cache, expression["local"]));
-  } else if (type == "LocalLoad") {
-    return new LocalLoad(
-        readLocal(cache, expression["local"]),
-        readUnconvertedOwnership(cache, expression["targetOwnership"]),
-        readName(cache, expression["localName"])->name);
-  } else if (type == "BorrowToWeak" || type == "PointerToWeak") {
-    return new WeakAlias(
-        readExpression(cache, expression["sourceExpr"]),
-        readReference(cache, expression["sourceType"]),
-        readKind(cache, expression["sourceKind"]),
-        readReference(cache, expression["resultType"]));
-  } else if (type == "BorrowToPointer") {
-    return new BorrowToPointer(
-        readExpression(cache, expression["sourceExpr"]),
-        readReference(cache, expression["resultType"]));
-  } else if (type == "PointerToBorrow") {
-    return new PointerToBorrow(
-        readExpression(cache, expression["sourceExpr"]),
-        readReference(cache, expression["resultType"]));
-  } else if (type == "NarrowPermission") {
-    return new NarrowPermission(
-        readExpression(cache, expression["sourceExpr"]));
-  } else if (type == "Call") {
-    return new Call(
-        readPrototype(cache, expression["function"]),
-        readArray(cache, expression["argExprs"], readExpression));
-  } else if (type == "ExternCall") {
-    return new ExternCall(
-        readPrototype(cache, expression["function"]),
-        readArray(cache, expression["argExprs"], readExpression),
-        readArray(cache, expression["argTypes"], readReference));
-  } else if (type == "Consecutor") {
-    return new Consecutor(
-        readArray(cache, expression["exprs"], readExpression));
-  } else if (type == "Block") {
-    return new Block(
-        readExpression(cache, expression["innerExpr"]),
-        readReference(cache, expression["innerType"]));
-  } else if (type == "If") {
-    return new If(
-        readExpression(cache, expression["conditionBlock"]),
-        readExpression(cache, expression["thenBlock"]),
-        readReference(cache, expression["thenResultType"]),
-        readExpression(cache, expression["elseBlock"]),
-        readReference(cache, expression["elseResultType"]),
-        readReference(cache, expression["commonSupertype"]));
-  } else if (type == "While") {
-    return new While(
-        readExpression(cache, expression["bodyBlock"]));
-  } else if (type == "NewStruct") {
-    return new NewStruct(
-        readArray(cache, expression["sourceExprs"], readExpression),
-        readReference(cache, expression["resultType"]));
-  } else if (type == "Destroy") {
-    return new Destroy(
-        readExpression(cache, expression["structExpr"]),
-        readReference(cache, expression["structType"]),
-        readArray(cache, expression["localTypes"], readReference),
-        readArray(cache, expression["localIndices"], readLocal),
-        readArray(cache, expression["localsKnownLives"], [](MetalCache*, const json& j) -> bool { return j; }));
-  } else if (type == "MemberLoad") {
-    return new MemberLoad(
-        readExpression(cache, expression["structExpr"]),
-        readStructKind(cache, expression["structId"]),
-        readReference(cache, expression["structType"]),
-        expression["structKnownLive"],
-        expression["memberIndex"],
-        readUnconvertedOwnership(cache, expression["targetOwnership"]),
-        readReference(cache, expression["expectedMemberType"]),
-        readReference(cache, expression["expectedResultType"]),
-        readName(cache, expression["memberName"])->name);
-  } else if (type == "NewArrayFromValues") {
-    return new NewArrayFromValues(
-        readArray(cache, expression["sourceExprs"], readExpression),
-        readReference(cache, expression["resultType"]),
-        readStaticSizedArray(cache, expression["resultKind"]));
-  } else if (type == "StaticSizedArrayLoad") {
-    return new StaticSizedArrayLoad(
-        readExpression(cache, expression["arrayExpr"]),
-        readReference(cache, expression["arrayType"]),
-        readStaticSizedArray(cache, expression["arrayKind"]),
-        expression["arrayKnownLive"],
-        readExpression(cache, expression["indexExpr"]),
-        readReference(cache, expression["resultType"]),
-        readUnconvertedOwnership(cache, expression["targetOwnership"]),
-        readReference(cache, expression["expectedElementType"]),
-        expression["arraySize"]);
-  } else if (type == "RuntimeSizedArrayLoad") {
-    return new RuntimeSizedArrayLoad(
-        readExpression(cache, expression["arrayExpr"]),
-        readReference(cache, expression["arrayType"]),
-        readRuntimeSizedArray(cache, expression["arrayKind"]),
-        expression["arrayKnownLive"],
-        readExpression(cache, expression["indexExpr"]),
-        readReference(cache, expression["indexType"]),
-        readKind(cache, expression["indexKind"]),
-        readReference(cache, expression["resultType"]),
-        readUnconvertedOwnership(cache, expression["targetOwnership"]),
-        readReference(cache, expression["expectedElementType"]));
-  } else if (type == "RuntimeSizedArrayStore") {
-    return new RuntimeSizedArrayStore(
-        readExpression(cache, expression["arrayExpr"]),
-        readReference(cache, expression["arrayType"]),
-        readRuntimeSizedArray(cache, expression["arrayKind"]),
-        expression["arrayKnownLive"],
-        readExpression(cache, expression["indexExpr"]),
-        readReference(cache, expression["indexType"]),
-        readKind(cache, expression["indexKind"]),
-        readExpression(cache, expression["sourceExpr"]),
-        readReference(cache, expression["sourceType"]),
-        readKind(cache, expression["sourceKind"]));
-  } else if (type == "NewImmRuntimeSizedArray") {
-    return new NewImmRuntimeSizedArray(
-        readExpression(cache, expression["sizeExpr"]),
-        readReference(cache, expression["sizeType"]),
-        readKind(cache, expression["sizeKind"]),
-        readExpression(cache, expression["generatorExpr"]),
-        readReference(cache, expression["generatorType"]),
-        readKind(cache, expression["generatorKind"]),
-        readPrototype(cache, expression["generatorMethod"]),
-        expression["generatorKnownLive"],
-        readReference(cache, expression["resultType"]),
-        readReference(cache, expression["elementType"]));
-  } else if (type == "NewMutRuntimeSizedArray") {
-    return new NewMutRuntimeSizedArray(
-        readExpression(cache, expression["capacityExpr"]),
-        readReference(cache, expression["capacityType"]),
-        readKind(cache, expression["capacityKind"]),
-        readReference(cache, expression["resultType"]),
-        readReference(cache, expression["elementType"]));
-  } else if (type == "StaticArrayFromCallable") {
-    return new StaticArrayFromCallable(
-        readExpression(cache, expression["generatorExpr"]),
-        readReference(cache, expression["generatorType"]),
-        readKind(cache, expression["generatorKind"]),
-        readPrototype(cache, expression["generatorMethod"]),
-        expression["generatorKnownLive"],
-        readReference(cache, expression["resultType"]),
-        readReference(cache, expression["elementType"]));
-  } else if (type == "DestroyMutRuntimeSizedArray") {
-    return new DestroyMutRuntimeSizedArray(
-        readExpression(cache, expression["arrayExpr"]),
-        readReference(cache, expression["arrayType"]),
-        readRuntimeSizedArray(cache, expression["arrayKind"]));
-  } else if (type == "DestroyImmRuntimeSizedArray") {
-    return new DestroyImmRuntimeSizedArray(
-        readExpression(cache, expression["arrayExpr"]),
-        readReference(cache, expression["arrayType"]),
-        readRuntimeSizedArray(cache, expression["arrayKind"]),
-        readExpression(cache, expression["consumerExpr"]),
-        readReference(cache, expression["consumerType"]),
-        readKind(cache, expression["consumerKind"]),
-        readPrototype(cache, expression["consumerMethod"]),
-        expression["consumerKnownLive"]);
-  } else if (type == "PushRuntimeSizedArray") {
-    return new PushRuntimeSizedArray(
-        readExpression(cache, expression["arrayExpr"]),
-        readReference(cache, expression["arrayType"]),
-        readKind(cache, expression["arrayKind"]),
-        readExpression(cache, expression["newcomerExpr"]),
-        readReference(cache, expression["newcomerType"]),
-        readKind(cache, expression["newcomerKind"]));
-  } else if (type == "PopRuntimeSizedArray") {
-    return new PopRuntimeSizedArray(
-        readExpression(cache, expression["arrayExpr"]),
-        readReference(cache, expression["arrayType"]),
-        readKind(cache, expression["arrayKind"]));
-  } else if (type == "ArrayLength") {
-    return new ArrayLength(
-        readExpression(cache, expression["sourceExpr"]),
-        readReference(cache, expression["sourceType"]),
-        expression["sourceKnownLive"]);
-  } else if (type == "ArrayCapacity") {
-    return new ArrayCapacity(
-        readExpression(cache, expression["sourceExpr"]),
-        readReference(cache, expression["sourceType"]),
-        expression["sourceKnownLive"]);
-  } else if (type == "StructToInterfaceUpcast") {
-    return new StructToInterfaceUpcast(
-        readExpression(cache, expression["sourceExpr"]),
-        readReference(cache, expression["sourceStructType"]),
-        readStructKind(cache, expression["sourceStructKind"]),
-        readReference(cache, expression["targetInterfaceType"]),
-        readInterfaceKind(cache, expression["targetInterfaceKind"]));
-  } else if (type == "DestroyStaticSizedArrayIntoFunction") {
-    return new DestroyStaticSizedArrayIntoFunction(
-        readExpression(cache, expression["arrayExpr"]),
-        readReference(cache, expression["arrayType"]),
-        readStaticSizedArray(cache, expression["arrayKind"]),
-        readExpression(cache, expression["consumerExpr"]),
-        readReference(cache, expression["consumerType"]),
-        readPrototype(cache, expression["consumerMethod"]),
-        expression["consumerKnownLive"],
-        readReference(cache, expression["arrayElementType"]),
-        expression["arraySize"]);
-  } else if (type == "InterfaceCall") {
-    return new InterfaceCall(
-        readArray(cache, expression["argExprs"], readExpression),
-        expression["virtualParamIndex"],
-        readInterfaceKind(cache, expression["interfaceRef"]),
-        expression["indexInEdge"],
-        readPrototype(cache, expression["functionType"]));
-  } else if (type == "ConstantStr") {
-    return new ConstantStr(
-        expression["value"]);
-  } else if (type == "ConstantF64") {
-    return new ConstantF64(expression["value"]);
-  } else if (type == "LockWeak") {
-    return new LockWeak(
-        readExpression(cache, expression["sourceExpr"]),
-        readReference(cache, expression["sourceType"]),
-        expression["sourceKnownLive"],
-        readPrototype(cache, expression["someConstructor"]),
-        readReference(cache, expression["someType"]),
-        readStructKind(cache, expression["someKind"]),
-        readPrototype(cache, expression["noneConstructor"]),
-        readReference(cache, expression["noneType"]),
-        readStructKind(cache, expression["noneKind"]),
-        readReference(cache, expression["resultOptType"]),
-        readInterfaceKind(cache, expression["resultOptKind"]));
-  } else if (type == "AsSubtype") {
-    return new AsSubtype(
-        readExpression(cache, expression["sourceExpr"]),
-        readReference(cache, expression["sourceType"]),
-        expression["sourceKnownLive"],
-        readKind(cache, expression["targetKind"]),
-        readPrototype(cache, expression["okConstructor"]),
-        readReference(cache, expression["okType"]),
-        readStructKind(cache, expression["okKind"]),
-        readPrototype(cache, expression["errConstructor"]),
-        readReference(cache, expression["errType"]),
-        readStructKind(cache, expression["errKind"]),
-        readReference(cache, expression["resultResultType"]),
-        readInterfaceKind(cache, expression["resultResultKind"]));
-  } else {
-    std::cerr << "Unexpected instruction: " << type << std::endl;
-    assert(false);
+  switch (readTypeTag(expression)) {
+    case vastTypeTag("ConstantInt"):
+      return cache->make<ConstantInt>(
+          readI64(cache, field(expression, "value")),
+          field(expression, "bits"));
+    case vastTypeTag("ConstantVoid"):
+      return cache->make<ConstantVoid>();
+    case vastTypeTag("ConstantBool"):
+      return cache->make<ConstantBool>(
+          field(expression, "value"));
+    case vastTypeTag("Return"):
+      return cache->make<Return>(
+          readExpression(cache, field(expression, "sourceExpr")),
+          readReference(cache, field(expression, "sourceType")));
+    case vastTypeTag("Break"):
+      return cache->make<Break>();
+    case vastTypeTag("Stackify"):
+      return cache->make<Stackify>(
+          readExpression(cache, field(expression, "sourceExpr")),
+          readLocal(cache, field(expression, "local")),
+          field(expression, "knownLive"),
+          "");
+    case vastTypeTag("LocalStore"):
+      return cache->make<LocalStore>(
+          readLocal(cache, field(expression, "local")),
+          readExpression(cache, field(expression, "sourceExpr")),
+          readName(cache, field(expression, "localName"))->name,
+          field(expression, "knownLive"));
+    case vastTypeTag("MemberStore"):
+      return cache->make<MemberStore>(
+          readExpression(cache, field(expression, "structExpr")),
+          readReference(cache, field(expression, "structType")),
+          field(expression, "structKnownLive"),
+          field(expression, "memberIndex"),
+          readExpression(cache, field(expression, "sourceExpr")),
+          readReference(cache, field(expression, "resultType")),
+          readName(cache, field(expression, "memberName"))->name);
+    case vastTypeTag("Discard"):
+      return cache->make<Discard>(
+          readExpression(cache, field(expression, "sourceExpr")),
+          readReference(cache, field(expression, "sourceResultType")));
+    case vastTypeTag("Argument"):
+      return cache->make<Argument>(
+          readReference(cache, field(expression, "resultType")),
+          field(expression, "argumentIndex"));
+    case vastTypeTag("Unstackify"):
+      return cache->make<Unstackify>(
+          readLocal(cache, field(expression, "local")));
+    case vastTypeTag("LocalLoad"):
+      return cache->make<LocalLoad>(
+          readLocal(cache, field(expression, "local")),
+          readUnconvertedOwnership(cache, field(expression, "targetOwnership")),
+          readName(cache, field(expression, "localName"))->name,
+          readOptionalRange(field(expression, "range")));
+    case vastTypeTag("BorrowToWeak"):
+    case vastTypeTag("PointerToWeak"):
+      return cache->make<WeakAlias>(
+          readExpression(cache, field(expression, "sourceExpr")),
+          readReference(cache, field(expression, "sourceType")),
+          readKind(cache, field(expression, "sourceKind")),
+          readReference(cache, field(expression, "resultType")));
+    case vastTypeTag("BorrowToPointer"):
+      return cache->make<BorrowToPointer>(
+          readExpression(cache, field(expression, "sourceExpr")),
+          readReference(cache, field(expression, "resultType")));
+    case vastTypeTag("PointerToBorrow"):
+      return cache->make<PointerToBorrow>(
+          readExpression(cache, field(expression, "sourceExpr")),
+          readReference(cache, field(expression, "resultType")));
+    case vastTypeTag("NarrowPermission"):
+      return cache->make<NarrowPermission>(
+          readExpression(cache, field(expression, "sourceExpr")));
+    case vastTypeTag("Call"):
+      return cache->make<Call>(
+          readPrototype(cache, field(expression, "function")),
+          readArray(cache, field(expression, "argExprs"), readExpression));
+    case vastTypeTag("ExternCall"):
+      return cache->make<ExternCall>(
+          readPrototype(cache, field(expression, "function")),
+          readArray(cache, field(expression, "argExprs"), readExpression),
+          readArray(cache, field(expression, "argTypes"), readReference));
+    case vastTypeTag("Consecutor"):
+      return cache->make<Consecutor>(
+          readArray(cache, field(expression, "exprs"), readExpression));
+    case vastTypeTag("Block"):
+      return cache->make<Block>(
+          readExpression(cache, field(expression, "innerExpr")),
+          readReference(cache, field(expression, "innerType")));
+    case vastTypeTag("If"):
+      return cache->make<If>(
+          readExpression(cache, field(expression, "conditionBlock")),
+          readExpression(cache, field(expression, "thenBlock")),
+          readReference(cache, field(expression, "thenResultType")),
+          readExpression(cache, field(expression, "elseBlock")),
+          readReference(cache, field(expression, "elseResultType")),
+          readReference(cache, field(expression, "commonSupertype")));
+    case vastTypeTag("While"):
+      return cache->make<While>(
+          readExpression(cache, field(expression, "bodyBlock")));
+    case vastTypeTag("NewStruct"):
+      return cache->make<NewStruct>(
+          readArray(cache, field(expression, "sourceExprs"), readExpression),
+          readReference(cache, field(expression, "resultType")));
+    case vastTypeTag("Destroy"):
+      return cache->make<Destroy>(
+          readExpression(cache, field(expression, "structExpr")),
+          readReference(cache, field(expression, "structType")),
+          readArray(cache, field(expression, "localTypes"), readReference),
+          readArray(cache, field(expression, "localIndices"), readLocal),
+          readArray(cache, field(expression, "localsKnownLives"), [](MetalCache*, const json& j) -> bool { return j; }));
+    case vastTypeTag("MemberLoad"):
+      return cache->make<MemberLoad>(
+          readExpression(cache, field(expression, "structExpr")),
+          readStructKind(cache, field(expression, "structId")),
+          readReference(cache, field(expression, "structType")),
+          field(expression, "structKnownLive"),
+          field(expression, "memberIndex"),
+          readUnconvertedOwnership(cache, field(expression, "targetOwnership")),
+          readReference(cache, field(expression, "expectedMemberType")),
+          readReference(cache, field(expression, "expectedResultType")),
+          readName(cache, field(expression, "memberName"))->name,
+          readOptionalRange(field(expression, "range")));
+    case vastTypeTag("NewArrayFromValues"):
+      return cache->make<NewArrayFromValues>(
+          readArray(cache, field(expression, "sourceExprs"), readExpression),
+          readReference(cache, field(expression, "resultType")),
+          readStaticSizedArray(cache, field(expression, "resultKind")));
+    case vastTypeTag("StaticSizedArrayLoad"):
+      return cache->make<StaticSizedArrayLoad>(
+          readExpression(cache, field(expression, "arrayExpr")),
+          readReference(cache, field(expression, "arrayType")),
+          readStaticSizedArray(cache, field(expression, "arrayKind")),
+          field(expression, "arrayKnownLive"),
+          readExpression(cache, field(expression, "indexExpr")),
+          readReference(cache, field(expression, "resultType")),
+          readUnconvertedOwnership(cache, field(expression, "targetOwnership")),
+          readReference(cache, field(expression, "expectedElementType")),
+          field(expression, "arraySize"));
+    case vastTypeTag("RuntimeSizedArrayLoad"):
+      return cache->make<RuntimeSizedArrayLoad>(
+          readExpression(cache, field(expression, "arrayExpr")),
+          readReference(cache, field(expression, "arrayType")),
+          readRuntimeSizedArray(cache, field(expression, "arrayKind")),
+          field(expression, "arrayKnownLive"),
+          readExpression(cache, field(expression, "indexExpr")),
+          readReference(cache, field(expression, "indexType")),
+          readKind(cache, field(expression, "indexKind")),
+          readReference(cache, field(expression, "resultType")),
+          readUnconvertedOwnership(cache, field(expression, "targetOwnership")),
+          readReference(cache, field(expression, "expectedElementType")));
+    case vastTypeTag("RuntimeSizedArrayStore"):
+      return cache->make<RuntimeSizedArrayStore>(
+          readExpression(cache, field(expression, "arrayExpr")),
+          readReference(cache, field(expression, "arrayType")),
+          readRuntimeSizedArray(cache, field(expression, "arrayKind")),
+          field(expression, "arrayKnownLive"),
+          readExpression(cache, field(expression, "indexExpr")),
+          readReference(cache, field(expression, "indexType")),
+          readKind(cache, field(expression, "indexKind")),
+          readExpression(cache, field(expression, "sourceExpr")),
+          readReference(cache, field(expression, "sourceType")),
+          readKind(cache, field(expression, "sourceKind")));
+    case vastTypeTag("NewImmRuntimeSizedArray"):
+      return cache->make<NewImmRuntimeSizedArray>(
+          readExpression(cache, field(expression, "sizeExpr")),
+          readReference(cache, field(expression, "sizeType")),
+          readKind(cache, field(expression, "sizeKind")),
+          readExpression(cache, field(expression, "generatorExpr")),
+          readReference(cache, field(expression, "generatorType")),
+          readKind(cache, field(expression, "generatorKind")),
+          readPrototype(cache, field(expression, "generatorMethod")),
+          field(expression, "generatorKnownLive"),
+          readReference(cache, field(expression, "resultType")),
+          readReference(cache, field(expression, "elementType")));
+    case vastTypeTag("NewMutRuntimeSizedArray"):
+      return cache->make<NewMutRuntimeSizedArray>(
+          readExpression(cache, field(expression, "capacityExpr")),
+          readReference(cache, field(expression, "capacityType")),
+          readKind(cache, field(expression, "capacityKind")),
+          readReference(cache, field(expression, "resultType")),
+          readReference(cache, field(expression, "elementType")));
+    case vastTypeTag("StaticArrayFromCallable"):
+      return cache->make<StaticArrayFromCallable>(
+          readExpression(cache, field(expression, "generatorExpr")),
+          readReference(cache, field(expression, "generatorType")),
+          readKind(cache, field(expression, "generatorKind")),
+          readPrototype(cache, field(expression, "generatorMethod")),
+          field(expression, "generatorKnownLive"),
+          readReference(cache, field(expression, "resultType")),
+          readReference(cache, field(expression, "elementType")));
+    case vastTypeTag("DestroyMutRuntimeSizedArray"):
+      return cache->make<DestroyMutRuntimeSizedArray>(
+          readExpression(cache, field(expression, "arrayExpr")),
+          readReference(cache, field(expression, "arrayType")),
+          readRuntimeSizedArray(cache, field(expression, "arrayKind")));
+    case vastTypeTag("DestroyImmRuntimeSizedArray"):
+      return cache->make<DestroyImmRuntimeSizedArray>(
+          readExpression(cache, field(expression, "arrayExpr")),
+          readReference(cache, field(expression, "arrayType")),
+          readRuntimeSizedArray(cache, field(expression, "arrayKind")),
+          readExpression(cache, field(expression, "consumerExpr")),
+          readReference(cache, field(expression, "consumerType")),
+          readKind(cache, field(expression, "consumerKind")),
+          readPrototype(cache, field(expression, "consumerMethod")),
+          field(expression, "consumerKnownLive"));
+    case vastTypeTag("PushRuntimeSizedArray"):
+      return cache->make<PushRuntimeSizedArray>(
+          readExpression(cache, field(expression, "arrayExpr")),
+          readReference(cache, field(expression, "arrayType")),
+          readKind(cache, field(expression, "arrayKind")),
+          readExpression(cache, field(expression, "newcomerExpr")),
+          readReference(cache, field(expression, "newcomerType")),
+          readKind(cache, field(expression, "newcomerKind")));
+    case vastTypeTag("MigrateRuntimeSizedArray"):
+      return cache->make<MigrateRuntimeSizedArray>(
+          readExpression(cache, field(expression, "sourceArrayExpr")),
+          readReference(cache, field(expression, "sourceArrayType")),
+          readExpression(cache, field(expression, "targetArrayExpr")),
+          readReference(cache, field(expression, "targetArrayType")),
+          readRuntimeSizedArray(cache, field(expression, "arrayKind")));
+    case vastTypeTag("PopRuntimeSizedArray"):
+      return cache->make<PopRuntimeSizedArray>(
+          readExpression(cache, field(expression, "arrayExpr")),
+          readReference(cache, field(expression, "arrayType")),
+          readKind(cache, field(expression, "arrayKind")));
+    case vastTypeTag("ArrayLength"):
+      return cache->make<ArrayLength>(
+          readExpression(cache, field(expression, "sourceExpr")),
+          readReference(cache, field(expression, "sourceType")),
+          field(expression, "sourceKnownLive"));
+    case vastTypeTag("ArrayCapacity"):
+      return cache->make<ArrayCapacity>(
+          readExpression(cache, field(expression, "sourceExpr")),
+          readReference(cache, field(expression, "sourceType")),
+          field(expression, "sourceKnownLive"));
+    case vastTypeTag("StructToInterfaceUpcast"):
+      return cache->make<StructToInterfaceUpcast>(
+          readExpression(cache, field(expression, "sourceExpr")),
+          readReference(cache, field(expression, "sourceStructType")),
+          readStructKind(cache, field(expression, "sourceStructKind")),
+          readReference(cache, field(expression, "targetInterfaceType")),
+          readInterfaceKind(cache, field(expression, "targetInterfaceKind")));
+    case vastTypeTag("DestroyStaticSizedArrayIntoFunction"):
+      return cache->make<DestroyStaticSizedArrayIntoFunction>(
+          readExpression(cache, field(expression, "arrayExpr")),
+          readReference(cache, field(expression, "arrayType")),
+          readStaticSizedArray(cache, field(expression, "arrayKind")),
+          readExpression(cache, field(expression, "consumerExpr")),
+          readReference(cache, field(expression, "consumerType")),
+          readPrototype(cache, field(expression, "consumerMethod")),
+          field(expression, "consumerKnownLive"),
+          readReference(cache, field(expression, "arrayElementType")),
+          field(expression, "arraySize"));
+    case vastTypeTag("InterfaceCall"):
+      return cache->make<InterfaceCall>(
+          readArray(cache, field(expression, "argExprs"), readExpression),
+          field(expression, "virtualParamIndex"),
+          readInterfaceKind(cache, field(expression, "interfaceRef")),
+          field(expression, "indexInEdge"),
+          readPrototype(cache, field(expression, "functionType")));
+    case vastTypeTag("ConstantStr"):
+      return cache->make<ConstantStr>(
+          field(expression, "value"));
+    case vastTypeTag("ConstantF64"):
+      return cache->make<ConstantF64>(field(expression, "value"));
+    case vastTypeTag("LockWeak"):
+      return cache->make<LockWeak>(
+          readExpression(cache, field(expression, "sourceExpr")),
+          readReference(cache, field(expression, "sourceType")),
+          field(expression, "sourceKnownLive"),
+          readPrototype(cache, field(expression, "someConstructor")),
+          readReference(cache, field(expression, "someType")),
+          readStructKind(cache, field(expression, "someKind")),
+          readPrototype(cache, field(expression, "noneConstructor")),
+          readReference(cache, field(expression, "noneType")),
+          readStructKind(cache, field(expression, "noneKind")),
+          readReference(cache, field(expression, "resultOptType")),
+          readInterfaceKind(cache, field(expression, "resultOptKind")));
+    case vastTypeTag("AsSubtype"):
+      return cache->make<AsSubtype>(
+          readExpression(cache, field(expression, "sourceExpr")),
+          readReference(cache, field(expression, "sourceType")),
+          field(expression, "sourceKnownLive"),
+          readKind(cache, field(expression, "targetKind")),
+          readPrototype(cache, field(expression, "okConstructor")),
+          readReference(cache, field(expression, "okType")),
+          readStructKind(cache, field(expression, "okKind")),
+          readPrototype(cache, field(expression, "errConstructor")),
+          readReference(cache, field(expression, "errType")),
+          readStructKind(cache, field(expression, "errKind")),
+          readReference(cache, field(expression, "resultResultType")),
+          readInterfaceKind(cache, field(expression, "resultResultKind")));
+    default:
+      std::cerr << "Unexpected instruction: " << field(expression, "__type") << std::endl;
+      assert(false);
+      exit(1);
   }
 }
 
 StructMember* readStructMember(MetalCache* cache, const json& struuct) {
   assert(struuct.is_object());
-  assert(struuct["__type"] == "StructMember");
-  return new StructMember(
-      readName(cache, struuct["fullName"])->name,
-      struuct["name"],
-      readVariability(struuct["variability"]),
-      readReference(cache, struuct["type"]));
+  assert(hasType(struuct, "StructMember"));
+  return cache->make<StructMember>(
+      readName(cache, field(struuct, "fullName"))->name,
+      field(struuct, "name"),
+      readVariability(field(struuct, "variability")),
+      readReference(cache, field(struuct, "type")));
 }
 
 InterfaceMethod* readInterfaceMethod(MetalCache* cache, const json& struuct) {
   assert(struuct.is_object());
-  assert(struuct["__type"] == "InterfaceMethod");
+  assert(hasType(struuct, "InterfaceMethod"));
   return cache->getInterfaceMethod(
-      readPrototype(cache, struuct["prototype"]),
-      struuct["virtualParamIndex"]);
+      readPrototype(cache, field(struuct, "prototype")),
+      field(struuct, "virtualParamIndex"));
 }
 
 std::pair<InterfaceMethod*, Prototype*> readInterfaceMethodAndPrototypeEntry(MetalCache* cache, const json& edge) {
   assert(edge.is_object());
-  assert(edge["__type"] == "Entry");
+  assert(hasType(edge, "Entry"));
   return std::make_pair(
-      readInterfaceMethod(cache, edge["method"]),
-      readPrototype(cache, edge["override"]));
+      readInterfaceMethod(cache, field(edge, "method")),
+      readPrototype(cache, field(edge, "override")));
 }
 
 Edge* readEdge(MetalCache* cache, const json& edge) {
   assert(edge.is_object());
-  assert(edge["__type"] == "Edge");
-  return new Edge(
-      readStructKind(cache, edge["structName"]),
-      readInterfaceKind(cache, edge["interfaceName"]),
-      readArray(cache, edge["methods"], readInterfaceMethodAndPrototypeEntry));
+  assert(hasType(edge, "Edge"));
+  return cache->make<Edge>(
+      readStructKind(cache, field(edge, "structName")),
+      readInterfaceKind(cache, field(edge, "interfaceName")),
+      readArray(cache, field(edge, "methods"), readInterfaceMethodAndPrototypeEntry));
 }
 
 StructDefinition* readStruct(MetalCache* cache, const json& struuct) {
   assert(struuct.is_object());
-  assert(struuct["__type"] == "Struct");
-  auto mutability = readMutability(struuct["mutability"]);
+  assert(hasType(struuct, "Struct"));
+  auto mutability = readMutability(field(struuct, "mutability"));
   auto result =
-      new StructDefinition(
-          readName(cache, struuct["name"]),
-          readStructKind(cache, struuct["kind"]),
+      cache->make<StructDefinition>(
+          readName(cache, field(struuct, "name")),
+          readStructKind(cache, field(struuct, "kind")),
           mutability == Mutability::IMMUTABLE ? cache->rcImmRegionId : cache->mutRegionId,
           mutability,
-          readArray(cache, struuct["edges"], readEdge),
-          readArray(cache, struuct["members"], readStructMember),
-          struuct["weakable"] ? Weakability::WEAKABLE : Weakability::NON_WEAKABLE);
+          readArray(cache, field(struuct, "edges"), readEdge),
+          readArray(cache, field(struuct, "members"), readStructMember),
+          field(struuct, "weakable") ? Weakability::WEAKABLE : Weakability::NON_WEAKABLE);
 
   return result;
 }
 
 InterfaceDefinition* readInterface(MetalCache* cache, const json& interface) {
   assert(interface.is_object());
-  assert(interface["__type"] == "Interface");
-  auto mutability = readMutability(interface["mutability"]);
-  return new InterfaceDefinition(
-      readName(cache, interface["name"]),
-      readInterfaceKind(cache, interface["kind"]),
+  assert(hasType(interface, "Interface"));
+  auto mutability = readMutability(field(interface, "mutability"));
+  return cache->make<InterfaceDefinition>(
+      readName(cache, field(interface, "name")),
+      readInterfaceKind(cache, field(interface, "kind")),
       mutability == Mutability::IMMUTABLE ? cache->rcImmRegionId : cache->mutRegionId,
       mutability,
-      {},
-      readArray(cache, interface["methods"], readInterfaceMethod),
-      interface["weakable"] ? Weakability::WEAKABLE : Weakability::NON_WEAKABLE);
+      std::vector<Name*>{},
+      readArray(cache, field(interface, "methods"), readInterfaceMethod),
+      field(interface, "weakable") ? Weakability::WEAKABLE : Weakability::NON_WEAKABLE);
 }
 
 Function* readFunction(MetalCache* cache, const json& function) {
   assert(function.is_object());
-  assert(function["__type"] == "Function");
-  return new Function(
-      readPrototype(cache, function["prototype"]),
-      readExpression(cache, function["block"]));
+  assert(hasType(function, "Function"));
+  auto result =
+      cache->make<Function>(
+          readPrototype(cache, field(function, "prototype")),
+          readExpression(cache, field(function, "block")),
+          readOptionalRange(field(function, "range")));
+  return result;
 }
 
 std::pair<Kind*, Prototype*> readKindAndPrototypeEntry(MetalCache* cache, const json& edge) {
   assert(edge.is_object());
-  assert(edge["__type"] == "Entry");
+  assert(hasType(edge, "Entry"));
   return std::make_pair(
-      readKind(cache, edge["kind"]),
-      readPrototype(cache, edge["destructor"]));
+      readKind(cache, field(edge, "kind")),
+      readPrototype(cache, field(edge, "destructor")));
 }
 
 Package* readPackage(MetalCache* cache, const json& program) {
   assert(program.is_object());
-  assert(program["__type"] == "Package");
-  return new Package(
+  assert(hasType(program, "Package"));
+  return cache->make<Package>(
       cache->addressNumberer,
-      readPackageCoordinate(cache, program["packageCoordinate"]),
+      readPackageCoordinate(cache, field(program, "packageCoordinate")),
       readArrayIntoMap<std::string, InterfaceDefinition*>(
           cache,
           std::hash<std::string>(),
           std::equal_to<std::string>(),
-          program["interfaces"],
-          [](MetalCache* cache, json j){
+          field(program, "interfaces"),
+          [](MetalCache* cache, const json& j){
             auto s = readInterface(cache, j);
             return std::make_pair(s->name->name, s);
           }),
@@ -679,8 +732,8 @@ Package* readPackage(MetalCache* cache, const json& program) {
           cache,
           std::hash<std::string>(),
           std::equal_to<std::string>(),
-          program["structs"],
-          [](MetalCache* cache, json j){
+          field(program, "structs"),
+          [](MetalCache* cache, const json& j){
             auto s = readStruct(cache, j);
             return std::make_pair(s->name->name, s);
           }),
@@ -688,8 +741,8 @@ Package* readPackage(MetalCache* cache, const json& program) {
           cache,
           std::hash<std::string>(),
           std::equal_to<std::string>(),
-          program["staticSizedArrays"],
-          [](MetalCache* cache, json j){
+          field(program, "staticSizedArrays"),
+          [](MetalCache* cache, const json& j){
             auto s = readStaticSizedArrayDefinition(cache, j);
             return std::make_pair(s->name->name, s);
           }),
@@ -697,8 +750,8 @@ Package* readPackage(MetalCache* cache, const json& program) {
           cache,
           std::hash<std::string>(),
           std::equal_to<std::string>(),
-          program["runtimeSizedArrays"],
-          [](MetalCache* cache, json j){
+          field(program, "runtimeSizedArrays"),
+          [](MetalCache* cache, const json& j){
             auto s = readRuntimeSizedArrayDefinition(cache, j);
             return std::make_pair(s->name->name, s);
           }),
@@ -707,7 +760,7 @@ Package* readPackage(MetalCache* cache, const json& program) {
 //          std::hash<std::string>(),
 //          std::equal_to<std::string>(),
 //          program["externFunctions"],
-//          [](MetalCache* cache, json j){
+//          [](MetalCache* cache, const json& j){
 //            auto f = readPrototype(cache, j);
 //            return std::make_pair(f->name->name, f);
 //          }),
@@ -715,8 +768,8 @@ Package* readPackage(MetalCache* cache, const json& program) {
           cache,
           std::hash<std::string>(),
           std::equal_to<std::string>(),
-          program["functions"],
-          [](MetalCache* cache, json j){
+          field(program, "functions"),
+          [](MetalCache* cache, const json& j){
             auto f = readFunction(cache, j);
             return std::make_pair(f->prototype->name->name, f);
           }),
@@ -724,56 +777,56 @@ Package* readPackage(MetalCache* cache, const json& program) {
           cache,
           AddressHasher<Kind*>(cache->addressNumberer),
           std::equal_to<Kind*>(),
-          program["immDestructorsByKind"],
+          field(program, "immDestructorsByKind"),
           readKindAndPrototypeEntry),
       readArrayIntoMap<std::string, Prototype*>(
           cache,
           std::hash<std::string>(),
           std::equal_to<std::string>(),
-          program["exportNameToFunction"],
-          [](MetalCache* cache, json entryJ){
-            auto exportName = readString(cache, entryJ["exportName"]);
-            auto prototype = readPrototype(cache, entryJ["prototype"]);
+          field(program, "exportNameToFunction"),
+          [](MetalCache* cache, const json& entryJ){
+            auto exportName = readString(cache, field(entryJ, "exportName"));
+            auto prototype = readPrototype(cache, field(entryJ, "prototype"));
             return std::make_pair(exportName, prototype);
           }),
       readArrayIntoMap<std::string, Kind*>(
           cache,
           std::hash<std::string>(),
           std::equal_to<std::string>(),
-          program["exportNameToKind"],
-          [](MetalCache* cache, json entryJ){
-            auto exportName = readString(cache, entryJ["exportName"]);
-            auto kind = readKind(cache, entryJ["kind"]);
+          field(program, "exportNameToKind"),
+          [](MetalCache* cache, const json& entryJ){
+            auto exportName = readString(cache, field(entryJ, "exportName"));
+            auto kind = readKind(cache, field(entryJ, "kind"));
             return std::make_pair(exportName, kind);
           }),
       readArrayIntoMap<std::string, Prototype*>(
           cache,
           std::hash<std::string>(),
           std::equal_to<std::string>(),
-          program["externNameToFunction"],
-          [](MetalCache* cache, json entryJ){
-            auto externName = readString(cache, entryJ["externName"]);
-            auto prototype = readPrototype(cache, entryJ["prototype"]);
+          field(program, "externNameToFunction"),
+          [](MetalCache* cache, const json& entryJ){
+            auto externName = readString(cache, field(entryJ, "externName"));
+            auto prototype = readPrototype(cache, field(entryJ, "prototype"));
             return std::make_pair(externName, prototype);
           }),
       readArrayIntoMap<std::string, Kind*>(
           cache,
           std::hash<std::string>(),
           std::equal_to<std::string>(),
-          program["externNameToKind"],
-          [](MetalCache* cache, json entryJ){
-            auto externName = readString(cache, entryJ["externName"]);
-            auto kind = readKind(cache, entryJ["kind"]);
+          field(program, "externNameToKind"),
+          [](MetalCache* cache, const json& entryJ){
+            auto externName = readString(cache, field(entryJ, "externName"));
+            auto kind = readKind(cache, field(entryJ, "kind"));
             return std::make_pair(externName, kind);
           }));
 }
 
 std::pair<PackageCoordinate*, Package*> readPackageCoordinateAndPackageEntry(MetalCache* cache, const json& edge) {
   assert(edge.is_object());
-  assert(edge["__type"] == "Entry");
+  assert(hasType(edge, "Entry"));
   return std::make_pair<PackageCoordinate*, Package*>(
-      readPackageCoordinate(cache, edge["packageCoordinate"]),
-      readPackage(cache, edge["package"]));
+      readPackageCoordinate(cache, field(edge, "packageCoordinate")),
+      readPackage(cache, field(edge, "package")));
 }
 
 //Program* readProgram(MetalCache* cache, const json& program) {
@@ -785,7 +838,7 @@ std::pair<PackageCoordinate*, Package*> readPackageCoordinateAndPackageEntry(Met
 //          cache->addressNumberer->makeHasher<PackageCoordinate*>(),
 //          std::equal_to<PackageCoordinate*>(),
 //          program["packages"],
-//          [](MetalCache* cache, json j){
+//          [](MetalCache* cache, const json& j){
 //            return readPackageCoordinateAndPackageEntry(cache, j);
 //          }));
 //}
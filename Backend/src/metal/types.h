@@ -12,6 +12,7 @@
 class Name;
 class PackageCoordinate;
 class CodeLocation;
+class IRegion;
 
 // Defined in this file
 class Reference;
@@ -70,6 +71,10 @@ struct RegionId {
   PackageCoordinate* packageCoord;
   std::string id;
 
+  // Which region handles this, filled in by GlobalState::getRegion the first time it's asked.
+  // Interned things only live as long as one compile, so this can't go stale.
+  IRegion* region = nullptr;
+
   RegionId(PackageCoordinate* packageCoord_, std::string id_) :
       packageCoord(packageCoord_), id(id_) {}
 };
@@ -80,6 +85,8 @@ public:
   Ownership ownership;
   Location location;
   Kind* kind;
+  // Same as RegionId's region, so getRegion is just a load for the types we lower most.
+  IRegion* region = nullptr;
 //  std::string debugStr;
 
   Reference(
@@ -105,6 +112,9 @@ public:
 
 class Kind {
 public:
+    // Same as RegionId's region.
+    IRegion* region = nullptr;
+
     virtual ~Kind() {}
     virtual PackageCoordinate* getPackageCoordinate() const = 0;
 };
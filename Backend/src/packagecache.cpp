@@ -0,0 +1,152 @@
+#include <cassert>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include "packagecache.h"
+#include "metal/readjson.h"
+
+using json = nlohmann::json;
+
+// FNV-1a, we only need it to tell versions of a file apart.
+static uint64_t hashContents(const std::string& bytes) {
+  uint64_t hash = 14695981039346656037ull;
+  for (unsigned char c : bytes) {
+    hash ^= c;
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+// Returns false and fills errorOut if the file is missing or empty.
+static bool readFileContents(const std::string& inputFilepath, std::string* contentsOut, std::string* errorOut) {
+  std::ifstream instream(inputFilepath);
+  contentsOut->assign(std::istreambuf_iterator<char>{instream}, {});
+  if (contentsOut->size() == 0) {
+    *errorOut = "Nothing found in " + inputFilepath;
+    return false;
+  }
+  return true;
+}
+
+static PackageCoordinate* getPackageCoordinateForFile(MetalCache* metalCache, const std::string& inputFilepath) {
+  auto stem = std::filesystem::path(inputFilepath).stem().string();
+  std::vector<std::string> package_coord_parts;
+  std::stringstream stemStream(stem);
+  std::string part;
+  while (std::getline(stemStream, part, '.')) {
+    package_coord_parts.push_back(part);
+  }
+  auto project_name = package_coord_parts[0];
+  package_coord_parts.erase(package_coord_parts.begin());
+  return metalCache->getPackageCoordinate(project_name, package_coord_parts);
+}
+
+// Returns null and fills errorOut if the contents aren't JSON, or aren't shaped like a package.
+static Package* readPackageContents(
+    MetalCache* metalCache, const std::string& inputFilepath, const std::string& contents, std::string* errorOut) {
+  try {
+    auto packageJ = json::parse(contents.c_str());
+    return readPackage(metalCache, packageJ);
+  }
+  catch (const nlohmann::json::exception &error) {
+    *errorOut = "Error while parsing json in " + inputFilepath + ": " + error.what();
+    return nullptr;
+  }
+}
+
+void setMutRegionId(MetalCache* metalCache, RegionOverride regionOverride) {
+  switch (regionOverride) {
+    case RegionOverride::ASSIST:
+      metalCache->mutRegionId = metalCache->assistRegionId;
+      break;
+    case RegionOverride::FAST:
+      metalCache->mutRegionId = metalCache->unsafeRegionId;
+      break;
+    case RegionOverride::ARENA:
+      metalCache->mutRegionId = metalCache->arenaRegionId;
+      break;
+    case RegionOverride::NAIVE_RC:
+      metalCache->mutRegionId = metalCache->naiveRcRegionId;
+      break;
+    case RegionOverride::RESILIENT_V3:
+      metalCache->mutRegionId = metalCache->resilientV3RegionId;
+      break;
+    case RegionOverride::RESILIENT_V4:
+      metalCache->mutRegionId = metalCache->resilientV4RegionId;
+      break;
+    default:
+      assert(false);
+  }
+}
+
+Package* readPackageFile(MetalCache* metalCache, const std::string& inputFilepath, PackageCoordinate** packageCoordOut) {
+  *packageCoordOut = getPackageCoordinateForFile(metalCache, inputFilepath);
+  std::string contents;
+  std::string error;
+  Package* package = nullptr;
+  if (readFileContents(inputFilepath, &contents, &error)) {
+    package = readPackageContents(metalCache, inputFilepath, contents, &error);
+  }
+  if (!package) {
+    std::cerr << error << std::endl;
+    exit(1);
+  }
+  return package;
+}
+
+PackageCache::RegionCache* PackageCache::getRegionCache(RegionOverride regionOverride) {
+  auto iter = regionCaches.find((int)regionOverride);
+  if (iter == regionCaches.end()) {
+    RegionCache regionCache;
+    regionCache.addressNumberer = std::make_unique<AddressNumberer>();
+    regionCache.metalCache = std::make_unique<MetalCache>(regionCache.addressNumberer.get());
+    setMutRegionId(regionCache.metalCache.get(), regionOverride);
+    iter = regionCaches.emplace((int)regionOverride, std::move(regionCache)).first;
+  }
+  return &iter->second;
+}
+
+MetalCache* PackageCache::getMetalCache(RegionOverride regionOverride) {
+  return getRegionCache(regionOverride)->metalCache.get();
+}
+
+Package* PackageCache::getPackage(
+    RegionOverride regionOverride, const std::string& inputFilepath, PackageCoordinate** packageCoordOut) {
+  std::string error;
+  auto package = tryGetPackage(regionOverride, inputFilepath, packageCoordOut, &error);
+  if (!package) {
+    std::cerr << error << std::endl;
+    exit(1);
+  }
+  return package;
+}
+
+Package* PackageCache::tryGetPackage(
+    RegionOverride regionOverride,
+    const std::string& inputFilepath,
+    PackageCoordinate** packageCoordOut,
+    std::string* errorOut) {
+  auto regionCache = getRegionCache(regionOverride);
+  std::string contents;
+  if (!readFileContents(inputFilepath, &contents, errorOut)) {
+    return nullptr;
+  }
+  auto key = std::filesystem::path(inputFilepath).stem().string() + ":" + std::to_string(hashContents(contents));
+  auto iter = regionCache->packages.find(key);
+  if (iter != regionCache->packages.end()) {
+    packagesReused++;
+  } else {
+    auto metalCache = regionCache->metalCache.get();
+    CachedPackage cached;
+    cached.packageCoord = getPackageCoordinateForFile(metalCache, inputFilepath);
+    cached.package = readPackageContents(metalCache, inputFilepath, contents, errorOut);
+    if (!cached.package) {
+      return nullptr;
+    }
+    packagesRead++;
+    iter = regionCache->packages.emplace(key, cached).first;
+  }
+  *packageCoordOut = iter->second.packageCoord;
+  return iter->second.package;
+}
@@ -0,0 +1,66 @@
+#ifndef PACKAGECACHE_H_
+#define PACKAGECACHE_H_
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include "addresshasher.h"
+#include "valeopts.h"
+#include "metal/metalcache.h"
+#include "metal/ast.h"
+
+// Points metalCache's mutRegionId at the region that --region_override asks for.
+void setMutRegionId(MetalCache* metalCache, RegionOverride regionOverride);
+
+// Reads a .vast file into a package, interning everything in metalCache. The package's coordinate
+// comes from the file's name, e.g. stdlib.collections.vast is stdlib's collections package.
+// Exits if the file is empty or isn't JSON.
+Package* readPackageFile(MetalCache* metalCache, const std::string& inputFilepath, PackageCoordinate** packageCoordOut);
+
+// For --serve. Keeps packages read from .vast files across compiles, so the server only parses
+// the stdlib once instead of once per request.
+//
+// readPackage bakes the mutable region into every kind it makes, so there's one MetalCache per
+// --region_override, and everything read for that region is interned in it. Packages are keyed
+// by the file's name and a hash of its contents, so an edited file is read again.
+//
+// The server reads the request's packages in here before forking, and the child compiles from
+// its own copy, so whatever the compile does to the packages (like pruning) doesn't stick.
+class PackageCache {
+public:
+  MetalCache* getMetalCache(RegionOverride regionOverride);
+
+  // Returns the package in this file, reading it if we haven't seen these contents before.
+  // Exits if the file is empty or isn't JSON.
+  Package* getPackage(RegionOverride regionOverride, const std::string& inputFilepath, PackageCoordinate** packageCoordOut);
+  // Like getPackage, but returns null and fills errorOut instead of exiting, for the server
+  // itself, which has to outlive a file that changed or broke since the request used it.
+  Package* tryGetPackage(
+      RegionOverride regionOverride,
+      const std::string& inputFilepath,
+      PackageCoordinate** packageCoordOut,
+      std::string* errorOut);
+
+  int numPackagesRead() const { return packagesRead; }
+  int numPackagesReused() const { return packagesReused; }
+
+private:
+  struct CachedPackage {
+    PackageCoordinate* packageCoord;
+    Package* package;
+  };
+  struct RegionCache {
+    std::unique_ptr<AddressNumberer> addressNumberer;
+    std::unique_ptr<MetalCache> metalCache;
+    // Keyed by the file's stem and a hash of its contents.
+    std::unordered_map<std::string, CachedPackage> packages;
+  };
+
+  RegionCache* getRegionCache(RegionOverride regionOverride);
+
+  std::unordered_map<int, RegionCache> regionCaches;
+  int packagesRead = 0;
+  int packagesReused = 0;
+};
+
+#endif
@@ -0,0 +1,13 @@
+#include "../../function/expressions/shared/shared.h"
+#include "arena.h"
+
+Arena::Arena(GlobalState* globalState_) :
+    Unsafe(globalState_, globalState_->metalCache->arenaRegionId) {}
+
+void Arena::mainCleanup(FunctionState* functionState, LLVMBuilderRef builder) {
+  Unsafe::mainCleanup(functionState, builder);
+  if (globalState->opt->regionOverride == RegionOverride::ARENA) {
+    auto zeroLE = constI64LE(globalState, 0);
+    LLVMBuildCall(builder, globalState->externs->arenaRelease, &zeroLE, 1, "");
+  }
+}
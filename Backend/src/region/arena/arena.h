@@ -0,0 +1,17 @@
+#ifndef REGION_ARENA_ARENA_H_
+#define REGION_ARENA_ARENA_H_
+
+#include "../unsafe/unsafe.h"
+
+// The region for --region_override=arena. It's laid out just like Unsafe, but its objects are
+// bump-allocated from builtins/arena.c, freeing one does nothing, and they're all released at
+// once: when the program releases an arena mark (see arena.vale), or when main returns.
+class Arena : public Unsafe {
+public:
+  Arena(GlobalState* globalState);
+  ~Arena() override = default;
+
+  void mainCleanup(FunctionState* functionState, LLVMBuilderRef builder) override;
+};
+
+#endif
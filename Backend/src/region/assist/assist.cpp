@@ -940,6 +940,25 @@ Ref Assist::popRuntimeSizedArrayNoBoundsCheck(
   return valLE;
 }
 
+void Assist::migrateRuntimeSizedArrayNoBoundsCheck(
+    FunctionState* functionState,
+    LLVMBuilderRef builder,
+    RuntimeSizedArrayT* rsaMT,
+    Reference* sourceRefMT,
+    Ref sourceArrayRef,
+    Reference* targetRefMT,
+    Ref targetArrayRef) {
+  auto sourceWrapperPtrLE =
+      kindStructs.makeWrapperPtr(
+          FL(), functionState, builder, sourceRefMT,
+          checkValidReference(FL(), functionState, builder, sourceRefMT, sourceArrayRef));
+  auto targetWrapperPtrLE =
+      kindStructs.makeWrapperPtr(
+          FL(), functionState, builder, targetRefMT,
+          checkValidReference(FL(), functionState, builder, targetRefMT, targetArrayRef));
+  ::migrateElementsInRSA(globalState, functionState, builder, sourceWrapperPtrLE, targetWrapperPtrLE);
+}
+
 void Assist::initializeElementInSSA(
     FunctionState* functionState,
     LLVMBuilderRef builder,
@@ -0,0 +1,188 @@
+#include "allocprofile.h"
+#include "../../globalstate.h"
+#include "../../function/expressions/shared/shared.h"
+
+static int getAllocProfileKindId(GlobalState* globalState, Kind* kindM) {
+  auto iter = globalState->allocProfileKindIds.find(kindM);
+  if (iter == globalState->allocProfileKindIds.end()) {
+    auto name =
+        dynamic_cast<Str*>(kindM) ? std::string("str") : globalState->getKindName(kindM)->name;
+    iter =
+        globalState->allocProfileKindIds.emplace(
+            kindM, globalState->allocProfileKindNames.size()).first;
+    globalState->allocProfileKindNames.push_back(name);
+  }
+  return iter->second;
+}
+
+static LLVMValueRef getAllocProfileEntryMemberPtr(
+    GlobalState* globalState,
+    LLVMBuilderRef builder,
+    Kind* kindM,
+    int memberIndex) {
+  LLVMValueRef indices[2] = {
+      constI64LE(globalState, 0),
+      constI64LE(globalState, getAllocProfileKindId(globalState, kindM))
+  };
+  auto entryPtrLE =
+      LLVMBuildGEP(builder, globalState->allocProfileTable, indices, 2, "allocProfileEntryPtr");
+  return LLVMBuildStructGEP(builder, entryPtrLE, memberIndex, "allocProfileMemberPtr");
+}
+
+// Adds amountLE to the counter and returns the new value. With --threadsafe_imms, any thread can
+// be allocating, so this is an atomic add; the counters don't order anything else, so relaxed is
+// enough.
+static LLVMValueRef addToAllocProfileCounter(
+    GlobalState* globalState,
+    LLVMBuilderRef builder,
+    LLVMValueRef counterPtrLE,
+    LLVMValueRef amountLE) {
+  if (globalState->opt->threadsafeImms) {
+    auto prevValLE =
+        LLVMBuildAtomicRMW(
+            builder, LLVMAtomicRMWBinOpAdd, counterPtrLE, amountLE, LLVMAtomicOrderingMonotonic, false);
+    return LLVMBuildAdd(builder, prevValLE, amountLE, "counterNewVal");
+  } else {
+    auto prevValLE = LLVMBuildLoad(builder, counterPtrLE, "counterPrevVal");
+    auto newValLE = LLVMBuildAdd(builder, prevValLE, amountLE, "counterNewVal");
+    LLVMBuildStore(builder, newValLE, counterPtrLE);
+    return newValLE;
+  }
+}
+
+void declareAllocProfile(GlobalState* globalState) {
+  auto int8LT = LLVMInt8TypeInContext(globalState->context);
+  auto int64LT = LLVMInt64TypeInContext(globalState->context);
+  auto int8PtrLT = LLVMPointerType(int8LT, 0);
+
+  globalState->allocProfileEntryLT =
+      LLVMStructCreateNamed(globalState->context, "__ValeAllocProfileEntry");
+  std::vector<LLVMTypeRef> memberTypesL;
+  assert(ALLOC_PROFILE_ENTRY_MEMBER_INDEX_FOR_ALLOCS == memberTypesL.size());
+  memberTypesL.push_back(int64LT);
+  assert(ALLOC_PROFILE_ENTRY_MEMBER_INDEX_FOR_FREES == memberTypesL.size());
+  memberTypesL.push_back(int64LT);
+  assert(ALLOC_PROFILE_ENTRY_MEMBER_INDEX_FOR_BYTES == memberTypesL.size());
+  memberTypesL.push_back(int64LT);
+  assert(ALLOC_PROFILE_ENTRY_MEMBER_INDEX_FOR_LIVE == memberTypesL.size());
+  memberTypesL.push_back(int64LT);
+  assert(ALLOC_PROFILE_ENTRY_MEMBER_INDEX_FOR_PEAK_LIVE == memberTypesL.size());
+  memberTypesL.push_back(int64LT);
+  LLVMStructSetBody(
+      globalState->allocProfileEntryLT, memberTypesL.data(), memberTypesL.size(), false);
+
+  globalState->allocProfileTable =
+      LLVMAddGlobal(
+          globalState->mod, LLVMArrayType(globalState->allocProfileEntryLT, 0),
+          "__vale_allocProfileTablePlaceholder");
+  globalState->allocProfileNames =
+      LLVMAddGlobal(
+          globalState->mod, LLVMArrayType(int8PtrLT, 0), "__vale_allocProfileNamesPlaceholder");
+  globalState->allocProfileNumKinds =
+      LLVMAddGlobal(globalState->mod, int64LT, "__vale_allocProfileNumKinds");
+  LLVMSetInitializer(globalState->allocProfileNumKinds, constI64LE(globalState, 0));
+}
+
+void buildAllocProfileNoteAlloc(
+    GlobalState* globalState,
+    LLVMBuilderRef builder,
+    Kind* kindM,
+    LLVMValueRef sizeBytesLE) {
+  addToAllocProfileCounter(
+      globalState, builder,
+      getAllocProfileEntryMemberPtr(globalState, builder, kindM, ALLOC_PROFILE_ENTRY_MEMBER_INDEX_FOR_ALLOCS),
+      constI64LE(globalState, 1));
+  addToAllocProfileCounter(
+      globalState, builder,
+      getAllocProfileEntryMemberPtr(globalState, builder, kindM, ALLOC_PROFILE_ENTRY_MEMBER_INDEX_FOR_BYTES),
+      sizeBytesLE);
+  auto liveLE =
+      addToAllocProfileCounter(
+          globalState, builder,
+          getAllocProfileEntryMemberPtr(globalState, builder, kindM, ALLOC_PROFILE_ENTRY_MEMBER_INDEX_FOR_LIVE),
+          constI64LE(globalState, 1));
+
+  auto peakLivePtrLE =
+      getAllocProfileEntryMemberPtr(globalState, builder, kindM, ALLOC_PROFILE_ENTRY_MEMBER_INDEX_FOR_PEAK_LIVE);
+  if (globalState->opt->threadsafeImms) {
+    LLVMBuildAtomicRMW(
+        builder, LLVMAtomicRMWBinOpMax, peakLivePtrLE, liveLE, LLVMAtomicOrderingMonotonic, false);
+  } else {
+    auto peakLiveLE = LLVMBuildLoad(builder, peakLivePtrLE, "peakLive");
+    LLVMBuildStore(
+        builder,
+        LLVMBuildSelect(
+            builder,
+            LLVMBuildICmp(builder, LLVMIntSGT, liveLE, peakLiveLE, "isNewPeak"),
+            liveLE,
+            peakLiveLE,
+            "newPeakLive"),
+        peakLivePtrLE);
+  }
+}
+
+void buildAllocProfileNoteFree(
+    GlobalState* globalState,
+    LLVMBuilderRef builder,
+    Kind* kindM) {
+  if (dynamic_cast<InterfaceKind*>(kindM)) {
+    // We only know the interface here, not which struct is actually being freed. Interface refs
+    // are normally freed via their concrete struct's destructor, so this shouldn't come up.
+    return;
+  }
+  addToAllocProfileCounter(
+      globalState, builder,
+      getAllocProfileEntryMemberPtr(globalState, builder, kindM, ALLOC_PROFILE_ENTRY_MEMBER_INDEX_FOR_FREES),
+      constI64LE(globalState, 1));
+  addToAllocProfileCounter(
+      globalState, builder,
+      getAllocProfileEntryMemberPtr(globalState, builder, kindM, ALLOC_PROFILE_ENTRY_MEMBER_INDEX_FOR_LIVE),
+      constI64LE(globalState, -1));
+}
+
+void buildAllocProfileInit(GlobalState* globalState, LLVMBuilderRef builder) {
+  auto int8PtrLT = LLVMPointerType(LLVMInt8TypeInContext(globalState->context), 0);
+  LLVMValueRef argsLE[3] = {
+      LLVMBuildBitCast(builder, globalState->allocProfileTable, int8PtrLT, "allocProfileTable"),
+      LLVMBuildBitCast(
+          builder, globalState->allocProfileNames, LLVMPointerType(int8PtrLT, 0), "allocProfileNames"),
+      LLVMBuildLoad(builder, globalState->allocProfileNumKinds, "allocProfileNumKinds"),
+  };
+  LLVMBuildCall(builder, globalState->externs->allocProfileInit, argsLE, 3, "");
+}
+
+void buildAllocProfileDump(GlobalState* globalState, LLVMBuilderRef builder) {
+  LLVMBuildCall(builder, globalState->externs->allocProfileDump, nullptr, 0, "");
+}
+
+void finishAllocProfile(GlobalState* globalState) {
+  auto int8PtrLT = LLVMPointerType(LLVMInt8TypeInContext(globalState->context), 0);
+  int numKinds = globalState->allocProfileKindNames.size();
+
+  auto tableLT = LLVMArrayType(globalState->allocProfileEntryLT, numKinds);
+  auto tableLE = LLVMAddGlobal(globalState->mod, tableLT, "__vale_allocProfileTable");
+  LLVMSetInitializer(tableLE, LLVMConstNull(tableLT));
+
+  std::vector<LLVMValueRef> namesLE;
+  for (auto& name : globalState->allocProfileKindNames) {
+    namesLE.push_back(globalState->getOrMakeStringConstant(name));
+  }
+  auto namesTableLE =
+      LLVMAddGlobal(globalState->mod, LLVMArrayType(int8PtrLT, numKinds), "__vale_allocProfileNames");
+  LLVMSetInitializer(namesTableLE, LLVMConstArray(int8PtrLT, namesLE.data(), namesLE.size()));
+  LLVMSetGlobalConstant(namesTableLE, true);
+
+  LLVMSetInitializer(globalState->allocProfileNumKinds, constI64LE(globalState, numKinds));
+
+  // Everything so far was built against the zero-length placeholders, point it at the real ones.
+  LLVMReplaceAllUsesWith(
+      globalState->allocProfileTable,
+      LLVMConstBitCast(tableLE, LLVMTypeOf(globalState->allocProfileTable)));
+  LLVMDeleteGlobal(globalState->allocProfileTable);
+  globalState->allocProfileTable = tableLE;
+  LLVMReplaceAllUsesWith(
+      globalState->allocProfileNames,
+      LLVMConstBitCast(namesTableLE, LLVMTypeOf(globalState->allocProfileNames)));
+  LLVMDeleteGlobal(globalState->allocProfileNames);
+  globalState->allocProfileNames = namesTableLE;
+}
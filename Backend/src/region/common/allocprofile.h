@@ -0,0 +1,39 @@
+#ifndef REGION_COMMON_ALLOCPROFILE_H_
+#define REGION_COMMON_ALLOCPROFILE_H_
+
+#include <llvm-c/Core.h>
+#include "../../metal/types.h"
+
+class GlobalState;
+
+// When --alloc_profile is on, we keep one of these entries per kind, in a static table indexed
+// by the kind's ID. It has to stay in sync with ValeAllocProfileEntry in builtins/allocprofile.c.
+constexpr int ALLOC_PROFILE_ENTRY_MEMBER_INDEX_FOR_ALLOCS = 0;
+constexpr int ALLOC_PROFILE_ENTRY_MEMBER_INDEX_FOR_FREES = 1;
+constexpr int ALLOC_PROFILE_ENTRY_MEMBER_INDEX_FOR_BYTES = 2;
+constexpr int ALLOC_PROFILE_ENTRY_MEMBER_INDEX_FOR_LIVE = 3;
+constexpr int ALLOC_PROFILE_ENTRY_MEMBER_INDEX_FOR_PEAK_LIVE = 4;
+
+// Makes the table's placeholder globals. We don't know how many kinds will allocate until we've
+// compiled everything, so finishAllocProfile swaps in the real table at the very end.
+void declareAllocProfile(GlobalState* globalState);
+
+void buildAllocProfileNoteAlloc(
+    GlobalState* globalState,
+    LLVMBuilderRef builder,
+    Kind* kindM,
+    LLVMValueRef sizeBytesLE);
+
+void buildAllocProfileNoteFree(
+    GlobalState* globalState,
+    LLVMBuilderRef builder,
+    Kind* kindM);
+
+// Hands the table to the runtime, so it can dump it when it gets a signal.
+void buildAllocProfileInit(GlobalState* globalState, LLVMBuilderRef builder);
+
+void buildAllocProfileDump(GlobalState* globalState, LLVMBuilderRef builder);
+
+void finishAllocProfile(GlobalState* globalState);
+
+#endif
@@ -1,3 +1,6 @@
+#include <algorithm>
+#include <cmath>
+#include <optional>
 #include <llvm-c/Types.h>
 #include "../../globalstate.h"
 #include "../../function/function.h"
@@ -9,6 +12,10 @@
 #include "../../utils/branch.h"
 #include "../../function/expressions/shared/string.h"
 #include "common.h"
+#include "allocprofile.h"
+#include "../../metal/generatorshape.h"
+#include "../../translatetype.h"
+#include "../linear/linear.h"
 
 constexpr int INTERFACE_REF_MEMBER_INDEX_FOR_OBJ_PTR = 0;
 constexpr int INTERFACE_REF_MEMBER_INDEX_FOR_ITABLE_PTR = 1;
@@ -30,7 +37,8 @@ LLVMValueRef upcastThinPtr(
   switch (globalState->opt->regionOverride) {
     case RegionOverride::ASSIST:
     case RegionOverride::NAIVE_RC:
-    case RegionOverride::FAST: {
+    case RegionOverride::FAST:
+    case RegionOverride::ARENA: {
       assert(sourceStructTypeM->ownership == Ownership::SHARE ||
           sourceStructTypeM->ownership == Ownership::OWN ||
           sourceStructTypeM->ownership == Ownership::BORROW);
@@ -95,13 +103,13 @@ LoadResult loadInnerInnerStructMember(
     FunctionState* functionState,
     LLVMBuilderRef builder,
     LLVMValueRef innerStructPtrLE,
-    int memberIndex,
+    int memberLlvmIndex,
     Reference* expectedType,
     std::string memberName) {
   assert(LLVMGetTypeKind(LLVMTypeOf(innerStructPtrLE)) == LLVMPointerTypeKind);
 
   auto ptrToMemberLE =
-      LLVMBuildStructGEP(builder, innerStructPtrLE, memberIndex, memberName.c_str());
+      LLVMBuildStructGEP(builder, innerStructPtrLE, memberLlvmIndex, memberName.c_str());
   buildFlare(FL(), globalState, functionState, builder, "Ptr to member: ", ptrToIntLE(globalState, builder, ptrToMemberLE));
   auto result =
       LLVMBuildLoad(
@@ -112,24 +120,25 @@ LoadResult loadInnerInnerStructMember(
 }
 
 void storeInnerInnerStructMember(
-    LLVMBuilderRef builder, LLVMValueRef innerStructPtrLE, int memberIndex, std::string memberName, LLVMValueRef newValueLE) {
+    LLVMBuilderRef builder, LLVMValueRef innerStructPtrLE, int memberLlvmIndex, std::string memberName, LLVMValueRef newValueLE) {
   assert(LLVMGetTypeKind(LLVMTypeOf(innerStructPtrLE)) == LLVMPointerTypeKind);
   LLVMBuildStore(
       builder,
       newValueLE,
       LLVMBuildStructGEP(
-          builder, innerStructPtrLE, memberIndex, memberName.c_str()));
+          builder, innerStructPtrLE, memberLlvmIndex, memberName.c_str()));
 }
 
 LLVMValueRef getItablePtrFromInterfacePtr(
     GlobalState* globalState,
     FunctionState* functionState,
     LLVMBuilderRef builder,
+    KindStructs* structs,
     Reference* virtualParamMT,
     InterfaceFatPtrLE virtualArgLE) {
   buildFlare(FL(), globalState, functionState, builder);
   assert(LLVMTypeOf(virtualArgLE.refLE) == globalState->getRegion(virtualParamMT)->translateType(virtualParamMT));
-  return getTablePtrFromInterfaceRef(builder, virtualArgLE);
+  return getTablePtrFromInterfaceRef(builder, structs, virtualArgLE);
 }
 
 
@@ -248,6 +257,10 @@ LLVMValueRef makeInterfaceRefStruct(
           objControlBlockPtrLE,
           INTERFACE_REF_MEMBER_INDEX_FOR_OBJ_PTR,
           "interfaceRefWithOnlyObj");
+  if (structs->isThinInterface(targetInterfaceKindM)) {
+    // The object's header already has this itable, see constructWrappedStruct.
+    return interfaceRefLE;
+  }
   interfaceRefLE =
       LLVMBuildInsertValue(
           builder,
@@ -272,6 +285,33 @@ LLVMValueRef getTablePtrFromInterfaceRef(
   return LLVMBuildExtractValue(builder, interfaceRefLE.refLE, INTERFACE_REF_MEMBER_INDEX_FOR_ITABLE_PTR, "itablePtr");
 }
 
+LLVMValueRef getTablePtrFromInterfaceRef(
+    LLVMBuilderRef builder,
+    KindStructs* structs,
+    InterfaceFatPtrLE interfaceRefLE) {
+  auto interfaceKindM = dynamic_cast<InterfaceKind*>(interfaceRefLE.refM->kind);
+  assert(interfaceKindM);
+  if (!structs->isThinInterface(interfaceKindM)) {
+    return getTablePtrFromInterfaceRef(builder, interfaceRefLE);
+  }
+  // The reference is just the control block pointer, so get the itable from the object's header.
+  auto controlBlockPtrLE = getObjPtrFromInterfaceRef(builder, interfaceRefLE);
+  auto itableVoidPtrLE =
+      LLVMBuildLoad(
+          builder,
+          LLVMBuildStructGEP(
+              builder,
+              controlBlockPtrLE,
+              structs->getControlBlock(interfaceKindM)->getMemberIndex(ControlBlockMember::ITABLE_PTR),
+              "itablePtrPtr"),
+          "itableVoidPtr");
+  return LLVMBuildBitCast(
+      builder,
+      itableVoidPtrLE,
+      LLVMPointerType(structs->getInterfaceTableStruct(interfaceKindM), 0),
+      "itablePtr");
+}
+
 void callFree(
     GlobalState* globalState,
     LLVMBuilderRef builder,
@@ -285,6 +325,19 @@ void callFree(
   LLVMBuildCall(builder, globalState->externs->free, &concreteAsCharPtrLE, 1, "");
 }
 
+void callGenFree(
+    GlobalState* globalState,
+    LLVMBuilderRef builder,
+    LLVMValueRef ptrLE) {
+  auto concreteAsCharPtrLE =
+      LLVMBuildBitCast(
+          builder,
+          ptrLE,
+          LLVMPointerType(LLVMInt8TypeInContext(globalState->context), 0),
+          "concreteCharPtrForFree");
+  LLVMBuildCall(builder, globalState->externs->genFree, &concreteAsCharPtrLE, 1, "");
+}
+
 void innerDeallocateYonder(
     AreaAndFileAndLine from,
     GlobalState* globalState,
@@ -320,7 +373,19 @@ void innerDeallocateYonder(
         "");
   }
 
-  callFree(globalState, builder, controlBlockPtrLE.refLE);
+  if (globalState->opt->allocProfile) {
+    buildAllocProfileNoteFree(globalState, builder, refMT->kind);
+  }
+
+  if (usesArena(globalState, refMT->kind)) {
+    // Nothing to do, the arena frees its objects all at once when it's released.
+  } else if (usesGenHeap(globalState, kindStructsSource, refMT->kind)) {
+    // The gen heap bumps the generation as it frees, so any outstanding weak refs and
+    // generational refs will see the object as dead.
+    callGenFree(globalState, builder, controlBlockPtrLE.refLE);
+  } else {
+    callFree(globalState, builder, controlBlockPtrLE.refLE);
+  }
 
   if (globalState->opt->census) {
     adjustCounter(globalState, builder, globalState->metalCache->i64, globalState->liveHeapObjCounter, -1);
@@ -365,6 +430,224 @@ void fillStaticSizedArray(
   }
 }
 
+// Whether we can fill an array from this generator without calling it, see GeneratorShape.
+static std::optional<GeneratorShape> getBulkFillShape(
+    GlobalState* globalState,
+    IRegion* arrayRegion,
+    Reference* elementType,
+    Reference* generatorType,
+    Prototype* generatorMethod) {
+  if (!globalState->opt->bulkArrayFill ||
+      arrayRegion == globalState->linearRegion ||
+      elementType->ownership != Ownership::SHARE ||
+      elementType->location != Location::INLINE ||
+      generatorMethod->params.empty() ||
+      generatorMethod->params[0] != generatorType) {
+    return std::nullopt;
+  }
+  auto shape = analyzeGeneratorShape(globalState->program, generatorMethod);
+  switch (shape.kind) {
+    case GeneratorShape::Kind::AFFINE_INT: {
+      auto innt = dynamic_cast<Int*>(elementType->kind);
+      if (innt && innt->bits == shape.bits) {
+        return shape;
+      }
+      break;
+    }
+    case GeneratorShape::Kind::CONSTANT_BOOL:
+      if (dynamic_cast<Bool*>(elementType->kind)) {
+        return shape;
+      }
+      break;
+    case GeneratorShape::Kind::CONSTANT_FLOAT:
+      if (dynamic_cast<Float*>(elementType->kind)) {
+        return shape;
+      }
+      break;
+    case GeneratorShape::Kind::COPY_FROM_MEMBER: {
+      auto load = shape.sourceArrayLoad;
+      auto sourceRSAMT = dynamic_cast<RuntimeSizedArrayT*>(load->expectedResultType->kind);
+      if (load->structType == generatorType &&
+          sourceRSAMT &&
+          globalState->getRegion(load->expectedResultType) != globalState->linearRegion &&
+          globalState->program->getRuntimeSizedArray(sourceRSAMT)->elementType == elementType) {
+        return shape;
+      }
+      break;
+    }
+    case GeneratorShape::Kind::OPAQUE:
+      break;
+  }
+  return std::nullopt;
+}
+
+// The element shape would have produced for this index, as elementLT.
+static LLVMValueRef buildBulkFillScalar(
+    GlobalState* globalState,
+    LLVMBuilderRef builder,
+    const GeneratorShape& shape,
+    LLVMTypeRef elementLT,
+    LLVMValueRef indexLE) {
+  switch (shape.kind) {
+    case GeneratorShape::Kind::AFFINE_INT: {
+      if (shape.scale == 0) {
+        return LLVMConstInt(elementLT, shape.offset, false);
+      }
+      auto iLE = LLVMBuildSExtOrBitCast(builder, indexLE, elementLT, "i");
+      auto scaledLE = LLVMBuildMul(builder, iLE, LLVMConstInt(elementLT, shape.scale, false), "scaled");
+      return LLVMBuildAdd(builder, scaledLE, LLVMConstInt(elementLT, shape.offset, false), "element");
+    }
+    case GeneratorShape::Kind::CONSTANT_BOOL:
+      return LLVMConstInt(elementLT, shape.boolValue, false);
+    case GeneratorShape::Kind::CONSTANT_FLOAT:
+      return LLVMConstReal(elementLT, shape.floatValue);
+    default:
+      assert(false);
+      exit(1);
+  }
+}
+
+// Stores shape's elements into [0, sizeLE) of firstElementPtrLE. We don't run any IR
+// optimizations, so nothing would vectorize a scalar loop for us; instead we store 16 bytes at a
+// time, and do the last few elements one by one.
+static void buildBulkFillLoop(
+    GlobalState* globalState,
+    FunctionState* functionState,
+    LLVMBuilderRef builder,
+    const GeneratorShape& shape,
+    LLVMValueRef firstElementPtrLE,
+    LLVMValueRef sizeLE) {
+  auto int32LT = LLVMInt32TypeInContext(globalState->context);
+  auto elementLT = LLVMGetElementType(LLVMTypeOf(firstElementPtrLE));
+  auto elementSizeBytes = LLVMABISizeOfType(globalState->dataLayout, elementLT);
+  auto elementAlignment = LLVMABIAlignmentOfType(globalState->dataLayout, elementLT);
+  int numLanes = std::max<int>(1, 16 / elementSizeBytes);
+  auto vectorLT = LLVMVectorType(elementLT, numLanes);
+
+  std::vector<LLVMValueRef> startLanesLE;
+  for (int lane = 0; lane < numLanes; lane++) {
+    // These fold to constants, since the index is one.
+    startLanesLE.push_back(
+        buildBulkFillScalar(globalState, builder, shape, elementLT, constI32LE(globalState, lane)));
+  }
+  auto startVectorLE = LLVMConstVector(startLanesLE.data(), startLanesLE.size());
+  bool stepping = shape.kind == GeneratorShape::Kind::AFFINE_INT && shape.scale != 0;
+  LLVMValueRef stepVectorLE = nullptr;
+  if (stepping) {
+    std::vector<LLVMValueRef> stepLanesLE(
+        numLanes, LLVMConstInt(elementLT, shape.scale * numLanes, false));
+    stepVectorLE = LLVMConstVector(stepLanesLE.data(), stepLanesLE.size());
+  }
+
+  auto indexPtrLE = makeBackendLocal(functionState, builder, int32LT, "bulkFillIndex", constI32LE(globalState, 0));
+  auto vectorPtrLE = makeBackendLocal(functionState, builder, vectorLT, "bulkFillVector", startVectorLE);
+  auto lastVectorStartLE = LLVMBuildSub(builder, sizeLE, constI32LE(globalState, numLanes), "lastVectorStart");
+  buildWhile(
+      globalState, functionState, builder,
+      [globalState, indexPtrLE, lastVectorStartLE](LLVMBuilderRef conditionBuilder) {
+        auto indexLE = LLVMBuildLoad(conditionBuilder, indexPtrLE, "bulkFillIndex");
+        auto isBeforeEndLE =
+            LLVMBuildICmp(conditionBuilder, LLVMIntSLE, indexLE, lastVectorStartLE, "vectorFits");
+        return wrap(globalState->getRegion(globalState->metalCache->boolRef), globalState->metalCache->boolRef, isBeforeEndLE);
+      },
+      [globalState, indexPtrLE, vectorPtrLE, firstElementPtrLE, vectorLT, elementAlignment, stepVectorLE, numLanes](
+          LLVMBuilderRef bodyBuilder) {
+        auto indexLE = LLVMBuildLoad(bodyBuilder, indexPtrLE, "bulkFillIndex");
+        auto vectorLE = LLVMBuildLoad(bodyBuilder, vectorPtrLE, "bulkFillVector");
+        auto elementPtrLE = LLVMBuildGEP(bodyBuilder, firstElementPtrLE, &indexLE, 1, "elementPtr");
+        auto vectorDestPtrLE =
+            LLVMBuildBitCast(bodyBuilder, elementPtrLE, LLVMPointerType(vectorLT, 0), "vectorPtr");
+        LLVMSetAlignment(LLVMBuildStore(bodyBuilder, vectorLE, vectorDestPtrLE), elementAlignment);
+        if (stepVectorLE) {
+          LLVMBuildStore(bodyBuilder, LLVMBuildAdd(bodyBuilder, vectorLE, stepVectorLE, "nextVector"), vectorPtrLE);
+        }
+        LLVMBuildStore(
+            bodyBuilder,
+            LLVMBuildAdd(bodyBuilder, indexLE, constI32LE(globalState, numLanes), "nextIndex"),
+            indexPtrLE);
+      });
+
+  buildWhile(
+      globalState, functionState, builder,
+      [globalState, indexPtrLE, sizeLE](LLVMBuilderRef conditionBuilder) {
+        auto indexLE = LLVMBuildLoad(conditionBuilder, indexPtrLE, "bulkFillIndex");
+        auto isBeforeEndLE = LLVMBuildICmp(conditionBuilder, LLVMIntSLT, indexLE, sizeLE, "isBeforeEnd");
+        return wrap(globalState->getRegion(globalState->metalCache->boolRef), globalState->metalCache->boolRef, isBeforeEndLE);
+      },
+      [globalState, indexPtrLE, firstElementPtrLE, elementLT, shape](LLVMBuilderRef bodyBuilder) {
+        auto indexLE = LLVMBuildLoad(bodyBuilder, indexPtrLE, "bulkFillIndex");
+        auto elementPtrLE = LLVMBuildGEP(bodyBuilder, firstElementPtrLE, &indexLE, 1, "elementPtr");
+        LLVMBuildStore(bodyBuilder, buildBulkFillScalar(globalState, bodyBuilder, shape, elementLT, indexLE), elementPtrLE);
+        LLVMBuildStore(
+            bodyBuilder,
+            LLVMBuildAdd(bodyBuilder, indexLE, constI32LE(globalState, 1), "nextIndex"),
+            indexPtrLE);
+      });
+}
+
+// Fills [0, sizeLE) of the array's elements from the generator's shape, without calling it.
+static void fillArrayInBulk(
+    GlobalState* globalState,
+    FunctionState* functionState,
+    LLVMBuilderRef builder,
+    const GeneratorShape& shape,
+    Ref generatorLE,
+    LLVMValueRef elementsPtrLE,
+    LLVMValueRef sizeLE) {
+  auto int64LT = LLVMInt64TypeInContext(globalState->context);
+  LLVMValueRef firstIndices[2] = { constI32LE(globalState, 0), constI32LE(globalState, 0) };
+  auto firstElementPtrLE = LLVMBuildGEP(builder, elementsPtrLE, firstIndices, 2, "firstElementPtr");
+  auto elementLT = LLVMGetElementType(LLVMTypeOf(firstElementPtrLE));
+  auto elementSizeBytes = LLVMABISizeOfType(globalState->dataLayout, elementLT);
+  auto elementAlignment = LLVMABIAlignmentOfType(globalState->dataLayout, elementLT);
+  auto numBytesLE =
+      LLVMBuildMul(
+          builder,
+          LLVMBuildZExt(builder, sizeLE, int64LT, ""),
+          constI64LE(globalState, elementSizeBytes),
+          "fillBytes");
+
+  bool allZeroBits =
+      (shape.kind == GeneratorShape::Kind::AFFINE_INT && shape.scale == 0 && shape.offset == 0) ||
+      (shape.kind == GeneratorShape::Kind::CONSTANT_BOOL && !shape.boolValue) ||
+      (shape.kind == GeneratorShape::Kind::CONSTANT_FLOAT &&
+          shape.floatValue == 0 && !std::signbit(shape.floatValue));
+  if (allZeroBits) {
+    LLVMBuildMemSet(builder, firstElementPtrLE, LLVMConstInt(LLVMInt8TypeInContext(globalState->context), 0, false), numBytesLE, elementAlignment);
+  } else if (shape.kind == GeneratorShape::Kind::CONSTANT_BOOL && elementSizeBytes == 1) {
+    LLVMBuildMemSet(builder, firstElementPtrLE, LLVMConstInt(LLVMInt8TypeInContext(globalState->context), 1, false), numBytesLE, elementAlignment);
+  } else if (shape.kind == GeneratorShape::Kind::COPY_FROM_MEMBER) {
+    auto load = shape.sourceArrayLoad;
+    auto sourceArrayRefMT = load->expectedResultType;
+    auto sourceArrayRef =
+        loadMember(
+            AFL("Bulk fill source"), globalState, functionState, builder, load->structType, generatorLE,
+            load->structKnownLive || globalState->opt->overrideKnownLiveTrue,
+            ownershipToMutability(load->structType->ownership), load->expectedMemberType, load->memberIndex,
+            sourceArrayRefMT, load->memberName);
+    auto sourceWrapperPtrLE =
+        WrapperPtrLE(
+            sourceArrayRefMT,
+            globalState->getRegion(sourceArrayRefMT)->checkValidReference(
+                FL(), functionState, builder, sourceArrayRefMT, sourceArrayRef));
+    // The generator would have hit this on the first index past the source's end.
+    auto sourceSizeLE =
+        LLVMBuildLoad(builder, getRuntimeSizedArrayLengthPtr(globalState, builder, sourceWrapperPtrLE), "sourceSize");
+    buildAssert(
+        globalState, functionState, builder,
+        LLVMBuildICmp(builder, LLVMIntSLE, sizeLE, sourceSizeLE, "sourceBigEnough"),
+        "Index out of bounds!");
+    // Only immutable arrays get here, which have no capacity.
+    auto sourceElementsPtrLE = getRuntimeSizedArrayContentsPtr(builder, false, sourceWrapperPtrLE);
+    auto sourceFirstElementPtrLE = LLVMBuildGEP(builder, sourceElementsPtrLE, firstIndices, 2, "sourceFirstElementPtr");
+    LLVMBuildMemCpy(builder, firstElementPtrLE, elementAlignment, sourceFirstElementPtrLE, elementAlignment, numBytesLE);
+    globalState->getRegion(sourceArrayRefMT)->dealias(
+        AFL("Bulk fill source"), functionState, builder, sourceArrayRefMT, sourceArrayRef);
+  } else {
+    buildBulkFillLoop(globalState, functionState, builder, shape, firstElementPtrLE, sizeLE);
+  }
+}
+
 void fillRuntimeSizedArray(
     GlobalState* globalState,
     FunctionState* functionState,
@@ -377,6 +660,27 @@ void fillRuntimeSizedArray(
     Ref generatorLE,
     Ref sizeLE,
     Ref rsaRef) {
+  auto maybeShape =
+      getBulkFillShape(globalState, globalState->getRegion(rsaMT), elementType, generatorType, generatorMethod);
+  if (maybeShape.has_value()) {
+    auto rsaDef = globalState->program->getRuntimeSizedArray(rsaMT);
+    bool capacityExists = rsaDef->mutability == Mutability::MUTABLE;
+    auto rsaWrapperPtrLE =
+        WrapperPtrLE(
+            rsaRefMT,
+            globalState->getRegion(rsaRefMT)->checkValidReference(FL(), functionState, builder, rsaRefMT, rsaRef));
+    auto sizeIntLE =
+        globalState->getRegion(globalState->metalCache->i32Ref)
+            ->checkValidReference(FL(), functionState, builder, globalState->metalCache->i32Ref, sizeLE);
+    fillArrayInBulk(
+        globalState, functionState, builder, *maybeShape, generatorLE,
+        getRuntimeSizedArrayContentsPtr(builder, capacityExists, rsaWrapperPtrLE), sizeIntLE);
+    if (capacityExists) {
+      // Pushing would have counted these up one at a time.
+      LLVMBuildStore(builder, sizeIntLE, getRuntimeSizedArrayLengthPtr(globalState, builder, rsaWrapperPtrLE));
+    }
+    return;
+  }
 
   intRangeLoop(
       globalState, functionState, builder, sizeLE,
@@ -407,6 +711,21 @@ void fillStaticSizedArrayFromCallable(
     Ref generatorLE,
     Ref sizeLE,
     Ref ssaRef) {
+  auto maybeShape =
+      getBulkFillShape(globalState, globalState->getRegion(ssaMT), elementType, generatorType, generatorMethod);
+  if (maybeShape.has_value()) {
+    auto ssaWrapperPtrLE =
+        WrapperPtrLE(
+            ssaRefMT,
+            globalState->getRegion(ssaRefMT)->checkValidReference(FL(), functionState, builder, ssaRefMT, ssaRef));
+    auto sizeIntLE =
+        globalState->getRegion(globalState->metalCache->i32Ref)
+            ->checkValidReference(FL(), functionState, builder, globalState->metalCache->i32Ref, sizeLE);
+    fillArrayInBulk(
+        globalState, functionState, builder, *maybeShape, generatorLE,
+        getStaticSizedArrayContentsPtr(builder, ssaWrapperPtrLE), sizeIntLE);
+    return;
+  }
 
   intRangeLoop(
       globalState, functionState, builder, sizeLE,
@@ -439,6 +758,38 @@ LLVMValueRef callMalloc(
   return LLVMBuildCall(builder, globalState->externs->malloc, &sizeLE, 1, "");
 }
 
+bool usesGenHeap(
+    GlobalState* globalState,
+    KindStructs* kindStructs,
+    Kind* kindM) {
+  return globalState->opt->genHeap &&
+      kindStructs->getControlBlock(kindM)->hasMember(ControlBlockMember::GENERATION_32B);
+}
+
+LLVMValueRef callGenMalloc(
+    GlobalState* globalState,
+    LLVMBuilderRef builder,
+    LLVMValueRef sizeLE) {
+  assert(LLVMTypeOf(sizeLE) == LLVMInt64TypeInContext(globalState->context));
+  return LLVMBuildCall(builder, globalState->externs->genMalloc, &sizeLE, 1, "");
+}
+
+bool usesArena(
+    GlobalState* globalState,
+    Kind* kindM) {
+  auto iter = globalState->regionIdByKind.find(kindM);
+  return iter != globalState->regionIdByKind.end() &&
+      iter->second == globalState->metalCache->arenaRegionId;
+}
+
+LLVMValueRef callArenaMalloc(
+    GlobalState* globalState,
+    LLVMBuilderRef builder,
+    LLVMValueRef sizeLE) {
+  assert(LLVMTypeOf(sizeLE) == LLVMInt64TypeInContext(globalState->context));
+  return LLVMBuildCall(builder, globalState->externs->arenaMalloc, &sizeLE, 1, "");
+}
+
 WrapperPtrLE mallocStr(
     GlobalState* globalState,
     FunctionState* functionState,
@@ -462,6 +813,10 @@ WrapperPtrLE mallocStr(
 
   auto destCharPtrLE =callMalloc(globalState, builder, sizeBytesLE);
 
+  if (globalState->opt->allocProfile) {
+    buildAllocProfileNoteAlloc(globalState, builder, globalState->metalCache->str, sizeBytesLE);
+  }
+
   if (globalState->opt->census) {
     adjustCounter(globalState, builder, globalState->metalCache->i64, globalState->liveHeapObjCounter, 1);
 
@@ -493,8 +848,11 @@ WrapperPtrLE mallocStr(
   auto charsBeginPtr = getCharsPtrFromWrapperPtr(globalState, builder, newStrWrapperPtrLE);
 
 
-  std::vector<LLVMValueRef> strncpyArgsLE = { charsBeginPtr, sourceCharsPtrLE, lenI64LE };
-  LLVMBuildCall(builder, globalState->externs->strncpy, strncpyArgsLE.data(), strncpyArgsLE.size(), "");
+  // A null source means the caller will fill in the chars itself.
+  if (sourceCharsPtrLE) {
+    std::vector<LLVMValueRef> strncpyArgsLE = { charsBeginPtr, sourceCharsPtrLE, lenI64LE };
+    LLVMBuildCall(builder, globalState->externs->strncpy, strncpyArgsLE.data(), strncpyArgsLE.size(), "");
+  }
 
   auto charsEndPtr = LLVMBuildGEP(builder, charsBeginPtr, &lenI32LE, 1, "charsEndPtr");
   LLVMBuildStore(builder, constI8LE(globalState, 0), charsEndPtr);
@@ -508,6 +866,8 @@ LLVMValueRef mallocKnownSize(
     GlobalState* globalState,
     FunctionState* functionState,
     LLVMBuilderRef builder,
+    KindStructs* kindStructs,
+    Kind* kindM,
     Location location,
     LLVMTypeRef kindLT) {
   if (globalState->opt->census) {
@@ -521,7 +881,16 @@ LLVMValueRef mallocKnownSize(
     size_t sizeBytes = LLVMABISizeOfType(globalState->dataLayout, kindLT);
     LLVMValueRef sizeLE = LLVMConstInt(LLVMInt64TypeInContext(globalState->context), sizeBytes, false);
 
-    auto newStructLE = callMalloc(globalState, builder, sizeLE);
+    auto newStructLE =
+        usesArena(globalState, kindM) ?
+        callArenaMalloc(globalState, builder, sizeLE) :
+        usesGenHeap(globalState, kindStructs, kindM) ?
+        callGenMalloc(globalState, builder, sizeLE) :
+        callMalloc(globalState, builder, sizeLE);
+
+    if (globalState->opt->allocProfile) {
+      buildAllocProfileNoteAlloc(globalState, builder, kindM, sizeLE);
+    }
 
     resultPtrLE =
         LLVMBuildBitCast(
@@ -544,6 +913,7 @@ void fillInnerStruct(
     GlobalState* globalState,
     FunctionState* functionState,
     LLVMBuilderRef builder,
+    KindStructs* kindStructs,
     StructDefinition* structM,
     std::vector<Ref> membersLE,
     LLVMValueRef innerStructPtrLE) {
@@ -552,7 +922,9 @@ void fillInnerStruct(
     auto memberType = structM->members[i]->type;
     auto memberName = structM->members[i]->name;
     auto ptrLE =
-        LLVMBuildStructGEP(builder, innerStructPtrLE, i, memberName.c_str());
+        LLVMBuildStructGEP(
+            builder, innerStructPtrLE, kindStructs->getStructMemberLlvmIndex(structM->kind, i),
+            memberName.c_str());
     auto memberLE =
         globalState->getRegion(memberType)
             ->checkValidReference(FL(), functionState, builder, structM->members[i]->type, memberRef);
@@ -572,7 +944,10 @@ Ref constructWrappedStruct(
     std::vector<Ref> membersLE,
     std::function<void(LLVMBuilderRef builder, ControlBlockPtrLE controlBlockPtrLE)> fillControlBlock) {
 
-  auto ptrLE = mallocKnownSize(globalState, functionState, builder, structTypeM->location, structL);
+  auto ptrLE =
+      mallocKnownSize(
+          globalState, functionState, builder, kindStructsSource, structTypeM->kind,
+          structTypeM->location, structL);
 
   WrapperPtrLE newStructWrapperPtrLE =
       kindStructsSource->makeWrapperPtr(
@@ -584,13 +959,31 @@ Ref constructWrappedStruct(
 //      structTypeM->kind,
 //      structM->mutability,
 //      kindStructsSource->getConcreteControlBlockPtr(from, functionState, builder, structTypeM, newStructWrapperPtrLE), structM->name->name);
-  fillControlBlock(
-      builder,
+  auto controlBlockPtrLE =
       kindStructsSource->getConcreteControlBlockPtr(
-          FL(), functionState, builder, structTypeM, newStructWrapperPtrLE));
+          FL(), functionState, builder, structTypeM, newStructWrapperPtrLE);
+  fillControlBlock(builder, controlBlockPtrLE);
+  auto controlBlock = kindStructsSource->getControlBlock(structTypeM->kind);
+  if (structM->edges.size() == 1 && controlBlock->hasMember(ControlBlockMember::ITABLE_PTR)) {
+    // With --thin_interface_refs, references to the interface get the itable from here.
+    auto itableVoidPtrLE =
+        LLVMBuildBitCast(
+            builder,
+            globalState->getInterfaceTablePtr(structM->edges[0]),
+            LLVMPointerType(LLVMInt8TypeInContext(globalState->context), 0),
+            "itableVoidPtr");
+    LLVMBuildStore(
+        builder,
+        itableVoidPtrLE,
+        LLVMBuildStructGEP(
+            builder,
+            controlBlockPtrLE.refLE,
+            controlBlock->getMemberIndex(ControlBlockMember::ITABLE_PTR),
+            "itablePtrPtr"));
+  }
   fillInnerStruct(
       globalState, functionState,
-      builder, structM, membersLE,
+      builder, kindStructsSource, structM, membersLE,
       kindStructsSource->getStructContentsPtr(builder, structTypeM->kind, newStructWrapperPtrLE));
 
   auto refLE = wrap(globalState->getRegion(structTypeM), structTypeM, newStructWrapperPtrLE.refLE);
@@ -612,6 +1005,7 @@ LLVMValueRef constructInnerStruct(
     GlobalState* globalState,
     FunctionState* functionState,
     LLVMBuilderRef builder,
+    KindStructs* kindStructs,
     StructDefinition* structM,
     LLVMTypeRef valStructL,
     const std::vector<Ref>& memberRefs) {
@@ -632,7 +1026,7 @@ LLVMValueRef constructInnerStruct(
             builder,
             structValueBeingInitialized,
             memberLE,
-            i,
+            kindStructs->getStructMemberLlvmIndex(structM->kind, i),
             memberName.c_str());
   }
   return structValueBeingInitialized;
@@ -664,7 +1058,7 @@ Ref innerAllocate(
             kindStructs->getStructInnerStruct(structKind);
         auto innerStructLE =
             constructInnerStruct(
-                globalState, functionState, builder, structM, valStructL, memberRefs);
+                globalState, functionState, builder, kindStructs, structM, valStructL, memberRefs);
         return wrap(globalState->getRegion(desiredReference), desiredReference, innerStructLE);
       } else {
         auto countedStructL =
@@ -704,6 +1098,8 @@ Ref transmuteWeakRef(
 LLVMValueRef mallocRuntimeSizedArray(
     GlobalState* globalState,
     LLVMBuilderRef builder,
+    KindStructs* kindStructs,
+    Kind* kindM,
     LLVMTypeRef rsaWrapperLT,
     LLVMTypeRef rsaElementLT,
     LLVMValueRef lenI32LE) {
@@ -719,7 +1115,16 @@ LLVMValueRef mallocRuntimeSizedArray(
               ""),
           "rsaMallocSizeBytes");
 
-  auto newWrapperPtrLE = callMalloc(globalState, builder, sizeBytesLE);
+  auto newWrapperPtrLE =
+      usesArena(globalState, kindM) ?
+      callArenaMalloc(globalState, builder, sizeBytesLE) :
+      usesGenHeap(globalState, kindStructs, kindM) ?
+      callGenMalloc(globalState, builder, sizeBytesLE) :
+      callMalloc(globalState, builder, sizeBytesLE);
+
+  if (globalState->opt->allocProfile) {
+    buildAllocProfileNoteAlloc(globalState, builder, kindM, sizeBytesLE);
+  }
 
   if (globalState->opt->census) {
     adjustCounter(globalState, builder, globalState->metalCache->i64, globalState->liveHeapObjCounter, 1);
@@ -786,6 +1191,9 @@ ControlBlock makeAssistAndNaiveRCNonWeakableControlBlock(GlobalState* globalStat
     controlBlock.addMember(ControlBlockMember::CENSUS_TYPE_STR);
     controlBlock.addMember(ControlBlockMember::CENSUS_OBJ_ID);
   }
+  if (globalState->opt->thinInterfaceRefs) {
+    controlBlock.addMember(ControlBlockMember::ITABLE_PTR);
+  }
   controlBlock.build();
   return controlBlock;
 }
@@ -837,6 +1245,9 @@ ControlBlock makeFastNonWeakableControlBlock(GlobalState* globalState) {
     controlBlock.addMember(ControlBlockMember::CENSUS_TYPE_STR);
     controlBlock.addMember(ControlBlockMember::CENSUS_OBJ_ID);
   }
+  if (globalState->opt->thinInterfaceRefs) {
+    controlBlock.addMember(ControlBlockMember::ITABLE_PTR);
+  }
   controlBlock.build();
   return controlBlock;
 }
@@ -1120,7 +1531,7 @@ Ref constructStaticSizedArray(
   auto newStructLE =
       kindStructs->makeWrapperPtr(
           FL(), functionState, builder, refM,
-          mallocKnownSize(globalState, functionState, builder, refM->location, structLT));
+          mallocKnownSize(globalState, functionState, builder, kindStructs, ssaMT, refM->location, structLT));
   fillControlBlock(
       builder,
       kindStructs->getConcreteControlBlockPtr(FL(), functionState, builder, refM, newStructLE));
@@ -1140,7 +1551,7 @@ void regularCheckValidReference(
   if (auto interfaceKindM = dynamic_cast<InterfaceKind *>(refM->kind)) {
     auto interfaceFatPtrLE = kindStructs->makeInterfaceFatPtr(checkerAFL, functionState, builder,
         refM, refLE);
-    auto itablePtrLE = getTablePtrFromInterfaceRef(builder, interfaceFatPtrLE);
+    auto itablePtrLE = getTablePtrFromInterfaceRef(builder, kindStructs, interfaceFatPtrLE);
     buildAssertCensusContains(checkerAFL, globalState, functionState, builder, itablePtrLE);
   }
   if (refM->location == Location::INLINE) {
@@ -1311,7 +1722,9 @@ Ref constructRuntimeSizedArray(
   auto capacityLE =
       globalState->getRegion(globalState->metalCache->i32Ref)->checkValidReference(FL(),
           functionState, builder, globalState->metalCache->i32Ref, capacityRef);
-  auto ptrLE = mallocRuntimeSizedArray(globalState, builder, rsaWrapperPtrLT, rsaElementLT, capacityLE);
+  auto ptrLE =
+      mallocRuntimeSizedArray(
+          globalState, builder, kindStructs, rsaMT->kind, rsaWrapperPtrLT, rsaElementLT, capacityLE);
   auto rsaWrapperPtrLE =
       kindStructs->makeWrapperPtr(FL(), functionState, builder, rsaMT, ptrLE);
   fillControlBlock(
@@ -1357,7 +1770,8 @@ LoadResult regularLoadMember(
     return LoadResult{
       wrap(globalState->getRegion(expectedMemberType), expectedMemberType,
         LLVMBuildExtractValue(
-            builder, structRefLE, memberIndex, memberName.c_str()))};
+            builder, structRefLE, kindStructs->getStructMemberLlvmIndex(structRefMT->kind, memberIndex),
+            memberName.c_str()))};
   } else {
     switch (structRefMT->ownership) {
       case Ownership::OWN:
@@ -1391,7 +1805,8 @@ LoadResult resilientLoadWeakMember(
   auto innerStructPtrLE = kindStructs->getStructContentsPtr(builder,
       structRefMT->kind, wrapperPtrLE);
   return loadInnerInnerStructMember(
-      globalState, functionState, builder, innerStructPtrLE, memberIndex, expectedMemberType, memberName);
+      globalState, functionState, builder, innerStructPtrLE,
+      kindStructs->getStructMemberLlvmIndex(structRefMT->kind, memberIndex), expectedMemberType, memberName);
 }
 
 Ref upcastStrong(
@@ -1551,7 +1966,7 @@ void gmFillControlBlock(
       fillControlBlockCensusFields(
           from, globalState, functionState, structs, builder, kindM, newControlBlockLE, typeName);
   newControlBlockLE = hgmWeaks->fillWeakableControlBlock(functionState, builder, kindM,
-      newControlBlockLE);
+      controlBlockPtrLE, newControlBlockLE);
   LLVMBuildStore(
       builder,
       newControlBlockLE,
@@ -1609,7 +2024,8 @@ LoadResult regularLoadStrongMember(
 
   auto memberLE =
       loadInnerInnerStructMember(
-          globalState, functionState, builder, innerStructPtrLE, memberIndex, expectedMemberType,
+          globalState, functionState, builder, innerStructPtrLE,
+          kindStructs->getStructMemberLlvmIndex(structRefMT->kind, memberIndex), expectedMemberType,
           memberName);
   return memberLE;
 }
@@ -1629,7 +2045,7 @@ std::tuple<LLVMValueRef, LLVMValueRef> explodeStrongInterfaceRef(
   auto virtualArgInterfaceFatPtrLE =
       kindStructs->makeInterfaceFatPtr(
           FL(), functionState, builder, virtualParamMT, virtualArgLE);
-  itablePtrLE = getItablePtrFromInterfacePtr(globalState, functionState, builder,
+  itablePtrLE = getItablePtrFromInterfacePtr(globalState, functionState, builder, kindStructs,
       virtualParamMT, virtualArgInterfaceFatPtrLE);
   buildFlare(FL(), globalState, functionState, builder);
   auto objVoidPtrLE =
@@ -1664,7 +2080,7 @@ std::tuple<LLVMValueRef, LLVMValueRef> explodeWeakInterfaceRef(
           FL(), functionState, builder, virtualParamMT,
           fatWeaks->getInnerRefFromWeakRef(
               functionState, builder, virtualParamMT, weakFatPtrLE));
-  itablePtrLE = getTablePtrFromInterfaceRef(builder, interfaceRefLE);
+  itablePtrLE = getTablePtrFromInterfaceRef(builder, kindStructs, interfaceRefLE);
   // Now, reassemble a weak void* ref to the struct.
   auto weakVoidStructRefLE = weakInterfaceRefToWeakStructRef(weakFatPtrLE);
   objPtrLE = weakVoidStructRefLE.refLE;
@@ -1765,7 +2181,9 @@ void storeMemberStrong(
           globalState->getRegion(structRefMT)->checkValidReference(
               FL(), functionState, builder, structRefMT, structRef));
   innerStructPtrLE = kindStructs->getStructContentsPtr(builder, structRefMT->kind, wrapperPtrLE);
-  storeInnerInnerStructMember(builder, innerStructPtrLE, memberIndex, memberName, newValueLE);
+  storeInnerInnerStructMember(
+      builder, innerStructPtrLE, kindStructs->getStructMemberLlvmIndex(structRefMT->kind, memberIndex),
+      memberName, newValueLE);
 }
 
 void storeMemberWeak(
@@ -1784,7 +2202,9 @@ void storeMemberWeak(
       globalState->getRegion(structRefMT)->lockWeakRef(
           FL(), functionState, builder, structRefMT, structRef, structKnownLive);
   innerStructPtrLE = kindStructs->getStructContentsPtr(builder, structRefMT->kind, wrapperPtrLE);
-  storeInnerInnerStructMember(builder, innerStructPtrLE, memberIndex, memberName, newValueLE);
+  storeInnerInnerStructMember(
+      builder, innerStructPtrLE, kindStructs->getStructMemberLlvmIndex(structRefMT->kind, memberIndex),
+      memberName, newValueLE);
 }
 
 LLVMValueRef getInterfaceMethodFunctionPtrFromItable(
@@ -1846,6 +2266,40 @@ void initializeElementInRSA(
   }
 }
 
+void migrateElementsInRSA(
+    GlobalState* globalState,
+    FunctionState* functionState,
+    LLVMBuilderRef builder,
+    WrapperPtrLE sourceWrapperPtrLE,
+    WrapperPtrLE targetWrapperPtrLE) {
+  auto sourceSizePtrLE = ::getRuntimeSizedArrayLengthPtr(globalState, builder, sourceWrapperPtrLE);
+  auto targetSizePtrLE = ::getRuntimeSizedArrayLengthPtr(globalState, builder, targetWrapperPtrLE);
+  auto sourceSizeLE = LLVMBuildLoad(builder, sourceSizePtrLE, "sourceSize");
+  auto targetSizeLE = LLVMBuildLoad(builder, targetSizePtrLE, "targetSize");
+  auto sourceElemsPtrLE = getRuntimeSizedArrayContentsPtr(builder, true, sourceWrapperPtrLE);
+  auto targetElemsPtrLE = getRuntimeSizedArrayContentsPtr(builder, true, targetWrapperPtrLE);
+
+  // The elements are just references (or inline primitives), so moving them is moving their bits.
+  auto elementLT = LLVMGetElementType(LLVMGetElementType(LLVMTypeOf(sourceElemsPtrLE)));
+  auto elementSizeBytes = LLVMABISizeOfType(globalState->dataLayout, elementLT);
+  auto elementAlignment = LLVMABIAlignmentOfType(globalState->dataLayout, elementLT);
+
+  LLVMValueRef sourceIndices[2] = { constI32LE(globalState, 0), constI32LE(globalState, 0) };
+  auto sourceFirstPtrLE = LLVMBuildGEP(builder, sourceElemsPtrLE, sourceIndices, 2, "sourceFirstPtr");
+  LLVMValueRef targetIndices[2] = { constI32LE(globalState, 0), targetSizeLE };
+  auto targetEndPtrLE = LLVMBuildGEP(builder, targetElemsPtrLE, targetIndices, 2, "targetEndPtr");
+  auto numBytesLE =
+      LLVMBuildMul(
+          builder,
+          LLVMBuildZExt(builder, sourceSizeLE, LLVMInt64TypeInContext(globalState->context), ""),
+          constI64LE(globalState, elementSizeBytes),
+          "migrateBytes");
+  LLVMBuildMemCpy(builder, targetEndPtrLE, elementAlignment, sourceFirstPtrLE, elementAlignment, numBytesLE);
+
+  LLVMBuildStore(builder, LLVMBuildAdd(builder, targetSizeLE, sourceSizeLE, "newTargetSize"), targetSizePtrLE);
+  LLVMBuildStore(builder, constI32LE(globalState, 0), sourceSizePtrLE);
+}
+
 Ref normalLocalLoad(GlobalState* globalState, FunctionState* functionState, LLVMBuilderRef builder, Local* local, LLVMValueRef localAddr) {
   auto region = globalState->getRegion(local->type);
   auto sourceLE = LLVMBuildLoad(builder, localAddr, local->id->maybeName.c_str());
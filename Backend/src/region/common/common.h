@@ -43,15 +43,16 @@ LLVMTypeRef translateWeakReference(GlobalState* globalState, KindStructs* weakRe
 LoadResult loadInnerInnerStructMember(
     GlobalState* globalState,
   FunctionState* functionState,
-    LLVMBuilderRef builder, LLVMValueRef innerStructPtrLE, int memberIndex, Reference* expectedType, std::string memberName);
+    LLVMBuilderRef builder, LLVMValueRef innerStructPtrLE, int memberLlvmIndex, Reference* expectedType, std::string memberName);
 void storeInnerInnerStructMember(
-    LLVMBuilderRef builder, LLVMValueRef innerStructPtrLE, int memberIndex, std::string memberName, LLVMValueRef newValueLE);
+    LLVMBuilderRef builder, LLVMValueRef innerStructPtrLE, int memberLlvmIndex, std::string memberName, LLVMValueRef newValueLE);
 
 
 LLVMValueRef getItablePtrFromInterfacePtr(
     GlobalState* globalState,
     FunctionState* functionState,
     LLVMBuilderRef builder,
+    KindStructs* structs,
     Reference* virtualParamMT,
     InterfaceFatPtrLE virtualArgLE);
 
@@ -109,10 +110,18 @@ LLVMValueRef makeInterfaceRefStruct(
     LLVMValueRef objControlBlockPtrLE,
     LLVMValueRef itablePtrLE);
 
+// Only for layouts that always keep the itable in the reference, like linear's.
 LLVMValueRef getTablePtrFromInterfaceRef(
     LLVMBuilderRef builder,
     InterfaceFatPtrLE interfaceFatPtrLE);
 
+// Gets the itable from the reference, or from the object's header if it's a thin interface, see
+// KindStructs::isThinInterface.
+LLVMValueRef getTablePtrFromInterfaceRef(
+    LLVMBuilderRef builder,
+    KindStructs* structs,
+    InterfaceFatPtrLE interfaceFatPtrLE);
+
 LLVMValueRef getObjPtrFromInterfaceRef(
     LLVMBuilderRef builder,
     InterfaceFatPtrLE interfaceRefLE);
@@ -159,6 +168,29 @@ LLVMValueRef callMalloc(
     LLVMBuilderRef builder,
     LLVMValueRef sizeLE);
 
+// Whether objects of this kind come from the generational heap (see builtins/genheap.c)
+// rather than malloc. Only kinds whose control block starts with a generation qualify.
+bool usesGenHeap(
+    GlobalState* globalState,
+    KindStructs* kindStructs,
+    Kind* kindM);
+
+LLVMValueRef callGenMalloc(
+    GlobalState* globalState,
+    LLVMBuilderRef builder,
+    LLVMValueRef sizeLE);
+
+// Whether objects of this kind live in the arena region, so come from builtins/arena.c and are
+// never freed individually.
+bool usesArena(
+    GlobalState* globalState,
+    Kind* kindM);
+
+LLVMValueRef callArenaMalloc(
+    GlobalState* globalState,
+    LLVMBuilderRef builder,
+    LLVMValueRef sizeLE);
+
 WrapperPtrLE mallocStr(
     GlobalState* globalState,
     FunctionState* functionState,
@@ -171,12 +203,15 @@ LLVMValueRef mallocKnownSize(
     GlobalState* globalState,
     FunctionState* functionState,
     LLVMBuilderRef builder,
+    KindStructs* kindStructs,
+    Kind* kindM,
     Location location,
     LLVMTypeRef kindLT);
 void fillInnerStruct(
     GlobalState* globalState,
     FunctionState* functionState,
     LLVMBuilderRef builder,
+    KindStructs* kindStructs,
     StructDefinition* structM,
     std::vector<Ref> membersLE,
     LLVMValueRef innerStructPtrLE);
@@ -195,6 +230,7 @@ LLVMValueRef constructInnerStruct(
     GlobalState* globalState,
     FunctionState* functionState,
     LLVMBuilderRef builder,
+    KindStructs* kindStructs,
     StructDefinition* structM,
     LLVMTypeRef valStructL,
     const std::vector<Ref>& memberRefs);
@@ -221,6 +257,8 @@ Ref transmuteWeakRef(
 LLVMValueRef mallocRuntimeSizedArray(
     GlobalState* globalState,
     LLVMBuilderRef builder,
+    KindStructs* kindStructs,
+    Kind* kindM,
     LLVMTypeRef rsaWrapperLT,
     LLVMTypeRef rsaElementLT,
     LLVMValueRef lengthLE);
@@ -587,6 +625,11 @@ void callFree(
     LLVMBuilderRef builder,
     LLVMValueRef ptrLE);
 
+void callGenFree(
+    GlobalState* globalState,
+    LLVMBuilderRef builder,
+    LLVMValueRef ptrLE);
+
 
 LLVMValueRef getInterfaceMethodFunctionPtrFromItable(
     GlobalState* globalState,
@@ -610,6 +653,15 @@ void initializeElementInRSA(
     Ref indexRef,
     Ref elementRef);
 
+// Moves all of the source RSA's elements onto the end of the target RSA with one memcpy, and
+// sets the source's length to zero. Both must have a capacity, and the target must have room.
+void migrateElementsInRSA(
+    GlobalState* globalState,
+    FunctionState* functionState,
+    LLVMBuilderRef builder,
+    WrapperPtrLE sourceWrapperPtrLE,
+    WrapperPtrLE targetWrapperPtrLE);
+
 Ref normalLocalLoad(
     GlobalState* globalState, FunctionState* functionState, LLVMBuilderRef builder, Local* local, LLVMValueRef localAddr);
 
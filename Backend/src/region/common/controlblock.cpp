@@ -18,9 +18,61 @@ LLVMValueRef getTypeNameStrPtrFromControlBlockPtr(
       "typeNameStrPtr");
 }
 
+static bool isControlBlockMember32B(ControlBlockMember member) {
+  switch (member) {
+    case ControlBlockMember::UNUSED_32B:
+    case ControlBlockMember::LGTI_32B:
+    case ControlBlockMember::GENERATION_32B:
+    case ControlBlockMember::WRCI_32B:
+    case ControlBlockMember::STRONG_RC_32B:
+    case ControlBlockMember::TETHER_32B:
+      return true;
+    case ControlBlockMember::CENSUS_TYPE_STR:
+    case ControlBlockMember::CENSUS_OBJ_ID:
+    case ControlBlockMember::ITABLE_PTR:
+      return false;
+  }
+  assert(false);
+  return false;
+}
+
+// Packs the members into as few words as we can. We drop the UNUSED_32B fillers, then put the
+// 32-bit members first (the generation at the very top, see hgm) and the 64-bit ones after, so
+// the only padding left is one 32-bit hole when there's an odd number of 32-bit members and some
+// 64-bit ones. For example, naive-rc's weakable block goes from strong RC, unused, WRCI (12
+// bytes) to strong RC, WRCI (8 bytes).
+static std::vector<ControlBlockMember> packControlBlockMembers(
+    const std::vector<ControlBlockMember>& members) {
+  std::vector<ControlBlockMember> packed;
+  for (auto member : members) {
+    if (member == ControlBlockMember::GENERATION_32B) {
+      packed.push_back(member);
+    }
+  }
+  for (auto member : members) {
+    if (isControlBlockMember32B(member) &&
+        member != ControlBlockMember::GENERATION_32B &&
+        member != ControlBlockMember::UNUSED_32B) {
+      packed.push_back(member);
+    }
+  }
+  for (auto member : members) {
+    if (!isControlBlockMember32B(member)) {
+      packed.push_back(member);
+    }
+  }
+  // Keep at least one word, so that even an empty struct has a nonzero size and a unique address.
+  if (packed.empty()) {
+    packed.push_back(ControlBlockMember::UNUSED_32B);
+  }
+  return packed;
+}
+
 void ControlBlock::build() {
   assert(!built);
 
+  members = packControlBlockMembers(members);
+
 //    auto voidLT = LLVMVoidTypeInContext(globalState->context);
   auto int1LT = LLVMInt1TypeInContext(globalState->context);
   auto int8LT = LLVMInt8TypeInContext(globalState->context);
@@ -58,6 +110,9 @@ void ControlBlock::build() {
       case ControlBlockMember::CENSUS_TYPE_STR:
         membersL.push_back(int8PtrLT);
         break;
+      case ControlBlockMember::ITABLE_PTR:
+        membersL.push_back(int8PtrLT);
+        break;
     }
   }
 
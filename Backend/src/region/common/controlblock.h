@@ -13,6 +13,8 @@ class FunctionState;
 constexpr int GENERATION_NUM_BITS = 32;
 
 enum class ControlBlockMember {
+  // Filler that kept the other members where older layouts expected them. build() packs the
+  // control block and drops these.
   UNUSED_32B,
   LGTI_32B,
   GENERATION_32B,
@@ -23,11 +25,16 @@ enum class ControlBlockMember {
   // It's 32B because we put it in the spot where the generational heap puts its size,
   // like we do with the UNUSED_32B elsewhere.
   TETHER_32B,
+  // Only with --thin_interface_refs. The itable for the one interface this object's struct
+  // implements, so that interface's references can be just the object pointer. It's an i8*,
+  // since every interface's itable is a different type. See KindStructs::isThinInterface.
+  ITABLE_PTR,
 };
 
 class ControlBlock {
 public:
-  // structL should *not* have a body yet, this will fill it.
+  // structL should *not* have a body yet, this will fill it. build() may put the members in a
+  // different order than they were added, so always go through getMemberIndex.
   ControlBlock(GlobalState* globalState_, LLVMTypeRef structL_) :
       globalState(globalState_),
       structL(structL_),
@@ -43,6 +50,15 @@ public:
     assert(false);
   }
 
+  bool hasMember(ControlBlockMember member) {
+    for (auto m : members) {
+      if (m == member) {
+        return true;
+      }
+    }
+    return false;
+  }
+
   void addMember(ControlBlockMember member) {
     assert(!built);
     members.push_back(member);
@@ -1,4 +1,5 @@
 
+#include <algorithm>
 #include "../common.h"
 #include "../../../function/expressions/shared/shared.h"
 #include "../../../function/expressions/shared/string.h"
@@ -24,7 +25,8 @@ KindStructs::KindStructs(
       staticSizedArrayWeakRefStructs(0, globalState_->addressNumberer->makeHasher<StaticSizedArrayT*>()),
       runtimeSizedArrayWeakRefStructs(0, globalState_->addressNumberer->makeHasher<RuntimeSizedArrayT*>()),
       interfaceTableStructs(0, globalState_->addressNumberer->makeHasher<InterfaceKind*>()),
-      interfaceRefStructs(0, globalState_->addressNumberer->makeHasher<InterfaceKind*>()) {
+      interfaceRefStructs(0, globalState_->addressNumberer->makeHasher<InterfaceKind*>()),
+      thinInterfaces(0, globalState_->addressNumberer->makeHasher<InterfaceKind*>()) {
 
 //  auto voidLT = LLVMVoidTypeInContext(globalState->context);
   auto int8LT = LLVMInt8TypeInContext(globalState->context);
@@ -89,6 +91,14 @@ LLVMTypeRef KindStructs::getStructInnerStruct(StructKind* structKind) {
   assert(structIter != structInnerStructs.end());
   return structIter->second;
 }
+int KindStructs::getStructMemberLlvmIndex(Kind* structKind, int memberIndex) {
+  auto structMT = dynamic_cast<StructKind*>(structKind);
+  assert(structMT);
+  auto iter = structMemberLlvmIndices.find(structMT->fullName->name);
+  assert(iter != structMemberLlvmIndices.end());
+  assert(memberIndex >= 0 && memberIndex < iter->second.size());
+  return iter->second[memberIndex];
+}
 LLVMTypeRef KindStructs::getWrapperStruct(Kind* kind) {
   if (auto structMT = dynamic_cast<StructKind*>(kind)) {
     return getStructWrapperStruct(structMT);
@@ -122,6 +132,10 @@ LLVMTypeRef KindStructs::getInterfaceRefStruct(InterfaceKind* interfaceKind) {
   assert(structIter != interfaceRefStructs.end());
   return structIter->second;
 }
+bool KindStructs::isThinInterface(InterfaceKind* interfaceKind) {
+  assert(interfaceRefStructs.count(interfaceKind));
+  return thinInterfaces.count(interfaceKind) != 0;
+}
 LLVMTypeRef KindStructs::getInterfaceTableStruct(InterfaceKind* interfaceKind) {
   auto structIter = interfaceTableStructs.find(interfaceKind);
   assert(structIter != interfaceTableStructs.end());
@@ -178,15 +192,67 @@ void KindStructs::declareStruct(StructKind* structM, Weakability weakable) {
   }
 }
 
+// C code sees exported and extern structs' layouts, so those keep their declared order.
+static bool structLayoutIsFixed(GlobalState* globalState, StructKind* structKind) {
+  for (auto [packageCoord, package] : globalState->program->packages) {
+    if (package->kindToExportName.count(structKind) || package->kindToExternName.count(structKind)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Returns, for each member, which field of the inner struct it should live in. We sort the
+// members by descending alignment (keeping declaration order among equals), so that e.g. an
+// i8, i64, i8 struct becomes i64, i8, i8 and takes 16 bytes instead of 24.
+static std::vector<int> layOutStructMembers(
+    GlobalState* globalState,
+    StructKind* structKind,
+    const std::vector<LLVMTypeRef>& membersLT) {
+  std::vector<int> memberLlvmIndices;
+  for (int i = 0; i < membersLT.size(); i++) {
+    memberLlvmIndices.push_back(i);
+  }
+  if (structLayoutIsFixed(globalState, structKind)) {
+    return memberLlvmIndices;
+  }
+  for (auto memberLT : membersLT) {
+    // An inline struct that isn't defined yet has no alignment to ask about.
+    if (!LLVMTypeIsSized(memberLT)) {
+      return memberLlvmIndices;
+    }
+  }
+
+  std::vector<int> membersInLayoutOrder = memberLlvmIndices;
+  std::stable_sort(
+      membersInLayoutOrder.begin(), membersInLayoutOrder.end(),
+      [globalState, &membersLT](int a, int b) {
+        return LLVMABIAlignmentOfType(globalState->dataLayout, membersLT[a]) >
+            LLVMABIAlignmentOfType(globalState->dataLayout, membersLT[b]);
+      });
+  for (int fieldIndex = 0; fieldIndex < membersInLayoutOrder.size(); fieldIndex++) {
+    memberLlvmIndices[membersInLayoutOrder[fieldIndex]] = fieldIndex;
+  }
+  return memberLlvmIndices;
+}
+
 void KindStructs::defineStruct(
     StructKind* structKind,
     std::vector<LLVMTypeRef> membersLT) {
   assert(weakRefHeaderStructL);
   Weakability weakable = structIsWeakable(structKind);
 
+  std::vector<int> memberLlvmIndices = layOutStructMembers(globalState, structKind, membersLT);
+  std::vector<LLVMTypeRef> fieldsLT(membersLT.size(), nullptr);
+  for (int i = 0; i < membersLT.size(); i++) {
+    fieldsLT[memberLlvmIndices[i]] = membersLT[i];
+  }
+  assert(structMemberLlvmIndices.count(structKind->fullName->name) == 0);
+  structMemberLlvmIndices.emplace(structKind->fullName->name, std::move(memberLlvmIndices));
+
   LLVMTypeRef valStructL = getStructInnerStruct(structKind);
   LLVMStructSetBody(
-      valStructL, membersLT.data(), membersLT.size(), false);
+      valStructL, fieldsLT.data(), fieldsLT.size(), false);
 
   LLVMTypeRef wrapperStructL = getStructWrapperStruct(structKind);
   std::vector<LLVMTypeRef> wrapperStructMemberTypesL;
@@ -273,13 +339,26 @@ void KindStructs::declareInterface(InterfaceKind* interface, Weakability weakabl
       LLVMStructCreateNamed(
           globalState->context, interface->fullName->name.c_str());
 
+  // With --thin_interface_refs, the itable can live in the object's header instead, as long as
+  // every object behind this interface has the control block with room for it. See
+  // findFatInterfaces for which interfaces can't.
+  bool thin =
+      weakable == Weakability::NON_WEAKABLE &&
+      nonWeakableControlBlock.hasMember(ControlBlockMember::ITABLE_PTR) &&
+      globalState->fatInterfaces.count(interface) == 0;
+  if (thin) {
+    thinInterfaces.insert(interface);
+  }
+
   std::vector<LLVMTypeRef> refStructMemberTypesL;
 
   // this points to the control block.
   // It makes it easier to increment and decrement ref counts.
   refStructMemberTypesL.push_back(LLVMPointerType(weakable == Weakability::WEAKABLE ? weakableControlBlock.getStruct() : nonWeakableControlBlock.getStruct(), 0));
 
-  refStructMemberTypesL.push_back(LLVMPointerType(interfaceTableStructL, 0));
+  if (!thin) {
+    refStructMemberTypesL.push_back(LLVMPointerType(interfaceTableStructL, 0));
+  }
   LLVMStructSetBody(
       interfaceRefStructL,
       refStructMemberTypesL.data(),
@@ -542,8 +621,11 @@ InterfaceFatPtrLE KindStructs::makeInterfaceFatPtrWithoutChecking(
 
   auto interfaceFatPtrLE = InterfaceFatPtrLE(referenceM_, ptrLE);
 
-  auto itablePtrLE = getTablePtrFromInterfaceRef(builder, interfaceFatPtrLE);
-  buildAssertCensusContains(checkerAFL, globalState, functionState, builder, itablePtrLE);
+  if (globalState->opt->census) {
+    // Only when we're checking, since for a thin interface this is a load from the object.
+    auto itablePtrLE = getTablePtrFromInterfaceRef(builder, this, interfaceFatPtrLE);
+    buildAssertCensusContains(checkerAFL, globalState, functionState, builder, itablePtrLE);
+  }
 
   return interfaceFatPtrLE;
 }
@@ -771,6 +853,7 @@ LLVMValueRef KindStructs::getStrongRcFromControlBlockPtr(
     case RegionOverride::NAIVE_RC:
       break;
     case RegionOverride::FAST:
+    case RegionOverride::ARENA:
       assert(refM->ownership == Ownership::SHARE);
       break;
     case RegionOverride::RESILIENT_V3: case RegionOverride::RESILIENT_V4:
@@ -794,6 +877,7 @@ LLVMValueRef KindStructs::getStrongRcPtrFromControlBlockPtr(
     case RegionOverride::NAIVE_RC:
       break;
     case RegionOverride::FAST:
+    case RegionOverride::ARENA:
       assert(refM->ownership == Ownership::SHARE);
       break;
     case RegionOverride::RESILIENT_V3: case RegionOverride::RESILIENT_V4:
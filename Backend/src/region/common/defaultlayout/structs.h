@@ -23,8 +23,15 @@ public:
   LLVMTypeRef getRuntimeSizedArrayWrapperStruct(RuntimeSizedArrayT* rsaMT);
   LLVMTypeRef getInterfaceRefStruct(InterfaceKind* interfaceKind);
   LLVMTypeRef getInterfaceTableStruct(InterfaceKind* interfaceKind);
+  // Whether this interface's references are just the control block pointer, because the itable
+  // is in the object's header instead. See ControlBlockMember::ITABLE_PTR.
+  bool isThinInterface(InterfaceKind* interfaceKind);
 
+  // Unless the struct is exported or extern, this lays its members out in a different order than
+  // membersLT, to cut down on padding. Use getStructMemberLlvmIndex to find a member's field.
   void defineStruct(StructKind* structM, std::vector<LLVMTypeRef> membersLT);
+  // The index of the inner struct's field that holds the given member.
+  int getStructMemberLlvmIndex(Kind* structKind, int memberIndex);
   void declareStruct(StructKind* structM, Weakability weakable);
   void declareEdge(Edge* edge);
   void defineEdge(
@@ -239,10 +246,14 @@ private:
   // These contain a pointer to the interface table struct below and a void*
   // to the underlying struct.
   std::unordered_map<InterfaceKind*, LLVMTypeRef, AddressHasher<InterfaceKind*>> interfaceRefStructs;
+  // The interfaces whose ref structs above have only the control block pointer.
+  std::unordered_set<InterfaceKind*, AddressHasher<InterfaceKind*>> thinInterfaces;
   // These don't have a ref count.
   // They're used directly for inl imm references, and
   // also used inside the below wrapperStructs.
   std::unordered_map<std::string, LLVMTypeRef> structInnerStructs;
+  // For each struct, maps each member's index to the inner struct field that holds it.
+  std::unordered_map<std::string, std::vector<int>> structMemberLlvmIndices;
   // These contain a ref count and the above val struct. Yon references
   // point to these.
   std::unordered_map<std::string, LLVMTypeRef> structWrapperStructs;
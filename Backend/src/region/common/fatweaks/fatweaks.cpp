@@ -21,6 +21,7 @@ LLVMValueRef FatWeaks::getInnerRefFromWeakRef(
               weakRefM->ownership == Ownership::WEAK);
       break;
     case RegionOverride::FAST:
+    case RegionOverride::ARENA:
     case RegionOverride::NAIVE_RC:
     case RegionOverride::ASSIST:
       assert(weakRefM->ownership == Ownership::WEAK);
@@ -50,6 +51,7 @@ LLVMValueRef FatWeaks::getInnerRefFromWeakRefWithoutCheck(
               weakRefM->ownership == Ownership::WEAK);
       break;
     case RegionOverride::FAST:
+    case RegionOverride::ARENA:
     case RegionOverride::NAIVE_RC:
     case RegionOverride::ASSIST:
       assert(weakRefM->ownership == Ownership::WEAK);
@@ -81,6 +81,7 @@ WeakFatPtrLE HybridGenerationalMemory::weakStructPtrToGenWeakInterfacePtr(
       // continue
       break;
     case RegionOverride::FAST:
+    case RegionOverride::ARENA:
     case RegionOverride::NAIVE_RC:
     case RegionOverride::ASSIST:
       assert(false);
@@ -369,7 +370,21 @@ LLVMValueRef HybridGenerationalMemory::fillWeakableControlBlock(
     FunctionState* functionState,
     LLVMBuilderRef builder,
     Kind* kindM,
+    ControlBlockPtrLE controlBlockPtrLE,
     LLVMValueRef controlBlockLE) {
+  if (globalState->opt->genHeap) {
+    // The gen heap incremented the generation when we freed it (or set it when it handed
+    // out the slot for the first time), and we're about to overwrite the whole control block,
+    // so carry the current generation over into the new one.
+    auto generationLE =
+        getGenerationFromControlBlockPtr(globalState, builder, kindStructs, kindM, controlBlockPtrLE);
+    return LLVMBuildInsertValue(
+        builder,
+        controlBlockLE,
+        generationLE,
+        kindStructs->getControlBlock(kindM)->getMemberIndex(ControlBlockMember::GENERATION_32B),
+        "controlBlockWithGen");
+  }
   // The generation was already incremented when we freed it (or malloc'd it for the first time),
   // so nothing to do here!
   return controlBlockLE;
@@ -434,7 +449,7 @@ void HybridGenerationalMemory::buildCheckWeakRef(
     if (auto interfaceKindM = dynamic_cast<InterfaceKind *>(weakRefM->kind)) {
       auto interfaceFatPtrLE = kindStructs->makeInterfaceFatPtrWithoutChecking(FL(),
           functionState, builder, weakRefM, innerLE);
-      auto itablePtrLE = getTablePtrFromInterfaceRef(builder, interfaceFatPtrLE);
+      auto itablePtrLE = getTablePtrFromInterfaceRef(builder, kindStructs, interfaceFatPtrLE);
       buildAssertCensusContains(FL(), globalState, functionState, builder, itablePtrLE);
     }
   }
@@ -144,6 +144,7 @@ public:
       FunctionState* functionState,
       LLVMBuilderRef builder,
       Kind* kindM,
+      ControlBlockPtrLE controlBlockPtrLE,
       LLVMValueRef controlBlockLE);
 
   WeakFatPtrLE weakInterfaceRefToWeakStructRef(
@@ -36,6 +36,7 @@ void LgtWeaks::buildCheckLgti(
     LLVMValueRef lgtiLE) {
   switch (globalState->opt->regionOverride) {
     case RegionOverride::FAST:
+    case RegionOverride::ARENA:
     case RegionOverride::NAIVE_RC:
     case RegionOverride::ASSIST:
       // These dont have LGT
@@ -139,6 +140,10 @@ LgtWeaks::LgtWeaks(
 
   lgtTablePtrLE = LLVMAddGlobal(globalState->mod, globalState->lgtTableStructLT, "__lgt_table");
   LLVMSetLinkage(lgtTablePtrLE, LLVMExternalLinkage);
+  if (globalState->opt->threadsafeImms) {
+    // Mutables never leave their thread, so each thread can have its own table.
+    LLVMSetThreadLocal(lgtTablePtrLE, true);
+  }
   std::vector<LLVMValueRef> wrcTableMembers = {
       constI32LE(globalState, 0),
       constI32LE(globalState, 0),
@@ -181,6 +186,7 @@ WeakFatPtrLE LgtWeaks::weakStructPtrToLgtiWeakInterfacePtr(
     Reference* targetInterfaceTypeM) {
   switch (globalState->opt->regionOverride) {
     case RegionOverride::FAST:
+    case RegionOverride::ARENA:
     case RegionOverride::NAIVE_RC:
     case RegionOverride::ASSIST:
     case RegionOverride::RESILIENT_V3: case RegionOverride::RESILIENT_V4:
@@ -553,7 +559,7 @@ void LgtWeaks::buildCheckWeakRef(
     auto interfaceFatPtrLE =
         kindStructsSource->makeInterfaceFatPtrWithoutChecking(
             checkerAFL, functionState, builder, weakRefM, innerLE);
-    auto itablePtrLE = getTablePtrFromInterfaceRef(builder, interfaceFatPtrLE);
+    auto itablePtrLE = getTablePtrFromInterfaceRef(builder, kindStructsSource, interfaceFatPtrLE);
     buildAssertCensusContains(checkerAFL, globalState, functionState, builder, itablePtrLE);
   }
 }
@@ -27,6 +27,7 @@ void WrcWeaks::buildCheckWrc(
     LLVMValueRef wrciLE) {
   switch (globalState->opt->regionOverride) {
     case RegionOverride::FAST:
+    case RegionOverride::ARENA:
     case RegionOverride::NAIVE_RC:
     case RegionOverride::ASSIST:
       // fine, proceed
@@ -125,6 +126,11 @@ WrcWeaks::WrcWeaks(GlobalState *globalState_, KindStructs* kindStructsSource_, K
 
   wrcTablePtrLE = LLVMAddGlobal(globalState->mod, globalState->wrcTableStructLT, "__wrc_table");
   LLVMSetLinkage(wrcTablePtrLE, LLVMExternalLinkage);
+  if (globalState->opt->threadsafeImms) {
+    // Mutables never leave their thread, so each thread can have its own table. It starts
+    // empty and grows on first use, like the main thread's.
+    LLVMSetThreadLocal(wrcTablePtrLE, true);
+  }
   std::vector<LLVMValueRef> wrcTableMembers = {
       constI32LE(globalState, 0),
       constI32LE(globalState, 0),
@@ -178,6 +184,7 @@ WeakFatPtrLE WrcWeaks::weakStructPtrToWrciWeakInterfacePtr(
 
   switch (globalState->opt->regionOverride) {
     case RegionOverride::FAST:
+    case RegionOverride::ARENA:
     case RegionOverride::NAIVE_RC:
     case RegionOverride::ASSIST:
       // continue
@@ -260,7 +267,8 @@ WeakFatPtrLE WrcWeaks::assembleStructWeakRef(
 //  } else
     if (globalState->opt->regionOverride == RegionOverride::ASSIST ||
       globalState->opt->regionOverride == RegionOverride::NAIVE_RC ||
-      globalState->opt->regionOverride == RegionOverride::FAST) {
+      globalState->opt->regionOverride == RegionOverride::FAST ||
+      globalState->opt->regionOverride == RegionOverride::ARENA) {
     assert(structTypeM->ownership == Ownership::OWN || structTypeM->ownership == Ownership::SHARE || structTypeM->ownership == Ownership::BORROW);
   } else assert(false);
 
@@ -342,7 +350,8 @@ LLVMValueRef WrcWeaks::getNewWrci(
   assert(
       globalState->opt->regionOverride == RegionOverride::ASSIST ||
           globalState->opt->regionOverride == RegionOverride::NAIVE_RC ||
-          globalState->opt->regionOverride == RegionOverride::FAST);
+          globalState->opt->regionOverride == RegionOverride::FAST ||
+          globalState->opt->regionOverride == RegionOverride::ARENA);
 
   // uint64_t resultWrci = __wrc_firstFree;
   auto resultWrciLE = LLVMBuildLoad(builder, getWrcFirstFreeWrciPtr(builder), "resultWrci");
@@ -497,6 +506,7 @@ Ref WrcWeaks::getIsAliveFromWeakRef(
               weakRefM->ownership == Ownership::WEAK);
       break;
     case RegionOverride::FAST:
+    case RegionOverride::ARENA:
     case RegionOverride::NAIVE_RC:
     case RegionOverride::ASSIST:
       assert(weakRefM->ownership == Ownership::WEAK);
@@ -594,7 +604,7 @@ void WrcWeaks::buildCheckWeakRef(
   // This will also run for objects which have since died, which is fine.
   if (auto interfaceKindM = dynamic_cast<InterfaceKind*>(weakRefM->kind)) {
     auto interfaceFatPtrLE = kindStructsSource->makeInterfaceFatPtrWithoutChecking(checkerAFL, functionState, builder, weakRefM, innerLE);
-    auto itablePtrLE = getTablePtrFromInterfaceRef(builder, interfaceFatPtrLE);
+    auto itablePtrLE = getTablePtrFromInterfaceRef(builder, kindStructsSource, interfaceFatPtrLE);
     buildAssertCensusContains(checkerAFL, globalState, functionState, builder, itablePtrLE);
   }
 }
@@ -311,6 +311,17 @@ public:
       bool arrayRefKnownLive,
       Ref indexRef) = 0;
 
+  // Moves all of the source array's elements onto the end of the target array, in order, and
+  // leaves the source empty. The caller checks that the target has room.
+  virtual void migrateRuntimeSizedArrayNoBoundsCheck(
+      FunctionState* functionState,
+      LLVMBuilderRef builder,
+      RuntimeSizedArrayT* rsaMT,
+      Reference* sourceRefMT,
+      Ref sourceArrayRef,
+      Reference* targetRefMT,
+      Ref targetArrayRef) = 0;
+
   virtual void initializeElementInSSA(
       FunctionState* functionState,
       LLVMBuilderRef builder,
@@ -396,6 +407,7 @@ public:
   // TODO:
   // One use is for makeNewStrFunc, make that private to the unsafe region.
   // Change this to also take in the bytes pointer.
+  // If sourceCharsPtrLE is null, the chars are left for the caller to fill in.
   virtual Ref mallocStr(
       Ref regionInstanceRef,
       FunctionState* functionState,
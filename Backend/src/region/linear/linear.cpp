@@ -1853,6 +1853,18 @@ Ref Linear::popRuntimeSizedArrayNoBoundsCheck(
   exit(1);
 }
 
+void Linear::migrateRuntimeSizedArrayNoBoundsCheck(
+    FunctionState* functionState,
+    LLVMBuilderRef builder,
+    RuntimeSizedArrayT* rsaMT,
+    Reference* sourceRefMT,
+    Ref sourceArrayRef,
+    Reference* targetRefMT,
+    Ref targetArrayRef) {
+  assert(false);
+  exit(1);
+}
+
 void Linear::initializeElementInSSA(
     FunctionState* functionState,
     LLVMBuilderRef builder,
@@ -759,7 +759,8 @@ Ref NaiveRC::loadMember(
                                                  structRefMT, structRef);
           return wrap(globalState->getRegion(expectedMemberType), expectedMemberType,
                       LLVMBuildExtractValue(
-                          builder, structRefLE, memberIndex, memberName.c_str()));
+                          builder, structRefLE, kindStructs.getStructMemberLlvmIndex(structRefMT->kind, memberIndex),
+                          memberName.c_str()));
         } else {
           switch (structRefMT->ownership) {
             case Ownership::OWN:
@@ -969,6 +970,25 @@ Ref NaiveRC::popRuntimeSizedArrayNoBoundsCheck(
   return elementLE;
 }
 
+void NaiveRC::migrateRuntimeSizedArrayNoBoundsCheck(
+    FunctionState* functionState,
+    LLVMBuilderRef builder,
+    RuntimeSizedArrayT* rsaMT,
+    Reference* sourceRefMT,
+    Ref sourceArrayRef,
+    Reference* targetRefMT,
+    Ref targetArrayRef) {
+  auto sourceWrapperPtrLE =
+      kindStructs.makeWrapperPtr(
+          FL(), functionState, builder, sourceRefMT,
+          checkValidReference(FL(), functionState, builder, sourceRefMT, sourceArrayRef));
+  auto targetWrapperPtrLE =
+      kindStructs.makeWrapperPtr(
+          FL(), functionState, builder, targetRefMT,
+          checkValidReference(FL(), functionState, builder, targetRefMT, targetArrayRef));
+  ::migrateElementsInRSA(globalState, functionState, builder, sourceWrapperPtrLE, targetWrapperPtrLE);
+}
+
 void NaiveRC::initializeElementInSSA(
     FunctionState* functionState,
     LLVMBuilderRef builder,
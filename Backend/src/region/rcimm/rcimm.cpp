@@ -571,6 +571,18 @@ Ref RCImm::popRuntimeSizedArrayNoBoundsCheck(
       arrayKnownLive, indexRef).move();
 }
 
+void RCImm::migrateRuntimeSizedArrayNoBoundsCheck(
+    FunctionState* functionState,
+    LLVMBuilderRef builder,
+    RuntimeSizedArrayT* rsaMT,
+    Reference* sourceRefMT,
+    Ref sourceArrayRef,
+    Reference* targetRefMT,
+    Ref targetArrayRef) {
+  assert(false);
+  exit(1);
+}
+
 
 Ref RCImm::storeElementInRSA(
     FunctionState* functionState,
@@ -743,7 +755,9 @@ void RCImm::discard(
                 globalState->getRegion(sourceMT)->checkValidReference(FL(),
                     functionState, thenBuilder, sourceMT, sourceRef);
             std::vector<LLVMValueRef> argExprsL = {sourceLE};
-            return LLVMBuildCall(thenBuilder, funcL, argExprsL.data(), argExprsL.size(), "");
+            auto callLE = LLVMBuildCall(thenBuilder, funcL, argExprsL.data(), argExprsL.size(), "");
+            LLVMSetInstructionCallConv(callLE, VALE_CALL_CONV);
+            return callLE;
           });
     }
   } else {
@@ -836,7 +850,9 @@ LoadResult RCImm::loadMember(
         globalState->getRegion(structRefMT)->checkValidReference(
             FL(), functionState, builder, structRefMT, structRef);
     auto memberLE =
-        LLVMBuildExtractValue(builder, innerStructLE, memberIndex, memberName.c_str());
+        LLVMBuildExtractValue(
+            builder, innerStructLE, kindStructs.getStructMemberLlvmIndex(structRefMT->kind, memberIndex),
+            memberName.c_str());
     return LoadResult{wrap(globalState->getRegion(expectedMemberType), expectedMemberType, memberLE)};
   } else {
     return regularLoadStrongMember(globalState, functionState, builder, &kindStructs, structRefMT, structRef, memberIndex, expectedMemberType, targetType, memberName);
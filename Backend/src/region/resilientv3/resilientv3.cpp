@@ -768,7 +768,8 @@ Ref ResilientV3::loadMember(
           structRefMT, structRef);
       return wrap(globalState->getRegion(expectedMemberType), expectedMemberType,
           LLVMBuildExtractValue(
-              builder, structRefLE, memberIndex, memberName.c_str()));
+              builder, structRefLE, kindStructs.getStructMemberLlvmIndex(structRefMT->kind, memberIndex),
+              memberName.c_str()));
     } else {
       switch (structRefMT->ownership) {
         case Ownership::OWN:
@@ -922,6 +923,21 @@ Ref ResilientV3::popRuntimeSizedArrayNoBoundsCheck(
   return elementLE;
 }
 
+void ResilientV3::migrateRuntimeSizedArrayNoBoundsCheck(
+    FunctionState* functionState,
+    LLVMBuilderRef builder,
+    RuntimeSizedArrayT* rsaMT,
+    Reference* sourceRefMT,
+    Ref sourceArrayRef,
+    Reference* targetRefMT,
+    Ref targetArrayRef) {
+  auto sourceWrapperPtrLE =
+      lockWeakRef(FL(), functionState, builder, sourceRefMT, sourceArrayRef, true);
+  auto targetWrapperPtrLE =
+      lockWeakRef(FL(), functionState, builder, targetRefMT, targetArrayRef, true);
+  ::migrateElementsInRSA(globalState, functionState, builder, sourceWrapperPtrLE, targetWrapperPtrLE);
+}
+
 void ResilientV3::initializeElementInSSA(
     FunctionState *functionState,
     LLVMBuilderRef builder,
@@ -325,6 +325,15 @@ public:
       bool arrayRefKnownLive,
       Ref indexRef) override;
 
+  void migrateRuntimeSizedArrayNoBoundsCheck(
+      FunctionState* functionState,
+      LLVMBuilderRef builder,
+      RuntimeSizedArrayT* rsaMT,
+      Reference* sourceRefMT,
+      Ref sourceArrayRef,
+      Reference* targetRefMT,
+      Ref targetArrayRef) override;
+
   void initializeElementInSSA(
       FunctionState* functionState,
       LLVMBuilderRef builder,
@@ -809,7 +809,8 @@ Ref ResilientV4::loadMember(
           structRefMT, structRef);
       return wrap(globalState->getRegion(expectedMemberType), expectedMemberType,
           LLVMBuildExtractValue(
-              builder, structRefLE, memberIndex, memberName.c_str()));
+              builder, structRefLE, kindStructs.getStructMemberLlvmIndex(structRefMT->kind, memberIndex),
+              memberName.c_str()));
     } else {
       switch (structRefMT->ownership) {
         case Ownership::OWN:
@@ -963,6 +964,21 @@ Ref ResilientV4::popRuntimeSizedArrayNoBoundsCheck(
   return elementLE;
 }
 
+void ResilientV4::migrateRuntimeSizedArrayNoBoundsCheck(
+    FunctionState* functionState,
+    LLVMBuilderRef builder,
+    RuntimeSizedArrayT* rsaMT,
+    Reference* sourceRefMT,
+    Ref sourceArrayRef,
+    Reference* targetRefMT,
+    Ref targetArrayRef) {
+  auto sourceWrapperPtrLE =
+      lockWeakRef(FL(), functionState, builder, sourceRefMT, sourceArrayRef, true);
+  auto targetWrapperPtrLE =
+      lockWeakRef(FL(), functionState, builder, targetRefMT, targetArrayRef, true);
+  ::migrateElementsInRSA(globalState, functionState, builder, sourceWrapperPtrLE, targetWrapperPtrLE);
+}
+
 void ResilientV4::initializeElementInSSA(
     FunctionState *functionState,
     LLVMBuilderRef builder,
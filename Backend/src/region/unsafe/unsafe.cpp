@@ -15,7 +15,11 @@
 #include <sstream>
 
 Unsafe::Unsafe(GlobalState* globalState_) :
+    Unsafe(globalState_, globalState_->metalCache->unsafeRegionId) {}
+
+Unsafe::Unsafe(GlobalState* globalState_, RegionId* regionId_) :
     globalState(globalState_),
+    regionId(regionId_),
     kindStructs(
         globalState,
         makeFastNonWeakableControlBlock(globalState),
@@ -36,7 +40,7 @@ void Unsafe::mainCleanup(FunctionState* functionState, LLVMBuilderRef builder) {
 }
 
 RegionId* Unsafe::getRegionId() {
-  return globalState->metalCache->unsafeRegionId;
+  return regionId;
 }
 
 Ref Unsafe::constructStaticSizedArray(
@@ -883,6 +887,25 @@ Ref Unsafe::popRuntimeSizedArrayNoBoundsCheck(
   return elementLE;
 }
 
+void Unsafe::migrateRuntimeSizedArrayNoBoundsCheck(
+    FunctionState* functionState,
+    LLVMBuilderRef builder,
+    RuntimeSizedArrayT* rsaMT,
+    Reference* sourceRefMT,
+    Ref sourceArrayRef,
+    Reference* targetRefMT,
+    Ref targetArrayRef) {
+  auto sourceWrapperPtrLE =
+      kindStructs.makeWrapperPtr(
+          FL(), functionState, builder, sourceRefMT,
+          checkValidReference(FL(), functionState, builder, sourceRefMT, sourceArrayRef));
+  auto targetWrapperPtrLE =
+      kindStructs.makeWrapperPtr(
+          FL(), functionState, builder, targetRefMT,
+          checkValidReference(FL(), functionState, builder, targetRefMT, targetArrayRef));
+  ::migrateElementsInRSA(globalState, functionState, builder, sourceWrapperPtrLE, targetWrapperPtrLE);
+}
+
 void Unsafe::initializeElementInSSA(
     FunctionState* functionState,
     LLVMBuilderRef builder,
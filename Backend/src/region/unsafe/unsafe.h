@@ -325,6 +325,15 @@ public:
       bool arrayRefKnownLive,
       Ref indexRef) override;
 
+  void migrateRuntimeSizedArrayNoBoundsCheck(
+      FunctionState* functionState,
+      LLVMBuilderRef builder,
+      RuntimeSizedArrayT* rsaMT,
+      Reference* sourceRefMT,
+      Ref sourceArrayRef,
+      Reference* targetRefMT,
+      Ref targetArrayRef) override;
+
   void initializeElementInSSA(
       FunctionState* functionState,
       LLVMBuilderRef builder,
@@ -489,7 +498,11 @@ public:
   void mainCleanup(FunctionState* functionState, LLVMBuilderRef builder) override;
 
 protected:
+  // For regions that share unsafe's layout but not its region ID, like Arena.
+  Unsafe(GlobalState* globalState, RegionId* regionId);
+
   GlobalState* globalState = nullptr;
+  RegionId* regionId = nullptr;
 
 //  KindStructs mutNonWeakableStructs;
   KindStructs kindStructs;
@@ -15,6 +15,22 @@ LLVMValueRef adjustCounter(
   return newValLE;
 }
 
+LLVMValueRef adjustCounterAtomic(
+    GlobalState* globalState,
+    LLVMBuilderRef builder,
+    Int* innt,
+    LLVMValueRef counterPtrLE,
+    int adjustAmount) {
+  auto adjustByLE = LLVMConstInt(LLVMIntTypeInContext(globalState->context, innt->bits), adjustAmount, true);
+  // Increments can be relaxed, since whoever increments already holds a reference. Decrements
+  // must release our writes to whichever thread hits zero, and acquire everyone else's if it's us.
+  auto orderingL = adjustAmount > 0 ? LLVMAtomicOrderingMonotonic : LLVMAtomicOrderingAcquireRelease;
+  auto prevValLE =
+      LLVMBuildAtomicRMW(builder, LLVMAtomicRMWBinOpAdd, counterPtrLE, adjustByLE, orderingL, false);
+  assert(LLVMTypeOf(prevValLE) == LLVMTypeOf(adjustByLE));
+  return LLVMBuildAdd(builder, prevValLE, adjustByLE, "counterNewVal");
+}
+
 LLVMValueRef isZeroLE(LLVMBuilderRef builder, LLVMValueRef intLE) {
   return LLVMBuildICmp(
       builder,
@@ -13,6 +13,14 @@ LLVMValueRef adjustCounter(
     LLVMValueRef counterPtrLE,
     int adjustAmount);
 
+// Like adjustCounter, but safe to race with other threads adjusting the same counter.
+LLVMValueRef adjustCounterAtomic(
+    GlobalState* globalState,
+    LLVMBuilderRef builder,
+    Int* innt,
+    LLVMValueRef counterPtrLE,
+    int adjustAmount);
+
 LLVMValueRef isZeroLE(LLVMBuilderRef builder, LLVMValueRef intLE);
 LLVMValueRef isNonZeroLE(LLVMBuilderRef builder, LLVMValueRef intLE);
 
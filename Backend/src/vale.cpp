@@ -5,6 +5,13 @@
 #include <llvm-c/IRReader.h>
 
 #include <sys/stat.h>
+#ifndef _WIN32
+#include <csignal>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
 
 #include <assert.h>
 #include <string>
@@ -22,6 +29,7 @@
 
 #include "function/function.h"
 #include "metal/readjson.h"
+#include "metal/reachability.h"
 #include "error.h"
 #include "translatetype.h"
 #include "externs.h"
@@ -33,6 +41,7 @@
 #include "region/assist/assist.h"
 #include "region/resilientv3/resilientv3.h"
 #include "region/unsafe/unsafe.h"
+#include "region/arena/arena.h"
 #include "function/expressions/shared/string.h"
 #include <sstream>
 #include "region/linear/linear.h"
@@ -40,6 +49,11 @@
 #include "function/expressions/expressions.h"
 #include "region/naiverc/naiverc.h"
 #include "region/resilientv4/resilientv4.h"
+#include "region/common/allocprofile.h"
+#include "jit.h"
+#include "debuginfo.h"
+#include "mergefunctions.h"
+#include "packagecache.h"
 
 #ifdef _WIN32
 #define asmext "asm"
@@ -588,6 +602,42 @@ void makeExternOrExportFunction(
   (*sourceC) << userSourceC.str();
 }
 
+static std::string escapeJsonString(const std::string& str) {
+  std::stringstream result;
+  for (char c : str) {
+    if (c == '"' || c == '\\') {
+      result << '\\' << c;
+    } else if ((unsigned char)c < 0x20) {
+      char escaped[8];
+      snprintf(escaped, sizeof(escaped), "\\u%04x", (unsigned char)c);
+      result << escaped;
+    } else {
+      result << c;
+    }
+  }
+  return result.str();
+}
+
+// Writes the strings that trace records' event and location IDs refer to, for
+// test/decode_trace.py to read back in.
+void writeTraceStringTable(GlobalState* globalState) {
+  auto filepath = globalState->opt->outputDir + "/trace_strings.json";
+  std::ofstream out(filepath, std::ofstream::out);
+  if (!out) {
+    std::cerr << "Couldn't make file '" << filepath << std::endl;
+    exit(1);
+  }
+  out << "{\"events\": [";
+  for (int i = 0; i < globalState->traceEvents.size(); i++) {
+    out << (i == 0 ? "\n  " : ",\n  ") << "\"" << escapeJsonString(globalState->traceEvents[i]) << "\"";
+  }
+  out << "\n], \"locations\": [";
+  for (int i = 0; i < globalState->traceLocations.size(); i++) {
+    out << (i == 0 ? "\n  " : ",\n  ") << "\"" << escapeJsonString(globalState->traceLocations[i]) << "\"";
+  }
+  out << "\n]}\n";
+}
+
 std::ofstream makeCFile(const std::string &filepath) {
   std::ofstream out(filepath, std::ofstream::out);
   if (!out) {
@@ -642,6 +692,23 @@ std::string makeModuleAbiDirectory(const GlobalState *globalState, PackageCoordi
   return moduleIncludeDirectory;
 }
 
+// For --thin_interface_refs. An object's header only has room for one itable, so an interface
+// can only have thin references if every struct implementing it implements nothing else. They
+// also have to be non-weakable, so they all have the control block with the itable in it.
+static void findFatInterfaces(GlobalState* globalState, Program* program) {
+  for (auto packageCoordAndPackage : program->packages) {
+    auto[packageCoord, package] = packageCoordAndPackage;
+    for (auto p : package->structs) {
+      auto structM = p.second;
+      if (structM->edges.size() > 1 || structM->weakability == Weakability::WEAKABLE) {
+        for (auto edge : structM->edges) {
+          globalState->fatInterfaces.insert(edge->interfaceName);
+        }
+      }
+    }
+  }
+}
+
 void compileValeCode(GlobalState* globalState, std::vector<std::string>& inputFilepaths) {
   auto voidLT = LLVMVoidTypeInContext(globalState->context);
   auto int8LT = LLVMInt8TypeInContext(globalState->context);
@@ -689,6 +756,9 @@ void compileValeCode(GlobalState* globalState, std::vector<std::string>& inputFi
     case RegionOverride::FAST:
       std::cout << "Region override: fast" << std::endl;
       break;
+    case RegionOverride::ARENA:
+      std::cout << "Region override: arena" << std::endl;
+      break;
     case RegionOverride::RESILIENT_V3:
       std::cout << "Region override: resilient-v3" << std::endl;
       break;
@@ -718,63 +788,67 @@ void compileValeCode(GlobalState* globalState, std::vector<std::string>& inputFi
       std::cout << "Warning: not using fashCrash, will slow things down!" << std::endl;
     }
   }
+  if (globalState->opt->genHeap &&
+      globalState->opt->regionOverride != RegionOverride::RESILIENT_V3 &&
+      globalState->opt->regionOverride != RegionOverride::RESILIENT_V4) {
+    std::cout << "Warning: gen heap only applies to resilient-v3 and resilient-v4, ignoring!" << std::endl;
+  }
+  if (globalState->opt->threadsafeImms && globalState->opt->census) {
+    std::cout << "Warning: census isn't thread-safe, only use it with a single thread!" << std::endl;
+  }
+  if (globalState->opt->threadsafeImms && globalState->opt->genHeap) {
+    std::cout << "Warning: gen heap isn't thread-safe, only use it with a single thread!" << std::endl;
+  }
+  if (globalState->opt->threadsafeImms && globalState->opt->regionOverride == RegionOverride::ARENA) {
+    std::cout << "Warning: arena isn't thread-safe, only use it with a single thread!" << std::endl;
+  }
 
 
 
-  AddressNumberer addressNumberer;
-  MetalCache metalCache(&addressNumberer);
-  globalState->metalCache = &metalCache;
-
-  switch (globalState->opt->regionOverride) {
-    case RegionOverride::ASSIST:
-      metalCache.mutRegionId = metalCache.assistRegionId;
-      break;
-    case RegionOverride::FAST:
-      metalCache.mutRegionId = metalCache.unsafeRegionId;
-      break;
-    case RegionOverride::NAIVE_RC:
-      metalCache.mutRegionId = metalCache.naiveRcRegionId;
-      break;
-    case RegionOverride::RESILIENT_V3:
-      metalCache.mutRegionId = metalCache.resilientV3RegionId;
-      break;
-    case RegionOverride::RESILIENT_V4:
-      metalCache.mutRegionId = metalCache.resilientV4RegionId;
-      break;
-    default:
-      assert(false);
+  // With --serve, the packages were read into the server's cache before it forked us.
+  MetalCache* metalCachePtr = nullptr;
+  if (globalState->packageCache) {
+    metalCachePtr = globalState->packageCache->getMetalCache(globalState->opt->regionOverride);
+  } else {
+    globalState->ownedAddressNumberer = std::make_unique<AddressNumberer>();
+    globalState->ownedMetalCache = std::make_unique<MetalCache>(globalState->ownedAddressNumberer.get());
+    metalCachePtr = globalState->ownedMetalCache.get();
+    setMutRegionId(metalCachePtr, globalState->opt->regionOverride);
   }
+  MetalCache& metalCache = *metalCachePtr;
+  globalState->metalCache = &metalCache;
 
-  Program program(
-      std::unordered_map<PackageCoordinate*, Package*, AddressHasher<PackageCoordinate*>, std::equal_to<PackageCoordinate*>>(
-          0,
-          addressNumberer.makeHasher<PackageCoordinate*>(),
-          std::equal_to<PackageCoordinate*>()));
+  globalState->ownedProgram =
+      std::make_unique<Program>(
+          std::unordered_map<PackageCoordinate*, Package*, AddressHasher<PackageCoordinate*>, std::equal_to<PackageCoordinate*>>(
+              0,
+              metalCache.addressNumberer->makeHasher<PackageCoordinate*>(),
+              std::equal_to<PackageCoordinate*>()));
+  Program& program = *globalState->ownedProgram;
+  int packagesReusedBefore =
+      globalState->packageCache ? globalState->packageCache->numPackagesReused() : 0;
   for (auto inputFilepath : inputFilepaths) {
     //std::cout << "Reading input file: " << inputFilepath << std::endl;
-    auto stem = std::filesystem::path(inputFilepath).stem();
-    auto package_coord_parts = split(stem.string(), '.');
-    auto project_name = package_coord_parts[0];
-    package_coord_parts.erase(package_coord_parts.begin());
-    auto package_steps = package_coord_parts;
-
-    auto package_coord = metalCache.getPackageCoordinate(project_name, package_steps);
-
-    try {
-      std::ifstream instream(inputFilepath);
-      std::string str(std::istreambuf_iterator<char>{instream}, {});
-      if (str.size() == 0) {
-        std::cerr << "Nothing found in " << inputFilepath << std::endl;
-        exit(1);
-      }
-      auto packageJ = json::parse(str.c_str());
-      auto packageM = readPackage(&metalCache, packageJ);
+    PackageCoordinate* package_coord = nullptr;
+    auto packageM =
+        globalState->packageCache ?
+        globalState->packageCache->getPackage(globalState->opt->regionOverride, inputFilepath, &package_coord) :
+        readPackageFile(&metalCache, inputFilepath, &package_coord);
+    program.packages.emplace(package_coord, packageM);
+  }
+  if (globalState->packageCache && globalState->opt->printStats) {
+    auto packagesReused = globalState->packageCache->numPackagesReused() - packagesReusedBefore;
+    std::cout << "Reused " << packagesReused << " of " << inputFilepaths.size()
+        << " packages from the server's cache." << std::endl;
+  }
 
-      program.packages.emplace(package_coord, packageM);
-    }
-    catch (const nlohmann::detail::parse_error &error) {
-      std::cerr << "Error while parsing json: " << error.what() << std::endl;
-      exit(1);
+  if (globalState->opt->pruneUnreachable) {
+    auto pruneStats = pruneUnreachable(&program);
+    if (globalState->opt->printStats) {
+      std::cout << "Pruned " << pruneStats.functionsPruned << " of "
+          << (pruneStats.functionsKept + pruneStats.functionsPruned) << " functions and "
+          << pruneStats.kindsPruned << " of " << (pruneStats.kindsKept + pruneStats.kindsPruned)
+          << " kinds, unreachable from exports." << std::endl;
     }
   }
 
@@ -843,6 +917,14 @@ void compileValeCode(GlobalState* globalState, std::vector<std::string>& inputFi
 
   initInternalExterns(globalState);
 
+  if (globalState->opt->allocProfile) {
+    declareAllocProfile(globalState);
+  }
+
+  if (globalState->opt->thinInterfaceRefs) {
+    findFatInterfaces(globalState, &program);
+  }
+
   RCImm rcImm(globalState);
   globalState->rcImm = &rcImm;
   globalState->regions.emplace(globalState->rcImm->getRegionId(), globalState->rcImm);
@@ -855,6 +937,9 @@ void compileValeCode(GlobalState* globalState, std::vector<std::string>& inputFi
   Unsafe unsafeRegion(globalState);
   globalState->unsafeRegion = &unsafeRegion;
   globalState->regions.emplace(globalState->unsafeRegion->getRegionId(), globalState->unsafeRegion);
+  Arena arenaRegion(globalState);
+  globalState->arenaRegion = &arenaRegion;
+  globalState->regions.emplace(globalState->arenaRegion->getRegionId(), globalState->arenaRegion);
   Linear linearRegion(globalState);
   globalState->linearRegion = &linearRegion;
   globalState->regions.emplace(globalState->linearRegion->getRegionId(), globalState->linearRegion);
@@ -1143,6 +1228,19 @@ void compileValeCode(GlobalState* globalState, std::vector<std::string>& inputFi
       translateFunction(globalState, function);
     }
   }
+  if (globalState->opt->printStats) {
+    int inlinedStrCalls = 0;
+    std::string inlinedStrCallsByName;
+    for (auto[externName, count] : globalState->inlinedStrBuiltinCalls) {
+      inlinedStrCalls += count;
+      inlinedStrCallsByName +=
+          (inlinedStrCallsByName.empty() ? "" : ", ") + externName + " " + std::to_string(count);
+    }
+    std::cout << "Inlined " << inlinedStrCalls << " string extern calls"
+        << (inlinedStrCallsByName.empty() ? "" : " (" + inlinedStrCallsByName + ")") << "." << std::endl;
+    std::cout << "Flattened " << globalState->strConcatChainsFlattened << " chains of string +'s, "
+        << globalState->strConcatOperandsFlattened << " operands in all." << std::endl;
+  }
 
   // We translate the edges after the functions are declared because the
   // functions have to exist for the itables to point to them.
@@ -1198,23 +1296,24 @@ void compileValeCode(GlobalState* globalState, std::vector<std::string>& inputFi
   auto entryFuncL = makeEntryFunction(globalState, valeMainPrototype);
 
   generateExports(globalState, mainM);
+
+  if (globalState->opt->allocProfile) {
+    finishAllocProfile(globalState);
+  }
+  if (globalState->opt->binaryTrace) {
+    writeTraceStringTable(globalState);
+  }
+  if (globalState->opt->debugInfo) {
+    finishDebugInfo(globalState);
+  }
 }
 
 void createModule(std::vector<std::string>& inputFilepaths, GlobalState *globalState) {
   globalState->mod = LLVMModuleCreateWithNameInContext("build", globalState->context);
-  if (!globalState->opt->release) {
-    globalState->dibuilder = LLVMCreateDIBuilder(globalState->mod);
-    globalState->difile = LLVMDIBuilderCreateFile(globalState->dibuilder, "main.vale", 9, ".", 1);
-    // If theres a compile error on this line, its some sort of LLVM version issue, try commenting or uncommenting the last four args.
-    globalState->compileUnit =
-        LLVMDIBuilderCreateCompileUnit(
-            globalState->dibuilder, LLVMDWARFSourceLanguageC, globalState->difile, "Vale compiler",
-            13, 0, "", 0, 0, "", 0, LLVMDWARFEmissionFull, 0, 0, 0,
-            "isysroothere", strlen("isysroothere"), "sdkhere", strlen("sdkhere"));
+  if (globalState->opt->debugInfo) {
+    beginDebugInfo(globalState);
   }
   compileValeCode(globalState, inputFilepaths);
-  if (!globalState->opt->release)
-    LLVMDIBuilderFinalize(globalState->dibuilder);
 }
 
 // Use provided options (triple, etc.) to creation a machine
@@ -1337,6 +1436,10 @@ void generateModule(std::vector<std::string>& inputFilepaths, GlobalState *globa
     }
   }
 
+  if (globalState->opt->mergeFunctions) {
+    mergeIdenticalFunctions(globalState);
+  }
+
   // Optimize the generated LLVM IR
   LLVMPassManagerRef passmgr = LLVMCreatePassManager();
 
@@ -1363,6 +1466,11 @@ void generateModule(std::vector<std::string>& inputFilepaths, GlobalState *globa
     }
   }
 
+  if (globalState->opt->jit) {
+    // runJit takes the module from here.
+    return;
+  }
+
   // Transform IR to target's ASM and OBJ
   if (globalState->machine) {
     auto objpath =
@@ -1385,8 +1493,13 @@ void generateModule(std::vector<std::string>& inputFilepaths, GlobalState *globa
 void setup(GlobalState *globalState, ValeOptions *opt) {
   globalState->opt = opt;
 
-  // LLVM inlining bugs prevent use of LLVMContextCreate();
-  globalState->context = LLVMContextCreate();
+  if (opt->jit) {
+    globalState->threadSafeContext = LLVMOrcCreateNewThreadSafeContext();
+    globalState->context = LLVMOrcThreadSafeContextGetContext(globalState->threadSafeContext);
+  } else {
+    // LLVM inlining bugs prevent use of LLVMContextCreate();
+    globalState->context = LLVMContextCreate();
+  }
 
   LLVMTargetMachineRef machine = createMachine(opt);
   if (!machine)
@@ -1401,24 +1514,44 @@ void setup(GlobalState *globalState, ValeOptions *opt) {
 
 void closeGlobalState(GlobalState *globalState) {
   LLVMDisposeTargetMachine(globalState->machine);
+  if (globalState->threadSafeContext) {
+    LLVMOrcDisposeThreadSafeContext(globalState->threadSafeContext);
+  }
 }
 
-
-int main(int argc, char **argv) {
-  ValeOptions valeOptions;
-
-  // Get compiler's options from passed arguments
-  int ok = valeOptSet(&valeOptions, &argc, argv);
-  if (ok <= 0) {
-    exit((int)(ok == 0 ? ExitCode::Success : ExitCode::BadOpts));
+static bool isJitNativeInput(const std::string& path) {
+  for (auto extension : { ".c", ".bc", ".ll" }) {
+    auto len = strlen(extension);
+    if (path.size() >= len && path.compare(path.size() - len, len, extension) == 0) {
+      return true;
+    }
   }
+  return false;
+}
+
+// Compiles the program, and with --jit runs it too, returning its exit code.
+// With --serve, packageCache has the packages already read, see runServer.
+int compileProgram(ValeOptions* valeOptions, int argc, char **argv, PackageCache* packageCache = nullptr) {
   if (argc < 2)
     errorExit(ExitCode::BadOpts, "Specify a Vale program to compile.");
+  if (valeOptions->jit) {
+#ifdef _WIN32
+    errorExit(ExitCode::BadOpts, "--jit isn't supported on Windows yet.");
+#endif
+    if (valeOptions->wasm || valeOptions->threadsafeImms) {
+      errorExit(ExitCode::BadOpts, "--jit can't be used with --wasm or --threadsafe_imms.");
+    }
+  }
 
   auto inputFilepaths = std::vector<std::string>{};
+  auto nativeInputPaths = std::vector<std::string>{};
   for (int i = 1; i < argc; i++) {
     //std::cout << "Backend found file: " << argv[i] << std::endl;
-    inputFilepaths.emplace_back(argv[i]);
+    if (valeOptions->jit && isJitNativeInput(argv[i])) {
+      nativeInputPaths.emplace_back(argv[i]);
+    } else {
+      inputFilepaths.emplace_back(argv[i]);
+    }
   }
 
 //  valeOptions.srcpath = argv[1];
@@ -1429,13 +1562,252 @@ int main(int argc, char **argv) {
   // We set up generation early because we need target info, e.g.: pointer size
   AddressNumberer addressNumberer;
   GlobalState globalState(&addressNumberer);
-  setup(&globalState, &valeOptions);
+  setup(&globalState, valeOptions);
+  globalState.packageCache = packageCache;
 
   // Parse source file, do semantic analysis, and generate code
 //    ModuleNode *modnode = NULL;
 //    if (!errors)
   generateModule(inputFilepaths, &globalState);
 
+  int result = 0;
+  if (valeOptions->jit) {
+    result = runJit(&globalState, nativeInputPaths);
+  }
+
   closeGlobalState(&globalState);
 //    errorSummary();
+  return result;
+}
+
+// For --jit_batch. Each line of stdin is a backend command line (without the program name, and
+// split on spaces), which we compile and run as if it had --jit. After each, we print a line with
+// jitBatchExitMarker and its exit code. Compile errors still end the whole batch.
+static const char* jitBatchExitMarker = "vale_jit_exit_code:";
+int runJitBatch(const char* programName) {
+  std::string line;
+  while (std::getline(std::cin, line)) {
+    std::vector<std::string> words = { programName };
+    std::istringstream lineStream(line);
+    std::string word;
+    while (lineStream >> word) {
+      words.push_back(word);
+    }
+    if (words.size() == 1) {
+      continue;
+    }
+    std::vector<char*> argv;
+    for (auto& w : words) {
+      argv.push_back(const_cast<char*>(w.c_str()));
+    }
+    argv.push_back(nullptr);
+    int argc = words.size();
+
+    ValeOptions valeOptions;
+    int ok = valeOptSet(&valeOptions, &argc, argv.data());
+    if (ok <= 0) {
+      exit((int)(ok == 0 ? ExitCode::Success : ExitCode::BadOpts));
+    }
+    valeOptions.jit = true;
+    int result = compileProgram(&valeOptions, argc, argv.data());
+    std::cout << jitBatchExitMarker << " " << result << std::endl;
+  }
+  return 0;
+}
+
+#ifndef _WIN32
+// For --serve. Each connection sends one backend command line (without the program name, split
+// on spaces, and ending in a newline), which we compile just like a normal run, writing build.o
+// and the rest to its --output_dir. Whatever the compile prints comes back over the connection,
+// followed by a line with serverExitMarker and its exit code.
+//
+// The server's working directory has nothing to do with the client's, so a request's inputs and
+// its --output_dir must be absolute paths; the child refuses the request otherwise.
+//
+// Each compile happens in a forked child, so that compile errors (which exit) only end the child.
+// Once a compile succeeds, we read its .vast files into packageCache here in the parent, so the
+// next request's child starts with them already parsed and interned. We only do that after a
+// success, and with PackageCache::tryGetPackage, so a file that broke in the meantime just
+// isn't cached instead of taking the server down.
+static const char* serverExitMarker = "vale_server_exit_code:";
+
+static bool readServerRequest(int connection, std::string* line) {
+  char c = 0;
+  while (read(connection, &c, 1) == 1) {
+    if (c == '\n') {
+      return true;
+    }
+    line->push_back(c);
+  }
+  return !line->empty();
+}
+
+static void writeServerResponse(int connection, const std::string& str) {
+  size_t written = 0;
+  while (written < str.size()) {
+    auto n = write(connection, str.data() + written, str.size() - written);
+    if (n <= 0) {
+      // The client went away, nothing to do.
+      return;
+    }
+    written += n;
+  }
+}
+
+// Turns a request line into an argv for valeOptSet and compileProgram. The strings live in words.
+static std::vector<char*> makeServerArgv(const char* programName, const std::string& line, std::vector<std::string>* words) {
+  words->push_back(programName);
+  std::istringstream lineStream(line);
+  std::string word;
+  while (lineStream >> word) {
+    words->push_back(word);
+  }
+  std::vector<char*> argv;
+  for (auto& w : *words) {
+    argv.push_back(const_cast<char*>(w.c_str()));
+  }
+  argv.push_back(nullptr);
+  return argv;
+}
+
+// Makes sure the request doesn't depend on the server's working directory, see above.
+static bool checkServerRequestPaths(const ValeOptions& valeOptions, int argc, char** argv) {
+  if (valeOptions.outputDir.empty() || !std::filesystem::path(valeOptions.outputDir).is_absolute()) {
+    std::cerr << "Server requests need an absolute --output_dir, got: " << valeOptions.outputDir << std::endl;
+    return false;
+  }
+  for (int i = 1; i < argc; i++) {
+    if (!std::filesystem::path(argv[i]).is_absolute()) {
+      std::cerr << "Server requests need absolute input paths, got: " << argv[i] << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+static int compileServerRequest(const char* programName, PackageCache* packageCache, int connection, const std::string& line) {
+  std::cout.flush();
+  std::cerr.flush();
+  auto pid = fork();
+  if (pid < 0) {
+    perror("fork");
+    return (int)ExitCode::BadOpts;
+  }
+  if (pid == 0) {
+    dup2(connection, STDOUT_FILENO);
+    dup2(connection, STDERR_FILENO);
+    close(connection);
+    std::vector<std::string> words;
+    auto argv = makeServerArgv(programName, line, &words);
+    int argc = words.size();
+    ValeOptions valeOptions;
+    int ok = valeOptSet(&valeOptions, &argc, argv.data());
+    if (ok <= 0) {
+      exit((int)(ok == 0 ? ExitCode::Success : ExitCode::BadOpts));
+    }
+    if (!checkServerRequestPaths(valeOptions, argc, argv.data())) {
+      exit((int)ExitCode::BadOpts);
+    }
+    int result = compileProgram(&valeOptions, argc, argv.data(), packageCache);
+    std::cout.flush();
+    exit(result);
+  }
+  int status = 0;
+  while (waitpid(pid, &status, 0) < 0 && errno == EINTR) { }
+  if (WIFSIGNALED(status)) {
+    return 128 + WTERMSIG(status);
+  }
+  return WEXITSTATUS(status);
+}
+
+// Reads the packages a successful request used, so the next one can reuse them.
+static void cacheServerRequestPackages(const char* programName, PackageCache* packageCache, const std::string& line) {
+  std::vector<std::string> words;
+  auto argv = makeServerArgv(programName, line, &words);
+  int argc = words.size();
+  ValeOptions valeOptions;
+  if (valeOptSet(&valeOptions, &argc, argv.data()) <= 0) {
+    return;
+  }
+  for (int i = 1; i < argc; i++) {
+    if (!isJitNativeInput(argv[i])) {
+      PackageCoordinate* packageCoord = nullptr;
+      std::string error;
+      if (!packageCache->tryGetPackage(valeOptions.regionOverride, argv[i], &packageCoord, &error)) {
+        std::cerr << "Not caching " << argv[i] << ": " << error << std::endl;
+      }
+    }
+  }
+}
+
+int runServer(const char* programName, const std::string& socketPath) {
+  sockaddr_un address = {};
+  address.sun_family = AF_UNIX;
+  if (socketPath.size() >= sizeof(address.sun_path)) {
+    errorExit(ExitCode::BadOpts, "--serve socket path is too long: ", socketPath);
+  }
+  strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+
+  int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (listener < 0) {
+    perror("socket");
+    return (int)ExitCode::BadOpts;
+  }
+  unlink(socketPath.c_str());
+  if (bind(listener, (sockaddr*)&address, sizeof(address)) < 0 || listen(listener, 16) < 0) {
+    perror("Couldn't listen on --serve socket");
+    return (int)ExitCode::BadOpts;
+  }
+  // Otherwise a client hanging up early would take the whole server down.
+  signal(SIGPIPE, SIG_IGN);
+  std::cout << "Serving on " << socketPath << std::endl;
+
+  PackageCache packageCache;
+  while (true) {
+    int connection = accept(listener, nullptr, nullptr);
+    if (connection < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      perror("accept");
+      break;
+    }
+    std::string line;
+    if (readServerRequest(connection, &line)) {
+      int result = compileServerRequest(programName, &packageCache, connection, line);
+      writeServerResponse(connection, std::string(serverExitMarker) + " " + std::to_string(result) + "\n");
+      close(connection);
+      if (result == 0) {
+        cacheServerRequestPackages(programName, &packageCache, line);
+      }
+    } else {
+      close(connection);
+    }
+  }
+  close(listener);
+  unlink(socketPath.c_str());
+  return 0;
+}
+#endif
+
+
+int main(int argc, char **argv) {
+  ValeOptions valeOptions;
+
+  // Get compiler's options from passed arguments
+  int ok = valeOptSet(&valeOptions, &argc, argv);
+  if (ok <= 0) {
+    exit((int)(ok == 0 ? ExitCode::Success : ExitCode::BadOpts));
+  }
+  if (valeOptions.jitBatch) {
+    return runJitBatch(argv[0]);
+  }
+  if (!valeOptions.serveSocketPath.empty()) {
+#ifdef _WIN32
+    errorExit(ExitCode::BadOpts, "--serve isn't supported on Windows yet.");
+#else
+    return runServer(argv[0], valeOptions.serveSocketPath);
+#endif
+  }
+  return compileProgram(&valeOptions, argc, argv);
 }
@@ -14,6 +14,7 @@ enum
     OPT_VERSION,
     OPT_HELP,
     OPT_DEBUG,
+    OPT_DEBUG_INFO,
     OPT_BUILDFLAG,
     OPT_STRIP,
     OPT_PATHS,
@@ -45,10 +46,22 @@ enum
     OPT_FLARES,
     OPT_FAST_CRASH,
     OPT_GEN_HEAP,
+    OPT_THREADSAFE_IMMS,
+    OPT_ALLOC_PROFILE,
+    OPT_BINARY_TRACE,
+    OPT_PRUNE_UNREACHABLE,
+    OPT_MERGE_FUNCTIONS,
+    OPT_BULK_ARRAY_FILL,
+    OPT_THIN_INTERFACE_REFS,
     OPT_ELIDE_CHECKS_FOR_KNOWN_LIVE,
     OPT_OVERRIDE_KNOWN_LIVE_TRUE,
     OPT_PRINT_MEM_OVERHEAD,
     OPT_CENSUS,
+    OPT_JIT,
+    OPT_JIT_BATCH,
+    OPT_JIT_CACHE_DIR,
+    OPT_JIT_ARG,
+    OPT_SERVE,
     OPT_REGION_OVERRIDE,
     OPT_FILENAMES,
     OPT_CHECKTREE,
@@ -66,6 +79,7 @@ static opt_arg_t args[] =
     { "version", 'v', OPT_ARG_NONE, OPT_VERSION },
     { "help", 'h', OPT_ARG_NONE, OPT_HELP },
     { "debug", 'd', OPT_ARG_NONE, OPT_DEBUG },
+    { "debug_info", '\0', OPT_ARG_NONE, OPT_DEBUG_INFO },
     { "define", 'D', OPT_ARG_REQUIRED, OPT_BUILDFLAG },
     { "strip", 's', OPT_ARG_NONE, OPT_STRIP },
     { "path", 'p', OPT_ARG_REQUIRED, OPT_PATHS },
@@ -90,10 +104,22 @@ static opt_arg_t args[] =
     { "flares", '\0', OPT_ARG_OPTIONAL, OPT_FLARES },
     { "fast_crash", '\0', OPT_ARG_OPTIONAL, OPT_FLARES },
     { "gen_heap", '\0', OPT_ARG_OPTIONAL, OPT_GEN_HEAP },
+    { "threadsafe_imms", '\0', OPT_ARG_OPTIONAL, OPT_THREADSAFE_IMMS },
+    { "alloc_profile", '\0', OPT_ARG_OPTIONAL, OPT_ALLOC_PROFILE },
+    { "binary_trace", '\0', OPT_ARG_OPTIONAL, OPT_BINARY_TRACE },
+    { "prune_unreachable", '\0', OPT_ARG_OPTIONAL, OPT_PRUNE_UNREACHABLE },
+    { "merge_functions", '\0', OPT_ARG_OPTIONAL, OPT_MERGE_FUNCTIONS },
+    { "bulk_array_fill", '\0', OPT_ARG_OPTIONAL, OPT_BULK_ARRAY_FILL },
+    { "thin_interface_refs", '\0', OPT_ARG_OPTIONAL, OPT_THIN_INTERFACE_REFS },
     { "elide_checks_for_known_live", '\0', OPT_ARG_OPTIONAL, OPT_ELIDE_CHECKS_FOR_KNOWN_LIVE },
     { "override_known_live_true", '\0', OPT_ARG_NONE, OPT_OVERRIDE_KNOWN_LIVE_TRUE },
     { "print_mem_overhead", '\0', OPT_ARG_OPTIONAL, OPT_PRINT_MEM_OVERHEAD },
     { "census", '\0', OPT_ARG_OPTIONAL, OPT_CENSUS },
+    { "jit", '\0', OPT_ARG_NONE, OPT_JIT },
+    { "jit_batch", '\0', OPT_ARG_NONE, OPT_JIT_BATCH },
+    { "jit_cache_dir", '\0', OPT_ARG_REQUIRED, OPT_JIT_CACHE_DIR },
+    { "jit_arg", '\0', OPT_ARG_REQUIRED, OPT_JIT_ARG },
+    { "serve", '\0', OPT_ARG_REQUIRED, OPT_SERVE },
     { "region_override", '\0', OPT_ARG_REQUIRED, OPT_REGION_OVERRIDE },
     { "ir", '\0', OPT_ARG_NONE, OPT_IR },
     { "asm", '\0', OPT_ARG_NONE, OPT_ASM },
@@ -122,6 +148,8 @@ static void usage()
         "  --version, -v   Print the version of the compiler and exit.\n"
         "  --help, -h      Print this help text and exit.\n"
         "  --debug, -d     Don't optimise the output.\n"
+        "  --debug_info    Emit DWARF line tables and keep frame pointers, even\n"
+        "                  with optimizations, for debuggers and profilers.\n"
         "  --define, -D    Define the specified build flag.\n"
         "    =name\n"
         "  --strip, -s     Strip debug info.\n"
@@ -137,6 +165,17 @@ static void usage()
         "  --nopic         Don't compile using position independent code.\n"
         "  --docs, -g      Generate code documentation.\n"
         "  --docs_public   Generate code documentation for public types only.\n"
+        "  --jit           Run the program in-process instead of writing build.o.\n"
+        "                  Also give it the program's .c (or .bc, .ll) inputs.\n"
+        "  --jit_arg       Pass an argument to the program's main, with --jit.\n"
+        "    =arg          Can be given more than once.\n"
+        "  --jit_batch     Read backend command lines from stdin, one per line,\n"
+        "                  and run each with --jit, printing its exit code after.\n"
+        "  --jit_cache_dir Where to cache the C inputs compiled to bitcode.\n"
+        "    =path         Defaults to $VALE_JIT_CACHE_DIR, or ~/.cache/vale/jit.\n"
+        "  --serve         Stay up and take backend command lines on this Unix\n"
+        "    =path         socket, one per connection, reusing packages already read.\n"
+        "                  Requests' inputs and --output_dir must be absolute paths.\n"
         ,
         "Rarely needed options:\n"
         "  --safe          Allow only the listed packages to use C FFI.\n"
@@ -153,6 +192,20 @@ static void usage()
         "    =name         Default is the host architecture.\n"
         "  --linker        Set the linker command to use.\n"
         "    =name         Default is the compiler.\n"
+        "  --prune_unreachable\n"
+        "    =on|off       Skip functions and types nothing exported can reach.\n"
+        "                  Defaults to on.\n"
+        "  --merge_functions\n"
+        "    =on|off       Fold functions that are identical once lowered, like\n"
+        "                  generic instantiations. Defaults to on.\n"
+        "  --bulk_array_fill\n"
+        "    =on|off       Fill arrays with memset, memcpy, or vector stores when\n"
+        "                  their generator is simple enough. Defaults to on.\n"
+        "  --thin_interface_refs\n"
+        "    =on|off       Keep the itable in each object's header, so interface\n"
+        "                  references are one pointer instead of two. Only for\n"
+        "                  interfaces whose structs implement nothing else.\n"
+        "                  Adds a word to every object. Defaults to off.\n"
         ,
         "Debugging options:\n"
         "  --verbose, -V   Verbosity level.\n"
@@ -192,10 +245,18 @@ int valeOptSet(ValeOptions *opt, int *argc, char **argv) {
     optInit(args, &s, argc, argv);
     opt->release = 1;
     opt->flares = false;
+    opt->binaryTrace = false;
     opt->fastCrash = false;
     opt->elideChecksForKnownLive = false;
     opt->overrideKnownLiveTrue = false;
     opt->census = false;
+    opt->genHeap = false;
+    opt->threadsafeImms = false;
+    opt->allocProfile = false;
+    opt->pruneUnreachable = true;
+    opt->mergeFunctions = true;
+    opt->bulkArrayFill = true;
+    opt->thinInterfaceRefs = false;
 
 
   while ((id = optNext(&s)) != -1) {
@@ -209,6 +270,8 @@ int valeOptSet(ValeOptions *opt, int *argc, char **argv) {
             return 0;
 
         case OPT_DEBUG: opt->release = 0; break;
+        case OPT_DEBUG_INFO: opt->debugInfo = true; break;
+        case OPT_STATS: opt->printStats = true; break;
         case OPT_OUTPUT_DIR: opt->outputDir = s.arg_val; break;
         case OPT_LIBRARY: opt->library = 1; break;
         case OPT_PIC: opt->pic = 1; break;
@@ -224,6 +287,12 @@ int valeOptSet(ValeOptions *opt, int *argc, char **argv) {
         case OPT_LLVMIR: opt->print_llvmir = 1; break;
         case OPT_VERIFY: opt->verify = 1; break;
 
+        case OPT_JIT: opt->jit = true; break;
+        case OPT_JIT_BATCH: opt->jitBatch = true; break;
+        case OPT_JIT_CACHE_DIR: opt->jitCacheDir = s.arg_val; break;
+        case OPT_JIT_ARG: opt->jitArgs.push_back(s.arg_val); break;
+        case OPT_SERVE: opt->serveSocketPath = s.arg_val; break;
+
         case OPT_FLARES: {
           if (!s.arg_val) {
             opt->flares = true;
@@ -284,11 +353,101 @@ int valeOptSet(ValeOptions *opt, int *argc, char **argv) {
           break;
         }
 
+        case OPT_GEN_HEAP: {
+          if (!s.arg_val) {
+            opt->genHeap = true;
+          } else if (s.arg_val == std::string("on")) {
+            opt->genHeap = true;
+          } else if (s.arg_val == std::string("off")) {
+            opt->genHeap = false;
+          } else assert(false);
+          break;
+        }
+
+        case OPT_THREADSAFE_IMMS: {
+          if (!s.arg_val) {
+            opt->threadsafeImms = true;
+          } else if (s.arg_val == std::string("on")) {
+            opt->threadsafeImms = true;
+          } else if (s.arg_val == std::string("off")) {
+            opt->threadsafeImms = false;
+          } else assert(false);
+          break;
+        }
+
+        case OPT_ALLOC_PROFILE: {
+          if (!s.arg_val) {
+            opt->allocProfile = true;
+          } else if (s.arg_val == std::string("on")) {
+            opt->allocProfile = true;
+          } else if (s.arg_val == std::string("off")) {
+            opt->allocProfile = false;
+          } else assert(false);
+          break;
+        }
+
+        case OPT_BINARY_TRACE: {
+          if (!s.arg_val) {
+            opt->binaryTrace = true;
+          } else if (s.arg_val == std::string("on")) {
+            opt->binaryTrace = true;
+          } else if (s.arg_val == std::string("off")) {
+            opt->binaryTrace = false;
+          } else assert(false);
+          break;
+        }
+
+        case OPT_PRUNE_UNREACHABLE: {
+          if (!s.arg_val) {
+            opt->pruneUnreachable = true;
+          } else if (s.arg_val == std::string("on")) {
+            opt->pruneUnreachable = true;
+          } else if (s.arg_val == std::string("off")) {
+            opt->pruneUnreachable = false;
+          } else assert(false);
+          break;
+        }
+
+        case OPT_MERGE_FUNCTIONS: {
+          if (!s.arg_val) {
+            opt->mergeFunctions = true;
+          } else if (s.arg_val == std::string("on")) {
+            opt->mergeFunctions = true;
+          } else if (s.arg_val == std::string("off")) {
+            opt->mergeFunctions = false;
+          } else assert(false);
+          break;
+        }
+
+        case OPT_BULK_ARRAY_FILL: {
+          if (!s.arg_val) {
+            opt->bulkArrayFill = true;
+          } else if (s.arg_val == std::string("on")) {
+            opt->bulkArrayFill = true;
+          } else if (s.arg_val == std::string("off")) {
+            opt->bulkArrayFill = false;
+          } else assert(false);
+          break;
+        }
+
+        case OPT_THIN_INTERFACE_REFS: {
+          if (!s.arg_val) {
+            opt->thinInterfaceRefs = true;
+          } else if (s.arg_val == std::string("on")) {
+            opt->thinInterfaceRefs = true;
+          } else if (s.arg_val == std::string("off")) {
+            opt->thinInterfaceRefs = false;
+          } else assert(false);
+          break;
+        }
+
         case OPT_REGION_OVERRIDE: {
           if (s.arg_val == std::string("unsafe-fast")) {
             opt->regionOverride = RegionOverride::FAST;
           } else if (s.arg_val == std::string("assist")) {
             opt->regionOverride = RegionOverride::ASSIST;
+          } else if (s.arg_val == std::string("arena")) {
+            opt->regionOverride = RegionOverride::ARENA;
           } else if (s.arg_val == std::string("naive-rc")) {
             opt->regionOverride = RegionOverride::NAIVE_RC;
 //          } else if (s.arg_val == std::string("resilient-v0")) {
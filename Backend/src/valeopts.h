@@ -3,6 +3,7 @@
 #define valeopts_h
 
 #include <string>
+#include <vector>
 #include <stdint.h>
 #include <stddef.h>
 
@@ -15,7 +16,9 @@ enum class RegionOverride {
   RESILIENT_V3,
   RESILIENT_V4,
 //  RESILIENT_LIMIT,
-  FAST
+  FAST,
+  // Like FAST, but objects are bump-allocated from builtins/arena.c and never freed one by one.
+  ARENA
 };
 
 // Compiler options
@@ -31,11 +34,16 @@ struct ValeOptions {
     std::string cpu;
     std::string features;
 
+    std::string jitCacheDir;    // Where --jit caches the C inputs it compiled to bitcode
+    std::vector<std::string> jitArgs;    // Arguments for the program's main, with --jit
+    std::string serveSocketPath;    // With --serve, the Unix socket we take requests on
+
     void* data = nullptr; // User-defined data for unit test callbacks
 
     // Boolean flags
     bool wasm = false;        // 1=WebAssembly
     bool release = false;    // 0=debug (no optimizations). 1=release (default)
+    bool debugInfo = false;    // Emit DWARF line tables and frame pointers, see debuginfo.h
     bool library = false;    // 1=generate a C-API compatible static library
     bool pic = false;        // Compile using position independent code
     bool verify = false;        // Verify LLVM IR
@@ -43,11 +51,22 @@ struct ValeOptions {
     bool print_llvmir = false;    // Print out LLVM IR
     bool docs = false;            // Generate code documentation
     bool census = false;    // Enable census checking
+    bool genHeap = false;    // Allocate resilient objects from the type-stable generational heap
+    bool threadsafeImms = false;    // Atomic RC for immutables, per-thread weak tables
+    bool allocProfile = false;    // Count allocations per kind, see builtins/allocprofile.c
     bool flares = false;    // Enable flare output
+    bool printStats = false;    // Print some compiler stats
+    bool pruneUnreachable = true;    // Skip functions and kinds nothing can reach, see reachability.h
+    bool mergeFunctions = true;    // Fold identical functions, see mergefunctions.h
+    bool bulkArrayFill = true;    // Fill arrays from simple generators in bulk, see generatorshape.h
+    bool thinInterfaceRefs = false;    // Keep the itable in the object's control block, see ControlBlockMember::ITABLE_PTR
+    bool binaryTrace = false;    // Record flares into a binary ring buffer instead of printing them
     bool fastCrash = false;    // Enable single-instruction crash, a bit faster
     bool elideChecksForKnownLive = false;    // Enables generational heap
     bool overrideKnownLiveTrue = false;    // Enables generational heap
     bool printMemOverhead = false;    // Enables generational heap
+    bool jit = false;    // Run the program in-process instead of writing build.o, see jit.h
+    bool jitBatch = false;    // Read backend command lines from stdin, and JIT each one
 
     RegionOverride regionOverride = RegionOverride::ASSIST;
 };
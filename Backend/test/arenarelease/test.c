@@ -0,0 +1,60 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+// Includes the allocator itself, so we can check its page bookkeeping directly.
+#include "../../builtins/arena.c"
+
+// Whether everything from the bump pointer to the end of the bump range is in the current page.
+static int bumpRangeInCurrentPage() {
+  return arenaCurrentPage &&
+      arenaBump >= arenaCurrentPage->begin &&
+      arenaBumpEnd == arenaCurrentPage->end &&
+      arenaBump <= arenaBumpEnd;
+}
+
+int main() {
+#ifdef _WIN32
+  _putenv("VALE_ARENA_PAGE_BYTES=4096");
+#else
+  setenv("VALE_ARENA_PAGE_BYTES", "4096", 1);
+#endif
+
+  // Something before the mark, so the mark lands partway into the first page.
+  memset(__vale_arena_malloc(100), 1, 100);
+  int64_t mark = __vale_arena_mark();
+  ValeArenaPage* markPage = arenaCurrentPage;
+
+  // Each of these needs a page of its own.
+  for (int i = 0; i < 20; i++) {
+    memset(__vale_arena_malloc(4000), 2, 4000);
+  }
+  if (arenaCurrentPage == markPage) {
+    fprintf(stderr, "Expected the allocations to go past the mark's page.\n");
+    return 1;
+  }
+
+  // Releasing goes back across all those pages, to the mark's.
+  __vale_arena_release(mark);
+  if (arenaCurrentPage != markPage || !bumpRangeInCurrentPage()) {
+    fprintf(stderr, "Releasing across pages didn't go back to the mark's page.\n");
+    return 1;
+  }
+
+  // These fill the rest of the mark's page, and then move on to new ones.
+  for (int i = 0; i < 20; i++) {
+    char* bytes = (char*)__vale_arena_malloc(1000);
+    if (bytes < arenaCurrentPage->begin || bytes + 1000 > arenaCurrentPage->end) {
+      fprintf(stderr, "Allocation %d went outside its page.\n", i);
+      return 1;
+    }
+    memset(bytes, 3, 1000);
+  }
+
+  __vale_arena_release(0);
+  if (arenaCurrentPage != NULL || arenaBump != NULL || arenaBumpEnd != NULL) {
+    fprintf(stderr, "Releasing everything left something behind.\n");
+    return 1;
+  }
+  return 0;
+}
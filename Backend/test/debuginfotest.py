@@ -0,0 +1,84 @@
+import os
+import re
+import glob
+import argparse
+import subprocess
+
+
+def read_debug_info(ll_file):
+    subprograms = {}  # metadata id -> (function name, line)
+    locations = []  # (scope metadata id, line)
+    with open(ll_file) as f:
+        for line in f:
+            match = re.match(r'^(![0-9]+) = distinct !DISubprogram\(name: "([^"]*)"(?:.*?, line: ([0-9]+))?', line)
+            if match:
+                # LLVM leaves the line out when it's 0.
+                subprograms[match.group(1)] = (match.group(2), int(match.group(3) or 0))
+            match = re.match(r'^![0-9]+ = !DILocation\(line: ([0-9]+).*scope: (![0-9]+)', line)
+            if match:
+                locations.append((match.group(2), int(match.group(1))))
+    return subprograms, locations
+
+
+def parse_expectation(expectation):
+    function, line = expectation.rsplit("=", 1)
+    return function, int(line)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="build a program's .vast files, run the backend on them with --debug_info, and check the lines it gave functions and instructions")
+    parser.add_argument("VALEC", help="path to valec")
+    parser.add_argument("BACKEND", help="path to the backend")
+    parser.add_argument("VALE_INPUT", help="the program to build")
+    parser.add_argument("BUILD_DIR", help="where to put the .vast files and the backend's outputs")
+    parser.add_argument("--region_override", default="assist")
+    parser.add_argument("--subprogram", action="append", default=[], help="FUNCTION=LINE, the line a function's DISubprogram should be on")
+    parser.add_argument("--location", action="append", default=[], help="FUNCTION=LINE, a line some instruction in the function should be on")
+    parser.add_argument("BUILD_ARGS", nargs=argparse.REMAINDER, help="valec arguments, starting with build")
+    args = parser.parse_args()
+
+    build_dir = os.path.abspath(args.BUILD_DIR)
+    subprocess.run(
+        [args.VALEC] + args.BUILD_ARGS + [
+            "vtest=" + os.path.abspath(args.VALE_INPUT),
+            "--output_dir", build_dir,
+            "--no_std", "true",
+            "--run_backend", "false"],
+        check=True)
+    vast_files = sorted(glob.glob(os.path.join(build_dir, "vast", "*.vast")))
+    if not vast_files:
+        raise SystemExit("valec didn't write any .vast files to " + build_dir)
+
+    backend_output_dir = os.path.join(build_dir, "debuginfo")
+    os.makedirs(os.path.join(backend_output_dir, "include"), exist_ok=True)
+    subprocess.run(
+        [args.BACKEND, "--output_dir", backend_output_dir, "--region_override", args.region_override,
+            "--debug_info", "--llvm_ir", "--verify"] + vast_files,
+        check=True)
+
+    subprograms, locations = read_debug_info(os.path.join(backend_output_dir, "build.ll"))
+
+    # Vale functions get an _ and a number on the end of their names in LLVM.
+    def find_subprograms(function):
+        return [
+            (metadata_id, line) for metadata_id, (name, line) in subprograms.items()
+            if re.fullmatch(re.escape(function) + r"_[0-9]+", name)]
+
+    for expectation in args.subprogram:
+        function, expected_line = parse_expectation(expectation)
+        found = find_subprograms(function)
+        if not found:
+            raise SystemExit("No DISubprogram for " + function)
+        if any(line != expected_line for _, line in found):
+            raise SystemExit("{}'s DISubprogram is on line {}, expected {}".format(
+                function, [line for _, line in found], expected_line))
+    for expectation in args.location:
+        function, expected_line = parse_expectation(expectation)
+        scopes = set(metadata_id for metadata_id, _ in find_subprograms(function))
+        if not any(scope in scopes and line == expected_line for scope, line in locations):
+            raise SystemExit("No instruction in {} is on line {}".format(function, expected_line))
+    print("Debug info test passed.")
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,52 @@
+import json
+import struct
+import argparse
+
+
+HEADER_FORMAT = "<4sIIIQ"
+RECORD_FORMAT = "<IIqqQ"
+
+
+def decode_trace(strings_file, trace_file):
+    """Returns the trace's records as readable lines, oldest first."""
+    with open(strings_file, "r") as strings_f:
+        strings = json.load(strings_f)
+    events = strings["events"]
+    locations = strings["locations"]
+
+    with open(trace_file, "rb") as trace_f:
+        data = trace_f.read()
+
+    magic, version, record_size, _, num_records = struct.unpack_from(HEADER_FORMAT, data, 0)
+    if magic != b"VTRC" or version != 1 or record_size != struct.calcsize(RECORD_FORMAT):
+        raise SystemExit("Not a trace this decoder understands!")
+
+    lines = []
+    offset = struct.calcsize(HEADER_FORMAT)
+    first_timestamp = None
+    for _ in range(num_records):
+        event_id, location_id, value0, value1, timestamp = struct.unpack_from(RECORD_FORMAT, data, offset)
+        offset += record_size
+        if first_timestamp is None:
+            first_timestamp = timestamp
+
+        message = events[event_id] if event_id < len(events) else "<unknown event {}>".format(event_id)
+        for value in (value0, value1):
+            message = message.replace("{}", str(value), 1)
+        location = locations[location_id] if location_id < len(locations) else "?"
+        lines.append("+{:<12} {} {}".format(timestamp - first_timestamp, location, message))
+    return lines
+
+
+def main():
+    parser = argparse.ArgumentParser(description="decode a binary trace written by a program built with --binary_trace")
+    parser.add_argument("STRINGS_FILE", help="path to the build's trace_strings.json")
+    parser.add_argument("TRACE_FILE", help="path to the trace, usually vale_trace.bin")
+    args = parser.parse_args()
+
+    for line in decode_trace(args.STRINGS_FILE, args.TRACE_FILE):
+        print(line)
+
+
+if __name__ == '__main__':
+    main()
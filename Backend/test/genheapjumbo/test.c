@@ -0,0 +1,57 @@
+#include <stdlib.h>
+#include <stdio.h>
+
+// Includes the allocator itself, so we can check its slab bookkeeping directly.
+#include "../../builtins/genheap.c"
+
+static int countSlabs() {
+  int numSlabs = 0;
+  for (GenSlab* slab = genHeap.allSlabs; slab; slab = slab->nextInHeap) {
+    numSlabs++;
+  }
+  return numSlabs;
+}
+
+int main() {
+  // Jumbo objects of all sorts of sizes, from just over the small limit up to 64MB, one or two
+  // alive at a time. Reusing only exact fits would make a new slab for nearly every one.
+  uint64_t random = 12345;
+  void* previous = NULL;
+  for (int i = 0; i < 2000; i++) {
+    random = random * 6364136223846793005ULL + 1442695040888963407ULL;
+    int64_t bytes = GEN_HEAP_MAX_SMALL_BYTES + 1 + (int64_t)((random >> 33) % (64 * 1024 * 1024));
+    char* obj = (char*)__genMalloc(bytes);
+    uint32_t gen = *(uint32_t*)obj;
+    if (gen == 0) {
+      fprintf(stderr, "Allocation %d got generation 0.\n", i);
+      return 1;
+    }
+    obj[bytes - 1] = 1;
+    if (previous) {
+      __genFree(previous);
+    }
+    previous = obj;
+
+    if (genHeap.cachedJumboBytes > GEN_HEAP_MAX_CACHED_JUMBO_BYTES) {
+      fprintf(stderr, "Free jumbo slabs kept %llu bytes of pages.\n", (unsigned long long)genHeap.cachedJumboBytes);
+      return 1;
+    }
+  }
+  __genFree(previous);
+
+  int numSlabs = countSlabs();
+  if (numSlabs > 100) {
+    fprintf(stderr, "Made %d jumbo slabs for 2000 allocations.\n", numSlabs);
+    return 1;
+  }
+
+  // A freed object's generation still goes up, even when its slab's pages were released.
+  char* obj = (char*)__genMalloc(GEN_HEAP_MAX_SMALL_BYTES * 8);
+  uint32_t gen = *(uint32_t*)obj;
+  __genFree(obj);
+  if (*(uint32_t*)obj != gen + 1) {
+    fprintf(stderr, "Freeing didn't bump the generation.\n");
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,10 @@
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "vtest/Dimensions.h"
+#include "vtest/shapesArea.h"
+#include "vtest/cShapesArea.h"
+
+ValeInt vtest_cShapesArea(vtest_Dimensions* dims) {
+  return vtest_shapesArea(dims);
+}
@@ -0,0 +1,86 @@
+import os
+import glob
+import socket
+import argparse
+import subprocess
+import tempfile
+
+
+EXIT_MARKER = "vale_server_exit_code:"
+
+
+def send_request(socket_path, request):
+    with socket.socket(socket.AF_UNIX, socket.SOCK_STREAM) as conn:
+        conn.connect(socket_path)
+        conn.sendall((request + "\n").encode())
+        chunks = []
+        while True:
+            chunk = conn.recv(4096)
+            if not chunk:
+                break
+            chunks.append(chunk)
+    return b"".join(chunks).decode(errors="replace")
+
+
+def check_response(name, response, expected_reused, num_packages):
+    print("--- " + name + " ---")
+    print(response, end="")
+    lines = response.strip().splitlines()
+    if not lines or lines[-1] != EXIT_MARKER + " 0":
+        raise SystemExit(name + " didn't end in '" + EXIT_MARKER + " 0'!")
+    expected_stats = "Reused {} of {} packages from the server's cache.".format(expected_reused, num_packages)
+    if expected_stats not in lines:
+        raise SystemExit(name + " didn't say: " + expected_stats)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="build a program's .vast files, then compile them twice through backend --serve")
+    parser.add_argument("VALEC", help="path to valec")
+    parser.add_argument("BACKEND", help="path to the backend")
+    parser.add_argument("VALE_INPUT", help="the program to build")
+    parser.add_argument("BUILD_DIR", help="where to put the .vast files and the server's outputs")
+    parser.add_argument("--region_override", default="assist")
+    parser.add_argument("BUILD_ARGS", nargs=argparse.REMAINDER, help="valec arguments, starting with build")
+    args = parser.parse_args()
+
+    build_dir = os.path.abspath(args.BUILD_DIR)
+    subprocess.run(
+        [args.VALEC] + args.BUILD_ARGS + [
+            "vtest=" + os.path.abspath(args.VALE_INPUT),
+            "--output_dir", build_dir,
+            "--no_std", "true",
+            "--run_backend", "false"],
+        check=True)
+    vast_files = sorted(glob.glob(os.path.join(build_dir, "vast", "*.vast")))
+    if not vast_files:
+        raise SystemExit("valec didn't write any .vast files to " + build_dir)
+
+    # The server splits requests on spaces, and wants absolute paths.
+    server_output_dir = os.path.join(build_dir, "served")
+    os.makedirs(server_output_dir, exist_ok=True)
+    request = " ".join(
+        ["--output_dir", server_output_dir, "--region_override", args.region_override, "--stats"] + vast_files)
+
+    with tempfile.TemporaryDirectory() as socket_dir:
+        socket_path = os.path.join(socket_dir, "backend.sock")
+        server = subprocess.Popen([args.BACKEND, "--serve=" + socket_path], stdout=subprocess.PIPE, text=True)
+        try:
+            # The server says so once it's listening.
+            first_line = server.stdout.readline()
+            if not first_line.startswith("Serving on"):
+                raise SystemExit("Server didn't start, said: " + first_line)
+
+            # The first request reads everything, and the second should find it all in the cache.
+            check_response("first request", send_request(socket_path, request), 0, len(vast_files))
+            os.remove(os.path.join(server_output_dir, "build.o"))
+            check_response("second request", send_request(socket_path, request), len(vast_files), len(vast_files))
+            if not os.path.exists(os.path.join(server_output_dir, "build.o")):
+                raise SystemExit("Second request didn't write build.o!")
+        finally:
+            server.kill()
+            server.wait()
+    print("Server test passed.")
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,49 @@
+import os
+import re
+import glob
+import argparse
+import subprocess
+
+
+def main():
+    parser = argparse.ArgumentParser(description="build a program's .vast files, then check what the backend's --stats says about them")
+    parser.add_argument("VALEC", help="path to valec")
+    parser.add_argument("BACKEND", help="path to the backend")
+    parser.add_argument("VALE_INPUT", help="the program to build")
+    parser.add_argument("BUILD_DIR", help="where to put the .vast files and the backend's outputs")
+    parser.add_argument("--region_override", default="assist")
+    parser.add_argument("--expect", action="append", default=[], help="a regex some line of the stats has to match")
+    parser.add_argument("BUILD_ARGS", nargs=argparse.REMAINDER, help="valec arguments, starting with build")
+    args = parser.parse_args()
+
+    build_dir = os.path.abspath(args.BUILD_DIR)
+    subprocess.run(
+        [args.VALEC] + args.BUILD_ARGS + [
+            "vtest=" + os.path.abspath(args.VALE_INPUT),
+            "--output_dir", build_dir,
+            "--no_std", "true",
+            "--run_backend", "false"],
+        check=True)
+    vast_files = sorted(glob.glob(os.path.join(build_dir, "vast", "*.vast")))
+    if not vast_files:
+        raise SystemExit("valec didn't write any .vast files to " + build_dir)
+
+    backend_output_dir = os.path.join(build_dir, "stats")
+    os.makedirs(backend_output_dir, exist_ok=True)
+    result = subprocess.run(
+        [args.BACKEND, "--output_dir", backend_output_dir, "--region_override", args.region_override, "--stats"] +
+            vast_files,
+        stdout=subprocess.PIPE, stderr=subprocess.STDOUT, text=True)
+    print(result.stdout, end="")
+    if result.returncode != 0:
+        raise SystemExit("Backend failed with exit code {}!".format(result.returncode))
+
+    lines = result.stdout.splitlines()
+    for expected in args.expect:
+        if not any(re.search(expected, line) for line in lines):
+            raise SystemExit("No line of the stats matched: " + expected)
+    print("Stats test passed.")
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,60 @@
+import os
+import re
+import argparse
+import subprocess
+
+from decode_trace import decode_trace
+
+
+def main():
+    parser = argparse.ArgumentParser(description="build a program with --binary_trace, run it, and check what its trace recorded")
+    parser.add_argument("VALEC", help="path to valec")
+    parser.add_argument("VALE_INPUT", help="the program to build")
+    parser.add_argument("BUILD_DIR", help="where to build the program and write its trace")
+    parser.add_argument("--region_override", default="assist")
+    parser.add_argument("--expected_return_code", type=int, default=0)
+    parser.add_argument("--expect", action="append", default=[], help="regexes that records have to match, in this order")
+    parser.add_argument("BUILD_ARGS", nargs=argparse.REMAINDER, help="valec arguments, starting with build")
+    args = parser.parse_args()
+
+    build_dir = os.path.abspath(args.BUILD_DIR)
+    subprocess.run(
+        [args.VALEC] + args.BUILD_ARGS + [
+            "vtest=" + os.path.abspath(args.VALE_INPUT),
+            "--output_dir", build_dir,
+            "--region_override", args.region_override,
+            "--no_std", "true",
+            "--binary_trace", "true"],
+        check=True)
+
+    trace_file = os.path.join(build_dir, "vale_trace.bin")
+    if os.path.exists(trace_file):
+        os.remove(trace_file)
+    env = dict(os.environ, VALE_TRACE=trace_file)
+    result = subprocess.run([os.path.join(build_dir, "main")], env=env)
+    if result.returncode != args.expected_return_code:
+        raise SystemExit("Program returned {}, expected {}!".format(result.returncode, args.expected_return_code))
+    if not os.path.exists(trace_file):
+        raise SystemExit("Program didn't write a trace to " + trace_file)
+
+    lines = decode_trace(os.path.join(build_dir, "trace_strings.json"), trace_file)
+    for line in lines:
+        print(line)
+    if not lines:
+        raise SystemExit("Trace has no records!")
+    for line in lines:
+        if "<unknown event" in line or line.split()[1] == "?":
+            raise SystemExit("Trace has a record that's not in trace_strings.json: " + line)
+
+    line_index = 0
+    for expected in args.expect:
+        while line_index < len(lines) and not re.search(expected, lines[line_index]):
+            line_index += 1
+        if line_index == len(lines):
+            raise SystemExit("No record matched, in order: " + expected)
+        line_index += 1
+    print("Trace test passed.")
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,11 @@
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "vtest/streq.h"
+
+// Says everything's equal, which Builtins' streq never would for different strings.
+int8_t vtest_streq(ValeStr* a, ValeInt aBegin, ValeInt aEnd, ValeStr* b, ValeInt bBegin, int64_t bEnd) {
+  free(a);
+  free(b);
+  return 1;
+}
@@ -24,7 +24,8 @@ object Builtins {
       "opt" -> "opt.vale",
       "result" -> "result.vale",
       "sameinstance" -> "sameinstance.vale",
-      "weak" -> "weak.vale")
+      "weak" -> "weak.vale",
+      "arena" -> "arena.vale")
 
   def load(resourceFilename: String): String = {
     val stream = getClass().getClassLoader().getResourceAsStream(resourceFilename)
@@ -1,6 +1,6 @@
 package dev.vale.finalast
 
-import dev.vale.{PackageCoordinate, PackageCoordinateMap, vassert, vassertSome, vcurious, vfail}
+import dev.vale.{PackageCoordinate, PackageCoordinateMap, RangeS, vassert, vassertSome, vcurious, vfail}
 import dev.vale.vimpl
 import dev.vale.von.IVonData
 
@@ -219,7 +219,11 @@ case class FunctionH(
   attributes: Vector[IFunctionAttributeH],
 
   // The body of the function that contains the actual instructions.
-  body: ExpressionH[KindH]) {
+  body: ExpressionH[KindH],
+
+  // Where the function (or lambda) is in the source, for debug info. None for functions the
+  // compiler made up.
+  range: Option[RangeS]) {
   val hash = runtime.ScalaRunTime._hashCode(this); override def hashCode(): Int = hash; override def equals(obj: Any): Boolean = vcurious();
   def fullName = prototype.fullName
   def isUserFunction = attributes.contains(UserFunctionH)
@@ -1,6 +1,6 @@
 package dev.vale.finalast
 
-import dev.vale.{vassert, vcurious, vfail, vwat}
+import dev.vale.{RangeS, vassert, vcurious, vfail, vwat}
 import dev.vale.vimpl
 
 // Common trait for all instructions.
@@ -262,7 +262,9 @@ case class LocalLoadH(
   // to load a borrow reference from an owning local.
   targetOwnership: OwnershipH,
   // Name of the local variable, for debug purposes.
-  localName: FullNameH
+  localName: FullNameH,
+  // Where the lookup is in the source, for debug info. None if the compiler made it up.
+  range: Option[RangeS]
 ) extends ExpressionH[KindH] {
   val hash = runtime.ScalaRunTime._hashCode(this); override def hashCode(): Int = hash; override def equals(obj: Any): Boolean = vcurious();
   vassert(targetOwnership != OwnH) // must unstackify to get an owning reference
@@ -314,7 +316,9 @@ case class MemberLoadH(
   // The type of the resulting reference.
   resultType: ReferenceH[KindH],
   // Member's name, for debug purposes.
-  memberName: FullNameH
+  memberName: FullNameH,
+  // Where the lookup is in the source, for debug info. None if the compiler made it up.
+  range: Option[RangeS]
 ) extends ExpressionH[KindH] {
 
   // See BRCOBS, source shouldn't be Never.
@@ -718,6 +722,22 @@ case class PushRuntimeSizedArrayH(
   override def resultType: ReferenceH[KindH] = ReferenceH(ShareH, InlineH, VoidH())
 }
 
+// Moves all of one mutable unknown-size array's elements onto the end of another, in order,
+// and destroys the first. The second must have room for them.
+case class MigrateRuntimeSizedArrayH(
+  // Expression for the array to move elements out of, which is then destroyed.
+  sourceArrayExpression: ExpressionH[RuntimeSizedArrayHT],
+  // Expression for the array to move the elements onto.
+  targetArrayExpression: ExpressionH[RuntimeSizedArrayHT],
+) extends ExpressionH[KindH] {
+  vassert(sourceArrayExpression.resultType.ownership == OwnH)
+  vassert(sourceArrayExpression.resultType.kind == targetArrayExpression.resultType.kind)
+
+  val hash = runtime.ScalaRunTime._hashCode(this); override def hashCode(): Int = hash; override def equals(obj: Any): Boolean = vcurious();
+
+  override def resultType: ReferenceH[KindH] = ReferenceH(ShareH, InlineH, VoidH())
+}
+
 // Adds a new element to the end of a mutable unknown-size array.
 case class PopRuntimeSizedArrayH(
   // Expression for the array to add to.
@@ -327,6 +327,26 @@ class ExpressionHammer(
         (access, Vector.empty)
       }
 
+      case MigrateRuntimeSizedArrayTE(sourceTE, targetTE) => {
+        val (sourceHE, sourceDeferreds) =
+          translate(
+            hinputs, hamuts, currentFunctionHeader, locals, sourceTE);
+        val (targetHE, targetDeferreds) =
+          translate(
+            hinputs, hamuts, currentFunctionHeader, locals, targetTE);
+
+        val migrateHE =
+          MigrateRuntimeSizedArrayH(
+            sourceHE.expectRuntimeSizedArrayAccess(),
+            targetHE.expectRuntimeSizedArrayAccess())
+
+        val access =
+          translateDeferreds(
+            hinputs, hamuts, currentFunctionHeader, locals, migrateHE, sourceDeferreds ++ targetDeferreds)
+
+        (access, Vector.empty)
+      }
+
       case prsaTE @ PopRuntimeSizedArrayTE(_) => {
         val PopRuntimeSizedArrayTE(arrayTE) = prsaTE;
 
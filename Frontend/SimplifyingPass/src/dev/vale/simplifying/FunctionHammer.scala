@@ -74,7 +74,9 @@ class FunctionHammer(
         val isAbstract = header.getAbstractInterface.nonEmpty
         val isExtern = header.attributes.exists({ case ExternT(packageCoord) => true case _ => false })
         val attrsH = translateFunctionAttributes(attrs2.filter(a => !a.isInstanceOf[ExternT]))
-        val functionH = FunctionH(prototypeH, isAbstract, isExtern, attrsH, bodyH);
+        val functionH =
+          FunctionH(
+            prototypeH, isAbstract, isExtern, attrsH, bodyH, header.maybeOriginFunction.map(_.range));
         hamuts.addFunction(header.toPrototype, functionH)
 
         (temporaryFunctionRefH)
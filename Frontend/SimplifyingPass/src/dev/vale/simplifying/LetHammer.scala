@@ -142,7 +142,8 @@ class LetHammer(
         varId,
         variability,
         sourceExpr2.result.reference,
-        letTE.result.reference.ownership)
+        letTE.result.reference.ownership,
+        None)
     ConsecutorH(Vector(stackifyH, borrowAccess))
   }
 
@@ -202,7 +203,8 @@ class LetHammer(
         locals,
         varId,
         sourceExpr2.result.reference,
-        letTE.result.reference.ownership)
+        letTE.result.reference.ownership,
+        None)
 
       ConsecutorH(Vector(stackifyH, borrowAccess))
   }
@@ -1,6 +1,6 @@
 package dev.vale.simplifying
 
-import dev.vale.{finalast, vassert, vfail}
+import dev.vale.{RangeS, finalast, vassert, vfail}
 import dev.vale.finalast.{BorrowH, ExpressionH, KindH, LocalLoadH, MemberLoadH, OwnH, ReferenceH, RuntimeSizedArrayLoadH, ShareH, StaticSizedArrayLoadH, YonderH}
 import dev.vale.typing.Hinputs
 import dev.vale.typing.ast.{AddressMemberLookupTE, ExpressionT, FunctionHeaderT, LocalLookupTE, ReferenceExpressionTE, ReferenceMemberLookupTE, RuntimeSizedArrayLookupTE, SoftLoadTE, StaticSizedArrayLookupTE}
@@ -33,17 +33,17 @@ class LoadHammer(
 
     val (loadedAccessH, sourceDeferreds) =
       sourceExpr2 match {
-        case LocalLookupTE(_,ReferenceLocalVariableT(varId, variability, reference)) => {
-          translateMundaneLocalLoad(hinputs, hamuts, currentFunctionHeader, locals, varId, reference, targetOwnership)
+        case LocalLookupTE(range,ReferenceLocalVariableT(varId, variability, reference)) => {
+          translateMundaneLocalLoad(hinputs, hamuts, currentFunctionHeader, locals, varId, reference, targetOwnership, Some(range))
         }
-        case LocalLookupTE(_,AddressibleLocalVariableT(varId, variability, localReference2)) => {
-          translateAddressibleLocalLoad(hinputs, hamuts, currentFunctionHeader, locals, varId, variability, localReference2, targetOwnership)
+        case LocalLookupTE(range,AddressibleLocalVariableT(varId, variability, localReference2)) => {
+          translateAddressibleLocalLoad(hinputs, hamuts, currentFunctionHeader, locals, varId, variability, localReference2, targetOwnership, Some(range))
         }
-        case ReferenceMemberLookupTE(_,structExpr2, memberName, memberType2, _) => {
-          translateMundaneMemberLoad(hinputs, hamuts, currentFunctionHeader, locals, structExpr2, memberType2, memberName, targetOwnership)
+        case ReferenceMemberLookupTE(range,structExpr2, memberName, memberType2, _) => {
+          translateMundaneMemberLoad(hinputs, hamuts, currentFunctionHeader, locals, structExpr2, memberType2, memberName, targetOwnership, Some(range))
         }
-        case AddressMemberLookupTE(_,structExpr2, memberName, memberType2, _) => {
-          translateAddressibleMemberLoad(hinputs, hamuts, currentFunctionHeader, locals, structExpr2, memberName, memberType2, targetOwnership)
+        case AddressMemberLookupTE(range,structExpr2, memberName, memberType2, _) => {
+          translateAddressibleMemberLoad(hinputs, hamuts, currentFunctionHeader, locals, structExpr2, memberName, memberType2, targetOwnership, Some(range))
         }
         case RuntimeSizedArrayLookupTE(_, arrayExpr2, _, indexExpr2, _) => {
           translateMundaneRuntimeSizedArrayLoad(hinputs, hamuts, currentFunctionHeader, locals, arrayExpr2, indexExpr2, targetOwnership)
@@ -160,6 +160,7 @@ class LoadHammer(
       memberName: FullNameT[IVarNameT],
       expectedType2: CoordT,
       targetOwnershipT: OwnershipT,
+      range: Option[RangeS],
   ): (ExpressionH[KindH], Vector[ExpressionT]) = {
     val (structResultLine, structDeferreds) =
       expressionHammer.translate(hinputs, hamuts, currentFunctionHeader, locals, structExpr2);
@@ -196,7 +197,8 @@ class LoadHammer(
           memberIndex,
           boxInStructCoord,
           boxInStructCoord,
-          varFullNameH)
+          varFullNameH,
+          range)
 
     val targetOwnership = Conversions.evaluateOwnership(targetOwnershipT)
     val loadResultType =
@@ -210,7 +212,8 @@ class LoadHammer(
           StructHammer.BOX_MEMBER_INDEX,
           boxedTypeH,
           loadResultType,
-          nameHammer.addStep(hamuts, boxStructRefH.fullName, StructHammer.BOX_MEMBER_NAME))
+          nameHammer.addStep(hamuts, boxStructRefH.fullName, StructHammer.BOX_MEMBER_NAME),
+          range)
     (loadedNodeH, structDeferreds)
   }
 
@@ -224,6 +227,7 @@ class LoadHammer(
       memberName: FullNameT[IVarNameT],
 //      resultCoord: Coord,
       targetOwnershipT: OwnershipT,
+      range: Option[RangeS],
   ): (ExpressionH[KindH], Vector[ExpressionT]) = {
     val (structResultLine, structDeferreds) =
       expressionHammer.translate(hinputs, hamuts, currentFunctionHeader, locals, structExpr2);
@@ -253,7 +257,8 @@ class LoadHammer(
           memberIndex,
           expectedMemberTypeH,
           loadResultType,
-          nameHammer.translateFullName(hinputs, hamuts, memberName))
+          nameHammer.translateFullName(hinputs, hamuts, memberName),
+          range)
     (loadedNode, structDeferreds)
   }
 
@@ -266,6 +271,7 @@ class LoadHammer(
       variability: VariabilityT,
       localReference2: CoordT,
       targetOwnershipT: OwnershipT,
+      range: Option[RangeS],
   ): (ExpressionH[KindH], Vector[ExpressionT]) = {
     val local = locals.get(varId).get
     vassert(!locals.unstackifiedVars.contains(local.id))
@@ -283,7 +289,8 @@ class LoadHammer(
         LocalLoadH(
           local,
           finalast.BorrowH,
-          varNameH)
+          varNameH,
+          range)
 
     val targetOwnership = Conversions.evaluateOwnership(targetOwnershipT)
     val loadResultType = ReferenceH(targetOwnership, localTypeH.location, localTypeH.kind)
@@ -294,7 +301,8 @@ class LoadHammer(
           StructHammer.BOX_MEMBER_INDEX,
           localTypeH,
           loadResultType,
-          nameHammer.addStep(hamuts, boxStructRefH.fullName, StructHammer.BOX_MEMBER_NAME))
+          nameHammer.addStep(hamuts, boxStructRefH.fullName, StructHammer.BOX_MEMBER_NAME),
+          range)
     (loadedNode, Vector.empty)
   }
 
@@ -306,6 +314,7 @@ class LoadHammer(
       varId: FullNameT[IVarNameT],
       expectedType2: CoordT,
       targetOwnershipT: OwnershipT,
+      range: Option[RangeS],
   ): (ExpressionH[KindH], Vector[ExpressionT]) = {
     val targetOwnership = Conversions.evaluateOwnership(targetOwnershipT)
 
@@ -325,7 +334,8 @@ class LoadHammer(
         LocalLoadH(
           local,
           targetOwnership,
-          nameHammer.translateFullName(hinputs, hamuts, varId))
+          nameHammer.translateFullName(hinputs, hamuts, varId),
+          range)
     (loadedNode, Vector.empty)
   }
 
@@ -336,7 +346,7 @@ class LoadHammer(
       locals: LocalsBox,
       lookup2: LocalLookupTE):
   (ExpressionH[KindH]) = {
-    val LocalLookupTE(_,localVar) = lookup2;
+    val LocalLookupTE(range,localVar) = lookup2;
 
     val local = locals.get(localVar.id).get
     vassert(!locals.unstackifiedVars.contains(local.id))
@@ -349,7 +359,8 @@ class LoadHammer(
       LocalLoadH(
         local,
         finalast.BorrowH,
-        nameHammer.translateFullName(hinputs, hamuts, localVar.id))
+        nameHammer.translateFullName(hinputs, hamuts, localVar.id),
+        Some(range))
     loadBoxNode
   }
 
@@ -362,7 +373,7 @@ class LoadHammer(
       locals: LocalsBox,
       lookup2: AddressMemberLookupTE):
   (ExpressionH[KindH], Vector[ExpressionT]) = {
-    val AddressMemberLookupTE(_,structExpr2, memberName, resultType2, _) = lookup2;
+    val AddressMemberLookupTE(range,structExpr2, memberName, resultType2, _) = lookup2;
 
     val (structResultLine, structDeferreds) =
       expressionHammer.translate(hinputs, hamuts, currentFunctionHeader, locals, structExpr2);
@@ -409,7 +420,8 @@ class LoadHammer(
         memberIndex,
         expectedStructBoxMemberType,
         loadResultType,
-        nameHammer.translateFullName(hinputs, hamuts, memberName))
+        nameHammer.translateFullName(hinputs, hamuts, memberName),
+        Some(range))
 
     (loadBoxNode, structDeferreds)
   }
@@ -166,7 +166,8 @@ class MutateHammer(
           memberIndex,
           expectedStructBoxMemberType,
           loadResultType,
-          nameH)
+          nameH,
+          None)
     val storeNode =
         MemberStoreH(
           boxedTypeH,
@@ -236,7 +237,8 @@ class MutateHammer(
       LocalLoadH(
         local,
         finalast.BorrowH,
-        nameH)
+        nameH,
+        None)
     val storeNode =
         MemberStoreH(
           structDefH.members.head.tyype,
@@ -342,7 +342,7 @@ class VonHammer(nameHammer: NameHammer, typeHammer: TypeHammer) {
   }
 
   def vonifyFunction(functionH: FunctionH): IVonData = {
-    val FunctionH(prototype, _, _, _, body) = functionH
+    val FunctionH(prototype, _, _, _, body, range) = functionH
 
     VonObject(
       "Function",
@@ -350,7 +350,8 @@ class VonHammer(nameHammer: NameHammer, typeHammer: TypeHammer) {
       Vector(
         VonMember("prototype", vonifyPrototype(prototype)),
         // TODO: rename block to body
-        VonMember("block", vonifyExpression(body))))
+        VonMember("block", vonifyExpression(body)),
+        VonMember("range", vonifyOptional[RangeS](range, r => vonifyRange(r)))))
   }
 
   def vonifyExpression(node: ExpressionH[KindH]): IVonData = {
@@ -578,6 +579,17 @@ class VonHammer(nameHammer: NameHammer, typeHammer: TypeHammer) {
             VonMember("newcomerKind", vonifyKind(newcomerExpr.resultType.kind)),
             VonMember("consumerKnownLive", VonBool(false))))
       }
+      case MigrateRuntimeSizedArrayH(sourceArrayExpr, targetArrayExpr) => {
+        VonObject(
+          "MigrateRuntimeSizedArray",
+          None,
+          Vector(
+            VonMember("sourceArrayExpr", vonifyExpression(sourceArrayExpr)),
+            VonMember("sourceArrayType", vonifyCoord(sourceArrayExpr.resultType)),
+            VonMember("targetArrayExpr", vonifyExpression(targetArrayExpr)),
+            VonMember("targetArrayType", vonifyCoord(targetArrayExpr.resultType)),
+            VonMember("arrayKind", vonifyKind(targetArrayExpr.resultType.kind))))
+      }
       case PopRuntimeSizedArrayH(arrayExpr, arrayElementType) => {
         VonObject(
           "PopRuntimeSizedArray",
@@ -637,14 +649,15 @@ class VonHammer(nameHammer: NameHammer, typeHammer: TypeHammer) {
             VonMember("localName", vonifyName(localName)),
             VonMember("knownLive", VonBool(false))))
       }
-      case LocalLoadH(local, targetOwnership, localName) => {
+      case LocalLoadH(local, targetOwnership, localName, range) => {
         VonObject(
           "LocalLoad",
           None,
           Vector(
             VonMember("local", vonifyLocal(local)),
             VonMember("targetOwnership", vonifyOwnership(targetOwnership)),
-            VonMember("localName", vonifyName(localName))))
+            VonMember("localName", vonifyName(localName)),
+            VonMember("range", vonifyOptional[RangeS](range, r => vonifyRange(r)))))
       }
       case MemberStoreH(resultType, structExpr, memberIndex, sourceExpr, memberName) => {
         VonObject(
@@ -659,7 +672,7 @@ class VonHammer(nameHammer: NameHammer, typeHammer: TypeHammer) {
             VonMember("sourceExpr", vonifyExpression(sourceExpr)),
             VonMember("memberName", vonifyName(memberName))))
       }
-      case ml @ MemberLoadH(structExpr, memberIndex, expectedMemberType, resultType, memberName) => {
+      case ml @ MemberLoadH(structExpr, memberIndex, expectedMemberType, resultType, memberName, range) => {
         VonObject(
           "MemberLoad",
           None,
@@ -672,7 +685,8 @@ class VonHammer(nameHammer: NameHammer, typeHammer: TypeHammer) {
             VonMember("targetOwnership", vonifyOwnership(resultType.ownership)),
             VonMember("expectedMemberType", vonifyCoord(expectedMemberType)),
             VonMember("expectedResultType", vonifyCoord(resultType)),
-            VonMember("memberName", vonifyName(memberName))))
+            VonMember("memberName", vonifyName(memberName)),
+            VonMember("range", vonifyOptional[RangeS](range, r => vonifyRange(r)))))
       }
       case StaticSizedArrayStoreH(arrayExpr, indexExpr, sourceExpr, resultType) => {
         VonObject(
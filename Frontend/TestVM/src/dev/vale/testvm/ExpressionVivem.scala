@@ -462,7 +462,7 @@ object ExpressionVivem {
 //        NodeContinue(exprId))
       }
 
-      case ll @ LocalLoadH(local, targetOwnership, name) => {
+      case ll @ LocalLoadH(local, targetOwnership, name, _) => {
         vassert(targetOwnership != OwnH) // should have been Unstackified instead
         val varAddress = heap.getVarAddress(expressionId.callId, local)
         val reference = heap.getReferenceFromLocal(varAddress, local.typeH, ll.resultType)
@@ -605,7 +605,7 @@ object ExpressionVivem {
         NodeContinue(arrayReference)
       }
 
-      case ml @ MemberLoadH(structExpr, memberIndex, expectedMemberType, resultType, memberName) => {
+      case ml @ MemberLoadH(structExpr, memberIndex, expectedMemberType, resultType, memberName, _) => {
         val structReference =
           executeNode(programH, stdin, stdout, heap, expressionId.addStep(0), structExpr) match {
             case r @ (NodeReturn(_) | NodeBreak()) => return r
@@ -817,6 +817,45 @@ object ExpressionVivem {
         NodeContinue(heap.void)
       }
 
+      case MigrateRuntimeSizedArrayH(sourceHE, targetHE) => {
+        val sourceReference =
+          executeNode(programH, stdin, stdout, heap, expressionId.addStep(0), sourceHE) match {
+            case r @ (NodeReturn(_) | NodeBreak()) => return r
+            case NodeContinue(r) => r
+          }
+        val targetReference =
+          executeNode(programH, stdin, stdout, heap, expressionId.addStep(1), targetHE) match {
+            case r @ (NodeReturn(_) | NodeBreak()) => return r
+            case NodeContinue(r) => r
+          }
+
+        val (numElements, targetRoom) =
+          (heap.dereference(sourceReference), heap.dereference(targetReference)) match {
+            case (source @ ArrayInstanceV(_, _, _, _), target @ ArrayInstanceV(_, _, _, _)) => {
+              (source.getSize(), target.capacity - target.getSize())
+            }
+          }
+        if (numElements > targetRoom) {
+          throw PanicException();
+        }
+        // Popping takes them off the end, so put them back in the order they were in.
+        val elementReferences = (0 until numElements).map(_ => heap.deinitializeArrayElement(sourceReference)).reverse
+        elementReferences.foreach(elementReference => {
+          heap.initializeArrayElement(targetReference, elementReference)
+        })
+
+        // Now destroy the empty source, like DestroyMutRuntimeSizedArrayH does.
+        heap.decrementReferenceRefCount(RegisterToObjectReferrer(callId, sourceReference.ownership), sourceReference)
+        heap.ensureRefCount(sourceReference, None, 0)
+        heap.zero(sourceReference)
+        heap.deallocateIfNoWeakRefs(sourceReference)
+
+        discard(programH, heap, stdout, stdin, callId, targetHE.resultType, targetReference)
+
+        heap.vivemDout.print(" o" + targetReference.num + "+=o" + sourceReference.num)
+        NodeContinue(heap.void)
+      }
+
       case PopRuntimeSizedArrayH(arrayHE, elementType) => {
         val arrayReference =
           executeNode(programH, stdin, stdout, heap, expressionId.addStep(0), arrayHE) match {
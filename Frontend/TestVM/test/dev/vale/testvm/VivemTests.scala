@@ -20,7 +20,8 @@ class VivemTests extends FunSuite with Matchers {
         true,
         false,
         Vector(UserFunctionH),
-        BlockH(ConstantIntH(7, 32)))
+        BlockH(ConstantIntH(7, 32)),
+        None)
     val packages = new PackageCoordinateMap[PackageH]()
     packages.put(PackageCoordinate.TEST_TLD(interner), PackageH(Vector.empty, Vector.empty, Vector(main), Vector.empty, Vector.empty, Map(), Map("main" -> main.prototype), Map(), Map(), Map()))
     val programH = ProgramH(packages)
@@ -64,14 +65,16 @@ class VivemTests extends FunSuite with Matchers {
                 addPrototype,
                 Vector(
                   ConstantIntH(53, 32),
-                  ConstantIntH(54, 32)))))))
+                  ConstantIntH(54, 32)))))),
+        None)
     val addExtern =
       FunctionH(
         addPrototype,
         false,
         true,
         Vector.empty,
-        BlockH(ConstantIntH(133337, 32)))
+        BlockH(ConstantIntH(133337, 32)),
+        None)
 
     val packages = new PackageCoordinateMap[PackageH]()
     packages.put(PackageCoordinate.BUILTIN(interner), PackageH(Vector.empty, Vector.empty, Vector(addExtern), Vector.empty, Vector.empty, Map(), Map(), Map(), Map("__vbi_addI32" -> addPrototype), Map()))
@@ -22,7 +22,7 @@ import dev.vale.typing.ast.{ConsecutorTE, EdgeT, FunctionHeaderT, LocationInFunc
 import dev.vale.typing.env.{FunctionEnvEntry, FunctionEnvironment, GlobalEnvironment, IEnvEntry, IEnvironment, ImplEnvEntry, InterfaceEnvEntry, NodeEnvironment, NodeEnvironmentBox, PackageEnvironment, StructEnvEntry, TemplataEnvEntry, TemplatasStore}
 import dev.vale.typing.macros.{AbstractBodyMacro, AnonymousInterfaceMacro, AsSubtypeMacro, FunctorHelper, LockWeakMacro, SameInstanceMacro, StructConstructorMacro}
 import dev.vale.typing.macros.citizen.{ImplDropMacro, ImplFreeMacro, InterfaceDropMacro, InterfaceFreeMacro, StructDropMacro, StructFreeMacro}
-import dev.vale.typing.macros.rsa.{RSADropIntoMacro, RSAFreeMacro, RSAImmutableNewMacro, RSALenMacro, RSAMutableCapacityMacro, RSAMutableNewMacro, RSAMutablePopMacro, RSAMutablePushMacro}
+import dev.vale.typing.macros.rsa.{RSADropIntoMacro, RSAFreeMacro, RSAImmutableNewMacro, RSALenMacro, RSAMutableCapacityMacro, RSAMutableNewMacro, RSAMutableMigrateMacro, RSAMutablePopMacro, RSAMutablePushMacro}
 import dev.vale.typing.macros.ssa.{SSADropIntoMacro, SSAFreeMacro, SSALenMacro}
 import dev.vale.typing.names.{FullNameT, INameT, NameTranslator, PackageTopLevelNameT, PrimitiveNameT}
 import dev.vale.typing.templata.{FunctionTemplata, ITemplata, InterfaceTemplata, KindTemplata, PrototypeTemplata, RuntimeSizedArrayTemplateTemplata, StaticSizedArrayTemplateTemplata, StructTemplata}
@@ -399,6 +399,7 @@ class Compiler(
   val rsaImmNewMacro = new RSAImmutableNewMacro(interner)
   val rsaPushMacro = new RSAMutablePushMacro(interner)
   val rsaPopMacro = new RSAMutablePopMacro(interner)
+  val rsaMigrateMacro = new RSAMutableMigrateMacro(interner)
   val rsaCapacityMacro = new RSAMutableCapacityMacro(interner)
   val ssaLenMacro = new SSALenMacro()
   val rsaDropMacro = new RSADropIntoMacro(arrayCompiler)
@@ -490,6 +491,7 @@ class Compiler(
               rsaImmNewMacro.generatorId -> rsaImmNewMacro,
               rsaPushMacro.generatorId -> rsaPushMacro,
               rsaPopMacro.generatorId -> rsaPopMacro,
+              rsaMigrateMacro.generatorId -> rsaMigrateMacro,
               rsaCapacityMacro.generatorId -> rsaCapacityMacro,
               ssaLenMacro.generatorId -> ssaLenMacro,
               rsaDropMacro.generatorId -> rsaDropMacro,
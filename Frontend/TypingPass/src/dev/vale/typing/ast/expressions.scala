@@ -665,6 +665,15 @@ case class PushRuntimeSizedArrayTE(
   override def result: ReferenceResultT = ReferenceResultT(CoordT(ShareT, VoidT()))
 }
 
+// Moves all of the source array's elements onto the end of the target array, in order, and
+// destroys the source array.
+case class MigrateRuntimeSizedArrayTE(
+  sourceArrayExpr: ReferenceExpressionTE,
+  targetArrayExpr: ReferenceExpressionTE
+) extends ReferenceExpressionTE {
+  override def result: ReferenceResultT = ReferenceResultT(CoordT(ShareT, VoidT()))
+}
+
 case class PopRuntimeSizedArrayTE(
   arrayExpr: ReferenceExpressionTE
 ) extends ReferenceExpressionTE {
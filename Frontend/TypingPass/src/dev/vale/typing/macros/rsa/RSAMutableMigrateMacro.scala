@@ -0,0 +1,40 @@
+package dev.vale.typing.macros.rsa
+
+import dev.vale.highertyping.FunctionA
+import dev.vale.typing.CompilerOutputs
+import dev.vale.typing.ast.{ArgLookupTE, BlockTE, FunctionHeaderT, FunctionT, LocationInFunctionEnvironment, MigrateRuntimeSizedArrayTE, ParameterT, ReturnTE}
+import dev.vale.typing.env.FunctionEnvironment
+import dev.vale.typing.macros.IFunctionBodyMacro
+import dev.vale.typing.types.CoordT
+import dev.vale.{Interner, RangeS}
+
+
+class RSAMutableMigrateMacro( interner: Interner) extends IFunctionBodyMacro {
+  val generatorId: String = "vale_runtime_sized_array_migrate"
+
+  def generateFunctionBody(
+    env: FunctionEnvironment,
+    coutputs: CompilerOutputs,
+    generatorId: String,
+    life: LocationInFunctionEnvironment,
+    callRange: RangeS,
+    originFunction: Option[FunctionA],
+    paramCoords: Vector[ParameterT],
+    maybeRetCoord: Option[CoordT]):
+  FunctionHeaderT = {
+    val header =
+      FunctionHeaderT(
+        env.fullName, Vector.empty, paramCoords, maybeRetCoord.get, originFunction)
+    coutputs.declareFunctionReturnType(header.toSignature, header.returnType)
+
+    coutputs.addFunction(
+      FunctionT(
+        header,
+        BlockTE(
+          ReturnTE(
+            MigrateRuntimeSizedArrayTE(
+              ArgLookupTE(0, paramCoords(0).tyype),
+              ArgLookupTE(1, paramCoords(1).tyype))))))
+    header
+  }
+}
@@ -2,21 +2,38 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <errno.h>
 #include "ValeBuiltins.h"
 #include "stdlib/StrArray.h"
 
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#include <poll.h>
+#endif
+
+// How much the poller reads from a ready pipe at a time.
+#define SUBPROCESS_POLL_CHUNK_SIZE 65536
+
+// Reads whatever the pipe has (up to bytes), waiting only if it has nothing yet. Returns 0 once
+// the other end is closed and everything's been read. This goes straight to the file descriptor,
+// so nothing may read these pipes through their FILE*s.
 long read_into_buffer(char* buffer, ValeInt bytes, FILE* stream){
-  long i = 0;
-  for(i = 0; i < bytes; i++){
-    // feof comes after fgetc but before its result is used, taken from example at
-    // https://www.tutorialspoint.com/c_standard_library/c_function_fgetc.htm
-    int c = fgetc(stream);
-    if(feof(stream)) {
-      break;
+  if (!stream || bytes <= 0) {
+    return 0;
+  }
+  for (;;) {
+#ifdef _WIN32
+    long result = _read(_fileno(stream), buffer, bytes);
+#else
+    long result = read(fileno(stream), buffer, bytes);
+#endif
+    if (result < 0 && errno == EINTR) {
+      continue;
     }
-    buffer[i] = c;
+    return result < 0 ? 0 : result;
   }
-  return i;
 }
 
 ValeStr* stdlib_get_env_var(ValeStr* var_name) {
@@ -56,31 +73,25 @@ int64_t stdlib_launch_command(stdlib_StrArray* chain) {
   return out;
 }
 
-ValeStr* stdlib_read_stdout(int64_t cmd, long bytes) {
-  ValeStr* out = ValeStrNew(bytes+1); 
-  FILE* stdout_handle = subprocess_stdout((struct subprocess_s*)cmd); 
-  long read_len = read_into_buffer(out->chars, bytes, stdout_handle);
-  out->chars[bytes] = '\0'; 
+static ValeStr* read_chunk(FILE* stream, long bytes) {
+  ValeStr* out = ValeStrNew(bytes);
+  long read_len = read_into_buffer(out->chars, bytes, stream);
+  out->chars[read_len] = '\0';
   out->length = read_len;
-  //fclose(stdout_handle);
   return out;
 }
 
+ValeStr* stdlib_read_stdout(int64_t cmd, long bytes) {
+  return read_chunk(subprocess_stdout((struct subprocess_s*)cmd), bytes);
+}
+
 ValeStr* stdlib_read_stderr(int64_t cmd, long bytes) {
-  ValeStr* out = ValeStrNew(bytes+1);
-  FILE* stderr_handle = subprocess_stderr((struct subprocess_s*)cmd); 
-  long read_len = read_into_buffer(out->chars, bytes, stderr_handle);
-  out->chars[bytes] = '\0'; 
-  out->length = read_len;
-  //fclose(stderr_handle);
-  return out;
+  return read_chunk(subprocess_stderr((struct subprocess_s*)cmd), bytes);
 }
 
 void stdlib_write_stdin(int64_t cmd, ValeStr* contents) {
   FILE* stdin_handle = subprocess_stdin((struct subprocess_s*)cmd); 
-  for (int i = 0; i < contents->length; i++) {
-    fputc(contents->chars[i], stdin_handle);
-  }
+  fwrite(contents->chars, 1, contents->length, stdin_handle);
   free(contents);
 }
 
@@ -119,3 +130,215 @@ long stdlib_destroy(int64_t handle){
 int8_t stdlib_alive(int64_t handle){
   return subprocess_alive((struct subprocess_s*)handle);
 }
+
+// Waits on the stdout and stderr pipes of many subprocesses at once, so that one chatty pipe
+// can't fill up and stall its process while we're blocked reading another. A subprocess stays
+// in the poller until both its pipes are closed, which is when it's ready to join. One that
+// never had either pipe is reported finished by the very next wait.
+
+typedef struct {
+  struct subprocess_s* process;
+  ValeInt token;
+  int stdoutOpen;
+  int stderrOpen;
+} SubprocessPollEntry;
+
+typedef struct {
+  ValeInt token;
+  // Null if there was nothing on that pipe this time.
+  ValeStr* stdoutChunk;
+  ValeStr* stderrChunk;
+  int8_t finished;
+  // Which entry this came from, until we drop the finished ones.
+  ValeInt entryIndex;
+} SubprocessPollEvent;
+
+typedef struct {
+  SubprocessPollEntry* entries;
+  ValeInt numEntries;
+  ValeInt capacity;
+  SubprocessPollEvent* events;
+  ValeInt numEvents;
+  // How many entries were added with neither pipe, see stdlib_poller_add.
+  ValeInt numFinishedOnAdd;
+#ifndef _WIN32
+  struct pollfd* fds;
+#endif
+} SubprocessPoller;
+
+static void poller_clear_events(SubprocessPoller* poller) {
+  for (ValeInt i = 0; i < poller->numEvents; i++) {
+    free(poller->events[i].stdoutChunk);
+    free(poller->events[i].stderrChunk);
+  }
+  poller->numEvents = 0;
+}
+
+int64_t stdlib_poller_new() {
+  SubprocessPoller* poller = calloc(1, sizeof(SubprocessPoller));
+  return (int64_t)poller;
+}
+
+void stdlib_poller_add(int64_t handle, int64_t cmd, ValeInt token) {
+  SubprocessPoller* poller = (SubprocessPoller*)handle;
+  struct subprocess_s* process = (struct subprocess_s*)cmd;
+  if (poller->numEntries == poller->capacity) {
+    poller->capacity = poller->capacity ? poller->capacity * 2 : 8;
+    poller->entries = realloc(poller->entries, poller->capacity * sizeof(SubprocessPollEntry));
+    // Events can only be for entries from before this add, so they don't move.
+    SubprocessPollEvent* events = malloc(poller->capacity * sizeof(SubprocessPollEvent));
+    if (poller->numEvents > 0) {
+      memcpy(events, poller->events, poller->numEvents * sizeof(SubprocessPollEvent));
+    }
+    free(poller->events);
+    poller->events = events;
+#ifndef _WIN32
+    // Two per entry, stdout then stderr.
+    poller->fds = realloc(poller->fds, poller->capacity * 2 * sizeof(struct pollfd));
+#endif
+    if (!poller->entries || !poller->events) {
+      fprintf(stderr, "Couldn't grow subprocess poller!\n");
+      exit(1);
+    }
+  }
+  SubprocessPollEntry* entry = &poller->entries[poller->numEntries++];
+  entry->process = process;
+  entry->token = token;
+  entry->stdoutOpen = subprocess_stdout(process) != SUBPROCESS_NULL;
+  entry->stderrOpen = subprocess_stderr(process) != SUBPROCESS_NULL;
+  // With no pipes, no pipe will ever close to finish it, so it counts as finished already and
+  // the next wait reports it without blocking.
+  if (!entry->stdoutOpen && !entry->stderrOpen) {
+    poller->numFinishedOnAdd++;
+  }
+}
+
+ValeInt stdlib_poller_num_active(int64_t handle) {
+  return ((SubprocessPoller*)handle)->numEntries;
+}
+
+static ValeStr* poller_read(FILE* stream, int* open) {
+  ValeStr* chunk = read_chunk(stream, SUBPROCESS_POLL_CHUNK_SIZE);
+  if (chunk->length == 0) {
+    *open = 0;
+    free(chunk);
+    return NULL;
+  }
+  return chunk;
+}
+
+// Waits until at least one pipe has something (or is closed), or timeout_ms passes (negative
+// means forever), then reads everything that's ready. Returns how many subprocesses had news.
+ValeInt stdlib_poller_wait(int64_t handle, ValeInt timeout_ms) {
+  SubprocessPoller* poller = (SubprocessPoller*)handle;
+  poller_clear_events(poller);
+  if (poller->numEntries == 0) {
+    return 0;
+  }
+
+#ifdef _WIN32
+  // Windows pipes can't be polled, so just read them one after the other, which can stall if
+  // a subprocess fills the pipe we're not reading.
+  for (ValeInt i = 0; i < poller->numEntries; i++) {
+    SubprocessPollEntry* entry = &poller->entries[i];
+    SubprocessPollEvent* event = &poller->events[poller->numEvents++];
+    event->token = entry->token;
+    event->stdoutChunk =
+        entry->stdoutOpen ? poller_read(subprocess_stdout(entry->process), &entry->stdoutOpen) : NULL;
+    event->stderrChunk =
+        entry->stderrOpen ? poller_read(subprocess_stderr(entry->process), &entry->stderrOpen) : NULL;
+    event->finished = 0;
+    event->entryIndex = i;
+  }
+#else
+  for (ValeInt i = 0; i < poller->numEntries; i++) {
+    SubprocessPollEntry* entry = &poller->entries[i];
+    // poll ignores negative descriptors, which is how we skip the closed pipes.
+    poller->fds[i * 2].fd = entry->stdoutOpen ? fileno(subprocess_stdout(entry->process)) : -1;
+    poller->fds[i * 2].events = POLLIN;
+    poller->fds[i * 2].revents = 0;
+    poller->fds[i * 2 + 1].fd = entry->stderrOpen ? fileno(subprocess_stderr(entry->process)) : -1;
+    poller->fds[i * 2 + 1].events = POLLIN;
+    poller->fds[i * 2 + 1].revents = 0;
+  }
+  if (poller->numFinishedOnAdd > 0) {
+    // Someone's already finished, so just check who else has news.
+    timeout_ms = 0;
+  }
+  int numReady = poll(poller->fds, poller->numEntries * 2, timeout_ms < 0 ? -1 : timeout_ms);
+  if (numReady < 0) {
+    if (errno == EINTR) {
+      return 0;
+    }
+    perror("Couldn't poll subprocesses");
+    exit(1);
+  }
+  for (ValeInt i = 0; i < poller->numEntries; i++) {
+    SubprocessPollEntry* entry = &poller->entries[i];
+    short stdoutReady = poller->fds[i * 2].revents;
+    short stderrReady = poller->fds[i * 2 + 1].revents;
+    int finishedOnAdd = !entry->stdoutOpen && !entry->stderrOpen;
+    if (!stdoutReady && !stderrReady && !finishedOnAdd) {
+      continue;
+    }
+    SubprocessPollEvent* event = &poller->events[poller->numEvents++];
+    event->token = entry->token;
+    // A hang-up comes with no data, so the read sees the end and marks it closed.
+    event->stdoutChunk =
+        stdoutReady ? poller_read(subprocess_stdout(entry->process), &entry->stdoutOpen) : NULL;
+    event->stderrChunk =
+        stderrReady ? poller_read(subprocess_stderr(entry->process), &entry->stderrOpen) : NULL;
+    event->finished = 0;
+    event->entryIndex = i;
+  }
+#endif
+
+  // Report and drop whoever's pipes are both closed now. Going backwards, so the entry we swap
+  // into a removed one's place is always one we've already looked at.
+  poller->numFinishedOnAdd = 0;
+  for (ValeInt e = poller->numEvents - 1; e >= 0; e--) {
+    SubprocessPollEvent* event = &poller->events[e];
+    SubprocessPollEntry* entry = &poller->entries[event->entryIndex];
+    if (!entry->stdoutOpen && !entry->stderrOpen) {
+      event->finished = 1;
+      *entry = poller->entries[--poller->numEntries];
+    }
+  }
+  return poller->numEvents;
+}
+
+ValeInt stdlib_poller_event_token(int64_t handle, ValeInt i) {
+  return ((SubprocessPoller*)handle)->events[i].token;
+}
+
+static ValeStr* poller_take_chunk(ValeStr** chunk) {
+  ValeStr* result = *chunk;
+  *chunk = NULL;
+  if (!result) {
+    result = ValeStrNew(0);
+  }
+  return result;
+}
+
+ValeStr* stdlib_poller_event_stdout(int64_t handle, ValeInt i) {
+  return poller_take_chunk(&((SubprocessPoller*)handle)->events[i].stdoutChunk);
+}
+
+ValeStr* stdlib_poller_event_stderr(int64_t handle, ValeInt i) {
+  return poller_take_chunk(&((SubprocessPoller*)handle)->events[i].stderrChunk);
+}
+
+int8_t stdlib_poller_event_finished(int64_t handle, ValeInt i) {
+  return ((SubprocessPoller*)handle)->events[i].finished;
+}
+
+void stdlib_poller_destroy(int64_t handle) {
+  SubprocessPoller* poller = (SubprocessPoller*)handle;
+  poller_clear_events(poller);
+  free(poller->entries);
+  free(poller->events);
+#ifndef _WIN32
+  free(poller->fds);
+#endif
+  free(poller);
+}
@@ -32,6 +32,11 @@
 #include "stdlib/RemoveDirExtern.h"
 #include "stdlib/IsSymLinkExtern.h"
 #include "stdlib/RenameExtern.h"
+#include "stdlib/OpenFileReaderExtern.h"
+#include "stdlib/ReadFileChunkExtern.h"
+#include "stdlib/OpenFileWriterExtern.h"
+#include "stdlib/WriteFileChunkExtern.h"
+#include "stdlib/CloseFileExtern.h"
 
 
 
@@ -121,6 +126,7 @@ static int8_t makeDirectory_internal(char* path, char allow_already_existing) {
   return 1;
 }
 
+// Reads straight into the ValeStr we return, rather than into a temporary buffer first.
 static ValeStr* readFileAsString_internal(char* filename) {
   FILE *fp = fopen(filename, "rb");
   if (!fp) {
@@ -128,34 +134,59 @@ static ValeStr* readFileAsString_internal(char* filename) {
     exit(1);
   }
 
-  fseek(fp, 0L, SEEK_END);
-  long lSize = ftell(fp);
-  rewind(fp);
-
-  /* allocate memory for entire content */
-  char *buffer = malloc(lSize);
-  if (!buffer) {
+  // Regular files tell us their size up front. The +1 lets the first fread hit the end of the
+  // file, so we don't grow the buffer just to find out there's nothing more. Pipes and the like
+  // can't seek, so we just start small and double.
+  long capacity = 4096;
+  if (fseek(fp, 0L, SEEK_END) == 0) {
+    long size = ftell(fp);
+    if (size >= 0) {
+      capacity = size + 1;
+    }
+    rewind(fp);
+  }
+  if (capacity > INT32_MAX) {
     fclose(fp);
-    fputs("memory alloc fails", stderr);
+    fprintf(stderr, "File too big to read into a string: %s\n", filename);
     exit(1);
   }
 
-  /* copy the file into the buffer */
-  if (1 != fread(buffer, lSize, sizeof(char), fp)) {
+  ValeStr* result = ValeStrNew(capacity);
+  long length = 0;
+  while (1) {
+    if (length == capacity) {
+      capacity = capacity * 2 > INT32_MAX ? INT32_MAX : capacity * 2;
+      if (length == capacity) {
+        fclose(fp);
+        fprintf(stderr, "File too big to read into a string: %s\n", filename);
+        exit(1);
+      }
+      result = realloc(result, sizeof(ValeStr) + capacity + 1);
+      if (!result) {
+        fclose(fp);
+        fputs("memory alloc fails", stderr);
+        exit(1);
+      }
+    }
+    size_t numWanted = capacity - length;
+    size_t numRead = fread(result->chars + length, 1, numWanted, fp);
+    length += numRead;
+    if (numRead < numWanted) {
+      break;
+    }
+  }
+  if (ferror(fp)) {
     fclose(fp);
-    free(buffer);
+    free(result);
     fputs("Failed to read file: ", stderr);
     fputs(filename, stderr);
     fputs("\n", stderr);
     exit(1);
   }
-
-  ValeStr* result = ValeStrNew(lSize);
-  strncpy(result->chars, buffer, lSize);
-
   fclose(fp);
-  free(buffer);
 
+  result->length = length;
+  result->chars[length] = 0;
   return result;
 }
 
@@ -165,6 +196,8 @@ static void writeStringToFile_internal(char* filename, char* contents, int conte
     perror(filename);
     exit(1);
   }
+  // We hand over everything in one call anyway, so don't copy it through stdio's buffer.
+  setvbuf(fp, NULL, _IONBF, 0);
 
   if (contentsLen > 0) {
     if (1 != fwrite(contents, contentsLen, 1, fp)) {
@@ -295,6 +328,60 @@ extern int8_t stdlib_makeDirectory(ValeStr* path, int8_t allow_already_existing)
   return result;
 }
 
+// The streaming FileReader and FileWriter hold on to one of these FILE*s as an int64 handle.
+#define FILE_STREAM_BUFFER_SIZE 65536
+
+extern int64_t stdlib_OpenFileReaderExtern(ValeStr* path) {
+  FILE* fp = fopen(path->chars, "rb");
+  free(path);
+  if (!fp) {
+    return 0;
+  }
+  setvbuf(fp, NULL, _IOFBF, FILE_STREAM_BUFFER_SIZE);
+  return (int64_t)(intptr_t)fp;
+}
+
+// Returns up to max_bytes more of the file, or an empty string at the end of it. path.vale makes
+// sure max_bytes is above zero, so an empty string always means the end.
+extern ValeStr* stdlib_ReadFileChunkExtern(int64_t handle, ValeInt max_bytes) {
+  FILE* fp = (FILE*)(intptr_t)handle;
+  if (max_bytes <= 0) {
+    fputs("File chunk size must be above zero\n", stderr);
+    exit(1);
+  }
+  ValeStr* result = ValeStrNew(max_bytes);
+  size_t numRead = fread(result->chars, 1, max_bytes, fp);
+  if (numRead == 0 && ferror(fp)) {
+    fputs("Failed to read file chunk\n", stderr);
+    exit(1);
+  }
+  result->length = numRead;
+  result->chars[numRead] = 0;
+  return result;
+}
+
+extern int64_t stdlib_OpenFileWriterExtern(ValeStr* path, int8_t append) {
+  FILE* fp = fopen(path->chars, append ? "ab" : "wb");
+  free(path);
+  if (!fp) {
+    return 0;
+  }
+  setvbuf(fp, NULL, _IOFBF, FILE_STREAM_BUFFER_SIZE);
+  return (int64_t)(intptr_t)fp;
+}
+
+extern int8_t stdlib_WriteFileChunkExtern(int64_t handle, ValeStr* contents) {
+  FILE* fp = (FILE*)(intptr_t)handle;
+  int8_t result = contents->length == 0 || fwrite(contents->chars, contents->length, 1, fp) == 1;
+  free(contents);
+  return result;
+}
+
+// Returns false if writing out what was still buffered failed, like when the disk is full.
+extern int8_t stdlib_CloseFileExtern(int64_t handle) {
+  return fclose((FILE*)(intptr_t)handle) == 0;
+}
+
 extern ValeStr* stdlib_GetEnvPathSeparator() {
 #ifdef _WIN32
   return ValeStrFrom(";");
@@ -50,12 +50,18 @@ static char getche(void) {
 }
 #endif
 
+// From the builtins' stdio.c. Vale's prints are buffered separately from C's stdout, so we
+// flush them before reading, so that any prompt shows up first.
+void __vale_flushstdout();
+
 ValeInt stdlib_stdinReadInt() {
+  __vale_flushstdout();
   ValeInt x = 0;
   scanf("%d", &x);
   return x;
 }
 
 ValeInt stdlib_getch() {
+  __vale_flushstdout();
   return getch();
 }